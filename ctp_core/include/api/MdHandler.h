@@ -2,7 +2,9 @@
 
 #include "ThostFtdcMdApi.h"
 #include "network/Publisher.h"
+#include "market/TickNormalizer.h"
 #include <memory>
+#include <mutex>
 #include <string>
 #include <map>
 #include <set>
@@ -18,14 +20,20 @@ public:
     // 连接与登录
     void login();
     void subscribe(); // 订阅全部已存合约
-    void subscribe(const std::string& instrument);
+    // persist=false 时不写入 tb_subscriptions (进程内策略的订阅随策略存在，不跨重启保留)
+    void subscribe(const std::string& instrument, bool persist = true);
     void unsubscribe(const std::string& instrument);
     void join();
 
     // Callback for internal strategy engine
-    using TickCallback = std::function<void(const CThostFtdcDepthMarketDataField*)>;
+    // pData 的价格字段已清洗；normalized 为该合约的规整槽位 (交易所时间、成交量增量等)
+    using TickCallback = std::function<void(const CThostFtdcDepthMarketDataField*, const NormalizedTick&)>;
     void setTickCallback(TickCallback cb) { tick_callback_ = cb; }
 
+    // 转换后的 TickData (进程内策略)，与 TickCallback 同在行情线程调用
+    using TickDataCallback = std::function<void(const TickData&)>;
+    void setTickDataCallback(TickDataCallback cb) { tick_data_callback_ = cb; }
+
     // --- SPI 回调 ---
     void OnFrontConnected() override;
     void OnRspUserLogin(CThostFtdcRspUserLoginField *pRspUserLogin, CThostFtdcRspInfoField *pRspInfo, int nRequestID, bool bIsLast) override;
@@ -41,9 +49,13 @@ private:
     std::string password_;
     std::string md_front_;
     std::set<std::string> contracts_;
+    std::mutex contracts_mtx_; // 指令线程、策略线程与行情线程 (重连后重订) 都会访问 contracts_
+    char trading_day_[9] = {0}; // 当前交易日 (只在行情线程读写)
+    TickNormalizer normalizer_;  // 只在行情线程使用
 
     
     TickCallback tick_callback_; // Added
+    TickDataCallback tick_data_callback_;
 
 };
 
@@ -4,17 +4,20 @@
 
 #include "ThostFtdcTraderApi.h"
 #include "protocol/message_schema.h"
+#include <nlohmann/json.hpp>
 #include <atomic>
 #include <condition_variable>
 #include <cstring>
 #include <deque>
 #include <filesystem>
+#include <functional>
 #include <iostream>
 #include <map>
 #include <chrono>
 #include <iomanip>
 #include <memory>
 #include <mutex>
+#include <set>
 #include <string>
 #include <thread>
 #include <unordered_map>
@@ -64,6 +67,12 @@ public:
     void setCurrentStrategy(const std::string& strategy_id);
     std::string getCurrentStrategy() const;
 
+    // 委托/成交回报转发 (进程内策略)，在本账户的 CTP 交易线程调用，strategy_id 为报单时登记的策略
+    using OrderCallback = std::function<void(const std::string& strategy_id, const CThostFtdcOrderField&)>;
+    using TradeCallback = std::function<void(const std::string& strategy_id, const CThostFtdcTradeField&)>;
+    void setOrderCallback(OrderCallback cb) { order_callback_ = cb; }
+    void setTradeCallback(TradeCallback cb) { trade_callback_ = cb; }
+
     // --- SPI 回调 ---
     void OnFrontConnected() override;
     void OnRspAuthenticate(CThostFtdcRspAuthenticateField *pRspAuthenticateField, CThostFtdcRspInfoField *pRspInfo, int nRequestID, bool bIsLast) override;
@@ -99,10 +108,27 @@ private:
     void queryLoop();
     void updateLocalPosition(CThostFtdcTradeField *pTrade);
     void updateLocalAccount(CThostFtdcTradeField *pTrade, double commission, double realized_pnl);
+
+    // 持仓扁平化 (每个方向一条)，供推送和快照共用
+    std::vector<PositionData> collectPositions();
+    // 同时推送 JSON (PT) 与二进制 (PB)
+    void publishPosition(const PositionData& data, int64_t snapshot_seq);
+    // 委托缓存 key: FrontID:SessionID:OrderRef (报单全生命周期唯一)
+    static std::string orderKey(const CThostFtdcOrderField& order);
+    void cacheOrder(const CThostFtdcOrderField& order);
+    bool cacheTrade(const TradeData& trade); // 已存在返回 false
+    // 登录后在 restore_thread_ 上查库恢复当日报单/成交 (不占用 CTP 回调线程)，并入缓存后推送
+    void restoreDayOrdersAndTrades(std::string trading_day);
+    // 共享合约缓存更新时同步到本账户的 PositionManager
+    void syncInstrumentMeta(const InstrumentMeta& meta);
     
     // New: Position Manager
     PositionManager m_posManager;
 
+    // 盯市推送限频: 合约 -> 上次推送时间 (steady ms)，只在行情线程访问
+    static constexpr int64_t kPnlPushIntervalMs = 500;
+    std::unordered_map<std::string, int64_t> pnl_push_ms_;
+
     CThostFtdcTraderApi* td_api_ = nullptr;
     Publisher& pub_;
 
@@ -113,6 +139,11 @@ private:
     std::string app_id_;
     std::string auth_code_;
 
+    // 多账户: account_id 用于 topic/指令路由；primary 账户负责合约与费率查询
+    std::string account_id_;
+    bool primary_ = true;
+    int listener_id_ = 0;
+
     int front_id_ = 0;
     int session_id_ = 0;
     std::string current_trading_day_; // Added
@@ -126,9 +157,10 @@ private:
     // High performance cache
     long long cached_second_ = 0;       // 缓存的秒时间戳
     char cached_ref_prefix_[10] = {0};  // 缓存的 "DDHHMMSS" 字符串
+    int last_ref_ms_ = -1;              // 上一次生成 OrderRef 的毫秒数
+    int ref_ms_offset_ = 0;             // 同一毫秒内的碰撞偏移
 
-    // 缓存
-    std::map<std::string, InstrumentMeta> instrument_cache_;
+    // 缓存 (合约属性/费率在 InstrumentCache 中跨账户共享)
     AccountData account_cache_;
 
     // 查询队列 (线程安全)
@@ -136,9 +168,11 @@ private:
     std::deque<std::string> low_priority_queue_;  // Others (if needed)
     // 去重
     std::unordered_set<std::string> queried_set_; // Avoid dup query in session
+    std::unordered_set<std::string> instrument_retry_set_; // 已补查过合约信息的 ID (只在本账户 SPI 线程访问)
     std::mutex queue_mtx_;
     std::condition_variable queue_cv_;
     std::thread query_thread_;
+    std::thread restore_thread_;
     std::atomic<bool> running_{false};
 
     // Request ID mapping for async queries
@@ -150,10 +184,15 @@ private:
     std::string current_strategy_id_; // Default/Active Strategy
     std::map<std::string, std::string> order_strategy_map_;
     std::mutex order_strategy_mtx_;
+
+    OrderCallback order_callback_;
+    TradeCallback trade_callback_;
     
-    // Day Orders/Trades Cache
-    std::vector<CThostFtdcOrderField> order_cache_;
+    // Day Orders/Trades Cache (account_cache_ 同样受 cache_mtx_ 保护)
+    std::unordered_map<std::string, CThostFtdcOrderField> order_cache_;
     std::vector<TradeData> trade_cache_;
+    std::unordered_set<std::string> trade_keys_; // ExchangeID:TradeID 去重
+    std::mutex cache_mtx_;
 
 public:
     // 推送所有缓存的持仓和资金
@@ -165,6 +204,24 @@ public:
     // 推送当日所有委托和成交（用于前端重连）
     void pushCachedOrdersAndTrades();
 
+    /**
+     * @brief 将本账户状态追加到一致性快照 (req_snapshot)
+     * 调用方需先取 Publisher 序号再调用，保证快照不早于返回的 seq；
+     * 持仓/委托/成交逐条带 account_id，资金追加到 snap["accounts"]
+     * @param topics 需要的 topic (PT/PB/AT/OT/TT)，为空表示全部
+     */
+    void appendSnapshot(const std::set<std::string>& topics, nlohmann::json& snap);
+
+    /**
+     * @brief 行情盯市 (行情线程调用): 重算该合约浮动盈亏，变化时推送二进制持仓 (PB)
+     * 按合约限频 kPnlPushIntervalMs
+     */
+    void onMarketPrice(const CThostFtdcDepthMarketDataField& tick);
+
+    const std::string& accountId() const { return account_id_; }
+    const std::string& tradingDay() const { return current_trading_day_; }
+    bool isPrimary() const { return primary_; }
+
     void loadInstrumentsFromDB();
     void loadDayOrdersFromDB();
     void syncSubscribedInstruments();
@@ -0,0 +1,65 @@
+#pragma once
+
+#include "protocol/message_schema.h"
+#include "market/TradingSession.h"
+#include "market/TickNormalizer.h"
+#include "ThostFtdcUserApiStruct.h"
+#include <functional>
+#include <unordered_map>
+#include <string>
+#include <vector>
+
+namespace QuantLabs {
+
+/**
+ * @brief 实时 K 线合成引擎
+ * 挂在 MdHandler 的 Tick 回调上，按合约维护各周期的增量 Bar 状态。
+ * - 成交量/成交额增量取自 TickNormalizer (交易日切换时归零)
+ * - 按品种交易时间表归一 Tick 时间 (集合竞价、收盘 Tick、夜盘跨零点)
+ * - 自然日由本机时钟修正，交易日取 Tick 的 TradingDay (MdHandler 已统一修正)
+ *
+ * 线程模型: onTick 只在 CTP 行情线程调用，内部无锁。
+ */
+class BarEngine {
+public:
+    explicit BarEngine(std::vector<int> periods = {1, 60, 300});
+
+    // Bar 更新 (status=0) 与完成 (status=1) 都通过此回调输出，每根 Bar 的完成只输出一次
+    using BarCallback = std::function<void(const BarData&)>;
+    void setBarCallback(BarCallback cb) { bar_callback_ = cb; }
+
+    // 是否推送更新中的 Bar (关闭后只推送已完成 Bar)
+    void setPublishUpdates(bool enabled) { publish_updates_ = enabled; }
+
+    void onTick(const CThostFtdcDepthMarketDataField* pData, const NormalizedTick& tick);
+
+    // 强制完成所有未结束的 Bar (退出时调用)
+    void flushAll();
+
+private:
+    struct PeriodState {
+        BarData bar;
+        bool active = false;
+        // 迟到 Tick (所属 Bar 已完成) 的成交量/成交额增量，计入下一根 Bar
+        int64_t carry_volume = 0;
+        double carry_turnover = 0.0;
+    };
+
+    struct InstrumentState {
+        const std::vector<SessionRange>* sessions = nullptr;
+        std::vector<PeriodState> periods;
+    };
+
+    InstrumentState& stateFor(const char* instrument_id);
+    void closeBar(PeriodState& ps);
+    void sweepExpired(int64_t now_ms);
+
+    std::vector<int> periods_;
+    std::unordered_map<std::string, InstrumentState> states_;
+    bool publish_updates_ = true;
+
+    int64_t last_sweep_sec_ = 0;  // 上次扫描的交易所时间 (秒)
+    BarCallback bar_callback_;
+};
+
+} // namespace QuantLabs
@@ -0,0 +1,315 @@
+#pragma once
+
+#include "protocol/message_schema.h"
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace QuantLabs {
+
+// 合约句柄: 登记时按顺序分配的稠密下标，进程内不变
+using InstrumentId = uint32_t;
+constexpr InstrumentId kInvalidInstrument = 0xFFFFFFFFu;
+
+/**
+ * @brief 合约登记表 (进程内所有账户共享)
+ *
+ * - 每个合约登记时分配稠密整数句柄，属性按句柄存放在分块连续数组中 (块地址不变，只追加)
+ * - 合约代码 -> 句柄: 只增不删的开放寻址哈希表，桶内存 32 位指纹 + 句柄，命中通常只需一次探测
+ * - 读者无锁: 查找只做 acquire 读取；属性按条目 seqlock 拷贝，读到写入中的条目时重试
+ * - 写者 (合约/费率查询、DB 加载) 由互斥锁串行化，每次写入后通知监听者
+ *
+ * 热路径应在订阅/下单时取一次句柄 (find/intern)，之后按句柄读取属性。
+ */
+class InstrumentCache {
+public:
+    using Listener = std::function<void(const InstrumentMeta&)>;
+
+    static constexpr uint32_t kChunkBits = 12;                 // 每块 4096 个合约
+    static constexpr uint32_t kMaxChunks = 32;
+    static constexpr uint32_t kMaxInstruments = kMaxChunks << kChunkBits; // 131072
+    static constexpr uint32_t kIndexBits = 18;                 // 桶数为容量的 2 倍，装载率不超过 50%
+
+    static InstrumentCache& instance() {
+        static InstrumentCache i;
+        return i;
+    }
+
+    // ---- 句柄 ----
+
+    // 查找句柄 (无锁)，未登记返回 kInvalidInstrument
+    InstrumentId find(std::string_view id) const {
+        if (id.empty() || id.size() >= sizeof(InstrumentMeta::instrument_id)) return kInvalidInstrument;
+        const uint64_t h = hash(id);
+        const uint32_t tag = static_cast<uint32_t>(h >> 32);
+        for (uint32_t i = static_cast<uint32_t>(h) & kIndexMask;; i = (i + 1) & kIndexMask) {
+            const uint64_t v = index_[i].load(std::memory_order_acquire);
+            if (v == 0) return kInvalidInstrument;
+            if (static_cast<uint32_t>(v >> 32) != tag) continue;
+            const InstrumentId handle = static_cast<uint32_t>(v) - 1;
+            const Entry& e = entry(handle);
+            if (std::memcmp(e.key, id.data(), id.size()) == 0 && e.key[id.size()] == '\0') return handle;
+        }
+    }
+
+    // CTP 定长字段不一定以 0 结尾
+    template <size_t N>
+    InstrumentId find(const char (&id)[N]) const {
+        return find(std::string_view(id, strnlen(id, N)));
+    }
+    InstrumentId find(const std::string& id) const { return find(std::string_view(id)); }
+
+    // 查找或登记 (只登记代码，属性待查询写入)；容量用尽返回 kInvalidInstrument
+    InstrumentId intern(std::string_view id) {
+        InstrumentId handle = find(id);
+        if (handle != kInvalidInstrument || id.empty() || id.size() >= sizeof(InstrumentMeta::instrument_id)) return handle;
+        std::lock_guard<std::mutex> lock(write_mtx_);
+        return internLocked(id);
+    }
+
+    // 合约代码 (登记后不变)
+    const char* name(InstrumentId handle) const {
+        return handle < count_.load(std::memory_order_acquire) ? entry(handle).key : "";
+    }
+
+    // ---- 按句柄读取 (无锁) ----
+
+    bool get(InstrumentId handle, InstrumentMeta& out) const {
+        if (handle >= count_.load(std::memory_order_acquire)) return false;
+        return read(entry(handle), [&](const InstrumentMeta& m) { std::memcpy(&out, &m, sizeof(InstrumentMeta)); });
+    }
+
+    // 合约乘数，未知或无效时返回 1
+    int volumeMultiple(InstrumentId handle) const {
+        int mult = 0;
+        if (handle < count_.load(std::memory_order_acquire)) {
+            read(entry(handle), [&](const InstrumentMeta& m) { mult = m.volume_multiple; });
+        }
+        return mult > 0 ? mult : 1;
+    }
+
+    // 最小变动价位，未知返回 0
+    double priceTick(InstrumentId handle) const {
+        double tick = 0.0;
+        if (handle < count_.load(std::memory_order_acquire)) {
+            read(entry(handle), [&](const InstrumentMeta& m) { tick = m.price_tick; });
+        }
+        return tick;
+    }
+
+    std::string exchangeId(InstrumentId handle) const {
+        char exch[sizeof(InstrumentMeta::exchange_id)] = {0};
+        if (handle < count_.load(std::memory_order_acquire)) {
+            read(entry(handle), [&](const InstrumentMeta& m) { std::memcpy(exch, m.exchange_id, sizeof(exch)); });
+        }
+        return std::string(exch, strnlen(exch, sizeof(exch)));
+    }
+
+    // ---- 按代码读取 (兼容接口，内部先查句柄) ----
+
+    bool get(const std::string& id, InstrumentMeta& out) const { return get(find(id), out); }
+    template <size_t N>
+    bool get(const char (&id)[N], InstrumentMeta& out) const { return get(find(id), out); }
+    bool contains(const std::string& id) const {
+        InstrumentMeta meta;
+        return get(find(id), meta);
+    }
+    int volumeMultiple(const std::string& id) const { return volumeMultiple(find(id)); }
+    template <size_t N>
+    int volumeMultiple(const char (&id)[N]) const { return volumeMultiple(find(id)); }
+    std::string exchangeId(const std::string& id) const { return exchangeId(find(id)); }
+
+    // 当日已查询且有有效数据 (无需再查费率)
+    bool isFresh(const std::string& id, const std::string& trading_day) const {
+        InstrumentMeta meta;
+        return get(find(id), meta) && trading_day == meta.trading_day && meta.price_tick > 0;
+    }
+
+    size_t countForDay(const std::string& trading_day) const {
+        size_t n = 0;
+        forEach([&](InstrumentId, const InstrumentMeta& meta) {
+            if (trading_day == meta.trading_day) ++n;
+        });
+        return n;
+    }
+
+    // 有属性的合约数 (不含只登记了代码的)
+    size_t size() const { return loaded_.load(std::memory_order_acquire); }
+    // 已分配的句柄数，句柄范围 [0, handleCount())
+    uint32_t handleCount() const { return count_.load(std::memory_order_acquire); }
+
+    std::vector<InstrumentMeta> all() const {
+        std::vector<InstrumentMeta> out;
+        out.reserve(size());
+        forEach([&](InstrumentId, const InstrumentMeta& meta) { out.push_back(meta); });
+        return out;
+    }
+
+    // 按句柄顺序遍历有属性的合约 (每条为一致快照)
+    template <typename F>
+    void forEach(F&& fn) const {
+        const uint32_t n = count_.load(std::memory_order_acquire);
+        InstrumentMeta meta;
+        for (InstrumentId h = 0; h < n; ++h) {
+            if (get(h, meta)) fn(h, meta);
+        }
+    }
+
+    // ---- 写入 ----
+
+    /**
+     * @brief 原地修改 (不存在则登记)，返回修改后的副本
+     * fn 在写锁内对副本执行，只应做字段赋值
+     */
+    template <typename F>
+    InstrumentMeta update(const std::string& id, F&& fn, bool notify_listeners = true) {
+        InstrumentMeta copy;
+        {
+            std::lock_guard<std::mutex> lock(write_mtx_);
+            InstrumentId handle = internLocked(id);
+            if (handle == kInvalidInstrument) return copy;
+            Entry& e = entry(handle);
+            if (e.seq.load(std::memory_order_relaxed) != 0) copy = e.meta; // 写者串行，无需 seqlock
+            fn(copy);
+            std::strncpy(copy.instrument_id, e.key, sizeof(copy.instrument_id) - 1);
+            write(e, copy);
+        }
+        if (notify_listeners) notify(copy);
+        return copy;
+    }
+
+    void upsert(const InstrumentMeta& meta, bool notify_listeners = true) {
+        update(meta.instrument_id, [&](InstrumentMeta& m) { m = meta; }, notify_listeners);
+    }
+
+    int addListener(Listener listener) {
+        std::lock_guard<std::mutex> lock(listener_mtx_);
+        int id = next_listener_id_++;
+        listeners_.emplace_back(id, std::move(listener));
+        return id;
+    }
+
+    void removeListener(int id) {
+        std::lock_guard<std::mutex> lock(listener_mtx_);
+        for (auto it = listeners_.begin(); it != listeners_.end(); ++it) {
+            if (it->first == id) {
+                listeners_.erase(it);
+                return;
+            }
+        }
+    }
+
+private:
+    static constexpr uint32_t kChunkSize = 1u << kChunkBits;
+    static constexpr uint32_t kIndexMask = (1u << kIndexBits) - 1;
+
+    struct Entry {
+        std::atomic<uint32_t> seq{0};   // 0: 只登记了代码；奇数: 写入中；偶数: 可读
+        char key[sizeof(InstrumentMeta::instrument_id)] = {0}; // 登记后不变
+        InstrumentMeta meta;
+    };
+
+    InstrumentCache() : index_(new std::atomic<uint64_t>[1u << kIndexBits]) {
+        for (uint32_t i = 0; i <= kIndexMask; ++i) index_[i].store(0, std::memory_order_relaxed);
+        for (auto& c : chunks_) c.store(nullptr, std::memory_order_relaxed);
+    }
+    ~InstrumentCache() {
+        for (auto& c : chunks_) delete[] c.load(std::memory_order_relaxed);
+    }
+
+    // FNV-1a；低位定桶，高 32 位作指纹
+    static uint64_t hash(std::string_view s) {
+        uint64_t h = 1469598103934665603ULL;
+        for (unsigned char c : s) {
+            h ^= c;
+            h *= 1099511628211ULL;
+        }
+        return h ^ (h >> 29);
+    }
+
+    Entry& entry(InstrumentId handle) const {
+        return chunks_[handle >> kChunkBits].load(std::memory_order_acquire)[handle & (kChunkSize - 1)];
+    }
+
+    // 须持有 write_mtx_
+    InstrumentId internLocked(std::string_view id) {
+        InstrumentId handle = find(id);
+        if (handle != kInvalidInstrument) return handle;
+        if (id.empty() || id.size() >= sizeof(InstrumentMeta::instrument_id)) return kInvalidInstrument;
+
+        handle = count_.load(std::memory_order_relaxed);
+        if (handle >= kMaxInstruments) {
+            std::cerr << "[InstrumentCache] Capacity exhausted (" << kMaxInstruments << "), " << id << " not registered" << std::endl;
+            return kInvalidInstrument;
+        }
+        auto& chunk = chunks_[handle >> kChunkBits];
+        if (!chunk.load(std::memory_order_relaxed)) chunk.store(new Entry[kChunkSize], std::memory_order_release);
+        Entry& e = entry(handle);
+        std::memcpy(e.key, id.data(), id.size());
+        count_.store(handle + 1, std::memory_order_release);
+
+        // 最后发布桶: 读者看到桶时代码与块指针都已可见
+        const uint64_t h = hash(id);
+        uint32_t i = static_cast<uint32_t>(h) & kIndexMask;
+        while (index_[i].load(std::memory_order_relaxed) != 0) i = (i + 1) & kIndexMask;
+        index_[i].store((static_cast<uint64_t>(h >> 32) << 32) | (handle + 1), std::memory_order_release);
+        return handle;
+    }
+
+    // seqlock 读: 拷贝期间有写入则重试；无属性返回 false
+    template <typename F>
+    static bool read(const Entry& e, F&& copy) {
+        for (;;) {
+            const uint32_t s1 = e.seq.load(std::memory_order_acquire);
+            if (s1 == 0) return false;
+            if (s1 & 1) {
+                std::this_thread::yield();
+                continue;
+            }
+            copy(e.meta);
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (e.seq.load(std::memory_order_relaxed) == s1) return true;
+        }
+    }
+
+    // 须持有 write_mtx_
+    void write(Entry& e, const InstrumentMeta& meta) {
+        const uint32_t s = e.seq.load(std::memory_order_relaxed);
+        e.seq.store(s + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        std::memcpy(&e.meta, &meta, sizeof(InstrumentMeta));
+        e.seq.store(s + 2, std::memory_order_release);
+        if (s == 0) loaded_.fetch_add(1, std::memory_order_release);
+    }
+
+    // 在锁外回调，避免监听者内部再访问缓存时死锁
+    void notify(const InstrumentMeta& meta) {
+        std::vector<std::pair<int, Listener>> listeners;
+        {
+            std::lock_guard<std::mutex> lock(listener_mtx_);
+            listeners = listeners_;
+        }
+        for (const auto& [id, fn] : listeners) fn(meta);
+    }
+
+    std::mutex write_mtx_;
+    std::unique_ptr<std::atomic<uint64_t>[]> index_; // (指纹 << 32) | (句柄 + 1)，0 为空桶
+    mutable std::atomic<Entry*> chunks_[kMaxChunks];
+    std::atomic<uint32_t> count_{0};
+    std::atomic<size_t> loaded_{0};
+
+    std::mutex listener_mtx_;
+    std::vector<std::pair<int, Listener>> listeners_;
+    int next_listener_id_ = 1;
+};
+
+} // namespace QuantLabs
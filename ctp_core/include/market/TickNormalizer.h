@@ -0,0 +1,99 @@
+#pragma once
+
+#include "market/InstrumentCache.h"
+#include "ThostFtdcUserApiStruct.h"
+#include <cstdint>
+#include <ctime>
+#include <memory>
+
+namespace QuantLabs {
+
+/**
+ * @brief 规整后的 Tick (每合约一个预分配槽位)
+ * 价格字段集中在一个连续数组里，清洗时可整体向量化处理；无效价 (DBL_MAX/NaN/超界) 统一为 0。
+ */
+struct alignas(64) NormalizedTick {
+    enum PriceField : uint8_t {
+        Last = 0,
+        Bid1, Bid2, Bid3, Bid4, Bid5,
+        Ask1, Ask2, Ask3, Ask4, Ask5,
+        Open, High, Low, Close, Settlement,
+        PreSettlement, PreClose, UpperLimit, LowerLimit, Average,
+        kPriceFields,
+        kPriceSlots = 24 // 补齐到 3 个缓存行
+    };
+
+    double price[kPriceSlots];
+    int32_t bid_volume[5];
+    int32_t ask_volume[5];
+
+    int64_t exchange_time;   // 交易所时间 (UTC epoch 毫秒)
+    int64_t volume;          // 当日累计成交量
+    int64_t volume_delta;    // 相对上一笔的增量 (启动后首笔为 0，交易日切换后从 0 起算)
+    double turnover;
+    double turnover_delta;
+    double open_interest;
+    double open_interest_delta;
+    int trading_day;         // YYYYMMDD
+    uint32_t count;          // 本合约已接受的 Tick 数
+    InstrumentId instrument;
+
+    double bid(int level) const { return price[Bid1 + level]; }
+    double ask(int level) const { return price[Ask1 + level]; }
+};
+
+/**
+ * @brief 行情规整阶段 (MdHandler 内，所有消费者之前)
+ *
+ * - 清洗全部价格字段并写回 CTP 结构体，下游不再各自判断 DBL_MAX
+ * - 由 ActionDay/UpdateTime/UpdateMillisec 推出交易所时间 (epoch 毫秒)
+ * - 按合约检测重复与乱序 Tick (累计成交量回退，或时间回退且成交量未增加)
+ * - 计算成交量/成交额/持仓量增量
+ *
+ * 槽位按 InstrumentCache 句柄分块预分配，地址不变。只在 CTP 行情线程调用，内部无锁。
+ */
+class TickNormalizer {
+public:
+    enum class Result : uint8_t { Accepted, Invalid, Duplicate, OutOfOrder };
+
+    struct Stats {
+        uint64_t accepted = 0;
+        uint64_t invalid = 0;
+        uint64_t duplicate = 0;
+        uint64_t out_of_order = 0;
+    };
+
+    TickNormalizer();
+
+    /**
+     * @brief 规整一笔行情 (原地清洗 pData 的价格字段)
+     * @param out 接受时指向该合约的槽位，下一笔同合约行情前有效
+     */
+    Result normalize(CThostFtdcDepthMarketDataField& data, const NormalizedTick*& out);
+
+    // 最近一次接受的行情 (未收到返回 nullptr)
+    const NormalizedTick* slot(InstrumentId handle) const;
+
+    const Stats& stats() const { return stats_; }
+
+    // |价格| 超过该值视为无效 (CTP 空值为 DBL_MAX)
+    static constexpr double kMaxPrice = 1e12;
+
+private:
+    static constexpr uint32_t kChunkBits = InstrumentCache::kChunkBits;
+    static constexpr uint32_t kChunkSize = 1u << kChunkBits;
+    static constexpr uint32_t kMaxChunks = InstrumentCache::kMaxChunks;
+
+    NormalizedTick& slotFor(InstrumentId handle);
+    int actionDay(const CThostFtdcDepthMarketDataField& data, int sod);
+
+    std::unique_ptr<NormalizedTick[]> chunks_[kMaxChunks];
+    Stats stats_;
+
+    // 夜盘按本机时钟推算自然日，结果缓存 (同一秒内、同一小时段的行情只算一次)
+    std::time_t day_cache_now_ = 0;
+    int day_cache_hour_ = -1;
+    int day_cache_value_ = 0;
+};
+
+} // namespace QuantLabs
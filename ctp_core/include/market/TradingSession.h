@@ -0,0 +1,38 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace QuantLabs {
+
+/**
+ * @brief 交易时段 [start, end) (当日秒数)
+ * 跨零点的夜盘拆成两段: [21:00, 24:00) + [00:00, 02:30)
+ */
+struct SessionRange {
+    int start;
+    int end;
+    bool has_auction; // 开盘前有集合竞价 (20:59 / 08:59 / 09:29 的 Tick 归入首根 Bar)
+    bool is_close;    // end 是真正的收盘点 (收盘 Tick 归入最后一根 Bar)
+};
+
+/**
+ * @brief 品种交易时间表
+ * 按品种代码 (合约代码的字母前缀, 如 rb2505 -> rb) 查找，未知品种返回空表 (不做时段过滤)
+ */
+class TradingSession {
+public:
+    static const std::vector<SessionRange>& lookup(const std::string& instrument_id);
+
+    // 合约代码 -> 品种代码
+    static std::string productOf(const std::string& instrument_id);
+
+    /**
+     * @brief 将 Tick 时间归一到交易时段内
+     * @return 归一后的当日秒数; 不在任何交易时段 (含容差) 内返回 -1
+     * @param at_close 输出: 该 Tick 是否为收盘 Tick
+     */
+    static int normalize(const std::vector<SessionRange>& sessions, int sec_of_day, bool& at_close);
+};
+
+} // namespace QuantLabs
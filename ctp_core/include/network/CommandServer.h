@@ -2,15 +2,26 @@
 
 #include <zmq.hpp>
 #include <nlohmann/json.hpp>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <set>
+#include <string>
 #include <thread>
 #include <atomic>
 #include <functional>
+#include <vector>
 
 namespace QuantLabs {
 
 /**
- * @brief ZMQ REP 服务器
+ * @brief ZMQ ROUTER 指令服务器
  * 接收来自前端的指令并回调处理
+ *
+ * - 兼容 REQ 与 DEALER 客户端: 空帧及其之前的帧都视为信封，应答时原样带回
+ *   (DEALER 客户端把请求号放在信封里，可以同时有多条指令在途、乱序应答)
+ * - slow_types 中的指令 (查库、全量推送) 交给独立线程顺序处理，
+ *   下单/撤单等其余指令仍在接收线程内即时处理，不会排在慢查询后面
  */
 class CommandServer {
 public:
@@ -19,17 +30,32 @@ public:
 
     using CommandCallback = std::function<std::string(const nlohmann::json&)>;
 
-    void start(const std::string& addr, CommandCallback callback);
+    void start(const std::string& addr, CommandCallback callback, std::set<std::string> slow_types = {});
     void stop();
 
 private:
+    struct SlowRequest {
+        std::vector<zmq::message_t> envelope;
+        nlohmann::json request;
+    };
+
     void run();
+    void slowLoop();
+    std::string handle(const nlohmann::json& request);
+    static void sendReply(zmq::socket_t& socket, std::vector<zmq::message_t>& envelope, const std::string& reply);
 
     std::string addr_;
     CommandCallback callback_;
+    std::set<std::string> slow_types_;
     std::thread thread_;
     std::atomic<bool> running_{false};
     zmq::context_t context_;
+
+    // 慢指令队列 (接收线程写入，慢指令线程取出；应答经 inproc 交回接收线程发送)
+    std::thread slow_thread_;
+    std::mutex slow_mtx_;
+    std::condition_variable slow_cv_;
+    std::deque<SlowRequest> slow_queue_;
 };
 
 } // namespace QuantLabs
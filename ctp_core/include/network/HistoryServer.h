@@ -0,0 +1,86 @@
+#pragma once
+
+#include "storage/TickStoreReader.h"
+#include <zmq.hpp>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <list>
+#include <unordered_map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace QuantLabs {
+
+// 单次历史查询最多返回的记录数 (请求中的 limit 超出时截断)
+static constexpr size_t kMaxHistoryRows = 1000000;
+
+/**
+ * @brief 历史查询请求
+ * 由指令通道 (req_history_query) 提交，结果经 HistoryServer 的 ROUTER 套接字分块回传
+ */
+struct HistoryQuery {
+    uint64_t query_id = 0;
+    std::string client_id;          // 客户端 DEALER 的 routing_id
+    StoreRecordType type = StoreRecordType::BAR;
+    std::string instrument_id;
+    int period = 60;                // Bar 周期 (秒)
+    int64_t start_time = 0;         // UTC epoch 毫秒 (含)
+    int64_t end_time = 0;           // UTC epoch 毫秒 (含)
+    size_t limit = 100000;
+};
+
+/**
+ * @brief 历史数据服务 (独立线程 + ROUTER 套接字)
+ * 查询在本线程执行 (mmap 读本地存储，按块直接发出)，不阻塞 CommandServer；
+ * 最近查询过的区间缓存在 LRU 中。客户端不收数据时发送超时，丢弃该查询。
+ */
+class HistoryServer {
+public:
+    HistoryServer();
+    ~HistoryServer();
+
+    void start(const std::string& addr, const std::string& store_root);
+    void stop();
+
+    // 入队并立即返回 query_id (CommandServer 线程调用)
+    uint64_t submit(HistoryQuery query);
+
+private:
+    using Records = std::shared_ptr<const std::vector<char>>;
+
+    void run();
+    void process(zmq::socket_t& socket, const HistoryQuery& q);
+    bool sendFrames(zmq::socket_t& socket, const std::string& client_id, const std::string& header,
+                    zmq::message_t data);
+
+    // --- LRU 缓存 (仅工作线程访问) ---
+    struct CacheEntry {
+        std::string key;
+        Records records;
+    };
+    Records cacheGet(const std::string& key);
+    void cachePut(const std::string& key, Records records);
+
+    std::list<CacheEntry> lru_;
+    std::unordered_map<std::string, std::list<CacheEntry>::iterator> lru_index_;
+    size_t cache_bytes_ = 0;
+    size_t cache_capacity_ = 64 * 1024 * 1024;
+
+    std::string addr_;
+    std::unique_ptr<TickStoreReader> reader_;
+
+    std::deque<HistoryQuery> queries_;
+    std::mutex mtx_;
+    std::condition_variable cv_;
+    std::atomic<uint64_t> next_query_id_{1};
+
+    std::thread thread_;
+    std::atomic<bool> running_{false};
+    zmq::context_t context_;
+};
+
+} // namespace QuantLabs
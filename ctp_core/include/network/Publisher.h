@@ -6,6 +6,9 @@
 #include <nlohmann/json.hpp>
 #include <string>
 #include <memory>
+#include <mutex>
+#include <map>
+#include <unordered_map>
 
 namespace QuantLabs {
 
@@ -26,12 +29,24 @@ public:
     void publishTick(const TickData& data);
     void publishTickBinary(const TickData& data);
 
+    /**
+     * @brief 发送 K 线数据 (二进制 BarData)
+     */
+    void publishBarBinary(const BarData& data);
+
     /**
      * @brief 发送持仓数据
      * @param data 持仓数据
      * @param snapshot_seq 快照批次号（0=增量更新，>0=快照批次ID）
+     * @param account_id 所属账户 (非空时 topic 带账户后缀，payload 带 account_id 字段)
      */
-    void publishPosition(const PositionData& data, int64_t snapshot_seq = 0);
+    void publishPosition(const PositionData& data, int64_t snapshot_seq = 0, const std::string& account_id = "");
+
+    /**
+     * @brief 发送持仓数据 (二进制 PositionData，topic "PB|<account_id>")
+     * 成交变动与行情盯市 (浮动盈亏) 都走这里，客户端无需再自行计算
+     */
+    void publishPositionBinary(const PositionData& data, const std::string& account_id = "");
 
     /**
      * @brief 发送合约基础信息
@@ -41,27 +56,50 @@ public:
     /**
      * @brief 发送账户资金数据
      */
-    void publishAccount(const AccountData& data);
+    void publishAccount(const AccountData& data, const std::string& account_id = "");
 
     /**
      * @brief 发送报单回报
      */
-    void publishOrder(const CThostFtdcOrderField* pOrder);
+    void publishOrder(const CThostFtdcOrderField* pOrder, const std::string& account_id = "");
 
     /**
      * @brief 发送成交换单
      */
-    void publishTrade(const CThostFtdcTradeField* pTrade, double commission = 0.0, double close_profit = 0.0);
-    void publishTrade(const TradeData& data);
+    void publishTrade(const CThostFtdcTradeField* pTrade, double commission = 0.0, double close_profit = 0.0, const std::string& account_id = "");
+    void publishTrade(const TradeData& data, const std::string& account_id = "");
 
     /**
      * @brief 发送通用消息 (Topic + Message)
      */
     void publish(const std::string& topic, const std::string& message);
 
+    /**
+     * @brief 当前各 topic 已发布的最大序号 (快照对齐用)
+     */
+    std::map<std::string, uint64_t> sequenceSnapshot();
+
+    // "<topic>|<account_id>" (account_id 为空时即 topic 本身)
+    static std::string accountTopic(const char* topic, const std::string& account_id);
+
+    // JSON 序列化 (推送与快照共用同一格式)
+    static nlohmann::json positionToJson(const PositionData& data);
+    static nlohmann::json accountToJson(const AccountData& data);
+    static nlohmann::json instrumentToJson(const InstrumentMeta& data);
+    static nlohmann::json orderToJson(const CThostFtdcOrderField& order);
+    static nlohmann::json tradeToJson(const TradeData& data);
+
 private:
+    // 所有发送都经过这里: 加锁分配序号并发送三帧 [topic][MessageHeader][payload]
+    // 同时保证多线程 (行情/交易/指令线程) 共用一个 socket 的安全
+    void send(const char* topic, size_t topic_len, const void* data, size_t size);
+    void sendJson(const char* topic, const std::string& account_id, nlohmann::json& j);
+
     std::unique_ptr<zmq::context_t> context_;
     std::unique_ptr<zmq::socket_t> publisher_;
+
+    std::mutex send_mtx_;
+    std::unordered_map<std::string, uint64_t> topic_seq_;
 };
 
 } // namespace QuantLabs
@@ -0,0 +1,52 @@
+#pragma once
+
+#include "protocol/shm_market_bus.h"
+#include <string>
+#include <unordered_map>
+
+namespace QuantLabs {
+
+/**
+ * @brief 共享内存行情总线写端 (布局与读端见 shared/protocol/shm_market_bus.h)
+ * 只允许行情线程调用 publish()，无锁；未启用时 publish() 直接返回
+ */
+class ShmMarketWriter {
+public:
+    static ShmMarketWriter& instance() {
+        static ShmMarketWriter i;
+        return i;
+    }
+
+    /**
+     * @param name 共享内存名 (POSIX shm_open 名称，以 / 开头)
+     * @param ring_capacity 环形队列槽数，向上取整到 2 的幂
+     * @param table_capacity 最新值表容量 (合约数上限)
+     */
+    bool init(const std::string& name, uint32_t ring_capacity, uint32_t table_capacity);
+    void stop();
+    bool isRunning() const { return header_ != nullptr; }
+
+    void publish(const TickData& tick);
+
+private:
+    ShmMarketWriter() = default;
+    ~ShmMarketWriter() { stop(); }
+
+    // 查找或登记合约，表满返回 -1
+    int entryIndex(const char* instrument_id);
+
+    std::string name_;
+    char* base_ = nullptr;
+    size_t size_ = 0;
+    shm::ShmBusHeader* header_ = nullptr;
+    shm::ShmTickSlot* slots_ = nullptr;
+    shm::ShmLastValueEntry* table_ = nullptr;
+    uint64_t mask_ = 0;
+    uint64_t write_seq_ = 0;    // 本地副本，避免每次回读共享内存
+
+    // 仅行情线程访问
+    std::unordered_map<std::string, int> index_;
+    bool table_full_warned_ = false;
+};
+
+} // namespace QuantLabs
@@ -17,17 +17,31 @@ public:
     // 更新逻辑
     double UpdateFromTrade(const CThostFtdcTradeField& trade);
     void UpdateInstrument(const CThostFtdcInstrumentField& instrument);
-    void UpdateInstrumentMeta(const InstrumentMeta& meta);
     void SetTradingDay(const std::string& day) { trading_day_ = day; }
 
+    /**
+     * @brief 按最新价盯市，重算多空浮动盈亏 (行情线程调用)
+     * 浮盈 = (最新价 × 持仓 × 乘数 - 开仓成本) × 方向系数
+     * 浮盈变化时在持锁状态下生成多/空推送数据 (has* 标记该方向是否有持仓)
+     * @return 该合约有持仓且浮盈发生变化时返回 true
+     */
+    bool UpdateLastPrice(const std::string& instrumentID, double lastPrice,
+                         QuantLabs::PositionData& outLong, bool& hasLong,
+                         QuantLabs::PositionData& outShort, bool& hasShort);
+
+    // 单方向持仓扁平化 (调用方须保证 pos 不被并发修改)
+    static QuantLabs::PositionData ToPositionData(const InstrumentPosition& pos, char direction, int mult);
+
     // 查询接口
     std::shared_ptr<InstrumentPosition> GetPosition(const std::string& instrumentID);
     std::unordered_map<std::string, std::shared_ptr<InstrumentPosition>> GetAllPositions();
     void Clear();
 
 private:
+    // 用 pos.LastPrice 重算浮盈 (调用方持锁)，返回是否变化
+    static bool MarkToMarket(InstrumentPosition& pos, int multiple);
+
     std::unordered_map<std::string, std::shared_ptr<InstrumentPosition>> positions_;
-    std::unordered_map<std::string, InstrumentMeta> instruments_meta_;
     std::string trading_day_;   // 当前交易日 (判断 OpenDetail 是否今仓)
     std::mutex m_mutex; 
 };
@@ -9,6 +9,8 @@
 #include <iostream>
 #include <vector>
 #include <atomic>
+#include <unordered_map>
+#include <unordered_set>
 
 // CTP Headers
 #include "ThostFtdcUserApiStruct.h"
@@ -25,7 +27,13 @@ enum class DBTaskType {
     INSTRUMENT,
     ORDER,
     TRADE,
-    CONDITION_ORDER // Added
+    CONDITION_ORDER, // Added
+    CONDITION_STATUS,    // 条件单状态变更
+    CONDITION_MODIFY,    // 条件单改价/改量
+    SUBSCRIPTION_ADD,
+    SUBSCRIPTION_REMOVE,
+    SETTING,
+    STRATEGY_STATUS      // 策略运行状态
 };
 
 struct DBTask {
@@ -40,6 +48,21 @@ struct DBTask {
     double commission = 0.0; // Added for Trade
     double close_profit = 0.0; // Added for Trade
     ConditionOrderRequest condition_order; // Added
+    std::string key;   // 订阅合约 / 设置项
+    std::string value; // 设置值 / 策略状态信息
+    int status = 0;    // 策略状态
+};
+
+// 进程内策略定义 (tb_strategies 中登记了 library_path 的行)
+struct StrategyDef {
+    std::string strategy_id;
+    std::string strategy_name;
+    std::string strategy_type;
+    std::string instrument_id;
+    std::string library_path;
+    std::string account_id;  // 为空时使用主账户
+    std::string parameters;  // JSON 文本
+    int status = 0;          // 0=Stop, 1=Running, 2=Paused, 9=Error
 };
 
 class DBManager {
@@ -56,7 +79,7 @@ public:
     // 同步读取订阅列表 (用于启动时加载)
     std::vector<std::string> loadSubscriptions();
     
-    // 对订阅表及其增删改查 (同步操作)
+    // 订阅表增删 (进入写队列，不阻塞调用线程)
     void addSubscription(const std::string& instrumentId);
     void removeSubscription(const std::string& instrumentId);
 
@@ -68,20 +91,24 @@ public:
     void saveTrade(const CThostFtdcTradeField* pTrade, const std::string& strategy_id = "", double commission = 0.0, double close_profit = 0.0, const std::string& trading_day = "");
     void saveConditionOrder(const ConditionOrderRequest& order); // Added
 
-    // Condition Order State
+    // Condition Order State (进入写队列，与 saveConditionOrder 保持先后顺序)
     void updateConditionOrderStatus(uint64_t request_id, int status);
     void modifyConditionOrder(uint64_t request_id, double trigger_price, double limit_price, int volume); // 修改条件单
     std::vector<ConditionOrderRequest> loadConditionOrders(bool onlyActive = true);
     
     // Data Recovery
-    std::vector<CThostFtdcOrderField> loadOrders(const std::string& trading_day);
-    std::vector<TradeData> loadTrades(const std::string& trading_day);
+    // user_id 为空时不按账户过滤
+    std::vector<CThostFtdcOrderField> loadOrders(const std::string& trading_day, const std::string& user_id = "");
+    std::vector<TradeData> loadTrades(const std::string& trading_day, const std::string& user_id = ""); // 当日最近 1000 条，升序
     std::vector<TradeData> loadAllTradesAsc(); // Added Ascending for Replay
 
     // Strategy Management
     std::vector<std::pair<std::string, std::string>> loadStrategies();
+    std::vector<StrategyDef> loadStrategyDefs();
+    void updateStrategyStatus(const std::string& strategy_id, int status, const std::string& msg);
 
     // Global Settings
+    // init 时整表读入内存；get 只查缓存，set 写缓存后异步落库
     void setSetting(const std::string& key, const std::string& value);
     std::string getSetting(const std::string& key);
 
@@ -90,11 +117,55 @@ private:
     DBManager() = default;
     ~DBManager() { stop(); }
 
+    // 常驻连接: 记录当前客户端编码和已预编译的语句 (按需 prepare，表后建也能用)
+    struct PooledConnection {
+        std::unique_ptr<pqxx::connection> conn;
+        std::string encoding;
+        std::unordered_set<std::string> prepared;
+    };
+
+    // 借出的读连接，析构时归还；断开的连接不再放回池中
+    class Lease {
+    public:
+        Lease(DBManager& db, std::unique_ptr<PooledConnection> pc) : db_(db), pc_(std::move(pc)) {}
+        ~Lease() { db_.releaseConnection(std::move(pc_)); }
+        Lease(Lease&& other) noexcept : db_(other.db_), pc_(std::move(other.pc_)) {}
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+
+        explicit operator bool() const { return pc_ != nullptr; }
+        pqxx::connection& conn() { return *pc_->conn; }
+        // 确保语句已在该连接上预编译，返回语句名
+        const char* prepare(const char* name) { return DBManager::prepare(*pc_, name); }
+
+    private:
+        DBManager& db_;
+        std::unique_ptr<PooledConnection> pc_;
+    };
+
+    static constexpr size_t kReadPoolSize = 2;
+
+    // 借读连接 (池空且已达上限时等待)；等待超时或建连失败返回空 Lease
+    Lease acquireConnection(const char* encoding);
+    void releaseConnection(std::unique_ptr<PooledConnection> pc);
+    static std::unique_ptr<PooledConnection> connect(const std::string& connStr, const char* encoding);
+    static const char* prepare(PooledConnection& pc, const char* name);
+
+    void loadSettings();
+    void enqueue(DBTask&& task);
     void workerLoop();
-    void processTask(pqxx::work& txn, const DBTask& task);
+    void processTask(pqxx::transaction_base& txn, const DBTask& task);
 
-    std::unique_ptr<pqxx::connection> conn_;
+    std::unique_ptr<PooledConnection> conn_; // 写线程专用
     std::string connStr_;
+
+    std::vector<std::unique_ptr<PooledConnection>> idle_;
+    size_t poolCreated_ = 0;
+    std::mutex poolMutex_;
+    std::condition_variable poolCv_;
+
+    std::unordered_map<std::string, std::string> settings_;
+    std::mutex settingsMutex_;
     
     std::queue<DBTask> tasks_;
     std::mutex queueMutex_;
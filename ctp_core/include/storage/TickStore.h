@@ -0,0 +1,103 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <atomic>
+#include <cstdio>
+#include <cstdint>
+
+#include "protocol/message_schema.h"
+
+namespace QuantLabs {
+
+/**
+ * @brief 本地 Tick/Bar 存储文件格式
+ *
+ * 目录结构:
+ *   <root>/tick/<trading_day>/<instrument>.tick
+ *   <root>/bar/<period>/<trading_day>/<instrument>.bar
+ *
+ * 每个文件 = 64 字节文件头 + 定长记录 (按时间追加)，读端可直接 mmap 后二分查找。
+ */
+enum class StoreRecordType : uint32_t {
+    TICK = 1,
+    BAR = 2
+};
+
+struct TickStoreHeader {
+    char magic[8];          // "ATSTORE"
+    uint32_t version;       // 格式版本
+    uint32_t record_type;   // StoreRecordType
+    uint32_t record_size;   // 单条记录字节数
+    int32_t period;         // Bar 周期 (Tick 文件为 0)
+    char reserved[40];
+};
+static_assert(sizeof(TickStoreHeader) == 64, "TickStoreHeader must be 64 bytes");
+
+// Tick 落盘记录: 交易所时间戳 + 原始 TickData
+struct TickRecord {
+    int64_t ts;             // UTC epoch 毫秒 (由 action_day 修正 + update_time 推算)
+    TickData tick;
+};
+
+static constexpr const char* kTickStoreMagic = "ATSTORE";
+static constexpr uint32_t kTickStoreVersion = 1;
+
+/**
+ * @brief 本地行情存储 (异步追加写)
+ * 行情线程只做入队，文件写入在独立线程批量完成
+ */
+class TickStore {
+public:
+    static TickStore& instance() {
+        static TickStore i;
+        return i;
+    }
+
+    void init(const std::string& root_dir, bool record_ticks = true, bool record_bars = true);
+    void stop();
+    bool isRunning() const { return running_; }
+    const std::string& rootDir() const { return root_; }
+
+    void appendTick(const TickData& tick);
+    void appendBar(const BarData& bar); // 只应传入已完成 Bar
+
+    static std::string tickFilePath(const std::string& root, const std::string& trading_day, const std::string& instrument_id);
+    static std::string barFilePath(const std::string& root, int period, const std::string& trading_day, const std::string& instrument_id);
+
+private:
+    TickStore() = default;
+    ~TickStore() { stop(); }
+
+    struct StoreTask {
+        StoreRecordType type;
+        TickRecord tick;
+        BarData bar;
+    };
+
+    void workerLoop();
+    void writeTask(const StoreTask& task);
+    FILE* openFile(const std::string& path, StoreRecordType type, int period, uint32_t record_size);
+    void closeAll();
+
+    std::string root_;
+    bool record_ticks_ = true;
+    bool record_bars_ = true;
+
+    std::vector<StoreTask> tasks_;
+    std::mutex queueMutex_;
+    std::condition_variable cv_;
+
+    std::thread workerThread_;
+    std::atomic<bool> running_{false};
+
+    // 仅 worker 线程访问
+    std::unordered_map<std::string, FILE*> files_;
+    std::string current_day_;
+};
+
+} // namespace QuantLabs
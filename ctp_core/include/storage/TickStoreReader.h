@@ -0,0 +1,41 @@
+#pragma once
+
+#include "storage/TickStore.h"
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace QuantLabs {
+
+/**
+ * @brief 本地 Tick/Bar 存储的只读访问 (mmap + 二分查找)
+ * 记录前 8 字节均为 int64 时间戳 (TickRecord::ts / BarData::bar_time)，按时间升序排列
+ */
+class TickStoreReader {
+public:
+    explicit TickStoreReader(std::string root) : root_(std::move(root)) {}
+
+    // 接收一段连续记录 (指向 mmap 内存，仅在回调期间有效)；返回 false 中止扫描
+    using Sink = std::function<bool(const char* data, size_t count)>;
+
+    /**
+     * @brief 按时间顺序扫描 [start_ms, end_ms] 区间内的记录，连续段直接从 mmap 交给 sink
+     * @param period Bar 周期 (type 为 TICK 时忽略)
+     * @param limit 最多返回的记录数
+     * @return 交给 sink 的记录数; 单条记录长度见 recordSize()
+     */
+    size_t scan(StoreRecordType type, const std::string& instrument_id, int period,
+                int64_t start_ms, int64_t end_ms, size_t limit, const Sink& sink) const;
+
+    static size_t recordSize(StoreRecordType type) {
+        return type == StoreRecordType::TICK ? sizeof(TickRecord) : sizeof(BarData);
+    }
+
+private:
+    // 区间覆盖到的交易日目录 (升序)
+    std::vector<std::string> listDays(const std::string& dir, int64_t start_ms, int64_t end_ms) const;
+
+    std::string root_;
+};
+
+} // namespace QuantLabs
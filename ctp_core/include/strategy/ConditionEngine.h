@@ -2,15 +2,44 @@
 
 #include "protocol/message_schema.h"
 #include "api/TraderHandler.h"
+#include "utils/SpscQueue.h"
+#include "market/InstrumentCache.h"
 #include "ThostFtdcUserApiStruct.h"
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
 #include <functional>
+#include <memory>
+#include <thread>
 #include <vector>
 #include <mutex>
 #include <unordered_map>
+#include <unordered_set>
 #include <string>
 
 namespace QuantLabs {
 
+/**
+ * @brief 条件单引擎
+ *
+ * 分两级:
+ *   - 触发判定 (onTick, CTP 行情线程): 只做比较，命中后把条件单和当时的盘口拷贝成 TriggerEvent 放入 SPSC 队列
+ *   - 执行 (独立线程): 计算委托价、报单、落库、推送状态
+ * 行情线程上不做 IO / JSON / 日志，一笔触发不会拖慢后续 Tick。
+ *
+ * 条件类型 (ConditionType): 价格 (最新/买一/卖一/中间价)、跟踪止损、两合约价差；
+ * 可叠加生效时段与 OCO 分组。每笔 Tick 对每张相关条件单只做 O(1) 的状态更新与比较。
+ *
+ * 存储为 slot-map: 条件单本体在分块的槽位数组中，各合约 bucket 只存槽位下标；
+ * request_id 由引擎分配 (启动时间 | 代数 | 槽位)，经哈希索引 O(1) 定位，撤改只动所属合约的 bucket。
+ *
+ * 锁按合约分片: 条件单内容与 bucket 由所属合约分片的锁保护，撤改只与同分片合约上的触发判定互斥；
+ * 槽位分配/id 索引/OCO 组由 index_mtx_ 保护，价差腿索引由 spread_mtx_ 保护。
+ * 加锁顺序为 分片 -> index_mtx_ 或 spread_mtx_ (两者互不嵌套)，任何时候最多持有一个分片锁。
+ * onTick 只在行情线程调用: 盘口 quotes_ 只由该线程读写，跨分片的 OCO 撤销在释放分片锁后、
+ * 下一次扫描前完成 (只有行情线程会触发条件单，期间同组其它条件单不可能被触发)。
+ */
 class ConditionEngine {
 public:
     explicit ConditionEngine(TraderHandler& trader);
@@ -20,11 +49,20 @@ public:
     using StatusCallback = std::function<void(const ConditionOrderRequest&)>;
     void setStatusCallback(StatusCallback cb);
 
-    void addConditionOrder(const ConditionOrderRequest& order);
+    // 启动/停止执行线程 (start 前触发的条件单在队列中等待)
+    void start();
+    void stop();
+
+    /**
+     * @brief 加入条件单
+     * request_id 为 0 时由引擎分配；非 0 (从数据库恢复) 时沿用
+     * @return 条件单的 request_id，失败 (id 重复/容量耗尽) 返回 0
+     */
+    uint64_t addConditionOrder(const ConditionOrderRequest& order);
 
     // Cancel/Remove
     bool removeConditionOrder(uint64_t request_id);
-    
+
     // Modify condition order (only for pending orders)
     bool modifyConditionOrder(uint64_t request_id, double trigger_price, double limit_price, int volume);
 
@@ -32,14 +70,114 @@ public:
     void onTick(const CThostFtdcDepthMarketDataField *pDepthMarketData);
 
 private:
+    // 合约最新盘口 (只记录有条件单或作为价差腿的合约)
+    struct Quote {
+        double last_price = 0.0;
+        double bid_price1 = 0.0;
+        double ask_price1 = 0.0;
+        double upper_limit_price = 0.0;
+        double lower_limit_price = 0.0;
+    };
+
+    // 触发事件: 条件单 + 触发时刻的盘口 (行情回调返回后 CTP 结构不可再访问)
+    struct TriggerEvent {
+        ConditionOrderRequest order;
+        Quote quote;
+        InstrumentId instrument = kInvalidInstrument;
+    };
+
+    // 合约 bucket: 该合约上待触发条件单的槽位下标 (无序，删除时与末尾交换)
+    using OrderBucket = std::vector<uint32_t>;
+
+    struct Slot {
+        ConditionOrderRequest order;
+        uint32_t generation = 0;         // 每次释放 +1，旧 id 失效
+        uint32_t bucket_pos = 0;         // 在 bucket 中的下标
+        OrderBucket* bucket = nullptr;   // nullptr 表示空闲 (unordered_map 元素地址稳定)
+        InstrumentId instrument = kInvalidInstrument;
+        InstrumentId leg2 = kInvalidInstrument; // 价差条件单的第二腿
+    };
+
+    // request_id 布局: [启动时间秒 31 位][代数 12 位][槽位 20 位]
+    static constexpr uint32_t kSlotBits = 20;
+    static constexpr uint32_t kGenBits = 12;
+    static constexpr uint32_t kMaxSlots = 1u << kSlotBits;
+    static constexpr uint32_t kNoSlot = 0xFFFFFFFFu;
+    // 槽位按块分配，块地址不变: 持分片锁访问槽位时不受其它线程新增槽位影响
+    static constexpr uint32_t kSlotChunkBits = 10;
+    static constexpr uint32_t kSlotChunkSize = 1u << kSlotChunkBits;
+
+    // 合约分片: 该分片内各合约的 bucket、槽位中的条件单内容
+    static constexpr size_t kShardCount = 16;
+    struct Shard {
+        std::mutex mtx;
+        // 合约句柄 -> 槽位下标
+        std::unordered_map<InstrumentId, OrderBucket> order_book;
+        // 跟踪止损价有变动、待落库的条件单 (执行线程定期刷新)
+        std::unordered_set<uint64_t> trail_dirty;
+    };
+    Shard& shardOf(InstrumentId instrument) { return shards_[instrument % kShardCount]; }
+    Slot& slotAt(uint32_t index) { return slot_chunks_[index >> kSlotChunkBits][index & (kSlotChunkSize - 1)]; }
+
     TraderHandler& trader_;
-    
-    std::mutex mtx_;
-    // Map instrument_id -> List of orders
-    std::unordered_map<std::string, std::vector<ConditionOrderRequest>> order_book_;
-    
+
+    std::array<Shard, kShardCount> shards_;
+
+    // --- index_mtx_ ---
+    std::mutex index_mtx_;
+    std::array<std::unique_ptr<Slot[]>, (kMaxSlots >> kSlotChunkBits)> slot_chunks_;
+    uint32_t slot_count_ = 0;
+    std::deque<uint32_t> free_slots_;    // FIFO 复用，分散各槽位的代数增长
+    std::unordered_map<uint64_t, uint32_t> id_index_; // request_id -> 槽位
+    // OCO 组 -> 组内待触发条件单的槽位下标 (一组通常只有两三张)
+    std::unordered_map<uint64_t, std::vector<uint32_t>> oco_groups_;
+    // OCO 触发后被撤销的同组条件单 (执行线程落库/推送)
+    std::vector<ConditionOrderRequest> oco_cancelled_;
+    uint64_t epoch_ = 0;
+
+    // --- spread_mtx_ ---
+    std::mutex spread_mtx_;
+    // 价差第二腿 -> (第一腿 -> 条件单数)，第二腿的 Tick 也要驱动第一腿上的价差条件单
+    std::unordered_map<InstrumentId, std::unordered_map<InstrumentId, int>> spread_links_;
+    std::atomic<size_t> spread_count_{0}; // 价差条件单数，为 0 时 onTick 不查价差腿
+
+    // --- 仅行情线程 ---
+    std::unordered_map<InstrumentId, Quote> quotes_;
+    std::vector<InstrumentId> scratch_legs_; // onTick 复用，避免每笔分配
+    std::vector<uint64_t> fired_groups_;     // 本笔 Tick 已触发的 OCO 组
+
+    std::atomic<bool> has_cancels_{false};
+    // 待触发条件单总数，为 0 时 onTick 不加锁直接返回
+    std::atomic<size_t> pending_count_{0};
+
     bool checkCondition(double last_price, const ConditionOrderRequest& order);
-    void executeOrder(ConditionOrderRequest& order, const CThostFtdcDepthMarketDataField* pDepthData);
+    static double sourcePrice(const Quote& q, PriceSource source);
+    static bool inTimeWindow(const ConditionOrderRequest& order, int hhmmss);
+    // 评估单张条件单 (可能更新跟踪止损状态)，须持有所属分片锁
+    bool evaluate(Shard& shard, Slot& slot, const Quote& quote, int hhmmss);
+    // 扫描某合约的条件单并把触发的移入执行队列，须持有 shard 锁；触发的 OCO 组记入 fired_groups_
+    bool scanOrders(Shard& shard, OrderBucket& bucket, const Quote& quote, int hhmmss, bool spread_only);
+    // request_id -> 槽位 (校验代数)，不存在返回 kNoSlot，须持有 index_mtx_
+    uint32_t findSlot(uint64_t request_id);
+    // request_id 所属合约 (定位分片)，不存在返回 kInvalidInstrument；内部加 index_mtx_
+    InstrumentId instrumentOf(uint64_t request_id);
+    // 从 bucket 与索引中移除并释放槽位 (维护计数、价差与 OCO 索引)，须持有所属分片锁
+    void eraseOrder(uint32_t slot_index);
+    // 撤销 fired_groups_ 中各 OCO 组的其余条件单 (行情线程，不持有分片锁时调用)
+    void cancelOcoSiblings();
+    void executeOrder(TriggerEvent& ev);
+    // 执行线程: 落库/推送 OCO 撤销与跟踪止损价变动
+    void flushDeferred(bool include_trailing);
+    void executionLoop();
+
+    // 行情线程 -> 执行线程
+    static constexpr size_t kTriggerQueueSize = 1024;
+    std::unique_ptr<SpscQueue<TriggerEvent, kTriggerQueueSize>> trigger_queue_;
+    std::mutex wake_mtx_;
+    std::condition_variable wake_cv_;
+    std::atomic<bool> exec_sleeping_{false};
+    std::atomic<bool> running_{false};
+    std::thread exec_thread_;
 
     StatusCallback status_callback_;
 };
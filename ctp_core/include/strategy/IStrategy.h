@@ -0,0 +1,78 @@
+#pragma once
+
+/**
+ * @brief 进程内策略接口 (策略动态库实现)
+ *
+ * 策略编译为共享库，在 tb_strategies.library_path 登记后由 StrategyHost 加载。
+ * 每个策略独占一个工作线程，所有回调 (onInit/onStart/onTick/...) 都在该线程串行调用，
+ * 策略内部无需加锁；回调中不要长时间阻塞，否则会积压行情。
+ *
+ * 动态库导出:
+ *   class MyStrategy : public QuantLabs::IStrategy { ... };
+ *   ATRADER_EXPORT_STRATEGY(MyStrategy)
+ *
+ * 接口含 std::string 等 C++ 类型，策略库须与 ctp_core 使用同一编译器和标准库构建。
+ */
+
+#include "protocol/message_schema.h"
+#include "ThostFtdcUserApiStruct.h"
+#include <string>
+
+namespace QuantLabs {
+
+// 接口变更时递增，宿主拒绝加载版本不一致的策略库
+#define ATRADER_STRATEGY_ABI_VERSION 1
+
+/**
+ * @brief 宿主提供给策略的能力 (只能在策略自己的回调线程中调用)
+ */
+class IStrategyContext {
+public:
+    virtual ~IStrategyContext() = default;
+
+    // 报单，自动带上本策略的 strategy_id；返回 CTP 请求结果 (0 成功)
+    virtual int sendOrder(const std::string& instrument, double price, int volume,
+                          char direction, char offset, char price_type = THOST_FTDC_OPT_LimitPrice) = 0;
+    // 撤单 (order 为 onOrder 收到的回报)
+    virtual int cancelOrder(const CThostFtdcOrderField& order) = 0;
+
+    // 订阅合约，之后该合约的 Tick/Bar 推送给本策略
+    virtual void subscribe(const std::string& instrument) = 0;
+    virtual bool getInstrument(const std::string& instrument, InstrumentMeta& out) = 0;
+
+    virtual const std::string& strategyId() const = 0;
+    virtual const std::string& accountId() const = 0;
+    virtual void log(const std::string& msg) = 0;
+};
+
+class IStrategy {
+public:
+    virtual ~IStrategy() = default;
+
+    // 加载后首次启动前调用一次，params 为 tb_strategies.parameters (JSON 文本)
+    virtual void onInit(IStrategyContext& ctx, const std::string& params) = 0;
+    virtual void onStart() {}
+    virtual void onStop() {}
+    // UpdateParams 指令
+    virtual void onParams(const std::string& params) { (void)params; }
+
+    virtual void onTick(const TickData& tick) { (void)tick; }
+    virtual void onBar(const BarData& bar) { (void)bar; }
+    // 只推送本策略 strategy_id 的委托/成交
+    virtual void onOrder(const CThostFtdcOrderField& order) { (void)order; }
+    virtual void onTrade(const CThostFtdcTradeField& trade) { (void)trade; }
+};
+
+} // namespace QuantLabs
+
+#ifdef _WIN32
+#define ATRADER_STRATEGY_API extern "C" __declspec(dllexport)
+#else
+#define ATRADER_STRATEGY_API extern "C" __attribute__((visibility("default")))
+#endif
+
+// 策略库入口 (宿主按名字 dlsym)
+#define ATRADER_EXPORT_STRATEGY(StrategyClass)                                                   \
+    ATRADER_STRATEGY_API int atrader_strategy_abi_version() { return ATRADER_STRATEGY_ABI_VERSION; } \
+    ATRADER_STRATEGY_API QuantLabs::IStrategy* atrader_create_strategy() { return new StrategyClass(); } \
+    ATRADER_STRATEGY_API void atrader_destroy_strategy(QuantLabs::IStrategy* s) { delete s; }
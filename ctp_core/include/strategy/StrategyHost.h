@@ -0,0 +1,88 @@
+#pragma once
+
+#include "strategy/IStrategy.h"
+#include "storage/DBManager.h"
+#include "market/InstrumentCache.h"
+#include "utils/SpscQueue.h"
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace QuantLabs {
+
+class TraderHandler;
+
+/**
+ * @brief 进程内策略宿主
+ *
+ * 加载 tb_strategies 中登记了 library_path 的策略动态库，每个策略一个工作线程:
+ *   - 行情 SPSC 队列: 生产者为 CTP 行情线程 (Tick 与由 Tick 合成的 Bar)
+ *   - 回报 SPSC 队列: 生产者为策略绑定账户的 CTP 交易线程 (按 strategy_id 路由委托/成交)
+ * 策略直接调用 TraderHandler 报单，不经过 ZMQ。
+ * 队列满时行情丢弃并计数 (不阻塞行情线程)，回报短暂自旋等待 (回报不可丢)。
+ *
+ * 控制指令 (StrategyControl) 来自命令线程: Start/Stop/UpdateParams/Reload，状态写回 tb_strategies。
+ */
+class StrategyHost {
+public:
+    using AccountResolver = std::function<TraderHandler*(const std::string& account_id)>;
+    using SubscribeFn = std::function<void(const std::string& instrument)>;
+    using StatusCallback = std::function<void(const std::string& strategy_id, int status, const std::string& msg)>;
+
+    // 状态值与 tb_strategies.status 一致
+    static constexpr int kStopped = 0;
+    static constexpr int kRunning = 1;
+    static constexpr int kError = 9;
+
+    StrategyHost(AccountResolver resolve_account, SubscribeFn subscribe);
+    ~StrategyHost();
+
+    void setStatusCallback(StatusCallback cb) { status_callback_ = cb; }
+
+    // 加载全部策略定义，status=1 的自动启动 (启动时与 Reload 调用)
+    void loadFromDB();
+    // 处理控制指令，失败时 err 为原因
+    bool control(const StrategyControl& ctl, std::string& err);
+    void stopAll();
+
+    // 已加载策略的状态 (kStopped/kRunning/kError)
+    std::vector<std::pair<std::string, int>> statuses();
+
+    // 事件入口: onTick/onBar 只在行情线程调用，onOrder/onTrade 在账户交易线程调用
+    void onTick(const TickData& tick);
+    void onBar(const BarData& bar);
+    void onOrder(const std::string& account_id, const std::string& strategy_id, const CThostFtdcOrderField& order);
+    void onTrade(const std::string& account_id, const std::string& strategy_id, const CThostFtdcTradeField& trade);
+
+private:
+    class Runner;
+    friend class Runner;
+
+    // 策略订阅合约 (策略线程调用)
+    void addRoute(Runner* runner, const std::string& instrument);
+    void removeRoutes(Runner* runner);
+    void reportStatus(const std::string& strategy_id, int status, const std::string& msg);
+    Runner* findRunner(const std::string& strategy_id);
+    std::shared_ptr<Runner> returnTarget(const std::string& account_id, const std::string& strategy_id);
+    // 以下须持有 control_mtx_
+    void loadDefs();
+    bool startRunner(const StrategyDef& def, std::string& err);
+    void unloadAll();
+
+    AccountResolver resolve_account_;
+    SubscribeFn subscribe_;
+    StatusCallback status_callback_;
+
+    std::mutex control_mtx_;     // 串行化控制指令 (加载/启停可能耗时，不占用 routes_mtx_)
+    std::shared_mutex routes_mtx_;
+    std::unordered_map<std::string, std::shared_ptr<Runner>> runners_; // 交易线程出锁推送回报时持有引用
+    std::unordered_map<InstrumentId, std::vector<Runner*>> routes_; // 合约句柄 -> 订阅的策略
+    std::atomic<bool> has_routes_{false}; // 无策略订阅时行情线程不加锁
+};
+
+} // namespace QuantLabs
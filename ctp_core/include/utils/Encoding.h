@@ -1,7 +1,9 @@
 #pragma once
 
 #include <string>
-#include <vector>
+#include <string_view>
+#include <cstdint>
+#include <unordered_map>
 #include <iconv.h>
 #include <cstring>
 #include <iostream>
@@ -9,36 +11,123 @@
 namespace QuantLabs {
 namespace utils {
 
-inline std::string gbk_to_utf8(const std::string& gbk_str) {
-    if (gbk_str.empty()) return "";
+namespace detail {
 
-    iconv_t cd = iconv_open("UTF-8", "GB18030");
-    if (cd == (iconv_t)-1) {
-        std::cerr << "[Encoding] iconv_open failed" << std::endl;
-        return gbk_str;
+// 纯 ASCII (GBK 与 UTF-8 编码相同) 无需转换；按 8 字节一组检查最高位
+inline bool is_ascii(const char* p, size_t n) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        uint64_t w;
+        std::memcpy(&w, p + i, 8);
+        if (w & 0x8080808080808080ULL) return false;
     }
+    for (; i < n; ++i) {
+        if (static_cast<unsigned char>(p[i]) & 0x80) return false;
+    }
+    return true;
+}
+
+/**
+ * @brief 每线程一个 GB18030 -> UTF-8 转换器
+ * iconv_t 不是线程安全的，但可以复用: 每次转换前重置移位状态即可，避免每次 iconv_open/iconv_close。
+ */
+class GbkConverter {
+public:
+    static GbkConverter& local() {
+        thread_local GbkConverter c;
+        return c;
+    }
+
+    // 转换结果写入 out (复用其容量)
+    void convert(const char* in, size_t in_len, std::string& out) {
+        if (cd_ == (iconv_t)-1) {
+            out.assign(in, in_len);
+            return;
+        }
+        iconv(cd_, nullptr, nullptr, nullptr, nullptr); // 重置状态
+
+        out.resize(in_len * 2 + 1); // GBK 双字节 -> UTF-8 至多三字节 (四字节码位 GB18030 也是四字节)
+        char* in_ptr = const_cast<char*>(in);
+        char* out_ptr = &out[0];
+        size_t in_left = in_len;
+        size_t out_left = out.size();
+
+        // 遇到非法序列时保留已转换部分
+        iconv(cd_, &in_ptr, &in_left, &out_ptr, &out_left);
+        out.resize(out.size() - out_left);
+    }
+
+private:
+    GbkConverter() : cd_(iconv_open("UTF-8", "GB18030")) {
+        if (cd_ == (iconv_t)-1) {
+            std::cerr << "[Encoding] iconv_open failed" << std::endl;
+        }
+    }
+    ~GbkConverter() {
+        if (cd_ != (iconv_t)-1) iconv_close(cd_);
+    }
+    GbkConverter(const GbkConverter&) = delete;
+    GbkConverter& operator=(const GbkConverter&) = delete;
+
+    iconv_t cd_;
+};
+
+// CTP 结构体中的定长字段不一定以 0 结尾
+template <size_t N>
+inline std::string_view field_view(const char (&s)[N]) {
+    return std::string_view(s, strnlen(s, N));
+}
+inline std::string_view field_view(std::string_view s) { return s; }
+
+} // namespace detail
+
+inline std::string gbk_to_utf8(std::string_view gbk) {
+    if (gbk.empty()) return "";
+    if (detail::is_ascii(gbk.data(), gbk.size())) return std::string(gbk);
+
+    std::string out;
+    detail::GbkConverter::local().convert(gbk.data(), gbk.size(), out);
+    return out;
+}
+
+template <size_t N>
+inline std::string gbk_to_utf8(const char (&gbk)[N]) {
+    return gbk_to_utf8(detail::field_view(gbk));
+}
 
-    size_t in_len = gbk_str.size();
-    size_t out_len = in_len * 2 + 1; // max UTF8 expansion
-    std::vector<char> out_buf(out_len);
-
-    char* in_ptr = const_cast<char*>(gbk_str.c_str());
-    char* out_ptr = out_buf.data();
-    size_t in_bytes_left = in_len;
-    size_t out_bytes_left = out_len;
-
-    // Ignore invalid sequences to avoid stopping
-    // iconv implementation might vary, but usually we just process what we can
-    size_t res = iconv(cd, &in_ptr, &in_bytes_left, &out_ptr, &out_bytes_left);
-    
-    if (res == (size_t)-1) {
-         // If error, might be partly converted. We could still use it or fallback.
-         // For simplistic robustness, we just use what we converted so far if possible, or return original if totally failed
-         // std::cerr << "[Encoding] iconv failed: " << strerror(errno) << std::endl;
+inline std::string gbk_to_utf8(const std::string& gbk) {
+    return gbk_to_utf8(std::string_view(gbk));
+}
+
+/**
+ * @brief 带缓存的转换，用于反复出现的字符串 (合约名称、委托状态信息等)
+ * 每个不同的字符串每线程只转换一次。缓存按线程隔离，无需加锁；超过上限时整体清空。
+ * 返回的引用在本线程下一次调用前有效。
+ */
+inline const std::string& gbk_to_utf8_cached(std::string_view gbk) {
+    static constexpr size_t kMaxEntries = 8192;
+    thread_local std::unordered_map<std::string, std::string> cache;
+    thread_local std::string key;
+    thread_local std::string scratch;
+
+    if (detail::is_ascii(gbk.data(), gbk.size())) {
+        scratch.assign(gbk.data(), gbk.size());
+        return scratch;
     }
 
-    iconv_close(cd);
-    return std::string(out_buf.data(), out_buf.size() - out_bytes_left);
+    key.assign(gbk.data(), gbk.size()); // 复用 key 的容量，查找时不分配
+    auto it = cache.find(key);
+    if (it != cache.end()) return it->second;
+
+    if (cache.size() >= kMaxEntries) cache.clear();
+    std::string out;
+    detail::GbkConverter::local().convert(gbk.data(), gbk.size(), out);
+    return cache.emplace(key, std::move(out)).first->second;
+}
+
+template <size_t N>
+inline const std::string& gbk_to_utf8_cached(const char (&gbk)[N]) {
+    return gbk_to_utf8_cached(detail::field_view(gbk));
 }
 
 }
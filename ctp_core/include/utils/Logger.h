@@ -0,0 +1,258 @@
+#pragma once
+
+#include "utils/SpscQueue.h"
+#include <nlohmann/json.hpp>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#define ATRADER_LOG_TSC 1
+#elif defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define ATRADER_LOG_TSC 1
+#endif
+
+namespace QuantLabs {
+
+enum class LogLevel : uint8_t { Debug = 0, Info = 1, Warn = 2, Error = 3, Off = 4 };
+
+// 编译期最低级别: 低于该级别的日志调用连同参数求值一起被编译掉
+#ifndef ATRADER_LOG_MIN_LEVEL
+#ifdef _DEBUG
+#define ATRADER_LOG_MIN_LEVEL 0
+#else
+#define ATRADER_LOG_MIN_LEVEL 1
+#endif
+#endif
+
+// 调用点静态信息 (级别/模块/格式串)，只在记录中存指针
+struct LogSite {
+    LogLevel level;
+    const char* module;
+    const char* fmt; // 以 {} 作为占位符
+};
+
+// 一条日志: 参数按二进制编码，格式化推迟到后台线程
+struct LogRecord {
+    static constexpr size_t kArgBytes = 232;
+
+    int64_t stamp; // x86 为 TSC 计数，其它平台为 ns；后台线程换算为时间
+    const LogSite* site;
+    uint16_t size;
+    bool truncated;
+    char args[kArgBytes];
+};
+static_assert(sizeof(LogRecord) == 256, "LogRecord should stay at 4 cache lines");
+
+namespace log_detail {
+
+enum ArgTag : uint8_t { I64, U64, F64, Char, Bool, Str };
+
+struct ArgWriter {
+    char* p;
+    char* end;
+    bool truncated = false;
+
+    template <typename T>
+    void scalar(ArgTag tag, T v) {
+        if (end - p < static_cast<ptrdiff_t>(1 + sizeof(T))) { truncated = true; return; }
+        *p++ = static_cast<char>(tag);
+        std::memcpy(p, &v, sizeof(T));
+        p += sizeof(T);
+    }
+
+    // 字符串超出剩余空间时截断
+    void str(const char* s, size_t n) {
+        if (end - p < 4) { truncated = true; return; }
+        size_t room = static_cast<size_t>(end - p) - 3;
+        if (n > room) { n = room; truncated = true; }
+        uint16_t len = static_cast<uint16_t>(n);
+        *p++ = static_cast<char>(Str);
+        std::memcpy(p, &len, 2);
+        std::memcpy(p + 2, s, n);
+        p += 2 + n;
+    }
+};
+
+template <typename T>
+struct AlwaysFalse : std::false_type {};
+
+template <typename T>
+inline void encode(ArgWriter& w, const T& v) {
+    if constexpr (std::is_same_v<T, bool>) {
+        w.scalar(Bool, static_cast<uint8_t>(v));
+    } else if constexpr (std::is_same_v<T, char>) {
+        w.scalar(Char, v); // CTP 的方向/状态等标志按字符输出
+    } else if constexpr (std::is_enum_v<T>) {
+        w.scalar(I64, static_cast<int64_t>(v));
+    } else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+        w.scalar(I64, static_cast<int64_t>(v));
+    } else if constexpr (std::is_integral_v<T>) {
+        w.scalar(U64, static_cast<uint64_t>(v));
+    } else if constexpr (std::is_floating_point_v<T>) {
+        w.scalar(F64, static_cast<double>(v));
+    } else if constexpr (std::is_same_v<T, const char*> || std::is_same_v<T, char*>) {
+        if (v) w.str(v, std::strlen(v));
+        else w.str("(null)", 6);
+    } else if constexpr (std::is_convertible_v<const T&, std::string_view>) {
+        std::string_view sv(v);
+        w.str(sv.data(), sv.size());
+    } else {
+        static_assert(AlwaysFalse<T>::value, "Unsupported log argument type");
+    }
+}
+
+// CTP 结构体中的定长字符数组不一定以 0 结尾
+template <size_t N>
+inline void encode(ArgWriter& w, const char (&s)[N]) {
+    size_t n = strnlen(s, N);
+    w.str(s, n < N ? n : N); // 显式上界，避免 GCC 误报越界读
+}
+
+} // namespace log_detail
+
+/**
+ * @brief 异步结构化日志
+ *
+ * 调用线程只把时间戳、调用点指针和二进制参数写入本线程的 SPSC 缓冲 (无锁、无堆分配)，
+ * 格式化、写文件和控制台输出都在后台线程完成。缓冲满时丢弃并计数，不阻塞交易线程。
+ *
+ *   LOG_INFO("Td", "Trade Update: {} Price: {}", pTrade->TradeID, pTrade->Price);
+ *
+ * 配置 (config.json "log" 段):
+ *   {"level": "info", "console": true, "path": "./logs/core.log", "max_size_mb": 64, "max_files": 5}
+ * path 为空时只输出到控制台；文件超过 max_size_mb 后轮转为 core.log.1 ... core.log.<max_files>。
+ */
+class Logger {
+public:
+    static constexpr size_t kThreadQueueSize = 1024;
+
+    static Logger& instance() {
+        static Logger i;
+        return i;
+    }
+
+    // main 中尽早调用；之前写入的日志在缓冲中等待后台线程启动
+    void start(const nlohmann::json& config);
+    // 写完缓冲中剩余日志后停止后台线程
+    void stop();
+
+    static bool enabled(LogLevel level) {
+        return static_cast<uint8_t>(level) >= level_.load(std::memory_order_relaxed);
+    }
+    static void setLevel(LogLevel level) { level_.store(static_cast<uint8_t>(level), std::memory_order_relaxed); }
+    static LogLevel parseLevel(const std::string& name);
+
+    template <typename... Args>
+    static void write(const LogSite* site, const Args&... args) {
+        ThreadBuffer* buf = tls_buffer_ ? tls_buffer_ : registerThread();
+        LogRecord* rec = buf->queue.claim(); // 直接写入队列槽位
+        if (!rec) {
+            buf->dropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        rec->stamp = stamp();
+        rec->site = site;
+        log_detail::ArgWriter w{rec->args, rec->args + LogRecord::kArgBytes};
+        (log_detail::encode(w, args), ...);
+        rec->size = static_cast<uint16_t>(w.p - rec->args);
+        rec->truncated = w.truncated;
+        buf->queue.commit();
+    }
+
+    static int64_t stamp() {
+#ifdef ATRADER_LOG_TSC
+        return static_cast<int64_t>(__rdtsc());
+#else
+        return wallNanos();
+#endif
+    }
+
+    static int64_t wallNanos() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+
+private:
+    struct ThreadBuffer {
+        SpscQueue<LogRecord, kThreadQueueSize> queue;
+        std::atomic<uint64_t> dropped{0};
+        std::atomic<bool> alive{true}; // 所属线程退出后置 false，后台线程写完剩余记录再回收
+    };
+
+    Logger() = default;
+    ~Logger();
+
+    static ThreadBuffer* registerThread();
+    void calibrate();
+    int64_t toWallNanos(int64_t stamp) const;
+
+    void run();
+    // 返回处理的记录数
+    size_t drain();
+    void format(const LogRecord& rec, std::string& out);
+    void output(const LogRecord& rec, const std::string& line);
+    void rotateIfNeeded();
+    bool openFile();
+
+    static inline thread_local ThreadBuffer* tls_buffer_ = nullptr;
+    static inline std::atomic<uint8_t> level_{static_cast<uint8_t>(LogLevel::Info)};
+
+    std::mutex buffers_mtx_;
+    std::vector<std::shared_ptr<ThreadBuffer>> buffers_;
+
+    std::thread thread_;
+    std::atomic<bool> running_{false};
+    std::mutex wake_mtx_;
+    std::condition_variable wake_cv_;
+
+    // 以下只在后台线程 (或启动前/停止后) 访问
+    bool console_ = true;
+    std::string path_;
+    size_t max_size_ = 64u << 20;
+    int max_files_ = 5;
+    FILE* file_ = nullptr;
+    size_t file_size_ = 0;
+    std::vector<LogRecord> batch_;
+    std::string line_;
+    int64_t stamp0_ = 0;       // 换算锚点: stamp0_ 时刻对应 wall0_
+    int64_t wall0_ = 0;
+    double ns_per_tick_ = 1.0;
+    int64_t next_calibrate_ = 0;
+    int64_t cached_sec_ = -1;
+    char cached_time_[24] = {0};
+};
+
+// 编译期级别过滤 (写成函数，最低级别为 0 时不触发 -Wtype-limits)
+constexpr bool logCompiledIn(LogLevel l) {
+    return l >= static_cast<LogLevel>(ATRADER_LOG_MIN_LEVEL);
+}
+
+} // namespace QuantLabs
+
+#define ATRADER_LOG(lvl, module, fmt, ...)                                                      \
+    do {                                                                                         \
+        if constexpr (::QuantLabs::logCompiledIn(lvl)) {                                         \
+            if (::QuantLabs::Logger::enabled(lvl)) {                                             \
+                static constexpr ::QuantLabs::LogSite atrader_log_site{lvl, module, fmt};       \
+                ::QuantLabs::Logger::write(&atrader_log_site, ##__VA_ARGS__);                    \
+            }                                                                                    \
+        }                                                                                        \
+    } while (0)
+
+#define LOG_DEBUG(module, fmt, ...) ATRADER_LOG(::QuantLabs::LogLevel::Debug, module, fmt, ##__VA_ARGS__)
+#define LOG_INFO(module, fmt, ...) ATRADER_LOG(::QuantLabs::LogLevel::Info, module, fmt, ##__VA_ARGS__)
+#define LOG_WARN(module, fmt, ...) ATRADER_LOG(::QuantLabs::LogLevel::Warn, module, fmt, ##__VA_ARGS__)
+#define LOG_ERROR(module, fmt, ...) ATRADER_LOG(::QuantLabs::LogLevel::Error, module, fmt, ##__VA_ARGS__)
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+namespace QuantLabs {
+
+/**
+ * @brief 单生产者/单消费者有界无锁队列
+ * 容量为 2 的幂；push 只能在一个线程调用，pop 只能在另一个线程调用。
+ * 头尾索引各占一条缓存行，并各自缓存对端索引，避免生产者/消费者互相抖动缓存行。
+ */
+template <typename T, size_t Capacity>
+class SpscQueue {
+    static_assert(Capacity >= 2 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of 2");
+
+public:
+    // 队列满时返回 false，由调用方决定重试或丢弃
+    bool push(const T& item) {
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - head_cache_ >= Capacity) {
+            head_cache_ = head_.load(std::memory_order_acquire);
+            if (tail - head_cache_ >= Capacity) return false;
+        }
+        buffer_[tail & (Capacity - 1)] = item;
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // 原地写入: 返回下一个可写槽位 (队列满返回 nullptr)，写好后调用 commit() 发布
+    // 适用于较大的 T，省去一次整体拷贝
+    T* claim() {
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail - head_cache_ >= Capacity) {
+            head_cache_ = head_.load(std::memory_order_acquire);
+            if (tail - head_cache_ >= Capacity) return nullptr;
+        }
+        return &buffer_[tail & (Capacity - 1)];
+    }
+
+    void commit() {
+        tail_.store(tail_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    bool pop(T& out) {
+        const size_t head = head_.load(std::memory_order_relaxed);
+        if (head == tail_cache_) {
+            tail_cache_ = tail_.load(std::memory_order_acquire);
+            if (head == tail_cache_) return false;
+        }
+        out = std::move(buffer_[head & (Capacity - 1)]);
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // 近似值，仅用于监控/判空
+    bool empty() const {
+        return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire);
+    }
+
+    size_t size() const {
+        return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire);
+    }
+
+    static constexpr size_t capacity() { return Capacity; }
+
+private:
+    alignas(64) std::atomic<size_t> head_{0}; // 消费者写
+    size_t tail_cache_ = 0;                   // 消费者持有的 tail 副本
+    alignas(64) std::atomic<size_t> tail_{0}; // 生产者写
+    size_t head_cache_ = 0;                   // 生产者持有的 head 副本
+    alignas(64) T buffer_[Capacity];
+};
+
+} // namespace QuantLabs
@@ -0,0 +1,229 @@
+#pragma once
+
+#include <nlohmann/json.hpp>
+#include <zmq.h>
+#include <algorithm>
+#include <iostream>
+#include <map>
+#include <string>
+#include <thread>
+#include <vector>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace QuantLabs {
+
+/**
+ * @brief 线程角色登记
+ *
+ * Core 内每个线程按角色命名，并按 config.json 的 "threads" 段设置 CPU 亲和性与调度策略:
+ *   "threads": {
+ *     "isolated_cpus": [2, 3, 4],               // 只留给显式绑定的角色，其余线程不会调度到这些核
+ *     "roles": {
+ *       "md":        {"cpus": [2], "policy": "fifo", "priority": 80},
+ *       "condition": {"cpus": [3], "busy_poll": true},
+ *       "db":        {"cpus": [0, 1], "policy": "batch"}
+ *     }
+ *   }
+ * 角色: main / md / td / query / condition / strategy / db / tickstore / cmd / history / log / zmq_io。
+ * 未配置的角色使用非隔离核；main 线程最先登记，之后创建的线程 (含 CTP/ZMQ 内部线程) 继承该掩码。
+ * CTP 回调线程由 API 内部创建，在首次回调时登记 (applyOnce)。
+ *
+ * configure 须在创建任何线程之前调用，之后只读，无需加锁。亲和性与调度仅在 Linux 生效。
+ */
+class ThreadRoles {
+public:
+    struct RoleConfig {
+        std::vector<int> cpus;        // 为空使用非隔离核
+        std::string policy = "other"; // other | batch | idle | fifo | rr
+        int priority = 0;             // fifo/rr: 1-99；other/batch: nice 值
+        bool busy_poll = false;       // 自有队列的消费线程空闲时忙等而不休眠
+    };
+
+    static ThreadRoles& instance() {
+        static ThreadRoles i;
+        return i;
+    }
+
+    void configure(const nlohmann::json& j) {
+        if (!j.is_object()) return;
+        std::vector<int> isolated = j.value("isolated_cpus", std::vector<int>{});
+        if (j.contains("roles") && j["roles"].is_object()) {
+            for (auto it = j["roles"].begin(); it != j["roles"].end(); ++it) {
+                const auto& r = it.value();
+                if (!r.is_object()) continue;
+                RoleConfig cfg;
+                cfg.cpus = r.value("cpus", std::vector<int>{});
+                cfg.policy = r.value("policy", std::string("other"));
+                cfg.priority = r.value("priority", 0);
+                cfg.busy_poll = r.value("busy_poll", false);
+                roles_[it.key()] = cfg;
+            }
+        }
+
+        default_cpus_.clear();
+#ifdef __linux__
+        if (!isolated.empty()) {
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+                for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+                    if (CPU_ISSET(cpu, &set) && std::find(isolated.begin(), isolated.end(), cpu) == isolated.end()) {
+                        default_cpus_.push_back(cpu);
+                    }
+                }
+            }
+        }
+#endif
+        configured_ = true;
+        std::cout << "[Threads] " << roles_.size() << " role(s) configured, "
+                  << isolated.size() << " isolated CPU(s)" << std::endl;
+    }
+
+    /**
+     * @brief 当前线程登记为 role: 命名、绑核、设置调度策略
+     * @param name 线程名 (为空用角色名，Linux 限 15 字符)
+     */
+    void apply(const std::string& role, const std::string& name = "") {
+        setName(name.empty() ? role : name);
+        if (!configured_) return;
+
+        RoleConfig cfg = config(role);
+        const std::vector<int>& cpus = cfg.cpus.empty() ? default_cpus_ : cfg.cpus;
+        bool pinned = pin(cpus);
+        bool scheduled = setScheduling(cfg.policy, cfg.priority);
+
+        std::cout << "[Threads] " << (name.empty() ? role : name) << ": cpus=";
+        if (cpus.empty()) std::cout << "any";
+        for (size_t i = 0; i < cpus.size(); ++i) std::cout << (i ? "," : "") << cpus[i];
+        std::cout << " policy=" << cfg.policy << "/" << cfg.priority
+                  << ((pinned && scheduled) ? "" : " (partially applied)") << std::endl;
+    }
+
+    // CTP 等外部库创建的回调线程: 每个线程只在第一次调用时登记
+    void applyOnce(const char* role) {
+        thread_local const char* applied = nullptr;
+        if (applied == role) return;
+        applied = role;
+        apply(role);
+    }
+
+    // 绑定当前线程到指定 CPU 集合 (为空不处理)
+    static bool pin(const std::vector<int>& cpus) {
+        if (cpus.empty()) return true;
+#ifdef __linux__
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (int cpu : cpus) {
+            if (cpu >= 0 && cpu < CPU_SETSIZE) CPU_SET(cpu, &set);
+        }
+        if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0) {
+            std::cerr << "[Threads] pthread_setaffinity_np failed" << std::endl;
+            return false;
+        }
+#endif
+        return true;
+    }
+
+    bool busyPoll(const std::string& role) const {
+        auto it = roles_.find(role);
+        return it != roles_.end() && it->second.busy_poll;
+    }
+
+    RoleConfig config(const std::string& role) const {
+        auto it = roles_.find(role);
+        return it != roles_.end() ? it->second : RoleConfig{};
+    }
+
+    /**
+     * @brief 设置 ZMQ 上下文的 I/O 线程 (角色 zmq_io)，须在上下文创建第一个 socket 之前调用
+     */
+    void applyToZmqContext(void* ctx) const {
+        if (!configured_ || !ctx) return;
+        RoleConfig cfg = config("zmq_io");
+        const std::vector<int>& cpus = cfg.cpus.empty() ? default_cpus_ : cfg.cpus;
+#ifdef ZMQ_THREAD_AFFINITY_CPU_ADD
+        for (int cpu : cpus) zmq_ctx_set(ctx, ZMQ_THREAD_AFFINITY_CPU_ADD, cpu);
+#endif
+#if defined(ZMQ_THREAD_SCHED_POLICY) && defined(__linux__)
+        int policy = schedPolicy(cfg.policy);
+        if (policy == SCHED_FIFO || policy == SCHED_RR) {
+            zmq_ctx_set(ctx, ZMQ_THREAD_SCHED_POLICY, policy);
+            zmq_ctx_set(ctx, ZMQ_THREAD_PRIORITY, cfg.priority);
+        }
+#endif
+        (void)cpus;
+    }
+
+private:
+    ThreadRoles() = default;
+
+#ifdef __linux__
+    static int schedPolicy(const std::string& name) {
+        if (name == "fifo") return SCHED_FIFO;
+        if (name == "rr") return SCHED_RR;
+        if (name == "batch") return SCHED_BATCH;
+        if (name == "idle") return SCHED_IDLE;
+        return SCHED_OTHER;
+    }
+#endif
+
+    static void setName(const std::string& name) {
+#ifdef __linux__
+        pthread_setname_np(pthread_self(), name.substr(0, 15).c_str());
+#else
+        (void)name;
+#endif
+    }
+
+    static bool setScheduling(const std::string& policy_name, int priority) {
+#ifdef __linux__
+        int policy = schedPolicy(policy_name);
+        sched_param param{};
+        if (policy == SCHED_FIFO || policy == SCHED_RR) {
+            param.sched_priority = std::clamp(priority, sched_get_priority_min(policy), sched_get_priority_max(policy));
+        }
+        if (pthread_setschedparam(pthread_self(), policy, &param) != 0) {
+            // 实时策略需要 CAP_SYS_NICE / rtprio 限额
+            std::cerr << "[Threads] pthread_setschedparam(" << policy_name << ") failed" << std::endl;
+            return false;
+        }
+        // 普通策略下 priority 作为线程 nice 值
+        if (policy != SCHED_FIFO && policy != SCHED_RR && priority != 0) {
+            if (setpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)), priority) != 0) {
+                std::cerr << "[Threads] setpriority(" << priority << ") failed" << std::endl;
+                return false;
+            }
+        }
+#else
+        (void)policy_name;
+        (void)priority;
+#endif
+        return true;
+    }
+
+    std::map<std::string, RoleConfig> roles_;
+    std::vector<int> default_cpus_;
+    bool configured_ = false;
+};
+
+// 忙等循环中的 CPU 让步提示
+inline void cpuRelax() {
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__)
+    _mm_pause();
+#else
+    std::this_thread::yield();
+#endif
+}
+
+} // namespace QuantLabs
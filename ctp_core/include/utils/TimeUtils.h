@@ -0,0 +1,99 @@
+#pragma once
+
+#include <cstdint>
+#include <ctime>
+
+namespace QuantLabs {
+namespace utils {
+
+/**
+ * @brief 交易所时间工具
+ * CTP 的时间字段都是北京时间字符串 (YYYYMMDD / HH:MM:SS)，这里统一换算成整数，
+ * 避免热路径上反复做字符串比较。
+ */
+
+// "HH:MM:SS" -> 当日秒数 (格式不合法返回 -1)
+inline int parseTimeOfDay(const char* hms) {
+    if (!hms || hms[0] == '\0' || hms[2] != ':' || hms[5] != ':') return -1;
+    int h = (hms[0] - '0') * 10 + (hms[1] - '0');
+    int m = (hms[3] - '0') * 10 + (hms[4] - '0');
+    int s = (hms[6] - '0') * 10 + (hms[7] - '0');
+    if (h < 0 || h > 23 || m < 0 || m > 59 || s < 0 || s > 60) return -1;
+    return h * 3600 + m * 60 + s;
+}
+
+// "YYYYMMDD" -> 20260101 (格式不合法返回 0)
+inline int parseDate(const char* ymd) {
+    if (!ymd) return 0;
+    int v = 0;
+    for (int i = 0; i < 8; ++i) {
+        char c = ymd[i];
+        if (c < '0' || c > '9') return 0;
+        v = v * 10 + (c - '0');
+    }
+    return v;
+}
+
+// 公历日期 -> 1970-01-01 起的天数 (Howard Hinnant days_from_civil)
+inline int64_t daysFromCivil(int y, unsigned m, unsigned d) {
+    y -= m <= 2;
+    const int64_t era = (y >= 0 ? y : y - 399) / 400;
+    const unsigned yoe = static_cast<unsigned>(y - era * 400);
+    const unsigned doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + static_cast<int64_t>(doe) - 719468;
+}
+
+// 北京时间 (日期 + 当日秒数 + 毫秒) -> UTC epoch 毫秒
+inline int64_t toEpochMs(int yyyymmdd, int sec_of_day, int millisec) {
+    int y = yyyymmdd / 10000;
+    unsigned m = static_cast<unsigned>((yyyymmdd / 100) % 100);
+    unsigned d = static_cast<unsigned>(yyyymmdd % 100);
+    int64_t days = daysFromCivil(y, m, d);
+    return ((days * 86400 + sec_of_day) - 8 * 3600) * 1000 + millisec;
+}
+
+// UTC epoch 毫秒 -> 北京时间日期 (YYYYMMDD)，civil_from_days 的逆运算
+inline int dateFromEpochMs(int64_t epoch_ms) {
+    int64_t secs = epoch_ms / 1000 + 8 * 3600;
+    int64_t z = (secs >= 0 ? secs : secs - 86399) / 86400 + 719468;
+    const int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+    const unsigned doe = static_cast<unsigned>(z - era * 146097);
+    const unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    const unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    const unsigned mp = (5 * doy + 2) / 153;
+    const unsigned d = doy - (153 * mp + 2) / 5 + 1;
+    const unsigned m = mp < 10 ? mp + 3 : mp - 9;
+    const int64_t y = static_cast<int64_t>(yoe) + era * 400 + (m <= 2);
+    return static_cast<int>(y * 10000 + m * 100 + d);
+}
+
+/**
+ * @brief 根据本机时钟推算行情的自然日
+ * CTP 夜盘的 ActionDay 不可靠 (大商所夜盘填的是下一交易日)，
+ * 所以用本机日期并按行情时间修正跨零点的情况。要求本机时钟与交易所大致同步。
+ */
+inline int resolveActionDay(int tick_sec_of_day) {
+    std::time_t now = std::time(nullptr);
+    std::tm lt{};
+#ifdef _WIN32
+    localtime_s(&lt, &now);
+#else
+    localtime_r(&now, &lt);
+#endif
+    int local_sod = lt.tm_hour * 3600 + lt.tm_min * 60 + lt.tm_sec;
+
+    // 行情在零点前、本机已过零点 -> 昨天；反之 -> 明天
+    int shift = 0;
+    if (tick_sec_of_day - local_sod > 12 * 3600) shift = -1;
+    else if (local_sod - tick_sec_of_day > 12 * 3600) shift = 1;
+    if (shift != 0) {
+        lt.tm_mday += shift;
+        lt.tm_isdst = -1;
+        std::mktime(&lt); // 规范化月/年进位
+    }
+    return (lt.tm_year + 1900) * 10000 + (lt.tm_mon + 1) * 100 + lt.tm_mday;
+}
+
+} // namespace utils
+} // namespace QuantLabs
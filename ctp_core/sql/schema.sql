@@ -140,6 +140,10 @@ CREATE TABLE IF NOT EXISTS tb_strategies (
     updated_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP
 );
 
+-- 进程内策略: 动态库路径 (为空表示仅作为报单标签)，绑定的交易账户 (为空使用主账户)
+ALTER TABLE tb_strategies ADD COLUMN IF NOT EXISTS library_path VARCHAR(256);
+ALTER TABLE tb_strategies ADD COLUMN IF NOT EXISTS account_id VARCHAR(32);
+
 -- 索引：方便按用户和类型查询
 CREATE INDEX IF NOT EXISTS idx_strategy_user ON tb_strategies(user_id);
 CREATE INDEX IF NOT EXISTS idx_strategy_type ON tb_strategies(strategy_type);
@@ -162,9 +166,33 @@ CREATE TABLE IF NOT EXISTS tb_condition_orders (
     limit_price DOUBLE PRECISION,
     
     strategy_id VARCHAR(32),
+
+    price_type CHAR(1) DEFAULT '1',
+    tick_offset INT DEFAULT 0,
+
+    -- 扩展条件 (ConditionType: 0 价格, 1 跟踪止损, 2 价差; PriceSource: 0 最新, 1 买一, 2 卖一, 3 中间价)
+    condition_type INT DEFAULT 0,
+    price_source INT DEFAULT 0,
+    trail_distance DOUBLE PRECISION DEFAULT 0,
+    extreme_price DOUBLE PRECISION DEFAULT 0, -- 跟踪止损的最高/最低价，重启后继续跟踪
+    leg2_instrument_id VARCHAR(32),
+    oco_group BIGINT DEFAULT 0,
+    start_time INT DEFAULT 0, -- HHMMSS
+    end_time INT DEFAULT 0,
     
     insert_time TIMESTAMP DEFAULT NOW()
 );
+-- 旧库升级
+ALTER TABLE tb_condition_orders ADD COLUMN IF NOT EXISTS price_type CHAR(1) DEFAULT '1';
+ALTER TABLE tb_condition_orders ADD COLUMN IF NOT EXISTS tick_offset INT DEFAULT 0;
+ALTER TABLE tb_condition_orders ADD COLUMN IF NOT EXISTS condition_type INT DEFAULT 0;
+ALTER TABLE tb_condition_orders ADD COLUMN IF NOT EXISTS price_source INT DEFAULT 0;
+ALTER TABLE tb_condition_orders ADD COLUMN IF NOT EXISTS trail_distance DOUBLE PRECISION DEFAULT 0;
+ALTER TABLE tb_condition_orders ADD COLUMN IF NOT EXISTS extreme_price DOUBLE PRECISION DEFAULT 0;
+ALTER TABLE tb_condition_orders ADD COLUMN IF NOT EXISTS leg2_instrument_id VARCHAR(32);
+ALTER TABLE tb_condition_orders ADD COLUMN IF NOT EXISTS oco_group BIGINT DEFAULT 0;
+ALTER TABLE tb_condition_orders ADD COLUMN IF NOT EXISTS start_time INT DEFAULT 0;
+ALTER TABLE tb_condition_orders ADD COLUMN IF NOT EXISTS end_time INT DEFAULT 0;
 
 -- CREATE INDEX IF NOT EXISTS idx_cond_status ON tb_condition_orders(status);
 
@@ -3,8 +3,11 @@
 #include <cstring>
 #include <filesystem>
 #include <vector>
+#include "utils/ThreadRoles.h"
 
 #include "storage/DBManager.h"
+#include "storage/TickStore.h"
+#include "network/ShmMarketWriter.h"
 
 namespace QuantLabs {
 
@@ -54,6 +57,7 @@ void MdHandler::join() {
 }   
 
 void MdHandler::OnFrontConnected() {
+    ThreadRoles::instance().applyOnce("md");
     std::cout << "[Md] Front Connected. Logging in..." << std::endl;
     login();
 }
@@ -77,7 +81,10 @@ void MdHandler::login() {
 
 void MdHandler::OnRspUserLogin(CThostFtdcRspUserLoginField *pRspUserLogin, CThostFtdcRspInfoField *pRspInfo, int nRequestID, bool bIsLast) {
     if (pRspInfo && pRspInfo->ErrorID == 0) {
-        std::cout << "[Md] Login Success. Subscribing..." << std::endl;
+        if (pRspUserLogin && std::strcmp(pRspUserLogin->TradingDay, trading_day_) > 0) {
+            std::strncpy(trading_day_, pRspUserLogin->TradingDay, sizeof(trading_day_) - 1);
+        }
+        std::cout << "[Md] Login Success. TradingDay: " << trading_day_ << ". Subscribing..." << std::endl;
         subscribe();
     } else {
         std::cerr << "[Md] Login Failed: " << (pRspInfo ? pRspInfo->ErrorMsg : "Unknown") << " (ErrorID: " << (pRspInfo ? pRspInfo->ErrorID : -1) << ")" << std::endl;
@@ -86,17 +93,22 @@ void MdHandler::OnRspUserLogin(CThostFtdcRspUserLoginField *pRspUserLogin, CThos
 
 void MdHandler::OnRtnDepthMarketData(CThostFtdcDepthMarketDataField *pData) {
     if (!pData) return;
+    ThreadRoles::instance().applyOnce("md"); // 回调线程由 CTP 创建，首笔行情时登记
+
+    // 统一交易日: 郑商所夜盘推送的 TradingDay 是自然日，取已知最大交易日覆盖
+    // (登录返回值 + 大商所/上期所夜盘 Tick 中的 TradingDay 只会单调递增)
+    if (std::strcmp(pData->TradingDay, trading_day_) > 0) {
+        std::strncpy(trading_day_, pData->TradingDay, sizeof(trading_day_) - 1);
+    } else if (trading_day_[0] != '\0') {
+        std::strncpy(pData->TradingDay, trading_day_, sizeof(pData->TradingDay));
+    }
 
-    // CTP 有时会推送 DBL_MAX 作为空值，必须过滤
-    // 1e12 (一万亿) 是一个安全的上限，远超任何真实价格
-    if (pData->LastPrice > 1e12) return; 
-    
-    // 如果您确定不交易组合合约(Spread)，保留 < 0 过滤也是好的防错措施
-    // 但如果做组合合约，则应移除 || pData->LastPrice < 0
-    if (pData->LastPrice < 0) return; 
+    // 规整: 清洗价格 (DBL_MAX 等空值置 0)、推算交易所时间、丢弃重复/乱序行情、计算增量
+    // 只有被接受的行情才触发回调和后续处理
+    const NormalizedTick* normalized = nullptr;
+    if (normalizer_.normalize(*pData, normalized) != TickNormalizer::Result::Accepted) return;
 
-    // 只有数据有效才触发回调和后续处理
-    if (tick_callback_) tick_callback_(pData);
+    if (tick_callback_) tick_callback_(pData, *normalized);
 
     TickData tick;
     std::memset(&tick, 0, sizeof(tick));
@@ -143,14 +155,28 @@ void MdHandler::OnRtnDepthMarketData(CThostFtdcDepthMarketDataField *pData) {
 
     // std::cout << "[Md] Received tick: " << tick.instrument_id << " " << tick.last_price << " " << tick.update_time << std::endl;
     
+    // 同机消费者: 共享内存 (未启用时直接返回)
+    ShmMarketWriter::instance().publish(tick);
+
+    // 进程内策略
+    if (tick_data_callback_) tick_data_callback_(tick);
+
     // Binary Transport (High Performance)
     pub_.publishTickBinary(tick);
+
+    // 本地落盘 (未启用时直接返回)
+    TickStore::instance().appendTick(tick);
 }
 
 void MdHandler::subscribe() {
-    if (md_api_ && !contracts_.empty()) {
+    std::vector<std::string> contracts;
+    {
+        std::lock_guard<std::mutex> lock(contracts_mtx_);
+        contracts.assign(contracts_.begin(), contracts_.end());
+    }
+    if (md_api_ && !contracts.empty()) {
         std::vector<char*> ids;
-        for (const auto& s : contracts_) {
+        for (const auto& s : contracts) {
             ids.push_back(const_cast<char*>(s.c_str()));
         }
         int res = md_api_->SubscribeMarketData(ids.data(), ids.size());
@@ -166,15 +192,18 @@ void MdHandler::OnRspSubMarketData(CThostFtdcSpecificInstrumentField *pSpecificI
     }
 }
 
-void MdHandler::subscribe(const std::string& instrument) {
+void MdHandler::subscribe(const std::string& instrument, bool persist) {
     if (md_api_) {
         char* id = const_cast<char*>(instrument.c_str());
         md_api_->SubscribeMarketData(&id, 1);
-        contracts_.insert(instrument);
+        {
+            std::lock_guard<std::mutex> lock(contracts_mtx_);
+            contracts_.insert(instrument);
+        }
         std::cout << "[Md] Sent live subscription for: " << instrument << std::endl;
         
         // 持久化订阅
-        DBManager::instance().addSubscription(instrument);
+        if (persist) DBManager::instance().addSubscription(instrument);
     }
 }
 
@@ -182,7 +211,10 @@ void MdHandler::unsubscribe(const std::string& instrument) {
     if (md_api_) {
         char* id = const_cast<char*>(instrument.c_str());
         md_api_->UnSubscribeMarketData(&id, 1);
-        contracts_.erase(instrument);
+        {
+            std::lock_guard<std::mutex> lock(contracts_mtx_);
+            contracts_.erase(instrument);
+        }
         std::cout << "[Md] Sent live unsubscription for: " << instrument << std::endl;
         
         // 移除订阅
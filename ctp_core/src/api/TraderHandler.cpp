@@ -1,5 +1,6 @@
 #include "api/TraderHandler.h"
 #include "network/Publisher.h"
+#include "protocol/zmq_topics.h"
 #include "protocol/message_schema.h"
 #include <iostream>
 #include <cstring>
@@ -7,7 +8,10 @@
 #include <thread>
 #include <chrono>
 #include "storage/DBManager.h"
+#include "market/InstrumentCache.h"
 #include "utils/Encoding.h"
+#include "utils/ThreadRoles.h"
+#include "utils/Logger.h"
 
 namespace QuantLabs {
 
@@ -18,6 +22,13 @@ TraderHandler::TraderHandler(std::map<std::string, std::string> config, Publishe
     td_front_ = config["td_front"];
     app_id_ = config["app_id"];
     auth_code_ = config["auth_code"];
+    account_id_ = config["account_id"].empty() ? user_id_ : config["account_id"];
+    primary_ = config["primary"] != "0";
+
+    // 共享合约缓存有更新时 (可能来自其它账户的查询)，同步到本账户的 PositionManager
+    listener_id_ = InstrumentCache::instance().addListener([this](const InstrumentMeta& meta) {
+        syncInstrumentMeta(meta);
+    });
 
     std::string flow_dir = "./flow/td/" + broker_id_ + "/" + user_id_ + "/";
     if (!std::filesystem::exists(flow_dir)) {
@@ -39,9 +50,11 @@ TraderHandler::TraderHandler(std::map<std::string, std::string> config, Publishe
 }
 
 TraderHandler::~TraderHandler() {
+    InstrumentCache::instance().removeListener(listener_id_);
     running_ = false;
     queue_cv_.notify_all();
     if (query_thread_.joinable()) query_thread_.join();
+    if (restore_thread_.joinable()) restore_thread_.join();
 
     if (td_api_) {
         td_api_->RegisterSpi(nullptr);
@@ -55,6 +68,7 @@ void TraderHandler::join() {
 }
 
 void TraderHandler::OnFrontConnected() {
+    ThreadRoles::instance().applyOnce("td");
     std::cout << "[Td] Connected. Authenticating..." << std::endl;
     reqAuthenticate();
 }
@@ -104,19 +118,14 @@ void TraderHandler::OnRspUserLogin(CThostFtdcRspUserLoginField *pRspUserLogin, C
 
         m_posManager.SetTradingDay(current_trading_day_);
         loadInstrumentsFromDB();
-        syncSubscribedInstruments();
+        // 订阅合约的保证金/手续费由主账户统一查询 (InstrumentCache 跨账户共享)，
+        // 其它账户重复查询只会加重流控并用自己的费率覆盖缓存
+        if (primary_) syncSubscribedInstruments();
 
-        // [数据恢复] 加载当日的报单和成交记录
-        {
-            auto orders = DBManager::instance().loadOrders(current_trading_day_);
-            std::cout << "[Td] Restored " << orders.size() << " orders from DB." << std::endl;
-            // 逐个推送给前端
-            for (const auto& o : orders) pub_.publishOrder(&o);
-
-            auto trades = DBManager::instance().loadTrades(current_trading_day_);
-            std::cout << "[Td] Restored " << trades.size() << " trades from DB." << std::endl;
-            for (const auto& t : trades) pub_.publishTrade(t);
-        }
+        // [数据恢复] 当日报单和成交的查库放到独立线程，SPI 线程直接继续结算确认
+        // (重连再次登录时上一次恢复通常早已结束)
+        if (restore_thread_.joinable()) restore_thread_.join();
+        restore_thread_ = std::thread(&TraderHandler::restoreDayOrdersAndTrades, this, current_trading_day_);
 
         confirmSettlement();
     } else {
@@ -135,15 +144,14 @@ void TraderHandler::confirmSettlement() {
 void TraderHandler::OnRspSettlementInfoConfirm(CThostFtdcSettlementInfoConfirmField *pConfirm, CThostFtdcRspInfoField *pRspInfo, int nRequestID, bool bIsLast) {
     if (pRspInfo && pRspInfo->ErrorID == 0) {
         // 统计缓存中当天有效的合约数量
-        int today_count = 0;
-        for (const auto& [id, meta] : instrument_cache_) {
-            if (std::string(meta.trading_day) == current_trading_day_) {
-                today_count++;
-            }
-        }
+        size_t today_count = InstrumentCache::instance().countForDay(current_trading_day_);
 
         // 如果当天缓存足够（说明今天已经做过全量查询），直接跳过
-        if (today_count >= 100) {
+        // 合约/费率由主账户统一查询，其它账户共享缓存
+        if (!primary_) {
+            std::cout << "[Td][" << account_id_ << "] Settlement Confirmed. Instruments shared from primary account. Querying BrokerParams..." << std::endl;
+            reqQueryBrokerTradingParams();
+        } else if (today_count >= 100) {
             std::cout << "[Td] Settlement Confirmed. Today's instrument cache valid (" 
                       << today_count << "). Skipping full query. Querying BrokerParams..." << std::endl;
             reqQueryBrokerTradingParams();
@@ -184,21 +192,20 @@ void TraderHandler::OnRspQryInstrument(CThostFtdcInstrumentField *pInstrument, C
         // 注意：不能用 return 过滤！否则最后一条如果是期权，bIsLast 检查会被跳过
         if (pInstrument->ProductClass == THOST_FTDC_PC_Futures) {
 
-            InstrumentMeta& data = instrument_cache_[pInstrument->InstrumentID];
-            std::strncpy(data.instrument_id, pInstrument->InstrumentID, sizeof(data.instrument_id));
-            std::strncpy(data.exchange_id, pInstrument->ExchangeID, sizeof(data.exchange_id));
-            std::strncpy(data.instrument_name, pInstrument->InstrumentName, sizeof(data.instrument_name));
-            std::strncpy(data.product_id, pInstrument->ProductID, sizeof(data.product_id));
-            std::strncpy(data.underlying_instr_id, pInstrument->UnderlyingInstrID, sizeof(data.underlying_instr_id));
-            data.strike_price = pInstrument->StrikePrice;
-            data.volume_multiple = pInstrument->VolumeMultiple;
-            data.price_tick = pInstrument->PriceTick;
-            std::strncpy(data.trading_day, current_trading_day_.c_str(), sizeof(data.trading_day) - 1);
+            InstrumentMeta data = InstrumentCache::instance().update(pInstrument->InstrumentID, [&](InstrumentMeta& data) {
+                std::strncpy(data.instrument_id, pInstrument->InstrumentID, sizeof(data.instrument_id) - 1);
+                std::strncpy(data.exchange_id, pInstrument->ExchangeID, sizeof(data.exchange_id) - 1);
+                std::strncpy(data.instrument_name, pInstrument->InstrumentName, sizeof(data.instrument_name) - 1);
+                std::strncpy(data.product_id, pInstrument->ProductID, sizeof(data.product_id) - 1);
+                std::strncpy(data.underlying_instr_id, pInstrument->UnderlyingInstrID, sizeof(data.underlying_instr_id) - 1);
+                data.strike_price = pInstrument->StrikePrice;
+                data.volume_multiple = pInstrument->VolumeMultiple;
+                data.price_tick = pInstrument->PriceTick;
+                data.position_date_type = pInstrument->PositionDateType;
+                std::strncpy(data.trading_day, current_trading_day_.c_str(), sizeof(data.trading_day) - 1);
+            });
 
-#ifdef _DEBUG        
-            std::cout << "[Td] Saved Instrument: " << data.instrument_id << " (" << data.instrument_name << ")" << std::endl;
-#endif  
-            m_posManager.UpdateInstrument(*pInstrument);
+            LOG_DEBUG("Td", "Saved Instrument: {} ({})", data.instrument_id, data.instrument_name);
             DBManager::instance().saveInstrument(data);
             pub_.publishInstrument(data);
         }
@@ -207,7 +214,7 @@ void TraderHandler::OnRspQryInstrument(CThostFtdcInstrumentField *pInstrument, C
 
     // Chain execution: when ALL instruments are loaded, query Account
     if (bIsLast) {
-        std::cout << "[Td] All Instruments Loaded (" << instrument_cache_.size() << "). Querying Account..." << std::endl;
+        std::cout << "[Td] All Instruments Loaded (" << InstrumentCache::instance().size() << "). Querying Account..." << std::endl;
         std::this_thread::sleep_for(std::chrono::milliseconds(500)); // Brief pause
         reqQueryBrokerTradingParams();
     }
@@ -232,15 +239,11 @@ void TraderHandler::OnRspQryBrokerTradingParams(CThostFtdcBrokerTradingParamsFie
 	{
 		// simnow MarginPriceType = 4 开仓价算保证金
 
-#ifdef _DEBUG
-		std::cout << "[Td] BrokerID:" << pBrokerTradingParams->BrokerID << std::endl
-			<< "保证金价格类型(MarginPriceType):" << pBrokerTradingParams->MarginPriceType << std::endl
-			<< "盈亏算法(Algorithm):" << pBrokerTradingParams->Algorithm << std::endl
-			<< "可用是否包含平仓盈利(AvailIncludeCloseProfit):" << pBrokerTradingParams->AvailIncludeCloseProfit << std::endl
-			<< "币种代码(CurrencyID):" << pBrokerTradingParams->CurrencyID << std::endl
-			<< "期权权利金价格类型(OptionRoyaltyPriceType):" << pBrokerTradingParams->OptionRoyaltyPriceType
-			<< std::endl;
-#endif
+		LOG_DEBUG("Td", "BrokerID:{} 保证金价格类型(MarginPriceType):{} 盈亏算法(Algorithm):{} "
+			"可用是否包含平仓盈利(AvailIncludeCloseProfit):{} 币种代码(CurrencyID):{} 期权权利金价格类型(OptionRoyaltyPriceType):{}",
+			pBrokerTradingParams->BrokerID, pBrokerTradingParams->MarginPriceType, pBrokerTradingParams->Algorithm,
+			pBrokerTradingParams->AvailIncludeCloseProfit, pBrokerTradingParams->CurrencyID,
+			pBrokerTradingParams->OptionRoyaltyPriceType);
 
 	}
 	if (bIsLast)
@@ -269,9 +272,12 @@ void TraderHandler::OnRspQryTradingAccount(CThostFtdcTradingAccountField *pAccou
         data.close_profit = pAccount->CloseProfit;
         
         // 更新缓存
-        account_cache_ = data;
+        {
+            std::lock_guard<std::mutex> lock(cache_mtx_);
+            account_cache_ = data;
+        }
 
-        pub_.publishAccount(data);
+        pub_.publishAccount(data, account_id_);
     }
     if (bIsLast) {
         std::this_thread::sleep_for(std::chrono::milliseconds(500));
@@ -326,30 +332,16 @@ void TraderHandler::OnRspQryInvestorPositionDetail(CThostFtdcInvestorPositionDet
 
     if (pDetail) {
 
-#ifdef _DEBUG
-		std::cerr << "[Td] 合约代码：" << pDetail->InstrumentID << std::endl;
-		std::cerr << "[Td] 经纪公司代码(BrokerID)：\t" << pDetail->BrokerID << std::endl;
-		std::cerr << "[Td] 投资者代码(InvestorID)：\t" << pDetail->InvestorID << std::endl;
-		std::cerr << "[Td] 投机套保标记(HedgeFlag)：\t" << pDetail->HedgeFlag << std::endl;
-		std::cerr << "[Td] 买卖(Direction)：\t" << pDetail->Direction << std::endl;
-		std::cerr << "[Td] 成交类型(TradeType)：\t" << pDetail->TradeType << std::endl;
-		std::cerr << "[Td] 开仓日期(OpenDate)：\t" << pDetail->OpenDate << std::endl;
-		std::cerr << "[Td] 交易日(TradingDay)：\t" << pDetail->TradingDay << std::endl;
-		std::cerr << "[Td] 成交编号(TradeID)：\t" << pDetail->TradeID << std::endl;
-		std::cerr << "[Td] 数量(Volume)：\t" << pDetail->Volume << std::endl;
-		std::cerr << "[Td] 平仓量(CloseVolume)：\t" << pDetail->CloseVolume << std::endl;
-		std::cerr << "[Td] 开仓价(OpenPrice)：\t" << pDetail->OpenPrice << std::endl;
-		std::cerr << "[Td] 逐日盯市平仓盈亏(CloseProfitByDate)：\t" << pDetail->CloseProfitByDate << std::endl;
-		std::cerr << "[Td] 逐笔对冲平仓盈亏(CloseProfitByTrade)：\t" << pDetail->CloseProfitByTrade << std::endl;
-		std::cerr << "[Td] 逐日盯市持仓盈亏(PositionProfitByDate)：\t" << pDetail->PositionProfitByDate << std::endl;
-		std::cerr << "[Td] 逐笔对冲持仓盈亏(PositionProfitByTrade：\t" << pDetail->PositionProfitByTrade << std::endl;
-		std::cerr << "[Td] 投资者保证金(Margin)：\t" << pDetail->Margin << std::endl;
-		std::cerr << "[Td] 交易所保证金(ExchMargin)：\t" << pDetail->ExchMargin << std::endl;
-		std::cerr << "[Td] 保证金率(MarginRateByMoney)：\t" << pDetail->MarginRateByMoney << std::endl;
-		std::cerr << "[Td] 昨结算价(LastSettlementPrice)：\t" << pDetail->LastSettlementPrice << std::endl;
-		std::cerr << "[Td] 结算价(SettlementPrice)：\t" << pDetail->SettlementPrice << std::endl;
-
-#endif // _DEBUG
+        LOG_DEBUG("Td", "PositionDetail {} Broker:{} Investor:{} Hedge:{} Dir:{} TradeType:{} OpenDate:{} TradingDay:{} TradeID:{}",
+                  pDetail->InstrumentID, pDetail->BrokerID, pDetail->InvestorID, pDetail->HedgeFlag, pDetail->Direction,
+                  pDetail->TradeType, pDetail->OpenDate, pDetail->TradingDay, pDetail->TradeID);
+        LOG_DEBUG("Td", "PositionDetail {} Volume:{} CloseVolume:{} OpenPrice:{} CloseProfitByDate:{} CloseProfitByTrade:{} "
+                  "PositionProfitByDate:{} PositionProfitByTrade:{}",
+                  pDetail->InstrumentID, pDetail->Volume, pDetail->CloseVolume, pDetail->OpenPrice, pDetail->CloseProfitByDate,
+                  pDetail->CloseProfitByTrade, pDetail->PositionProfitByDate, pDetail->PositionProfitByTrade);
+        LOG_DEBUG("Td", "PositionDetail {} Margin:{} ExchMargin:{} MarginRateByMoney:{} LastSettlementPrice:{} SettlementPrice:{}",
+                  pDetail->InstrumentID, pDetail->Margin, pDetail->ExchMargin, pDetail->MarginRateByMoney,
+                  pDetail->LastSettlementPrice, pDetail->SettlementPrice);
         // 过滤已平仓明细 (CTP 有时会推送 Volume=0 的记录)
         if (pDetail->Volume > 0) {
             
@@ -400,75 +392,80 @@ void TraderHandler::OnRspQryInvestorPositionDetail(CThostFtdcInvestorPositionDet
     }
 }
 
-void TraderHandler::pushCachedPositions() {
-    // std::lock_guard<std::mutex> lock(position_mtx_); // REMOVED
+void TraderHandler::publishPosition(const PositionData& data, int64_t snapshot_seq) {
+    pub_.publishPosition(data, snapshot_seq, account_id_);  // JSON (PT)，兼容脚本等旧订阅方
+    pub_.publishPositionBinary(data, account_id_);          // 二进制 (PB)，客户端持仓表
+}
+
+std::vector<PositionData> TraderHandler::collectPositions() {
     // 获取 PositionManager 的全量持仓
     auto positions = m_posManager.GetAllPositions();
-    
-    std::cout << "[Td] Pushing cached state (Account + " << positions.size() << " Instruments)..." << std::endl;
-    
-    // 1. 推送资金快照
-    pub_.publishAccount(account_cache_);
-
-    // 生成本次快照的批次号
-    int64_t seq = std::chrono::duration_cast<std::chrono::milliseconds>(
-        std::chrono::system_clock::now().time_since_epoch()).count();
+    std::vector<PositionData> result;
+    result.reserve(positions.size() * 2);
 
-    // 2. 推送持仓快照（需要扁平化）
     // PositionManager 的结构是 All-in-One (Long/Short Combined)
     // 我们需要把它们拆成两条记录 (Long, Short) 推送给前端
-    
     for (const auto& [instID, posPtr] : positions) {
         if (!posPtr) continue;
         
         // 查找合约乘数
-        int mult = 1;
-        if (instrument_cache_.count(instID)) {
-            mult = instrument_cache_[instID].volume_multiple;
-            if (mult <= 0) mult = 1;
-        }
+        int mult = InstrumentCache::instance().volumeMultiple(instID);
 
-        // --- 多头 ---
         if (posPtr->LongPosition > 0 || posPtr->LongFrozenMargin > 0) {
-            PositionData data = {0};
-            std::strncpy(data.instrument_id, posPtr->InstrumentID.c_str(), sizeof(data.instrument_id) - 1);
-            std::strncpy(data.exchange_id, posPtr->ExchangeID.c_str(), sizeof(data.exchange_id) - 1);
-            data.direction = THOST_FTDC_PD_Long; // '2'
-            data.position = posPtr->LongPosition;
-            data.today_position = posPtr->LongTodayPosition;
-            data.yd_position = posPtr->LongYdPosition;
-            data.position_cost = posPtr->LongPositionCost; 
-            data.open_cost = posPtr->LongOpenCost;
-            data.pos_profit = posPtr->LongPositionProfit;
-            data.close_profit = posPtr->LongCloseProfit;
-            data.margin = posPtr->Margin;  // TODO: 分多空保证金
-            data.volume_multiple = mult;
-
-            pub_.publishPosition(data, seq);
+            result.push_back(atrader::core::PositionManager::ToPositionData(*posPtr, THOST_FTDC_PD_Long, mult));
         }
-        
-        // --- 空头 ---
         if (posPtr->ShortPosition > 0 || posPtr->ShortFrozenMargin > 0) {
-            PositionData data = {0};
-            std::strncpy(data.instrument_id, posPtr->InstrumentID.c_str(), sizeof(data.instrument_id) - 1);
-            std::strncpy(data.exchange_id, posPtr->ExchangeID.c_str(), sizeof(data.exchange_id) - 1);
-            data.direction = THOST_FTDC_PD_Short; // '3'
-            data.position = posPtr->ShortPosition;
-            data.today_position = posPtr->ShortTodayPosition;
-            data.yd_position = posPtr->ShortYdPosition;
-            data.position_cost = posPtr->ShortPositionCost;
-            data.open_cost = posPtr->ShortOpenCost;
-            data.pos_profit = posPtr->ShortPositionProfit;
-            data.close_profit = posPtr->ShortCloseProfit;
-            data.margin = posPtr->Margin;  // TODO: 分多空保证金
-            data.volume_multiple = mult;
-
-            pub_.publishPosition(data, seq);
+            result.push_back(atrader::core::PositionManager::ToPositionData(*posPtr, THOST_FTDC_PD_Short, mult));
         }
+    }
+    return result;
+}
+
+void TraderHandler::onMarketPrice(const CThostFtdcDepthMarketDataField& tick) {
+    // 同一合约限频推送，浮盈随行情每 kPnlPushIntervalMs 最多刷新一次
+    // 限频表只记录有持仓的合约: 先查已有记录，持仓判断交给 UpdateLastPrice
+    auto now = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+    const std::string id(tick.InstrumentID);
+    auto it = pnl_push_ms_.find(id);
+    if (it != pnl_push_ms_.end() && now - it->second < kPnlPushIntervalMs) return;
+
+    // 多空数据在持仓锁内生成，避免与成交线程的 UpdateFromTrade 竞争
+    PositionData longData, shortData;
+    bool hasLong = false, hasShort = false;
+    if (!m_posManager.UpdateLastPrice(id, tick.LastPrice, longData, hasLong, shortData, hasShort)) return;
+    if (it != pnl_push_ms_.end()) it->second = now;
+    else pnl_push_ms_.emplace(id, now);
+
+    if (hasLong) pub_.publishPositionBinary(longData, account_id_);
+    if (hasShort) pub_.publishPositionBinary(shortData, account_id_);
+}
+
+void TraderHandler::pushCachedPositions() {
+    auto positions = collectPositions();
+    
+    std::cout << "[Td] Pushing cached state (Account + " << positions.size() << " Positions)..." << std::endl;
+    
+    // 1. 推送资金快照
+    AccountData account;
+    {
+        std::lock_guard<std::mutex> lock(cache_mtx_);
+        account = account_cache_;
+    }
+    pub_.publishAccount(account, account_id_);
+
+    // 生成本次快照的批次号
+    int64_t seq = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+
+    // 2. 推送持仓快照
+    for (const auto& data : positions) {
+        publishPosition(data, seq);
 
         // 顺便推一下合约信息，防止前端只有持仓没有名字
-        if (instrument_cache_.count(instID)) {
-             pub_.publishInstrument(instrument_cache_[instID]);
+        InstrumentMeta meta;
+        if (InstrumentCache::instance().get(data.instrument_id, meta)) {
+             pub_.publishInstrument(meta);
         }
     }
 }
@@ -476,40 +473,54 @@ void TraderHandler::pushCachedPositions() {
 void TraderHandler::pushCachedOrdersAndTrades() {
     if (current_trading_day_.empty()) return;
     
-    // 从 DB 加载当日委托和成交
-    auto orders = DBManager::instance().loadOrders(current_trading_day_);
+    // 内存缓存已包含 DB 恢复 + 当日回报，无需再查库
+    std::vector<CThostFtdcOrderField> orders;
+    std::vector<TradeData> trades;
+    {
+        std::lock_guard<std::mutex> lock(cache_mtx_);
+        orders.reserve(order_cache_.size());
+        for (const auto& [key, o] : order_cache_) orders.push_back(o);
+        trades = trade_cache_;
+    }
+
     if (!orders.empty()) {
         std::cout << "[Td] SyncState: Pushing " << orders.size() << " restored orders..." << std::endl;
-        for (const auto& o : orders) pub_.publishOrder(&o);
+        for (const auto& o : orders) pub_.publishOrder(&o, account_id_);
     }
 
-    auto trades = DBManager::instance().loadTrades(current_trading_day_);
     if (!trades.empty()) {
         std::cout << "[Td] SyncState: Pushing " << trades.size() << " restored trades..." << std::endl;
-        for (const auto& t : trades) pub_.publishTrade(t);
+        for (const auto& t : trades) pub_.publishTrade(t, account_id_);
     }
 }
 
 void TraderHandler::pushCachedInstruments() {
-    if (instrument_cache_.empty()) return;
-    std::cout << "[Td] Pushing cached instruments (" << instrument_cache_.size() << ")..." << std::endl;
-    for (const auto& [id, data] : instrument_cache_) {
+    auto instruments = InstrumentCache::instance().all();
+    if (instruments.empty()) return;
+    std::cout << "[Td] Pushing cached instruments (" << instruments.size() << ")..." << std::endl;
+    for (const auto& data : instruments) {
         pub_.publishInstrument(data);
     }
 }
 
 bool TraderHandler::getInstrumentMeta(const std::string& id, InstrumentMeta& out_data) {
-    if (instrument_cache_.find(id) != instrument_cache_.end()) {
-        out_data = instrument_cache_[id];
-        return true;
-    }
-    return false;
+    return InstrumentCache::instance().get(id, out_data);
+}
+
+void TraderHandler::syncInstrumentMeta(const InstrumentMeta& meta) {
+    CThostFtdcInstrumentField instr = {0};
+    std::strncpy(instr.InstrumentID, meta.instrument_id, sizeof(instr.InstrumentID) - 1);
+    std::strncpy(instr.ExchangeID, meta.exchange_id, sizeof(instr.ExchangeID) - 1);
+    instr.VolumeMultiple = meta.volume_multiple;
+    instr.PriceTick = meta.price_tick;
+    instr.PositionDateType = meta.position_date_type;
+    m_posManager.UpdateInstrument(instr);
 }
 
 
 void TraderHandler::qryMarginRate(const std::string& instrument_id) {
     if (instrument_id.empty()) {
-        std::cerr << "[Td Error] qryMarginRate failed: InstrumentID REQUIRED." << std::endl;
+        LOG_ERROR("Td", "qryMarginRate failed: InstrumentID REQUIRED.");
         return; 
     }
     CThostFtdcQryInstrumentMarginRateField req;
@@ -523,31 +534,26 @@ void TraderHandler::qryMarginRate(const std::string& instrument_id) {
 
 void TraderHandler::OnRspQryInstrumentMarginRate(CThostFtdcInstrumentMarginRateField *pMargin, CThostFtdcRspInfoField *pRspInfo, int nRequestID, bool bIsLast) {
     if (pMargin) {
-        std::cout << "[Td Debug] Margin Resp: " << pMargin->InstrumentID 
-                  << " LongMoney:" << pMargin->LongMarginRatioByMoney << std::endl;
-
-        InstrumentMeta& data = instrument_cache_[pMargin->InstrumentID];
-        data.long_margin_ratio_by_money = pMargin->LongMarginRatioByMoney;
-        data.long_margin_ratio_by_volume = pMargin->LongMarginRatioByVolume;
-        data.short_margin_ratio_by_money = pMargin->ShortMarginRatioByMoney;
-        data.short_margin_ratio_by_volume = pMargin->ShortMarginRatioByVolume;
-        
+        LOG_DEBUG("Td", "Margin Resp: {} LongMoney:{}", pMargin->InstrumentID, pMargin->LongMarginRatioByMoney);
+
         // 收到 Margin，仅更新缓存，不急着推送，等 Comm 一起推
-        
-        std::strncpy(data.trading_day, current_trading_day_.c_str(), sizeof(data.trading_day) - 1);
-        std::strncpy(data.trading_day, current_trading_day_.c_str(), sizeof(data.trading_day) - 1);
+        // (缓存更新会通知各账户同步 PositionManager)
+        InstrumentMeta data = InstrumentCache::instance().update(pMargin->InstrumentID, [&](InstrumentMeta& data) {
+            data.long_margin_ratio_by_money = pMargin->LongMarginRatioByMoney;
+            data.long_margin_ratio_by_volume = pMargin->LongMarginRatioByVolume;
+            data.short_margin_ratio_by_money = pMargin->ShortMarginRatioByMoney;
+            data.short_margin_ratio_by_volume = pMargin->ShortMarginRatioByVolume;
+            std::strncpy(data.trading_day, current_trading_day_.c_str(), sizeof(data.trading_day) - 1);
+        });
         DBManager::instance().saveInstrument(data);
-        
-        // --- Sync to PositionManager ---
-        m_posManager.UpdateInstrumentMeta(data);
     } else {
-        std::cerr << "[Td Error] Margin Resp is NULL or Error" << std::endl;
+        LOG_ERROR("Td", "Margin Resp is NULL or Error");
     }
 }
 
 void TraderHandler::qryCommissionRate(const std::string& instrument_id) {
     if (instrument_id.empty()) {
-        std::cerr << "[Td Error] qryCommissionRate failed: InstrumentID REQUIRED." << std::endl;
+        LOG_ERROR("Td", "qryCommissionRate failed: InstrumentID REQUIRED.");
         return; 
     }
     CThostFtdcQryInstrumentCommissionRateField req;
@@ -586,50 +592,44 @@ void TraderHandler::OnRspQryInstrumentCommissionRate(CThostFtdcInstrumentCommiss
         if (target_id.empty()) target_id = pComm->InstrumentID;
 
         if (target_id.empty()) {
-             std::cerr << "[Td Error] Unknown InstrumentID for Commission Rate" << std::endl;
+             LOG_ERROR("Td", "Unknown InstrumentID for Commission Rate");
              return;
         }
 
         // 严防死守：如果最终 ID 还是空的，绝对不处理
         if (target_id.empty() || target_id == "") return;
 
-        std::cout << "[Td Debug] Comm Resp: " << pComm->InstrumentID 
-                  << " (Mapped to: " << target_id << ")"
-                  << " OpenMoney:" << pComm->OpenRatioByMoney << std::endl;
+        LOG_DEBUG("Td", "Comm Resp: {} (Mapped to: {}) OpenMoney:{}", pComm->InstrumentID, target_id, pComm->OpenRatioByMoney);
 
-        InstrumentMeta& data = instrument_cache_[target_id];
-        // 如果 target_id 和 requested_iid 不一致（或者是纯新增），确保 instrument_id 字段也被正确填充
-        if (std::strlen(data.instrument_id) == 0) {
-             std::strncpy(data.instrument_id, target_id.c_str(), sizeof(data.instrument_id) - 1);
-        }
+        InstrumentMeta data = InstrumentCache::instance().update(target_id, [&](InstrumentMeta& data) {
+            // 如果 target_id 和 requested_iid 不一致（或者是纯新增），确保 instrument_id 字段也被正确填充
+            if (std::strlen(data.instrument_id) == 0) {
+                 std::strncpy(data.instrument_id, target_id.c_str(), sizeof(data.instrument_id) - 1);
+            }
 
-        data.open_ratio_by_money = pComm->OpenRatioByMoney;
-        data.open_ratio_by_volume = pComm->OpenRatioByVolume;
-        data.close_ratio_by_money = pComm->CloseRatioByMoney;
-        data.close_ratio_by_volume = pComm->CloseRatioByVolume;
-        data.close_today_ratio_by_money = pComm->CloseTodayRatioByMoney;
-        data.close_today_ratio_by_volume = pComm->CloseTodayRatioByVolume;
+            data.open_ratio_by_money = pComm->OpenRatioByMoney;
+            data.open_ratio_by_volume = pComm->OpenRatioByVolume;
+            data.close_ratio_by_money = pComm->CloseRatioByMoney;
+            data.close_ratio_by_volume = pComm->CloseRatioByVolume;
+            data.close_today_ratio_by_money = pComm->CloseTodayRatioByMoney;
+            data.close_today_ratio_by_volume = pComm->CloseTodayRatioByVolume;
+            std::strncpy(data.trading_day, current_trading_day_.c_str(), sizeof(data.trading_day) - 1);
+        });
         
         // 收到 Comm，推送一次
-        std::strncpy(data.trading_day, current_trading_day_.c_str(), sizeof(data.trading_day) - 1);
         DBManager::instance().saveInstrument(data);
-        
-        // --- Sync to PositionManager ---
-        m_posManager.UpdateInstrumentMeta(data);
-
         pub_.publishInstrument(data);
 
         // [补救措施] 如果收到了费率，但发现本地连名字都没有，说明基础查询可能丢了，尝试补查一次
         if (std::strlen(data.instrument_name) == 0) {
-             static std::unordered_set<std::string> retry_set;
-             if (retry_set.find(target_id) == retry_set.end()) {
-                 std::cout << "[Td] Retrying QryInstrument for incomplete: " << target_id << std::endl;
-                 retry_set.insert(target_id);
+             if (instrument_retry_set_.find(target_id) == instrument_retry_set_.end()) {
+                 LOG_INFO("Td", "Retrying QryInstrument for incomplete: {}", target_id);
+                 instrument_retry_set_.insert(target_id);
                  qryInstrument(target_id); // 立即补发一次
              }
         }
     } else {
-        std::cerr << "[Td Error] Comm Resp is NULL or Error" << std::endl;
+        LOG_ERROR("Td", "Comm Resp is NULL or Error");
     }
 }
 
@@ -674,19 +674,16 @@ int TraderHandler::insertOrder(const std::string& instrument, double price, int
             cached_second_ = current_sec;
         }
 
-        // 3. 处理极高频 (1ms内多单) 的唯一性
-        static int last_ms_check = -1;
-        static int ms_offset = 0;
-        
-        if (current_ms == last_ms_check) {
-            ms_offset++; // 毫秒内碰撞，逻辑增加
+        // 3. 处理极高频 (1ms内多单) 的唯一性 (状态按账户保存，受 ref_mtx_ 保护)
+        if (current_ms == last_ref_ms_) {
+            ref_ms_offset_++; // 毫秒内碰撞，逻辑增加
         } else {
-            last_ms_check = current_ms;
-            ms_offset = 0;
+            last_ref_ms_ = current_ms;
+            ref_ms_offset_ = 0;
         }
         
         // 加上偏移量，保证单调递增
-        int final_ms = current_ms + ms_offset;
+        int final_ms = current_ms + ref_ms_offset_;
         
         // 极端兜底: CTP Ref 长度限制，必须保持3位。
         if (final_ms > 999) final_ms = 999; 
@@ -706,10 +703,8 @@ int TraderHandler::insertOrder(const std::string& instrument, double price, int
     char finalOffset = offset;
     
     // 1. Get Exchange ID
-    std::string exchId;
-    if (instrument_cache_.count(instrument)) {
-        exchId = instrument_cache_[instrument].exchange_id;
-    }
+    const InstrumentId instrument_handle = InstrumentCache::instance().find(instrument);
+    std::string exchId = InstrumentCache::instance().exchangeId(instrument_handle);
 
     if (exchId == "SHFE" || exchId == "INE") {
         // Retrieve position from Manager
@@ -726,12 +721,12 @@ int TraderHandler::insertOrder(const std::string& instrument, double price, int
             // Logic:
             // If User sends Close (usually implies CloseYd on SHFE), but Yd is 0 and Today > 0 -> Switch to CloseToday
             if (offset == THOST_FTDC_OF_Close && ydPos <= 0 && todayPos > 0) {
-                 std::cout << "[Td] SmartClose: Auto-Switch to CloseToday for " << instrument << std::endl;
+                 LOG_INFO("Td", "SmartClose: Auto-Switch to CloseToday for {}", instrument);
                  finalOffset = THOST_FTDC_OF_CloseToday;
             }
             // If User sends CloseToday, but Today is 0 and Yd > 0 -> Switch to Close (Yd)
             else if (offset == THOST_FTDC_OF_CloseToday && todayPos <= 0 && ydPos > 0) {
-                 std::cout << "[Td] SmartClose: Auto-Switch to CloseYesterday for " << instrument << std::endl;
+                 LOG_INFO("Td", "SmartClose: Auto-Switch to CloseYesterday for {}", instrument);
                  finalOffset = THOST_FTDC_OF_Close; // On SHFE, Close usually means CloseYd
             }
         }
@@ -750,8 +745,7 @@ int TraderHandler::insertOrder(const std::string& instrument, double price, int
         order.TimeCondition = THOST_FTDC_TC_IOC; 
         order.VolumeCondition = THOST_FTDC_VC_AV;
         
-        std::cout << "[Td] Simulating Market Order (IOC): " << instrument 
-                  << " Dir:" << direction << " Price:" << order.LimitPrice << std::endl;
+        LOG_INFO("Td", "Simulating Market Order (IOC): {} Dir:{} Price:{}", instrument, direction, order.LimitPrice);
     } else {
         order.LimitPrice = price;
         order.TimeCondition = THOST_FTDC_TC_GFD;
@@ -772,7 +766,7 @@ int TraderHandler::insertOrder(const std::string& instrument, double price, int
 
     int ret = td_api_->ReqOrderInsert(&order, next_req_id_++);
     if (ret != 0) {
-        std::cerr << "[Td Error] ReqOrderInsert Failed: " << ret << std::endl;
+        LOG_ERROR("Td", "ReqOrderInsert Failed: {}", ret);
     }
     return ret;
 }
@@ -790,9 +784,9 @@ int TraderHandler::cancelOrder(const std::string& instrument, const std::string&
     // 自动补全 ExchangeID
     std::string finalExchangeID = exchangeID;
     if (finalExchangeID.empty() && !instrument.empty()) {
-        if (instrument_cache_.count(instrument)) {
-            finalExchangeID = instrument_cache_[instrument].exchange_id;
-            std::cout << "[Td] Auto-filled ExchangeID for Cancel: " << finalExchangeID << std::endl;
+        finalExchangeID = InstrumentCache::instance().exchangeId(instrument);
+        if (!finalExchangeID.empty()) {
+            LOG_DEBUG("Td", "Auto-filled ExchangeID for Cancel: {}", finalExchangeID);
         }
     }
     
@@ -808,7 +802,7 @@ int TraderHandler::cancelOrder(const std::string& instrument, const std::string&
                 std::stringstream ss;
                 ss << std::setw(12) << finalSysID; 
                 finalSysID = ss.str();
-                std::cout << "[Td] Padded SysID for " << finalExchangeID << ": '" << finalSysID << "'" << std::endl;
+                LOG_DEBUG("Td", "Padded SysID for {}: '{}'", finalExchangeID, finalSysID);
             }
         }
         
@@ -830,12 +824,8 @@ int TraderHandler::cancelOrder(const std::string& instrument, const std::string&
         std::strncpy(req.InstrumentID, instrument.c_str(), sizeof(req.InstrumentID));
     }
     
-    std::cout << "[Td] ReqOrderAction: Inst:" << instrument 
-              << " SysID:" << req.OrderSysID 
-              << " Ref:" << req.OrderRef 
-              << " Exch:" << req.ExchangeID 
-              << " Front:" << req.FrontID 
-              << " Session:" << req.SessionID << std::endl;
+    LOG_INFO("Td", "ReqOrderAction: Inst:{} SysID:{} Ref:{} Exch:{} Front:{} Session:{}",
+             instrument, req.OrderSysID, req.OrderRef, req.ExchangeID, req.FrontID, req.SessionID);
               
     return td_api_->ReqOrderAction(&req, next_req_id_++);
 }
@@ -857,8 +847,9 @@ std::string TraderHandler::getCurrentStrategy() const {
 }
 
 void TraderHandler::OnRtnOrder(CThostFtdcOrderField *pOrder) {
+    ThreadRoles::instance().applyOnce("td");
     if (pOrder) {
-        std::cout << "[Td] Order Update: " << pOrder->OrderSysID << " Status: " << pOrder->OrderStatus << std::endl;
+        LOG_INFO("Td", "Order Update: {} Status: {}", pOrder->OrderSysID, pOrder->OrderStatus);
         
         // 查找 strategy_id
         std::string strategy_id;
@@ -875,17 +866,20 @@ void TraderHandler::OnRtnOrder(CThostFtdcOrderField *pOrder) {
              std::strncpy(pOrder->InsertDate, current_trading_day_.c_str(), sizeof(pOrder->InsertDate) - 1);
         }
 
-        // 1. 推送给前端
-        pub_.publishOrder(pOrder);
+        // 1. 更新缓存并推送给前端 (先缓存，保证快照不落后于已发布的序号)
+        cacheOrder(*pOrder);
+        pub_.publishOrder(pOrder, account_id_);
         
         // 2. 保存到数据库（带 strategy_id）
         DBManager::instance().saveOrder(pOrder, strategy_id, current_trading_day_);
+
+        if (order_callback_) order_callback_(strategy_id, *pOrder);
     }
 }
 
 void TraderHandler::OnRtnTrade(CThostFtdcTradeField *pTrade) {
     if (pTrade) {
-        std::cout << "[Td] Trade Update: " << pTrade->TradeID << " Price: " << pTrade->Price << std::endl;
+        LOG_INFO("Td", "Trade Update: {} Price: {}", pTrade->TradeID, pTrade->Price);
         // --- PositionManager Integration ---
         double realized_pnl = m_posManager.UpdateFromTrade(*pTrade);
         // -----------------------------------
@@ -904,8 +898,8 @@ void TraderHandler::OnRtnTrade(CThostFtdcTradeField *pTrade) {
         double commission = 0.0;
         double close_profit = realized_pnl;
         
-        if (instrument_cache_.count(pTrade->InstrumentID)) {
-            const auto& instr = instrument_cache_[pTrade->InstrumentID];
+        InstrumentMeta instr;
+        if (InstrumentCache::instance().get(pTrade->InstrumentID, instr)) {
             double price = pTrade->Price;
             int vol = pTrade->Volume;
             int mult = instr.volume_multiple > 0 ? instr.volume_multiple : 1;
@@ -932,57 +926,46 @@ void TraderHandler::OnRtnTrade(CThostFtdcTradeField *pTrade) {
 
         }
 
-        // 1. 推送给前端
-        pub_.publishTrade(pTrade, commission, close_profit);
+        // 1. 更新缓存 (用于重连同步) 并推送给前端
+        TradeData td;
+        std::memset(&td, 0, sizeof(td));
+        std::strncpy(td.instrument_id, pTrade->InstrumentID, sizeof(td.instrument_id)-1);
+        std::strncpy(td.trade_id, pTrade->TradeID, sizeof(td.trade_id)-1);
+        std::strncpy(td.order_sys_id, pTrade->OrderSysID, sizeof(td.order_sys_id)-1);
+        td.direction = pTrade->Direction;
+        td.offset_flag = pTrade->OffsetFlag;
+        td.price = pTrade->Price;
+        td.volume = pTrade->Volume;
+        std::strncpy(td.trade_time, pTrade->TradeTime, sizeof(td.trade_time)-1);
+        std::strncpy(td.trade_date, pTrade->TradeDate, sizeof(td.trade_date)-1);
+        std::strncpy(td.exchange_id, pTrade->ExchangeID, sizeof(td.exchange_id)-1);
+        td.commission = commission;
+        td.close_profit = close_profit;
+        std::strncpy(td.strategy_id, strategy_id.c_str(), sizeof(td.strategy_id)-1);
+        cacheTrade(td);
+
+        pub_.publishTrade(td, account_id_);
 
         // [Debug Log] 打印成交更新后的持仓
         auto pos = m_posManager.GetPosition(pTrade->InstrumentID);
         if (pos) {
-             std::cout << "[Td] Post-Trade Position: " << pos->InstrumentID 
-                       << " L:" << pos->LongPosition << "(Td:" << pos->LongTodayPosition << ", Yd:" << pos->LongYdPosition << ")"
-                       << " S:" << pos->ShortPosition << "(Td:" << pos->ShortTodayPosition << ", Yd:" << pos->ShortYdPosition << ")" 
-                       << " PnL:" << realized_pnl << std::endl;
+             LOG_INFO("Td", "Post-Trade Position: {} L:{}(Td:{}, Yd:{}) S:{}(Td:{}, Yd:{}) PnL:{}",
+                      pos->InstrumentID, pos->LongPosition, pos->LongTodayPosition, pos->LongYdPosition,
+                      pos->ShortPosition, pos->ShortTodayPosition, pos->ShortYdPosition, realized_pnl);
         }
 
         // 2. 保存到数据库（带 strategy_id, commission, close_profit, trading_day）
         DBManager::instance().saveTrade(pTrade, strategy_id, commission, close_profit, current_trading_day_);
-        // 3. 更新缓存 (用于重连同步)
-        bool exists = false;
-        for (const auto& t : trade_cache_) {
-            // TradeID + Direction + OrderSysID usually unique enough, or just TradeID if Exchange is unique
-            if (std::strcmp(t.trade_id, pTrade->TradeID) == 0 && std::strcmp(t.exchange_id, pTrade->ExchangeID) == 0) {
-                exists = true;
-                break;
-            }
-        }
-        if (!exists) {
-            TradeData td;
-            std::memset(&td, 0, sizeof(td));
-            std::strncpy(td.instrument_id, pTrade->InstrumentID, sizeof(td.instrument_id)-1);
-            std::strncpy(td.trade_id, pTrade->TradeID, sizeof(td.trade_id)-1);
-            std::strncpy(td.order_sys_id, pTrade->OrderSysID, sizeof(td.order_sys_id)-1);
-            td.direction = pTrade->Direction;
-            td.offset_flag = pTrade->OffsetFlag;
-            td.price = pTrade->Price;
-            td.volume = pTrade->Volume;
-            std::strncpy(td.trade_time, pTrade->TradeTime, sizeof(td.trade_time)-1);
-            std::strncpy(td.trade_date, pTrade->TradeDate, sizeof(td.trade_date)-1);
-            std::strncpy(td.exchange_id, pTrade->ExchangeID, sizeof(td.exchange_id)-1);
-            
-            td.commission = commission;
-            td.close_profit = close_profit;
-            std::strncpy(td.strategy_id, strategy_id.c_str(), sizeof(td.strategy_id)-1);
-
-            trade_cache_.push_back(td);
-        }
-        
-        // 4. 更新本地持仓和资金
+        // 3. 更新本地持仓和资金
         // [FIX] Duplicate Call removed here to prevent double-counting.
         // It is called at the end of function (Lines 880+) for ALL trades.
         
         // 实时更新本地缓存
         updateLocalPosition(pTrade);
         updateLocalAccount(pTrade, commission, close_profit);
+
+        // 持仓/资金更新后再通知策略
+        if (trade_callback_) trade_callback_(strategy_id, *pTrade);
     }
 }
 
@@ -992,11 +975,7 @@ void TraderHandler::updateLocalPosition(CThostFtdcTradeField *pTrade) {
     if (!posPtr) return;
 
     // 查合约乘数
-    int mult = 1;
-    if (instrument_cache_.count(pTrade->InstrumentID)) {
-        mult = instrument_cache_[pTrade->InstrumentID].volume_multiple;
-        if (mult <= 0) mult = 1;
-    }
+    int mult = InstrumentCache::instance().volumeMultiple(pTrade->InstrumentID);
 
     // 判断受影响的方向
     bool checkLong = false;
@@ -1010,69 +989,41 @@ void TraderHandler::updateLocalPosition(CThostFtdcTradeField *pTrade) {
         else checkLong = true;
     }
 
-    if (checkLong) {
-        PositionData data = {0};
-        std::strncpy(data.instrument_id, posPtr->InstrumentID.c_str(), sizeof(data.instrument_id) - 1);
-        std::strncpy(data.exchange_id, posPtr->ExchangeID.c_str(), sizeof(data.exchange_id) - 1);
-        data.direction = THOST_FTDC_PD_Long; 
-        data.position = posPtr->LongPosition;
-        data.today_position = posPtr->LongTodayPosition;
-        data.yd_position = posPtr->LongYdPosition;
-        data.position_cost = posPtr->LongPositionCost;
-        data.open_cost = posPtr->LongOpenCost;
-        data.pos_profit = posPtr->LongPositionProfit;
-        data.close_profit = posPtr->LongCloseProfit;
-        data.margin = posPtr->Margin;
-        data.volume_multiple = mult;
-        
-        pub_.publishPosition(data);
-    }
-
-    if (checkShort) {
-        PositionData data = {0};
-        std::strncpy(data.instrument_id, posPtr->InstrumentID.c_str(), sizeof(data.instrument_id) - 1);
-        std::strncpy(data.exchange_id, posPtr->ExchangeID.c_str(), sizeof(data.exchange_id) - 1);
-        data.direction = THOST_FTDC_PD_Short;
-        data.position = posPtr->ShortPosition;
-        data.today_position = posPtr->ShortTodayPosition;
-        data.yd_position = posPtr->ShortYdPosition;
-        data.position_cost = posPtr->ShortPositionCost;
-        data.open_cost = posPtr->ShortOpenCost;
-        data.pos_profit = posPtr->ShortPositionProfit;
-        data.close_profit = posPtr->ShortCloseProfit;
-        data.margin = posPtr->Margin;
-        data.volume_multiple = mult;
-        
-        pub_.publishPosition(data);
-    }
+    if (checkLong) publishPosition(atrader::core::PositionManager::ToPositionData(*posPtr, THOST_FTDC_PD_Long, mult), 0);
+    if (checkShort) publishPosition(atrader::core::PositionManager::ToPositionData(*posPtr, THOST_FTDC_PD_Short, mult), 0);
 }
 
 void TraderHandler::updateLocalAccount(CThostFtdcTradeField *pTrade, double commission, double realized_pnl) {
     // 使用实际计算的手续费和平仓盈亏更新本地资金缓存
     // 注意：这是近似值，精确值需要通过 reqQueryTradingAccount 校准
-    account_cache_.commission += commission;
-    account_cache_.close_profit += realized_pnl;
-    account_cache_.balance += realized_pnl - commission;
-    account_cache_.available += realized_pnl - commission;
+    AccountData account;
+    {
+        std::lock_guard<std::mutex> lock(cache_mtx_);
+        account_cache_.commission += commission;
+        account_cache_.close_profit += realized_pnl;
+        account_cache_.balance += realized_pnl - commission;
+        account_cache_.available += realized_pnl - commission;
+        account = account_cache_;
+    }
     
-    pub_.publishAccount(account_cache_);
+    pub_.publishAccount(account, account_id_);
 }
 
 void TraderHandler::OnRspOrderInsert(CThostFtdcInputOrderField *pInput, CThostFtdcRspInfoField *pRspInfo, int nRequestID, bool bIsLast) {
-    if (pRspInfo && pRspInfo->ErrorID != 0) std::cerr << "[Td] Order Insert Error: " << utils::gbk_to_utf8(pRspInfo->ErrorMsg) << std::endl;
+    if (pRspInfo && pRspInfo->ErrorID != 0) LOG_ERROR("Td", "Order Insert Error: {}", utils::gbk_to_utf8(pRspInfo->ErrorMsg));
 }
 
 void TraderHandler::OnErrRtnOrderInsert(CThostFtdcInputOrderField *pInput, CThostFtdcRspInfoField *pRspInfo) {
-    if (pRspInfo && pRspInfo->ErrorID != 0) std::cerr << "[Td] ErrRtn Insert: " << utils::gbk_to_utf8(pRspInfo->ErrorMsg) << std::endl;
+    if (pRspInfo && pRspInfo->ErrorID != 0) LOG_ERROR("Td", "ErrRtn Insert: {}", utils::gbk_to_utf8(pRspInfo->ErrorMsg));
 }
 
 // 撤单报错
 void TraderHandler::OnRspOrderAction(CThostFtdcInputOrderActionField *pInput, CThostFtdcRspInfoField *pRspInfo, int nRequestID, bool bIsLast) {
-    if (pRspInfo && pRspInfo->ErrorID != 0) std::cerr << "[Td] RspOrderAction Error: " << utils::gbk_to_utf8(pRspInfo->ErrorMsg) << " (" << pRspInfo->ErrorID << ")" << std::endl;
+    if (pRspInfo && pRspInfo->ErrorID != 0) LOG_ERROR("Td", "RspOrderAction Error: {} ({})", utils::gbk_to_utf8(pRspInfo->ErrorMsg), pRspInfo->ErrorID);
 }
 
 void TraderHandler::OnErrRtnOrderAction(CThostFtdcOrderActionField *pAction, CThostFtdcRspInfoField *pRspInfo) {
-    if (pRspInfo && pRspInfo->ErrorID != 0) std::cerr << "[Td] ErrRtn Action: " << utils::gbk_to_utf8(pRspInfo->ErrorMsg) << " (" << pRspInfo->ErrorID << ")" << std::endl;
+    if (pRspInfo && pRspInfo->ErrorID != 0) LOG_ERROR("Td", "ErrRtn Action: {} ({})", utils::gbk_to_utf8(pRspInfo->ErrorMsg), pRspInfo->ErrorID);
 }
 
 
@@ -1092,8 +1043,8 @@ void TraderHandler::queueRateQuery(const std::string& instrumentID) {
     std::unique_lock<std::mutex> lock(queue_mtx_); 
     
     // 1. 检查缓存
-    if (instrument_cache_.count(instrumentID)) {
-         auto& d = instrument_cache_[instrumentID];
+    InstrumentMeta d;
+    if (InstrumentCache::instance().get(instrumentID, d)) {
          bool fresh = (std::string(d.trading_day) == current_trading_day_);
          bool hasData = (d.price_tick > 0);
 
@@ -1119,44 +1070,110 @@ void TraderHandler::queueRateQuery(const std::string& instrumentID) {
 
 
 void TraderHandler::loadInstrumentsFromDB() {
-    auto instrs = DBManager::instance().loadAllInstruments();
-    int count = 0;
-    for (const auto& i : instrs) {
-        instrument_cache_[i.instrument_id] = i;
-        if (std::string(i.trading_day) == current_trading_day_) {
-             count++;
-        }
+    // 共享缓存只需从 DB 加载一次 (先登录的账户负责)
+    auto& cache = InstrumentCache::instance();
+    if (cache.size() == 0) {
+        auto instrs = DBManager::instance().loadAllInstruments();
+        for (const auto& i : instrs) cache.upsert(i, false);
+        std::cout << "[Td] Loaded " << instrs.size() << " instruments from DB. Valid for Today:"
+                  << cache.countForDay(current_trading_day_) << std::endl;
     }
-    std::cout << "[Td] Loaded " << instrs.size() << " instruments from DB. Valid for Today:" << count << std::endl;
     
     // --- PositionManager Init from Cache ---
-    for (const auto& i : instrs) {
-         CThostFtdcInstrumentField instr = {0};
-         std::strncpy(instr.InstrumentID, i.instrument_id, sizeof(instr.InstrumentID));
-         std::strncpy(instr.ExchangeID, i.exchange_id, sizeof(instr.ExchangeID));
-         instr.VolumeMultiple = i.volume_multiple;
-         instr.PriceTick = i.price_tick;
-         // Assume cache is good enough for PositionDateType or infer it
-         // Ideally DB should store PositionDateType but we don't have it yet in struct
-         // Can infer from ExchangeID
-         if (std::string(i.exchange_id) == "SHFE" || std::string(i.exchange_id) == "INE") {
-             instr.PositionDateType = THOST_FTDC_PDT_UseHistory; 
-         } else {
-             instr.PositionDateType = THOST_FTDC_PDT_NoUseHistory;
-         }
-         
-         m_posManager.UpdateInstrument(instr);
+    for (const auto& i : cache.all()) {
+         syncInstrumentMeta(i);
     }
     // ---------------------------------------
 }
 
 void TraderHandler::loadDayOrdersFromDB() {
-    auto day_orders = DBManager::instance().loadOrders(current_trading_day_);
+    auto day_orders = DBManager::instance().loadOrders(current_trading_day_, user_id_);
+    for (const auto& o : day_orders) cacheOrder(o);
+    pushCachedOrdersAndTrades();
+}
+
+std::string TraderHandler::orderKey(const CThostFtdcOrderField& order) {
+    return std::to_string(order.FrontID) + ":" + std::to_string(order.SessionID) + ":" + order.OrderRef;
+}
+
+void TraderHandler::cacheOrder(const CThostFtdcOrderField& order) {
+    std::lock_guard<std::mutex> lock(cache_mtx_);
+    order_cache_[orderKey(order)] = order; // 同一报单的后续回报覆盖旧状态
+}
+
+void TraderHandler::restoreDayOrdersAndTrades(std::string trading_day) {
+    ThreadRoles::instance().apply("db");
+    auto orders = DBManager::instance().loadOrders(trading_day, user_id_);
+    auto trades = DBManager::instance().loadTrades(trading_day, user_id_);
+
+    // 查库期间 SPI 线程可能已收到实时回报: 报单以实时状态为准，
+    // 恢复的成交早于登录后的实时成交，插到缓存前面保持升序
+    std::vector<CThostFtdcOrderField> restored_orders;
+    std::vector<TradeData> restored_trades;
     {
-        std::lock_guard<std::mutex> lock(ref_mtx_);
-        order_cache_ = day_orders; 
+        std::lock_guard<std::mutex> lock(cache_mtx_);
+        for (const auto& o : orders) {
+            if (order_cache_.emplace(orderKey(o), o).second) restored_orders.push_back(o);
+        }
+        for (const auto& t : trades) {
+            if (trade_keys_.insert(std::string(t.exchange_id) + ":" + t.trade_id).second) restored_trades.push_back(t);
+        }
+        trade_cache_.insert(trade_cache_.begin(), restored_trades.begin(), restored_trades.end());
+    }
+    LOG_INFO("Td", "Restored {} orders / {} trades from DB ({}).", restored_orders.size(), restored_trades.size(), trading_day);
+
+    // 先入缓存再推送，快照与增量保持一致
+    for (const auto& o : restored_orders) pub_.publishOrder(&o, account_id_);
+    for (const auto& t : restored_trades) pub_.publishTrade(t, account_id_);
+}
+
+bool TraderHandler::cacheTrade(const TradeData& trade) {
+    std::string key = std::string(trade.exchange_id) + ":" + trade.trade_id;
+    std::lock_guard<std::mutex> lock(cache_mtx_);
+    if (!trade_keys_.insert(key).second) return false;
+    trade_cache_.push_back(trade); // DB 恢复为升序、之后实时追加，快照/重推保持该顺序
+    return true;
+}
+
+void TraderHandler::appendSnapshot(const std::set<std::string>& topics, nlohmann::json& snap) {
+    auto want = [&topics](const char* topic) { return topics.empty() || topics.count(topic) > 0; };
+    // 多账户共用同一个数组，首个账户负责创建 (请求了但为空时也要返回空数组)
+    auto section = [&snap](const char* key) -> nlohmann::json& {
+        if (!snap.contains(key)) snap[key] = nlohmann::json::array();
+        return snap[key];
+    };
+
+    if (want(zmq_topics::POSITION_DATA) || want(zmq_topics::POSITION_DATA_BIN)) {
+        auto& arr = section("positions");
+        for (const auto& p : collectPositions()) {
+            nlohmann::json j = Publisher::positionToJson(p);
+            j["account_id"] = account_id_;
+            arr.push_back(std::move(j));
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(cache_mtx_);
+    if (want(zmq_topics::ACCOUNT_DATA)) {
+        nlohmann::json j = Publisher::accountToJson(account_cache_);
+        j["account_id"] = account_id_;
+        section("accounts").push_back(std::move(j));
+    }
+    if (want(zmq_topics::ORDER_DATA)) {
+        auto& arr = section("orders");
+        for (const auto& [key, o] : order_cache_) {
+            nlohmann::json j = Publisher::orderToJson(o);
+            j["account_id"] = account_id_;
+            arr.push_back(std::move(j));
+        }
+    }
+    if (want(zmq_topics::TRADE_DATA)) {
+        auto& arr = section("trades");
+        for (const auto& t : trade_cache_) {
+            nlohmann::json j = Publisher::tradeToJson(t);
+            j["account_id"] = account_id_;
+            arr.push_back(std::move(j));
+        }
     }
-    pushCachedOrdersAndTrades();
 }
 
 
@@ -1181,6 +1198,7 @@ void TraderHandler::OnRspError(CThostFtdcRspInfoField *pRspInfo, int nRequestID,
     }
 }
 void TraderHandler::queryLoop() {
+    ThreadRoles::instance().apply("query");
     // [重要优化] 启动时先睡 5 秒，避开主线程查资金和持仓的高峰期，防止 ru2605 等首个合约被流控
     std::cout << "[Td] QueryLoop started. Waiting 5s for startup API calm down..." << std::endl;
     std::this_thread::sleep_for(std::chrono::seconds(5));
@@ -1208,15 +1226,12 @@ void TraderHandler::queryLoop() {
         if (!iid.empty()) {
             // [终极防护] 从队列取出后，执行前再检查一次缓存！
             // 防止在 DB 加载前就有请求入队，导致 DB 加载后依然执行了陈旧的查询请求
-            if (instrument_cache_.count(iid)) {
-                auto& d = instrument_cache_[iid];
-                if (std::string(d.trading_day) == current_trading_day_ && d.price_tick > 0) {
-                     // std::cout << "[Td] QueryLoop DoubleCheck Hit: " << iid << " (Drop)" << std::endl;
-                     continue; // 直接跳过，不查
-                }
+            if (InstrumentCache::instance().isFresh(iid, current_trading_day_)) {
+                 // std::cout << "[Td] QueryLoop DoubleCheck Hit: " << iid << " (Drop)" << std::endl;
+                 continue; // 直接跳过，不查
             }
 
-            std::cout << "[Td] QueryLoop Processing: " << iid << std::endl;
+            LOG_DEBUG("Td", "QueryLoop Processing: {}", iid);
             
             // CTP 限流: 每秒 1 次请求安全
             
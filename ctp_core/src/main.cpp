@@ -1,15 +1,26 @@
 #include "network/Publisher.h"
 #include "network/CommandServer.h"
+#include "network/HistoryServer.h"
 #include "api/MdHandler.h"
 #include "api/TraderHandler.h"
 #include "storage/DBManager.h" // 正确位置
 #include "protocol/zmq_topics.h"
 #include "strategy/ConditionEngine.h" // Added
+#include "strategy/StrategyHost.h"
+#include "storage/TickStore.h"
+#include "network/ShmMarketWriter.h"
+#include "market/BarEngine.h"
+#include "market/InstrumentCache.h"
+#include "utils/ThreadRoles.h"
+#include "utils/Logger.h"
 #include <iostream>
+#include <algorithm>
 #include <chrono>
 #include <thread>
 #include <vector>
 #include <set>
+#include <memory>
+#include <unordered_map>
 
 #include <fstream>
 #include <nlohmann/json.hpp>
@@ -33,6 +44,11 @@ int main() {
         return -1;
     }
 
+    // 线程角色须在创建任何线程之前配置，之后创建的线程继承 main 的亲和性
+    QuantLabs::ThreadRoles::instance().configure(j_config.value("threads", json::object()));
+    QuantLabs::ThreadRoles::instance().apply("main");
+    QuantLabs::Logger::instance().start(j_config.value("log", json::object()));
+
     // 1. 初始化发布者 (行情广播)
     QuantLabs::Publisher pub;
     // 使用配置文件中的端口，如果不存在则默认 5555
@@ -45,6 +61,22 @@ int main() {
     std::string db_conn = j_config["database"]["connection_string"];
     QuantLabs::DBManager::instance().init(db_conn);
     
+    // 2.0 本地行情存储 (Tick/Bar 落盘, 供历史查询)
+    json j_store = j_config.value("tick_store", json::object());
+    if (j_store.value("enabled", false)) {
+        QuantLabs::TickStore::instance().init(j_store.value("path", std::string("./data")),
+                                              j_store.value("record_ticks", true),
+                                              j_store.value("record_bars", true));
+    }
+
+    // 2.0.1 共享内存行情总线 (同机策略进程免序列化读取)
+    json j_shm = j_config.value("shm_bus", json::object());
+    if (j_shm.value("enabled", false)) {
+        QuantLabs::ShmMarketWriter::instance().init(j_shm.value("name", std::string(QuantLabs::shm::kDefaultBusName)),
+                                                    j_shm.value("ring_size", 65536u),
+                                                    j_shm.value("max_instruments", 4096u));
+    }
+
     // 2.1 从数据库加载订阅列表
     std::vector<std::string> db_subs = QuantLabs::DBManager::instance().loadSubscriptions();
     if (db_subs.empty()) {
@@ -52,16 +84,34 @@ int main() {
     }
 
     // 3. 准备配置 Map 传给 Handler
-    std::map<std::string, std::string> handler_config;
+    // 多账户: "accounts" 数组中每项覆盖 "ctp" 中的同名字段 (前置/经纪商等可只写一次)；
+    // 未配置 accounts 时退化为 "ctp" 单账户。第一个账户为主账户 (行情登录、合约/费率查询、条件单)
     auto& ctp = j_config["ctp"];
-    handler_config["broker_id"] = ctp["broker_id"];
-    handler_config["user_id"] = ctp["user_id"];
-    handler_config["password"] = ctp["password"];
-    handler_config["md_front"] = ctp["md_front"];
-    handler_config["td_front"] = ctp["td_front"];
-    handler_config["user_product_info"] = ctp.value("user_product_info", "");
-    handler_config["app_id"] = ctp["app_id"];
-    handler_config["auth_code"] = ctp["auth_code"];
+    auto makeConfig = [&ctp](const json& acc) {
+        auto field = [&](const char* key) -> std::string {
+            if (acc.contains(key) && acc[key].is_string()) return acc[key].get<std::string>();
+            return ctp.value(key, std::string());
+        };
+        std::map<std::string, std::string> cfg;
+        for (const char* key : {"broker_id", "user_id", "password", "md_front", "td_front",
+                                "user_product_info", "app_id", "auth_code", "account_id"}) {
+            cfg[key] = field(key);
+        }
+        return cfg;
+    };
+
+    std::vector<std::map<std::string, std::string>> account_configs;
+    if (j_config.contains("accounts") && j_config["accounts"].is_array() && !j_config["accounts"].empty()) {
+        for (const auto& acc : j_config["accounts"]) account_configs.push_back(makeConfig(acc));
+    } else {
+        account_configs.push_back(makeConfig(json::object()));
+    }
+    for (size_t i = 0; i < account_configs.size(); ++i) {
+        auto& cfg = account_configs[i];
+        if (cfg["account_id"].empty()) cfg["account_id"] = cfg["user_id"];
+        cfg["primary"] = (i == 0) ? "1" : "0";
+    }
+    std::map<std::string, std::string>& handler_config = account_configs.front();
     
     // Binary mode is now hardcoded to ON for performance
 
@@ -70,14 +120,36 @@ int main() {
     for(const auto& s : db_subs) sub_list_str += s + ",";
     handler_config["sub_list"] = sub_list_str;
     
-    // 4. 初始化行情处理器 (MdHandler 需要 set)
+    // 4. 初始化行情处理器 (MdHandler 需要 set)，各账户共享
     std::set<std::string> sub_set(db_subs.begin(), db_subs.end());
     QuantLabs::MdHandler md_handler(pub, handler_config, sub_set);
     
-    // 5. 初始化交易处理器
-    QuantLabs::TraderHandler td_handler(handler_config, pub);
+    // 5. 初始化交易处理器 (每个账户独立的 CTP 会话、持仓与委托缓存，回调线程互不阻塞)
+    std::vector<std::unique_ptr<QuantLabs::TraderHandler>> td_handlers;
+    std::unordered_map<std::string, QuantLabs::TraderHandler*> td_by_account;
+    for (const auto& cfg : account_configs) {
+        auto it = td_by_account.find(cfg.at("account_id"));
+        if (it != td_by_account.end()) {
+            std::cerr << "[Main] Duplicate account_id ignored: " << cfg.at("account_id") << std::endl;
+            continue;
+        }
+        td_handlers.push_back(std::make_unique<QuantLabs::TraderHandler>(cfg, pub));
+        td_by_account[cfg.at("account_id")] = td_handlers.back().get();
+    }
+    QuantLabs::TraderHandler& td_handler = *td_handlers.front();
+    std::cout << "[Main] " << td_handlers.size() << " trading account(s), primary: " << td_handler.accountId() << std::endl;
+
+    // 指令路由: account_id 可放在顶层或 data 中，缺省为主账户；未知账户返回 nullptr
+    auto resolveAccount = [&](const json& req) -> QuantLabs::TraderHandler* {
+        std::string acc;
+        if (req.contains("account_id") && req["account_id"].is_string()) acc = req["account_id"];
+        else if (req.contains("data") && req["data"].is_object()) acc = req["data"].value("account_id", std::string());
+        if (acc.empty()) return &td_handler;
+        auto it = td_by_account.find(acc);
+        return it != td_by_account.end() ? it->second : nullptr;
+    };
     
-    // 5.1 注册费率查询任务
+    // 5.1 注册费率查询任务 (费率由主账户查询，写入共享 InstrumentCache)
     for (const auto& id : db_subs) {
         td_handler.queueRateQuery(id);
     }
@@ -93,16 +165,54 @@ int main() {
     }
     std::cout << "[Main] Restored " << restored_orders.size() << " pending condition orders from DB." << std::endl;
     
+    // 5.4 K线合成引擎
+    json j_bar = j_config.value("bar", json::object());
+    QuantLabs::BarEngine bar_engine(j_bar.value("periods", std::vector<int>{1, 60, 300}));
+    bar_engine.setPublishUpdates(j_bar.value("publish_updates", true));
+    // 5.5 进程内策略宿主 (tb_strategies 中登记了 library_path 的策略，行情/回报经 SPSC 队列直达策略线程)
+    QuantLabs::StrategyHost strategy_host(
+        [&](const std::string& acc) -> QuantLabs::TraderHandler* {
+            if (acc.empty()) return &td_handler;
+            auto it = td_by_account.find(acc);
+            return it != td_by_account.end() ? it->second : nullptr;
+        },
+        // 策略订阅不落库: 只在策略运行期间需要，下次启动由策略自己重新订阅
+        [&](const std::string& instrument) { md_handler.subscribe(instrument, false); });
+    for (auto& handler : td_handlers) {
+        QuantLabs::TraderHandler* td = handler.get();
+        td->setOrderCallback([&strategy_host, td](const std::string& strategy_id, const CThostFtdcOrderField& order) {
+            strategy_host.onOrder(td->accountId(), strategy_id, order);
+        });
+        td->setTradeCallback([&strategy_host, td](const std::string& strategy_id, const CThostFtdcTradeField& trade) {
+            strategy_host.onTrade(td->accountId(), strategy_id, trade);
+        });
+    }
+    strategy_host.setStatusCallback([&](const std::string& strategy_id, int status, const std::string& msg) {
+        json j;
+        j["type"] = QuantLabs::CmdType::RtnStrategyStatus;
+        j["data"] = {{"strategy_id", strategy_id}, {"status", status}, {"msg", msg}};
+        pub.publish(QuantLabs::TOPIC_STRATEGY, j.dump());
+    });
+
+    bar_engine.setBarCallback([&](const QuantLabs::BarData& bar) {
+        pub.publishBarBinary(bar);
+        if (bar.status == 1) QuantLabs::TickStore::instance().appendBar(bar);
+        strategy_host.onBar(bar);
+    });
+
     // 连接行情回调
-    md_handler.setTickCallback([&](const CThostFtdcDepthMarketDataField* data) {
+    md_handler.setTickCallback([&](const CThostFtdcDepthMarketDataField* data, const QuantLabs::NormalizedTick& tick) {
         condition_engine->onTick(data);
+        bar_engine.onTick(data, tick);
+        for (auto& td : td_handlers) td->onMarketPrice(*data);
+    });
+    md_handler.setTickDataCallback([&](const QuantLabs::TickData& tick) {
+        strategy_host.onTick(tick);
     });
+    strategy_host.loadFromDB();
 
-    // 连接条件单状态回调 (Push to Frontend)
-    condition_engine->setStatusCallback([&](const QuantLabs::ConditionOrderRequest& order) {
-        json j;
-        j["type"] = QuantLabs::CmdType::RtnConditionOrder;
-        
+    // 条件单推送格式 (状态回调与查询共用)
+    auto conditionOrderToJson = [](const QuantLabs::ConditionOrderRequest& order) {
         json data;
         data["request_id"] = order.request_id;
         data["instrument_id"] = order.instrument_id;
@@ -114,22 +224,46 @@ int main() {
         data["volume"] = order.volume;
         data["limit_price"] = order.limit_price;
         data["strategy_id"] = order.strategy_id;
-        
-        j["data"] = data;
-        pub.publish(QuantLabs::TOPIC_STRATEGY, j.dump());
+        data["condition_type"] = (int)order.condition_type;
+        data["price_source"] = (int)order.price_source;
+        data["trail_distance"] = order.trail_distance;
+        data["extreme_price"] = order.extreme_price;
+        data["leg2_instrument_id"] = order.leg2_instrument_id;
+        data["oco_group"] = order.oco_group;
+        data["start_time"] = order.start_time;
+        data["end_time"] = order.end_time;
+
+        json j;
+        j["type"] = QuantLabs::CmdType::RtnConditionOrder;
+        j["data"] = std::move(data);
+        return j;
+    };
+
+    // 连接条件单状态回调 (Push to Frontend)
+    condition_engine->setStatusCallback([&](const QuantLabs::ConditionOrderRequest& order) {
+        pub.publish(QuantLabs::TOPIC_STRATEGY, conditionOrderToJson(order).dump());
     });
+    // 条件单执行线程 (报单/落库/推送)，行情线程只做触发判定
+    condition_engine->start();
 
     // 6. 初始化指令服务器 (接收前端下单)
     QuantLabs::CommandServer cmd_server;
     int rep_port = j_config["zmq"].value("rep_port", 5556);
     std::string rep_addr = "tcp://*:" + std::to_string(rep_port);
 
+    // 6.1 历史数据服务 (独立 ROUTER 端口, 分块回传查询结果)
+    QuantLabs::HistoryServer history_server;
+    int history_port = j_config["zmq"].value("history_port", 5557);
+    history_server.start("tcp://*:" + std::to_string(history_port), j_store.value("path", std::string("./data")));
+
     // [优化] 定义命令处理器映射
     using CommandHandler = std::function<std::string(const json&)>;
     std::map<std::string, CommandHandler> handlers;
 
     // 1. 下单
-    handlers[QuantLabs::CmdType::Order] = [&](const json& req) {
+    handlers[QuantLabs::CmdType::Order] = [&](const json& req) -> std::string {
+        QuantLabs::TraderHandler* td = resolveAccount(req);
+        if (!td) return "{\"status\":\"error\",\"msg\":\"Unknown account\"}";
         std::string id = req["id"];
         double price = req["price"];
         int vol = req["vol"];
@@ -164,7 +298,7 @@ int main() {
              strategy_id = req["strategy_id"];
         }
         
-        td_handler.insertOrder(id, price, vol, dir, off, priceType, strategy_id);
+        td->insertOrder(id, price, vol, dir, off, priceType, strategy_id);
         return "{\"status\":\"ok\",\"msg\":\"Order sent to CTP\"}";
     };
     
@@ -172,6 +306,8 @@ int main() {
     handlers[QuantLabs::CmdType::OrderAction] = [&](const json& req) -> std::string {
         if (!req.contains("data")) return "{\"status\":\"error\",\"msg\":\"No data field\"}";
         auto& d = req["data"];
+        QuantLabs::TraderHandler* td = resolveAccount(req);
+        if (!td) return "{\"status\":\"error\",\"msg\":\"Unknown account\"}";
         
         std::string inst = d.value("InstrumentID", "");
         std::string sysId = d.value("OrderSysID", "");
@@ -180,7 +316,7 @@ int main() {
         int front = d.value("FrontID", 0);
         int session = d.value("SessionID", 0);
         
-        td_handler.cancelOrder(inst, sysId, ref, exch, front, session);
+        td->cancelOrder(inst, sysId, ref, exch, front, session);
         return "{\"status\":\"ok\",\"msg\":\"OrderAction sent\"}";
     };
 
@@ -209,16 +345,73 @@ int main() {
     // 5. 状态同步
     handlers[QuantLabs::CmdType::SyncState] = [&](const json&) {
         std::cout << "[Main] Sync State requested by Client." << std::endl;
-        td_handler.reqQueryTradingAccount();
-        td_handler.pushCachedPositions();
         td_handler.pushCachedInstruments();
-        td_handler.pushCachedOrdersAndTrades();
+        for (auto& td : td_handlers) {
+            td->reqQueryTradingAccount();
+            td->pushCachedPositions();
+            td->pushCachedOrdersAndTrades();
+        }
         
         return "{\"status\":\"ok\",\"msg\":\"Sync started\"}";
     };
 
+    // 5.5 一致性快照: 同步返回全量状态 + 各 topic 序号，客户端据此衔接增量
+    // 先取序号再读状态: 之后发布的消息 seq 一定更大，快照内容只会比 seq 新不会旧
+    handlers[QuantLabs::CmdType::Snapshot] = [&](const json& req) -> std::string {
+        std::set<std::string> topics;
+        std::string account_filter;
+        if (req.contains("data")) {
+            const auto& d = req["data"];
+            if (d.contains("topics")) {
+                for (const auto& t : d["topics"]) {
+                    if (t.is_string()) topics.insert(t.get<std::string>());
+                }
+            }
+            account_filter = d.value("account_id", std::string());
+        }
+        if (!account_filter.empty() && !td_by_account.count(account_filter)) {
+            return "{\"status\":\"error\",\"msg\":\"Unknown account\"}";
+        }
+        // 未指定账户时绑定主账户: 客户端模型是单账户的，不能把多个账户合并进去
+        if (account_filter.empty()) account_filter = td_handler.accountId();
+        const std::string account_suffix = account_filter + QuantLabs::zmq_topics::ACCOUNT_SEPARATOR;
+#ifdef _DEBUG
+        std::cout << "[Main] Snapshot requested (" << (topics.empty() ? std::string("all") : std::to_string(topics.size())) << " topics)" << std::endl;
+#endif
+        auto want = [&topics](const std::string& topic) { return topics.empty() || topics.count(topic) > 0; };
+
+        // 1. 序号 (账户 topic 形如 "PT|acc|"，按基础 topic 过滤)
+        json seq = json::object();
+        for (const auto& [topic, value] : pub.sequenceSnapshot()) {
+            auto sep = topic.find(QuantLabs::zmq_topics::ACCOUNT_SEPARATOR);
+            if (!want(topic.substr(0, sep))) continue;
+            if (sep != std::string::npos && topic.compare(sep + 1, std::string::npos, account_suffix) != 0) continue;
+            seq[topic] = value;
+        }
+
+        // 2. 状态
+        json snap;
+        snap["type"] = QuantLabs::CmdType::RtnSnapshot;
+        snap["status"] = "ok";
+        snap["trading_day"] = td_handler.tradingDay();
+        snap["account_id"] = account_filter;
+        if (want(QuantLabs::zmq_topics::INSTRUMENT_DATA)) {
+            json arr = json::array();
+            for (const auto& meta : QuantLabs::InstrumentCache::instance().all()) {
+                arr.push_back(QuantLabs::Publisher::instrumentToJson(meta));
+            }
+            snap["instruments"] = std::move(arr);
+        }
+        for (auto& td : td_handlers) {
+            if (td->accountId() != account_filter) continue;
+            td->appendSnapshot(topics, snap);
+        }
+        snap["seq"] = std::move(seq);
+        return snap.dump();
+    };
+
     // 6. 条件单
-    handlers[QuantLabs::CmdType::ConditionOrderInsert] = [&](const json& req) {
+    handlers[QuantLabs::CmdType::ConditionOrderInsert] = [&](const json& req) -> std::string {
         // std::cout << "[Main] Condition Order Received: " << req["data"].dump() << std::endl;
         auto& d = req["data"];
         
@@ -265,15 +458,45 @@ int main() {
         
         order.volume = d.value("volume", 1);
         std::string st_id = d.value("strategy_id", "");
-        std::strncpy(order.strategy_id, st_id.c_str(), sizeof(order.strategy_id));
+        std::strncpy(order.strategy_id, st_id.c_str(), sizeof(order.strategy_id) - 1);
+
+        // 扩展条件 (缺省为最新价比较、不限时段)
+        int cond_type = d.value("condition_type", 0);
+        if (cond_type < 0 || cond_type > static_cast<int>(QuantLabs::ConditionType::Spread)) {
+            return "{\"status\":\"error\",\"msg\":\"Invalid condition_type\"}";
+        }
+        order.condition_type = static_cast<QuantLabs::ConditionType>(cond_type);
+        int source = d.value("price_source", 0);
+        if (source < 0 || source > static_cast<int>(QuantLabs::PriceSource::Mid)) source = 0;
+        order.price_source = static_cast<QuantLabs::PriceSource>(source);
+        order.trail_distance = d.value("trail_distance", 0.0);
+        order.extreme_price = 0.0;
+        std::string leg2 = d.value("leg2_instrument_id", "");
+        std::strncpy(order.leg2_instrument_id, leg2.c_str(), sizeof(order.leg2_instrument_id) - 1);
+        order.oco_group = d.value("oco_group", (uint64_t)0);
+        order.start_time = d.value("start_time", 0);
+        order.end_time = d.value("end_time", 0);
+
+        if (order.condition_type == QuantLabs::ConditionType::TrailingStop && order.trail_distance <= 0) {
+            return "{\"status\":\"error\",\"msg\":\"trail_distance required\"}";
+        }
+        if (order.condition_type == QuantLabs::ConditionType::Spread && leg2.empty()) {
+            return "{\"status\":\"error\",\"msg\":\"leg2_instrument_id required\"}";
+        }
         
-        // Generate a request ID (timestamp based for now)
-        order.request_id = std::chrono::system_clock::now().time_since_epoch().count();
+        // request_id 由引擎分配 (不会与历史条件单冲突)
+        order.request_id = 0;
         order.status = 0;
 
-        condition_engine->addConditionOrder(order);
+        uint64_t request_id = condition_engine->addConditionOrder(order);
+        if (request_id == 0) return "{\"status\":\"error\",\"msg\":\"Condition Order Rejected\"}";
         
-        return "{\"status\":\"ok\",\"msg\":\"Condition Order Accepted\"}";
+        // 回传 request_id，便于前端把多张条件单编入同一 OCO 组或后续撤改
+        json rep;
+        rep["status"] = "ok";
+        rep["msg"] = "Condition Order Accepted";
+        rep["request_id"] = request_id;
+        return rep.dump();
     };
 
     handlers[QuantLabs::CmdType::ConditionOrderCancel] = [&](const json& req) -> std::string {
@@ -321,23 +544,7 @@ int main() {
         
         // Push each pending order to frontend via PUB
         for (const auto& o : pending_orders) {
-            json j;
-            j["type"] = QuantLabs::CmdType::RtnConditionOrder;
-            
-            json data;
-            data["request_id"] = o.request_id;
-            data["instrument_id"] = o.instrument_id;
-            data["trigger_price"] = o.trigger_price;
-            data["compare_type"] = (int)o.compare_type;
-            data["status"] = o.status;
-            data["direction"] = std::string(1, o.direction);
-            data["offset_flag"] = std::string(1, o.offset_flag);
-            data["volume"] = o.volume;
-            data["limit_price"] = o.limit_price;
-            data["strategy_id"] = o.strategy_id;
-            
-            j["data"] = data;
-            pub.publish(QuantLabs::TOPIC_STRATEGY, j.dump());
+            pub.publish(QuantLabs::TOPIC_STRATEGY, conditionOrderToJson(o).dump());
         }
 
         return "{\"status\":\"ok\",\"msg\":\"Query Request Accepted, Pushing Data...\"}";
@@ -345,11 +552,16 @@ int main() {
 
     handlers[QuantLabs::CmdType::StrategyQuery] = [&](const json&) -> std::string {
         auto strategies = QuantLabs::DBManager::instance().loadStrategies();
+        std::unordered_map<std::string, int> running;
+        for (const auto& st : strategy_host.statuses()) running[st.first] = st.second;
         json j_list = json::array();
         for (const auto& p : strategies) {
             json item;
             item["id"] = p.first;
             item["name"] = p.second;
+            // 进程内策略的运行状态 (仅作为报单标签的策略为 false)
+            auto it = running.find(p.first);
+            item["running"] = it != running.end() && it->second == QuantLabs::StrategyHost::kRunning;
             j_list.push_back(item);
         }
         json msg;
@@ -362,11 +574,82 @@ int main() {
         return msg.dump();
     };
 
+    // 6.5 历史 Bar/Tick 查询: 只入队，结果由 HistoryServer 推给 client_id 对应的 DEALER
+    handlers[QuantLabs::CmdType::HistoryQuery] = [&](const json& req) -> std::string {
+        if (!req.contains("data")) return "{\"status\":\"error\",\"msg\":\"No data field\"}";
+        auto& d = req["data"];
+
+        QuantLabs::HistoryQuery q;
+        q.client_id = d.value("client_id", "");
+        q.instrument_id = d.value("instrument_id", "");
+        q.type = (d.value("kind", "bar") == "tick") ? QuantLabs::StoreRecordType::TICK : QuantLabs::StoreRecordType::BAR;
+        q.period = d.value("period", 60);
+        q.start_time = d.value("start_time", (int64_t)0);
+        q.end_time = d.value("end_time", (int64_t)0);
+        // 按有符号数读取: 负数不能回绕成超大的 size_t
+        const int64_t limit = d.value("limit", (int64_t)100000);
+
+        if (q.client_id.empty() || q.instrument_id.empty()) {
+            return "{\"status\":\"error\",\"msg\":\"Missing client_id or instrument_id\"}";
+        }
+        if (limit <= 0) return "{\"status\":\"error\",\"msg\":\"limit must be positive\"}";
+        q.limit = std::min(static_cast<size_t>(limit), QuantLabs::kMaxHistoryRows);
+
+        json rep;
+        rep["status"] = "ok";
+        rep["query_id"] = history_server.submit(std::move(q));
+        return rep.dump();
+    };
+
+    // 6.6 进程内策略控制: data {strategy_id, command: start|stop|update_params|reload, params}
+    handlers[QuantLabs::CmdType::StrategyControl] = [&](const json& req) -> std::string {
+        if (!req.contains("data")) return "{\"status\":\"error\",\"msg\":\"No data field\"}";
+        auto& d = req["data"];
+
+        static const std::map<std::string, QuantLabs::StrategyCommandType> kCommands = {
+            {"start", QuantLabs::StrategyCommandType::Start},
+            {"stop", QuantLabs::StrategyCommandType::Stop},
+            {"update_params", QuantLabs::StrategyCommandType::UpdateParams},
+            {"reload", QuantLabs::StrategyCommandType::Reload},
+        };
+        auto cmd = kCommands.find(d.value("command", ""));
+        if (cmd == kCommands.end()) return "{\"status\":\"error\",\"msg\":\"Unknown command\"}";
+
+        QuantLabs::StrategyControl ctl;
+        std::memset(&ctl, 0, sizeof(ctl));
+        ctl.type = cmd->second;
+        std::string st_id = d.value("strategy_id", "");
+        if (st_id.empty() && ctl.type != QuantLabs::StrategyCommandType::Reload) {
+            return "{\"status\":\"error\",\"msg\":\"Missing strategy_id\"}";
+        }
+        std::strncpy(ctl.strategy_id, st_id.c_str(), sizeof(ctl.strategy_id) - 1);
+        if (d.contains("params")) {
+            std::string payload = d["params"].is_string() ? d["params"].get<std::string>() : d["params"].dump();
+            if (payload.size() >= sizeof(ctl.json_payload)) {
+                return "{\"status\":\"error\",\"msg\":\"params too long\"}";
+            }
+            std::strncpy(ctl.json_payload, payload.c_str(), sizeof(ctl.json_payload) - 1);
+        }
+
+        std::string err;
+        json rep;
+        if (strategy_host.control(ctl, err)) {
+            rep["status"] = "ok";
+            rep["msg"] = "Strategy command accepted";
+        } else {
+            rep["status"] = "error";
+            rep["msg"] = err;
+        }
+        return rep.dump();
+    };
+
     // 7. 设置当前策略
     handlers["SET_STRATEGY"] = [&](const json& req) -> std::string {
         if (!req.contains("id")) return "{\"status\":\"error\",\"msg\":\"Missing id\"}";
+        QuantLabs::TraderHandler* td = resolveAccount(req);
+        if (!td) return "{\"status\":\"error\",\"msg\":\"Unknown account\"}";
         std::string s_id = req["id"];
-        td_handler.setCurrentStrategy(s_id);
+        td->setCurrentStrategy(s_id);
         return "{\"status\":\"ok\",\"msg\":\"Current Strategy Set\"}";
     };
 
@@ -387,10 +670,20 @@ int main() {
             }
         }
         return std::string("{\"status\":\"warning\",\"msg\":\"Unknown Command Type\"}");
+    }, {
+        // 查库/全量推送的指令走独立线程，不阻塞下单与撤单
+        QuantLabs::CmdType::ConditionOrderQuery,
+        QuantLabs::CmdType::StrategyQuery,
+        QuantLabs::CmdType::SyncState,
     });
 
     // 保持主线程运行
     md_handler.join();
 
+    // 行情线程已退出: 完成未收盘的 Bar 并落盘，之后再关闭行情存储
+    bar_engine.flushAll();
+    QuantLabs::TickStore::instance().stop();
+
+    QuantLabs::Logger::instance().stop();
     return 0;
 }
@@ -0,0 +1,140 @@
+#include "market/BarEngine.h"
+#include "utils/TimeUtils.h"
+#include <cstring>
+#include <cstdio>
+#include <algorithm>
+
+namespace QuantLabs {
+
+// 无新 Tick 时，Bar 结束后再等待多久由全局时钟强制完成 (毫秒)
+static constexpr int64_t kCloseGraceMs = 2000;
+
+BarEngine::BarEngine(std::vector<int> periods) : periods_(std::move(periods)) {
+    periods_.erase(std::remove_if(periods_.begin(), periods_.end(), [](int p) { return p <= 0; }), periods_.end());
+}
+
+BarEngine::InstrumentState& BarEngine::stateFor(const char* instrument_id) {
+    auto it = states_.find(instrument_id);
+    if (it != states_.end()) return it->second;
+
+    InstrumentState st;
+    st.sessions = &TradingSession::lookup(instrument_id);
+    st.periods.resize(periods_.size());
+    return states_.emplace(instrument_id, std::move(st)).first->second;
+}
+
+void BarEngine::closeBar(PeriodState& ps) {
+    ps.bar.status = 1;
+    if (bar_callback_) bar_callback_(ps.bar);
+}
+
+void BarEngine::onTick(const CThostFtdcDepthMarketDataField* pData, const NormalizedTick& tick) {
+    if (!pData) return;
+
+    int raw_sod = utils::parseTimeOfDay(pData->UpdateTime);
+    if (raw_sod < 0) return;
+
+    InstrumentState& st = stateFor(pData->InstrumentID);
+    const std::string trading_day = pData->TradingDay;
+
+    // 1. 成交量/成交额增量由行情规整阶段给出 (已处理启动首笔与交易日切换，乱序行情已丢弃)
+    const int64_t vol_delta = tick.volume_delta;
+    const double turnover_delta = tick.turnover_delta;
+
+    // 2. 时间归一到交易时段 (非交易时段的推送, 如盘后结算价, 不计入 Bar)
+    bool at_close = false;
+    int sod = TradingSession::normalize(*st.sessions, raw_sod, at_close);
+    if (sod < 0) return;
+
+    int action_day = utils::resolveActionDay(raw_sod);
+    int64_t tick_ms = utils::toEpochMs(action_day, sod, pData->UpdateMillisec);
+    double price = pData->LastPrice;
+
+    for (size_t i = 0; i < periods_.size(); ++i) {
+        PeriodState& ps = st.periods[i];
+        int period = periods_[i];
+        int64_t start_ms = tick_ms - pData->UpdateMillisec - static_cast<int64_t>(sod % period) * 1000;
+
+        if (ps.active) {
+            // 乱序 Tick 不回写已过去的 Bar；已完成的 Bar 只发出一次 (收盘后多余的收盘 Tick、强制完成后的迟到 Tick)。
+            // 价格不再计入，但累计成交量的增量不能丢: 计入当前 Bar，当前 Bar 已完成则计入下一根
+            if (start_ms < ps.bar.bar_time || (start_ms == ps.bar.bar_time && ps.bar.status == 1)) {
+                if (ps.bar.status == 0) {
+                    ps.bar.volume += vol_delta;
+                    ps.bar.turnover += turnover_delta;
+                } else {
+                    ps.carry_volume += vol_delta;
+                    ps.carry_turnover += turnover_delta;
+                }
+                continue;
+            }
+            if (start_ms > ps.bar.bar_time) {
+                if (ps.bar.status == 0) closeBar(ps);
+                ps.active = false;
+            }
+        }
+
+        BarData& bar = ps.bar;
+        if (!ps.active) {
+            // 跨交易日不结转 (增量已在交易日切换时归零)
+            const bool same_day = std::strncmp(bar.trading_day, trading_day.c_str(), sizeof(bar.trading_day)) == 0;
+            const int64_t carry_volume = same_day ? ps.carry_volume : 0;
+            const double carry_turnover = same_day ? ps.carry_turnover : 0.0;
+            ps.carry_volume = 0;
+            ps.carry_turnover = 0.0;
+
+            std::memset(&bar, 0, sizeof(bar));
+            bar.bar_time = start_ms;
+            bar.period = period;
+            bar.open_price = bar.high_price = bar.low_price = price;
+            std::strncpy(bar.instrument_id, pData->InstrumentID, sizeof(bar.instrument_id) - 1);
+            std::strncpy(bar.trading_day, trading_day.c_str(), sizeof(bar.trading_day) - 1);
+            std::snprintf(bar.action_day, sizeof(bar.action_day), "%08d", action_day);
+            bar.volume = carry_volume;
+            bar.turnover = carry_turnover;
+            ps.active = true;
+        } else {
+            bar.high_price = std::max(bar.high_price, price);
+            bar.low_price = std::min(bar.low_price, price);
+        }
+        bar.close_price = price;
+        bar.volume += vol_delta;
+        bar.turnover += turnover_delta;
+        bar.open_interest = pData->OpenInterest;
+        bar.tick_count++;
+
+        if (at_close) {
+            closeBar(ps); // 收盘 Tick: 立即完成
+        } else if (publish_updates_ && bar_callback_) {
+            bar_callback_(bar);
+        }
+    }
+
+    // 3. 每个交易所秒扫描一次，完成长时间无 Tick 的 Bar (不活跃合约)
+    int64_t now_sec = tick_ms / 1000;
+    if (now_sec > last_sweep_sec_) {
+        last_sweep_sec_ = now_sec;
+        sweepExpired(tick_ms);
+    }
+}
+
+void BarEngine::sweepExpired(int64_t now_ms) {
+    for (auto& [id, st] : states_) {
+        for (auto& ps : st.periods) {
+            if (ps.active && ps.bar.status == 0 &&
+                ps.bar.bar_time + static_cast<int64_t>(ps.bar.period) * 1000 + kCloseGraceMs <= now_ms) {
+                closeBar(ps);
+            }
+        }
+    }
+}
+
+void BarEngine::flushAll() {
+    for (auto& [id, st] : states_) {
+        for (auto& ps : st.periods) {
+            if (ps.active && ps.bar.status == 0) closeBar(ps);
+        }
+    }
+}
+
+} // namespace QuantLabs
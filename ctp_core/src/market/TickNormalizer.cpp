@@ -0,0 +1,178 @@
+#include "market/TickNormalizer.h"
+#include "utils/Logger.h"
+#include "utils/TimeUtils.h"
+#include <algorithm>
+
+namespace QuantLabs {
+
+TickNormalizer::TickNormalizer() {
+    // 首块预分配，常见订阅规模下行情线程不再分配内存
+    chunks_[0].reset(new NormalizedTick[kChunkSize]());
+}
+
+NormalizedTick& TickNormalizer::slotFor(InstrumentId handle) {
+    auto& chunk = chunks_[handle >> kChunkBits];
+    if (!chunk) chunk.reset(new NormalizedTick[kChunkSize]());
+    return chunk[handle & (kChunkSize - 1)];
+}
+
+const NormalizedTick* TickNormalizer::slot(InstrumentId handle) const {
+    if (handle >= InstrumentCache::kMaxInstruments) return nullptr;
+    const auto& chunk = chunks_[handle >> kChunkBits];
+    if (!chunk) return nullptr;
+    const NormalizedTick& t = chunk[handle & (kChunkSize - 1)];
+    return t.count > 0 ? &t : nullptr;
+}
+
+int TickNormalizer::actionDay(const CThostFtdcDepthMarketDataField& data, int sod) {
+    // 日盘的 ActionDay 可靠；夜盘 (大商所填的是下一交易日) 按本机时钟推算
+    if (sod >= 6 * 3600 && sod < 18 * 3600) {
+        int day = utils::parseDate(data.ActionDay);
+        if (day > 0) return day;
+    }
+    std::time_t now = std::time(nullptr);
+    int hour = sod / 3600;
+    if (now != day_cache_now_ || hour != day_cache_hour_) {
+        day_cache_value_ = utils::resolveActionDay(sod);
+        day_cache_now_ = now;
+        day_cache_hour_ = hour;
+    }
+    return day_cache_value_;
+}
+
+TickNormalizer::Result TickNormalizer::normalize(CThostFtdcDepthMarketDataField& data, const NormalizedTick*& out) {
+    out = nullptr;
+
+    // 1. 最新价无效 (CTP 空值 DBL_MAX / NaN / 负数) 的行情整笔丢弃
+    //    做组合合约 (价差可为负) 时需放开负数限制
+    if (!(data.LastPrice >= 0 && data.LastPrice < kMaxPrice)) {
+        ++stats_.invalid;
+        return Result::Invalid;
+    }
+    const InstrumentId handle = InstrumentCache::instance().intern(
+        std::string_view(data.InstrumentID, strnlen(data.InstrumentID, sizeof(data.InstrumentID))));
+    if (handle == kInvalidInstrument) {
+        ++stats_.invalid;
+        return Result::Invalid;
+    }
+
+    // 2. 收集价格到连续数组，整体清洗 (NaN 比较为 false，同样置 0)
+    NormalizedTick next;
+    double* px = next.price;
+    px[NormalizedTick::Last] = data.LastPrice;
+    px[NormalizedTick::Bid1] = data.BidPrice1;
+    px[NormalizedTick::Bid2] = data.BidPrice2;
+    px[NormalizedTick::Bid3] = data.BidPrice3;
+    px[NormalizedTick::Bid4] = data.BidPrice4;
+    px[NormalizedTick::Bid5] = data.BidPrice5;
+    px[NormalizedTick::Ask1] = data.AskPrice1;
+    px[NormalizedTick::Ask2] = data.AskPrice2;
+    px[NormalizedTick::Ask3] = data.AskPrice3;
+    px[NormalizedTick::Ask4] = data.AskPrice4;
+    px[NormalizedTick::Ask5] = data.AskPrice5;
+    px[NormalizedTick::Open] = data.OpenPrice;
+    px[NormalizedTick::High] = data.HighestPrice;
+    px[NormalizedTick::Low] = data.LowestPrice;
+    px[NormalizedTick::Close] = data.ClosePrice;
+    px[NormalizedTick::Settlement] = data.SettlementPrice;
+    px[NormalizedTick::PreSettlement] = data.PreSettlementPrice;
+    px[NormalizedTick::PreClose] = data.PreClosePrice;
+    px[NormalizedTick::UpperLimit] = data.UpperLimitPrice;
+    px[NormalizedTick::LowerLimit] = data.LowerLimitPrice;
+    px[NormalizedTick::Average] = data.AveragePrice;
+    for (int i = NormalizedTick::kPriceFields; i < NormalizedTick::kPriceSlots; ++i) px[i] = 0.0;
+
+    for (int i = 0; i < NormalizedTick::kPriceSlots; ++i) {
+        double p = px[i];
+        px[i] = (p > -kMaxPrice && p < kMaxPrice) ? p : 0.0;
+    }
+
+    next.bid_volume[0] = data.BidVolume1; next.ask_volume[0] = data.AskVolume1;
+    next.bid_volume[1] = data.BidVolume2; next.ask_volume[1] = data.AskVolume2;
+    next.bid_volume[2] = data.BidVolume3; next.ask_volume[2] = data.AskVolume3;
+    next.bid_volume[3] = data.BidVolume4; next.ask_volume[3] = data.AskVolume4;
+    next.bid_volume[4] = data.BidVolume5; next.ask_volume[4] = data.AskVolume5;
+
+    next.volume = data.Volume;
+    next.turnover = (data.Turnover >= 0 && data.Turnover < 1e18) ? data.Turnover : 0.0;
+    next.open_interest = (data.OpenInterest >= 0 && data.OpenInterest < 1e18) ? data.OpenInterest : 0.0;
+    next.trading_day = utils::parseDate(data.TradingDay); // MdHandler 已统一修正
+
+    // 3. 交易所时间 (UpdateTime 不合法时为 0，不参与乱序判断)
+    const int sod = utils::parseTimeOfDay(data.UpdateTime);
+    next.exchange_time = sod >= 0 ? utils::toEpochMs(actionDay(data, sod), sod, data.UpdateMillisec) : 0;
+    next.instrument = handle;
+
+    // 4. 重复/乱序检测 (交易日切换后重新起算)
+    NormalizedTick& cur = slotFor(handle);
+    const bool first = cur.count == 0;
+    const bool same_day = !first && next.trading_day == cur.trading_day;
+    if (same_day) {
+        if (next.volume == cur.volume && next.exchange_time == cur.exchange_time &&
+            next.turnover == cur.turnover && next.open_interest == cur.open_interest &&
+            px[NormalizedTick::Last] == cur.price[NormalizedTick::Last] &&
+            px[NormalizedTick::Bid1] == cur.price[NormalizedTick::Bid1] &&
+            px[NormalizedTick::Ask1] == cur.price[NormalizedTick::Ask1] &&
+            next.bid_volume[0] == cur.bid_volume[0] && next.ask_volume[0] == cur.ask_volume[0]) {
+            ++stats_.duplicate;
+            LOG_DEBUG("Md", "Duplicate tick {} {}.{}", data.InstrumentID, data.UpdateTime, data.UpdateMillisec);
+            return Result::Duplicate;
+        }
+        // 累计成交量回退，或时间回退且成交量没有增加: 过期行情
+        // (时间回退但成交量增加视为时间字段异常，照常接受)
+        bool stale = next.volume < cur.volume ||
+                     (next.volume == cur.volume && next.exchange_time > 0 && next.exchange_time < cur.exchange_time);
+        if (stale) {
+            ++stats_.out_of_order;
+            LOG_DEBUG("Md", "Out-of-order tick {} {}.{} vol={} (last vol={})", data.InstrumentID, data.UpdateTime,
+                      data.UpdateMillisec, next.volume, cur.volume);
+            return Result::OutOfOrder;
+        }
+    }
+
+    // 5. 增量: 启动后首笔无法得知之前的累计值记 0；交易日切换后累计值从 0 起算
+    if (first) {
+        next.volume_delta = 0;
+        next.turnover_delta = 0.0;
+        next.open_interest_delta = 0.0;
+    } else {
+        const int64_t base_volume = same_day ? cur.volume : 0;
+        const double base_turnover = same_day ? cur.turnover : 0.0;
+        next.volume_delta = next.volume - base_volume;
+        next.turnover_delta = std::max(0.0, next.turnover - base_turnover);
+        next.open_interest_delta = next.open_interest - cur.open_interest;
+    }
+    next.count = cur.count + 1;
+    cur = next;
+    ++stats_.accepted;
+
+    // 6. 清洗结果写回，CTP 结构体的消费者 (条件单/K 线/进程内策略) 拿到的也是干净数据
+    data.LastPrice = px[NormalizedTick::Last];
+    data.BidPrice1 = px[NormalizedTick::Bid1];
+    data.BidPrice2 = px[NormalizedTick::Bid2];
+    data.BidPrice3 = px[NormalizedTick::Bid3];
+    data.BidPrice4 = px[NormalizedTick::Bid4];
+    data.BidPrice5 = px[NormalizedTick::Bid5];
+    data.AskPrice1 = px[NormalizedTick::Ask1];
+    data.AskPrice2 = px[NormalizedTick::Ask2];
+    data.AskPrice3 = px[NormalizedTick::Ask3];
+    data.AskPrice4 = px[NormalizedTick::Ask4];
+    data.AskPrice5 = px[NormalizedTick::Ask5];
+    data.OpenPrice = px[NormalizedTick::Open];
+    data.HighestPrice = px[NormalizedTick::High];
+    data.LowestPrice = px[NormalizedTick::Low];
+    data.ClosePrice = px[NormalizedTick::Close];
+    data.SettlementPrice = px[NormalizedTick::Settlement];
+    data.PreSettlementPrice = px[NormalizedTick::PreSettlement];
+    data.PreClosePrice = px[NormalizedTick::PreClose];
+    data.UpperLimitPrice = px[NormalizedTick::UpperLimit];
+    data.LowerLimitPrice = px[NormalizedTick::LowerLimit];
+    data.AveragePrice = px[NormalizedTick::Average];
+    data.Turnover = next.turnover;
+    data.OpenInterest = next.open_interest;
+
+    out = &cur;
+    return Result::Accepted;
+}
+
+} // namespace QuantLabs
@@ -0,0 +1,118 @@
+#include "market/TradingSession.h"
+#include <unordered_map>
+#include <cctype>
+
+namespace QuantLabs {
+
+namespace {
+
+constexpr int HM(int h, int m) { return h * 3600 + m * 60; }
+
+// 商品期货日盘 (无夜盘: 08:59 集合竞价)
+const std::vector<SessionRange> kDayOnly = {
+    {HM(9, 0), HM(10, 15), true, true},
+    {HM(10, 30), HM(11, 30), false, true},
+    {HM(13, 30), HM(15, 0), false, true},
+};
+
+// 夜盘至 23:00
+const std::vector<SessionRange> kNight2300 = {
+    {HM(21, 0), HM(23, 0), true, true},
+    {HM(9, 0), HM(10, 15), false, true},
+    {HM(10, 30), HM(11, 30), false, true},
+    {HM(13, 30), HM(15, 0), false, true},
+};
+
+// 夜盘至 01:00 (跨零点)
+const std::vector<SessionRange> kNight0100 = {
+    {HM(21, 0), HM(24, 0), true, false},
+    {HM(0, 0), HM(1, 0), false, true},
+    {HM(9, 0), HM(10, 15), false, true},
+    {HM(10, 30), HM(11, 30), false, true},
+    {HM(13, 30), HM(15, 0), false, true},
+};
+
+// 夜盘至 02:30 (跨零点)
+const std::vector<SessionRange> kNight0230 = {
+    {HM(21, 0), HM(24, 0), true, false},
+    {HM(0, 0), HM(2, 30), false, true},
+    {HM(9, 0), HM(10, 15), false, true},
+    {HM(10, 30), HM(11, 30), false, true},
+    {HM(13, 30), HM(15, 0), false, true},
+};
+
+// 中金所股指
+const std::vector<SessionRange> kCffexIndex = {
+    {HM(9, 30), HM(11, 30), true, true},
+    {HM(13, 0), HM(15, 0), false, true},
+};
+
+// 中金所国债
+const std::vector<SessionRange> kCffexBond = {
+    {HM(9, 30), HM(11, 30), true, true},
+    {HM(13, 0), HM(15, 15), false, true},
+};
+
+const std::vector<SessionRange> kUnknown = {};
+
+const std::unordered_map<std::string, const std::vector<SessionRange>*>& productTable() {
+    static const std::unordered_map<std::string, const std::vector<SessionRange>*> table = [] {
+        std::unordered_map<std::string, const std::vector<SessionRange>*> t;
+        auto add = [&t](std::initializer_list<const char*> products, const std::vector<SessionRange>* s) {
+            for (const char* p : products) t[p] = s;
+        };
+        // SHFE / INE
+        add({"au", "ag", "sc"}, &kNight0230);
+        add({"cu", "al", "zn", "pb", "ni", "sn", "ss", "ao", "bc"}, &kNight0100);
+        add({"rb", "hc", "bu", "ru", "fu", "sp", "br", "nr", "lu"}, &kNight2300);
+        add({"wr", "ec"}, &kDayOnly);
+        // DCE
+        add({"a", "b", "m", "y", "p", "c", "cs", "i", "j", "jm", "l", "v", "pp", "eg", "eb", "pg", "rr", "lg"}, &kNight2300);
+        add({"jd", "lh", "fb", "bb"}, &kDayOnly);
+        // CZCE
+        add({"SR", "CF", "CY", "TA", "MA", "FG", "RM", "OI", "ZC", "SA", "PF", "PX", "SH", "PR"}, &kNight2300);
+        add({"AP", "CJ", "UR", "SF", "SM", "PK", "WH", "PM", "RI", "JR", "LR", "RS"}, &kDayOnly);
+        // GFEX
+        add({"si", "lc", "ps"}, &kDayOnly);
+        // CFFEX
+        add({"IF", "IH", "IC", "IM"}, &kCffexIndex);
+        add({"T", "TF", "TS", "TL"}, &kCffexBond);
+        return t;
+    }();
+    return table;
+}
+
+} // namespace
+
+std::string TradingSession::productOf(const std::string& instrument_id) {
+    size_t n = 0;
+    while (n < instrument_id.size() && std::isalpha(static_cast<unsigned char>(instrument_id[n]))) ++n;
+    return instrument_id.substr(0, n);
+}
+
+const std::vector<SessionRange>& TradingSession::lookup(const std::string& instrument_id) {
+    const auto& table = productTable();
+    auto it = table.find(productOf(instrument_id));
+    return it != table.end() ? *it->second : kUnknown;
+}
+
+int TradingSession::normalize(const std::vector<SessionRange>& sessions, int sec_of_day, bool& at_close) {
+    at_close = false;
+    if (sessions.empty()) return sec_of_day; // 未知品种: 不过滤
+
+    for (const auto& s : sessions) {
+        if (sec_of_day >= s.start && sec_of_day < s.end) return sec_of_day;
+    }
+    for (const auto& s : sessions) {
+        // 集合竞价 Tick (开盘前 5 分钟内) 归入首根 Bar
+        if (s.has_auction && sec_of_day >= s.start - 300 && sec_of_day < s.start) return s.start;
+        // 收盘 Tick (收盘后 1 分钟内) 归入最后一根 Bar
+        if (s.is_close && sec_of_day >= s.end && sec_of_day < s.end + 60) {
+            at_close = true;
+            return s.end - 1;
+        }
+    }
+    return -1;
+}
+
+} // namespace QuantLabs
@@ -1,56 +1,139 @@
 #line 1 "/home/zd/A-Trader/ctp_core/src/network/CommandServer.cpp"
 #include "network/CommandServer.h"
+#include "utils/ThreadRoles.h"
+#include <chrono>
 #include <iostream>
 
 namespace QuantLabs {
 
+// 慢指令线程把应答交回接收线程 (ROUTER socket 只能在接收线程里使用)
+static const char* kSlowReplyAddr = "inproc://cmd-slow-replies";
+
 CommandServer::CommandServer() : context_(1) {}
 
 CommandServer::~CommandServer() {
     stop();
 }
 
-void CommandServer::start(const std::string& addr, CommandCallback callback) {
+void CommandServer::start(const std::string& addr, CommandCallback callback, std::set<std::string> slow_types) {
     addr_ = addr;
     callback_ = callback;
+    slow_types_ = std::move(slow_types);
     running_ = true;
+    ThreadRoles::instance().applyToZmqContext(context_.handle());
     thread_ = std::thread(&CommandServer::run, this);
 }
 
 void CommandServer::stop() {
     running_ = false;
+    slow_cv_.notify_all();
     if (thread_.joinable()) thread_.join();
 }
 
 void CommandServer::run() {
-    zmq::socket_t socket(context_, zmq::socket_type::rep);
+    ThreadRoles::instance().apply("cmd");
+    zmq::socket_t socket(context_, zmq::socket_type::router);
+    socket.set(zmq::sockopt::linger, 0);
     socket.bind(addr_);
-    
-    // 设置超时，防止 join 阻塞
-    int timeout = 1000;
-    socket.set(zmq::sockopt::rcvtimeo, timeout);
+
+    // inproc 需先 bind 再启动慢指令线程
+    zmq::socket_t slow_replies(context_, zmq::socket_type::pull);
+    slow_replies.set(zmq::sockopt::linger, 0);
+    slow_replies.bind(kSlowReplyAddr);
+    slow_thread_ = std::thread(&CommandServer::slowLoop, this);
 
     std::cout << "[CommandServer] Listening on " << addr_ << std::endl;
 
+    zmq::pollitem_t items[] = {
+        {socket.handle(), 0, ZMQ_POLLIN, 0},
+        {slow_replies.handle(), 0, ZMQ_POLLIN, 0},
+    };
+
     while (running_) {
-        zmq::message_t request;
-        auto res = socket.recv(request, zmq::recv_flags::none);
-        
-        if (res) {
-            std::string req_str(static_cast<char*>(request.data()), request.size());
-            try {
-                auto j = nlohmann::json::parse(req_str);
-                std::string reply_str = callback_(j);
-                
-                zmq::message_t reply(reply_str.size());
-                std::memcpy(reply.data(), reply_str.data(), reply_str.size());
-                socket.send(reply, zmq::send_flags::none);
-            } catch (const std::exception& e) {
-                std::string err = "{\"status\":\"error\",\"msg\":\"" + std::string(e.what()) + "\"}";
-                socket.send(zmq::message_t(err.data(), err.size()), zmq::send_flags::none);
+        // 超时只用于检查 running_，防止 join 阻塞
+        zmq::poll(items, 2, std::chrono::milliseconds(1000));
+
+        if (items[0].revents & ZMQ_POLLIN) {
+            // [identity][信封...][空帧][body]
+            std::vector<zmq::message_t> frames;
+            do {
+                frames.emplace_back();
+                (void)socket.recv(frames.back(), zmq::recv_flags::none);
+            } while (frames.back().more());
+
+            if (frames.size() < 3 || frames[frames.size() - 2].size() != 0) {
+                std::cerr << "[CommandServer] Malformed request dropped (" << frames.size() << " frames)" << std::endl;
+            } else {
+                std::string req_str(static_cast<char*>(frames.back().data()), frames.back().size());
+                frames.pop_back();
+                try {
+                    auto j = nlohmann::json::parse(req_str);
+                    std::string type = j.value("type", "");
+                    if (slow_types_.count(type)) {
+                        {
+                            std::lock_guard<std::mutex> lock(slow_mtx_);
+                            slow_queue_.push_back({std::move(frames), std::move(j)});
+                        }
+                        slow_cv_.notify_one();
+                    } else {
+                        sendReply(socket, frames, handle(j));
+                    }
+                } catch (const std::exception& e) {
+                    std::string err = "{\"status\":\"error\",\"msg\":\"" + std::string(e.what()) + "\"}";
+                    sendReply(socket, frames, err);
+                }
             }
         }
+
+        if (items[1].revents & ZMQ_POLLIN) {
+            // 慢指令应答: 整条转发 (信封 + body)
+            zmq::message_t part;
+            do {
+                (void)slow_replies.recv(part, zmq::recv_flags::none);
+                const bool more = part.more();
+                socket.send(part, more ? zmq::send_flags::sndmore : zmq::send_flags::none);
+                if (!more) break;
+            } while (true);
+        }
+    }
+
+    slow_cv_.notify_all();
+    if (slow_thread_.joinable()) slow_thread_.join();
+}
+
+void CommandServer::slowLoop() {
+    // 不绑定 cmd 角色的核心，避免查库与下单争抢同一个核
+    zmq::socket_t replies(context_, zmq::socket_type::push);
+    replies.set(zmq::sockopt::linger, 0);
+    replies.connect(kSlowReplyAddr);
+
+    while (running_) {
+        SlowRequest req;
+        {
+            std::unique_lock<std::mutex> lock(slow_mtx_);
+            slow_cv_.wait_for(lock, std::chrono::milliseconds(500), [this] { return !slow_queue_.empty() || !running_; });
+            if (slow_queue_.empty()) continue;
+            req = std::move(slow_queue_.front());
+            slow_queue_.pop_front();
+        }
+        sendReply(replies, req.envelope, handle(req.request));
+    }
+}
+
+std::string CommandServer::handle(const nlohmann::json& request) {
+    try {
+        return callback_(request);
+    } catch (const std::exception& e) {
+        return "{\"status\":\"error\",\"msg\":\"" + std::string(e.what()) + "\"}";
+    }
+}
+
+void CommandServer::sendReply(zmq::socket_t& socket, std::vector<zmq::message_t>& envelope, const std::string& reply) {
+    // 客户端已断开时 ROUTER 静默丢弃，不抛异常
+    for (auto& frame : envelope) {
+        socket.send(frame, zmq::send_flags::sndmore);
     }
+    socket.send(zmq::message_t(reply.data(), reply.size()), zmq::send_flags::none);
 }
 
 } // namespace QuantLabs
@@ -0,0 +1,219 @@
+#include "network/HistoryServer.h"
+#include "protocol/message_schema.h"
+#include "utils/ThreadRoles.h"
+#include <nlohmann/json.hpp>
+#include <iostream>
+#include <chrono>
+#include <algorithm>
+#include <cstring>
+
+namespace QuantLabs {
+
+// 单个分块的目标大小
+static constexpr size_t kChunkBytes = 256 * 1024;
+// 结束时间距今不足此值的查询不缓存 (数据还在追加)
+static constexpr int64_t kLiveWindowMs = 60 * 1000;
+// 客户端接收队列满时单帧最多等待的时间，超时即丢弃该查询，避免拖住工作线程和 stop()
+static constexpr int kSendTimeoutMs = 2000;
+
+HistoryServer::HistoryServer() : context_(1) {}
+
+HistoryServer::~HistoryServer() {
+    stop();
+}
+
+void HistoryServer::start(const std::string& addr, const std::string& store_root) {
+    addr_ = addr;
+    reader_ = std::make_unique<TickStoreReader>(store_root);
+    running_ = true;
+    ThreadRoles::instance().applyToZmqContext(context_.handle());
+    thread_ = std::thread(&HistoryServer::run, this);
+}
+
+void HistoryServer::stop() {
+    running_ = false;
+    cv_.notify_all();
+    if (thread_.joinable()) thread_.join();
+}
+
+uint64_t HistoryServer::submit(HistoryQuery query) {
+    query.query_id = next_query_id_++;
+    uint64_t id = query.query_id;
+    {
+        std::lock_guard<std::mutex> lock(mtx_);
+        queries_.push_back(std::move(query));
+    }
+    cv_.notify_one();
+    return id;
+}
+
+void HistoryServer::run() {
+    ThreadRoles::instance().apply("history");
+    zmq::socket_t socket(context_, zmq::socket_type::router);
+    socket.set(zmq::sockopt::router_mandatory, 1); // 未知客户端立即报错而不是静默丢弃
+    socket.set(zmq::sockopt::linger, 0);
+    socket.set(zmq::sockopt::sndtimeo, kSendTimeoutMs);
+    try {
+        socket.bind(addr_);
+    } catch (const zmq::error_t& e) {
+        std::cerr << "[HistoryServer] Bind Error: " << e.what() << std::endl;
+        return;
+    }
+    std::cout << "[HistoryServer] Listening on " << addr_ << std::endl;
+
+    while (running_) {
+        HistoryQuery q;
+        {
+            std::unique_lock<std::mutex> lock(mtx_);
+            cv_.wait_for(lock, std::chrono::milliseconds(500), [this] { return !queries_.empty() || !running_; });
+            if (queries_.empty()) continue;
+            q = std::move(queries_.front());
+            queries_.pop_front();
+        }
+
+        // 丢弃客户端主动发来的消息 (握手/心跳)，ROUTER 只用于回传
+        zmq::message_t discard;
+        while (socket.recv(discard, zmq::recv_flags::dontwait)) {}
+
+        try {
+            process(socket, q);
+        } catch (const zmq::error_t& e) {
+            std::cerr << "[HistoryServer] Query " << q.query_id << " aborted: " << e.what() << std::endl;
+        }
+    }
+}
+
+void HistoryServer::process(zmq::socket_t& socket, const HistoryQuery& q) {
+    nlohmann::json header;
+    header["type"] = CmdType::RtnHistory;
+    header["query_id"] = q.query_id;
+    header["instrument_id"] = q.instrument_id;
+    header["kind"] = (q.type == StoreRecordType::TICK) ? "tick" : "bar";
+    header["period"] = q.period;
+
+    if (q.client_id.empty() || q.instrument_id.empty() || q.start_time > q.end_time) {
+        header["seq"] = 0;
+        header["last"] = true;
+        header["error"] = "Invalid query";
+        if (!q.client_id.empty()) sendFrames(socket, q.client_id, header.dump(), zmq::message_t());
+        return;
+    }
+
+    const size_t rec_size = TickStoreReader::recordSize(q.type);
+    const size_t per_chunk = std::max<size_t>(1, kChunkBytes / rec_size);
+    std::string key = std::to_string(static_cast<uint32_t>(q.type)) + "|" + q.instrument_id + "|" +
+                      std::to_string(q.period) + "|" + std::to_string(q.start_time) + "|" +
+                      std::to_string(q.end_time) + "|" + std::to_string(q.limit);
+
+    // 未命中缓存时先数一遍 (只读时间戳)，头里的 total/last 需要总数
+    Records cached = cacheGet(key);
+    const size_t total = cached
+        ? cached->size() / rec_size
+        : reader_->scan(q.type, q.instrument_id, q.period, q.start_time, q.end_time, q.limit,
+                        [](const char*, size_t) { return true; });
+
+    header["record_size"] = rec_size;
+    header["total"] = total;
+
+    size_t seq = 0;
+    size_t sent = 0;
+    auto sendChunk = [&](zmq::message_t data, size_t n, bool last) {
+        header["seq"] = seq++;
+        header["count"] = n;
+        header["last"] = last;
+        sent += n;
+        return sendFrames(socket, q.client_id, header.dump(), std::move(data));
+    };
+
+    if (cached) {
+        // 空结果也回一个 last 分块，客户端据此结束等待
+        do {
+            size_t n = std::min(per_chunk, total - sent);
+            if (!sendChunk(zmq::message_t(cached->data() + sent * rec_size, n * rec_size), n, sent + n >= total)) return;
+        } while (sent < total && running_);
+        return;
+    }
+
+    // 结束时间已过去且结果不大时顺带留一份进 LRU
+    int64_t now_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    std::shared_ptr<std::vector<char>> copy;
+    if (q.end_time < now_ms - kLiveWindowMs && total * rec_size <= cache_capacity_ / 4) {
+        copy = std::make_shared<std::vector<char>>();
+        copy->reserve(total * rec_size);
+    }
+
+    // 第二遍: mmap 中的连续段直接拷进当前分块，满一块发一块
+    zmq::message_t chunk;
+    size_t filled = 0;
+    bool ok = true;
+    reader_->scan(q.type, q.instrument_id, q.period, q.start_time, q.end_time, total,
+                  [&](const char* data, size_t n) {
+        if (copy) copy->insert(copy->end(), data, data + n * rec_size);
+        while (n > 0) {
+            if (filled == 0) chunk.rebuild(std::min(per_chunk, total - sent) * rec_size);
+            size_t cap = chunk.size() / rec_size;
+            size_t take = std::min(n, cap - filled);
+            std::memcpy(static_cast<char*>(chunk.data()) + filled * rec_size, data, take * rec_size);
+            filled += take;
+            data += take * rec_size;
+            n -= take;
+            if (filled == cap) {
+                filled = 0;
+                if (!sendChunk(std::move(chunk), cap, sent + cap >= total)) return ok = false;
+            }
+        }
+        return running_.load();
+    });
+    if (!ok || !running_) return;
+
+    // 两遍之间文件被截断等导致记录变少 (或结果为空): 补发 last 分块
+    if (sent < total || total == 0) {
+        header["total"] = sent + filled;
+        if (!sendChunk(zmq::message_t(chunk.data(), filled * rec_size), filled, true)) return;
+        copy.reset();
+    }
+    if (copy) cachePut(key, std::move(copy));
+
+#ifdef _DEBUG
+    std::cout << "[HistoryServer] Query " << q.query_id << " " << q.instrument_id
+              << " -> " << sent << " records in " << seq << " chunks" << std::endl;
+#endif
+}
+
+bool HistoryServer::sendFrames(zmq::socket_t& socket, const std::string& client_id, const std::string& header,
+                               zmq::message_t data) {
+    // 多帧消息整体入队: 首帧超时 (对端 HWM 已满) 即整条未发出
+    if (!socket.send(zmq::message_t(client_id.data(), client_id.size()), zmq::send_flags::sndmore) ||
+        !socket.send(zmq::message_t(header.data(), header.size()), zmq::send_flags::sndmore) ||
+        !socket.send(data, zmq::send_flags::none)) {
+        std::cerr << "[HistoryServer] Client " << client_id << " not reading, query dropped" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+HistoryServer::Records HistoryServer::cacheGet(const std::string& key) {
+    auto it = lru_index_.find(key);
+    if (it == lru_index_.end()) return nullptr;
+    lru_.splice(lru_.begin(), lru_, it->second); // 移到表头 (最近使用)
+    return it->second->records;
+}
+
+void HistoryServer::cachePut(const std::string& key, Records records) {
+    size_t bytes = records->size();
+    if (bytes > cache_capacity_ / 4) return; // 超大结果不缓存，避免挤掉其它条目
+
+    lru_.push_front({key, std::move(records)});
+    lru_index_[key] = lru_.begin();
+    cache_bytes_ += bytes;
+
+    while (cache_bytes_ > cache_capacity_ && !lru_.empty()) {
+        auto& victim = lru_.back();
+        cache_bytes_ -= victim.records->size();
+        lru_index_.erase(victim.key);
+        lru_.pop_back();
+    }
+}
+
+} // namespace QuantLabs
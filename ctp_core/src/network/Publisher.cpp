@@ -1,13 +1,18 @@
 #include "network/Publisher.h"
 #include "protocol/zmq_topics.h"
 #include "utils/Encoding.h"
+#include "utils/ThreadRoles.h"
 #include <iostream>
+#include <chrono>
+#include <cstring>
 
 namespace QuantLabs {
 
 Publisher::Publisher() 
-    : context_(std::make_unique<zmq::context_t>(1)),
-      publisher_(std::make_unique<zmq::socket_t>(*context_, zmq::socket_type::pub)) {
+    : context_(std::make_unique<zmq::context_t>(1)) {
+    // I/O 线程在第一个 socket 创建时启动，须先设置亲和性
+    ThreadRoles::instance().applyToZmqContext(context_->handle());
+    publisher_ = std::make_unique<zmq::socket_t>(*context_, zmq::socket_type::pub);
 }
 
 Publisher::~Publisher() {
@@ -60,17 +65,52 @@ void Publisher::publishTick(const TickData& data) {
 
 }
 
+void Publisher::send(const char* topic, size_t topic_len, const void* data, size_t size) {
+    std::lock_guard<std::mutex> lock(send_mtx_);
+
+    MessageHeader header;
+    header.seq = ++topic_seq_[std::string(topic, topic_len)];
+    header.publish_time = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+
+    publisher_->send(zmq::message_t(topic, topic_len), zmq::send_flags::sndmore);
+    publisher_->send(zmq::message_t(&header, sizeof(header)), zmq::send_flags::sndmore);
+    publisher_->send(zmq::message_t(data, size), zmq::send_flags::none);
+}
+
+void Publisher::sendJson(const char* topic, const std::string& account_id, nlohmann::json& j) {
+    if (account_id.empty()) {
+        std::string payload = j.dump();
+        send(topic, std::strlen(topic), payload.data(), payload.size());
+        return;
+    }
+    j["account_id"] = account_id;
+    std::string full = accountTopic(topic, account_id);
+    std::string payload = j.dump();
+    send(full.data(), full.size(), payload.data(), payload.size());
+}
+
+std::string Publisher::accountTopic(const char* topic, const std::string& account_id) {
+    return account_id.empty() ? std::string(topic) : zmq_topics::accountTopic(topic, account_id);
+}
+
+std::map<std::string, uint64_t> Publisher::sequenceSnapshot() {
+    std::lock_guard<std::mutex> lock(send_mtx_);
+    return std::map<std::string, uint64_t>(topic_seq_.begin(), topic_seq_.end());
+}
+
 void Publisher::publishTickBinary(const TickData& data) {
-    publisher_->send(zmq::message_t(zmq_topics::MARKET_DATA_BIN, 2), zmq::send_flags::sndmore);
-    
-    zmq::message_t msg(sizeof(TickData));
-    std::memcpy(msg.data(), &data, sizeof(TickData));
-    publisher_->send(msg, zmq::send_flags::none);
+    send(zmq_topics::MARKET_DATA_BIN, 2, &data, sizeof(TickData));
+}
+
+void Publisher::publishBarBinary(const BarData& data) {
+    send(zmq_topics::BAR_DATA_BIN, 2, &data, sizeof(BarData));
 }
 
-void Publisher::publishPosition(const PositionData& data, int64_t snapshot_seq) {
+nlohmann::json Publisher::positionToJson(const PositionData& data) {
     nlohmann::json j;
     j["instrument_id"] = data.instrument_id;
+    j["exchange_id"] = data.exchange_id;
     j["direction"] = std::string(1, data.direction); // char to string
     j["position"] = data.position;
     j["today_position"] = data.today_position;
@@ -81,15 +121,21 @@ void Publisher::publishPosition(const PositionData& data, int64_t snapshot_seq)
     j["close_profit"] = data.close_profit;
     j["margin"] = data.margin;
     j["volume_multiple"] = data.volume_multiple;
+    return j;
+}
+
+void Publisher::publishPosition(const PositionData& data, int64_t snapshot_seq, const std::string& account_id) {
+    nlohmann::json j = positionToJson(data);
     j["snapshot_seq"] = snapshot_seq; // 批次号
+    sendJson(zmq_topics::POSITION_DATA, account_id, j);
+}
 
-    std::string payload = j.dump();
-    
-    publisher_->send(zmq::message_t(zmq_topics::POSITION_DATA, 2), zmq::send_flags::sndmore);
-    publisher_->send(zmq::message_t(payload.data(), payload.size()), zmq::send_flags::none);
+void Publisher::publishPositionBinary(const PositionData& data, const std::string& account_id) {
+    std::string topic = accountTopic(zmq_topics::POSITION_DATA_BIN, account_id);
+    send(topic.data(), topic.size(), &data, sizeof(PositionData));
 }
 
-void Publisher::publishAccount(const AccountData& data) {
+nlohmann::json Publisher::accountToJson(const AccountData& data) {
     nlohmann::json j;
     j["balance"] = data.balance;
     j["available"] = data.available;
@@ -97,17 +143,18 @@ void Publisher::publishAccount(const AccountData& data) {
     j["frozen_margin"] = data.frozen_margin;
     j["commission"] = data.commission;
     j["close_profit"] = data.close_profit;
+    return j;
+}
 
-    std::string payload = j.dump();
-
-    publisher_->send(zmq::message_t(zmq_topics::ACCOUNT_DATA, 2), zmq::send_flags::sndmore);
-    publisher_->send(zmq::message_t(payload.data(), payload.size()), zmq::send_flags::none);
+void Publisher::publishAccount(const AccountData& data, const std::string& account_id) {
+    nlohmann::json j = accountToJson(data);
+    sendJson(zmq_topics::ACCOUNT_DATA, account_id, j);
 }
 
-void Publisher::publishInstrument(const InstrumentMeta& data) {
+nlohmann::json Publisher::instrumentToJson(const InstrumentMeta& data) {
     nlohmann::json j;
     j["instrument_id"] = data.instrument_id;
-    j["instrument_name"] = QuantLabs::utils::gbk_to_utf8(data.instrument_name);
+    j["instrument_name"] = QuantLabs::utils::gbk_to_utf8_cached(data.instrument_name);
     j["exchange_id"] = data.exchange_id;
     j["volume_multiple"] = data.volume_multiple;
     j["price_tick"] = data.price_tick;
@@ -125,15 +172,16 @@ void Publisher::publishInstrument(const InstrumentMeta& data) {
     j["close_ratio_by_volume"] = data.close_ratio_by_volume;
     j["close_today_ratio_by_money"] = data.close_today_ratio_by_money;
     j["close_today_ratio_by_volume"] = data.close_today_ratio_by_volume;
+    return j;
+}
 
-    std::string payload = j.dump();
-
-    publisher_->send(zmq::message_t(zmq_topics::INSTRUMENT_DATA, 2), zmq::send_flags::sndmore);
-    publisher_->send(zmq::message_t(payload.data(), payload.size()), zmq::send_flags::none);
+void Publisher::publishInstrument(const InstrumentMeta& data) {
+    std::string payload = instrumentToJson(data).dump();
+    send(zmq_topics::INSTRUMENT_DATA, 2, payload.data(), payload.size());
 }
 
-void Publisher::publishOrder(const CThostFtdcOrderField* pOrder) {
-    if (!pOrder) return;
+nlohmann::json Publisher::orderToJson(const CThostFtdcOrderField& order) {
+    const CThostFtdcOrderField* pOrder = &order;
     nlohmann::json j;
     j["instrument_id"] = pOrder->InstrumentID;
     j["order_sys_id"] = pOrder->OrderSysID; // 报单编号
@@ -150,41 +198,20 @@ void Publisher::publishOrder(const CThostFtdcOrderField* pOrder) {
     j["volume_total"] = pOrder->VolumeTotal; // 剩余数量
     
     j["order_status"] = std::string(1, pOrder->OrderStatus); // 报单状态
-    j["status_msg"] = QuantLabs::utils::gbk_to_utf8(pOrder->StatusMsg); // 状态信息
+    j["status_msg"] = QuantLabs::utils::gbk_to_utf8_cached(pOrder->StatusMsg); // 状态信息
     j["exchange_id"] = pOrder->ExchangeID; // Added
     
     j["insert_time"] = pOrder->InsertTime;
-    
-    std::string payload = j.dump();
-    publisher_->send(zmq::message_t(zmq_topics::ORDER_DATA, 2), zmq::send_flags::sndmore);
-    publisher_->send(zmq::message_t(payload.data(), payload.size()), zmq::send_flags::none);
+    return j;
 }
 
-void Publisher::publishTrade(const CThostFtdcTradeField* pTrade, double commission, double close_profit) {
-    if (!pTrade) return;
-    nlohmann::json j;
-    j["instrument_id"] = pTrade->InstrumentID;
-    j["trade_id"] = pTrade->TradeID;
-    j["order_sys_id"] = pTrade->OrderSysID;
-    
-    j["direction"] = std::string(1, pTrade->Direction);
-    j["offset_flag"] = std::string(1, pTrade->OffsetFlag);
-    
-    j["price"] = pTrade->Price;
-    j["volume"] = pTrade->Volume;
-    j["trade_time"] = pTrade->TradeTime;
-    j["trade_date"] = pTrade->TradeDate;
-    j["exchange_id"] = pTrade->ExchangeID;
-    
-    j["commission"] = commission;
-    j["close_profit"] = close_profit; // Added
-    
-    std::string payload = j.dump();
-    publisher_->send(zmq::message_t(zmq_topics::TRADE_DATA, 2), zmq::send_flags::sndmore);
-    publisher_->send(zmq::message_t(payload.data(), payload.size()), zmq::send_flags::none);
+void Publisher::publishOrder(const CThostFtdcOrderField* pOrder, const std::string& account_id) {
+    if (!pOrder) return;
+    nlohmann::json j = orderToJson(*pOrder);
+    sendJson(zmq_topics::ORDER_DATA, account_id, j);
 }
 
-void Publisher::publishTrade(const TradeData& data) {
+nlohmann::json Publisher::tradeToJson(const TradeData& data) {
     nlohmann::json j;
     j["instrument_id"] = data.instrument_id;
     j["trade_id"] = data.trade_id;
@@ -201,18 +228,35 @@ void Publisher::publishTrade(const TradeData& data) {
     
     j["commission"] = data.commission;
     j["close_profit"] = data.close_profit;
-    
-    std::string payload = j.dump();
-    publisher_->send(zmq::message_t(zmq_topics::TRADE_DATA, 2), zmq::send_flags::sndmore);
-    publisher_->send(zmq::message_t(payload.data(), payload.size()), zmq::send_flags::none);
+    return j;
+}
+
+void Publisher::publishTrade(const CThostFtdcTradeField* pTrade, double commission, double close_profit, const std::string& account_id) {
+    if (!pTrade) return;
+    TradeData data;
+    std::memset(&data, 0, sizeof(data));
+    std::strncpy(data.instrument_id, pTrade->InstrumentID, sizeof(data.instrument_id) - 1);
+    std::strncpy(data.trade_id, pTrade->TradeID, sizeof(data.trade_id) - 1);
+    std::strncpy(data.order_sys_id, pTrade->OrderSysID, sizeof(data.order_sys_id) - 1);
+    std::strncpy(data.trade_time, pTrade->TradeTime, sizeof(data.trade_time) - 1);
+    std::strncpy(data.trade_date, pTrade->TradeDate, sizeof(data.trade_date) - 1);
+    std::strncpy(data.exchange_id, pTrade->ExchangeID, sizeof(data.exchange_id) - 1);
+    data.direction = pTrade->Direction;
+    data.offset_flag = pTrade->OffsetFlag;
+    data.price = pTrade->Price;
+    data.volume = pTrade->Volume;
+    data.commission = commission;
+    data.close_profit = close_profit; // Added
+    publishTrade(data, account_id);
+}
+
+void Publisher::publishTrade(const TradeData& data, const std::string& account_id) {
+    nlohmann::json j = tradeToJson(data);
+    sendJson(zmq_topics::TRADE_DATA, account_id, j);
 }
 
 void Publisher::publish(const std::string& topic, const std::string& message) {
-    zmq::message_t t(topic.c_str(), topic.length());
-    zmq::message_t m(message.c_str(), message.length());
-    
-    publisher_->send(t, zmq::send_flags::sndmore);
-    publisher_->send(m, zmq::send_flags::none);
+    send(topic.c_str(), topic.length(), message.c_str(), message.length());
 }
 
 } // namespace QuantLabs
@@ -0,0 +1,135 @@
+#include "network/ShmMarketWriter.h"
+#include <iostream>
+#include <chrono>
+#include <new>
+
+namespace QuantLabs {
+
+static uint32_t roundUpPow2(uint32_t v) {
+    uint32_t p = 1;
+    while (p < v && p < (1u << 31)) p <<= 1;
+    return p;
+}
+
+bool ShmMarketWriter::init(const std::string& name, uint32_t ring_capacity, uint32_t table_capacity) {
+    if (header_) return true;
+#ifndef _WIN32
+    name_ = name;
+    ring_capacity = roundUpPow2(ring_capacity == 0 ? 1 : ring_capacity);
+    if (table_capacity == 0) table_capacity = 1;
+    size_ = shm::busSize(ring_capacity, table_capacity);
+
+    // 先删除旧的共享内存: 上次进程的读者仍持有旧映射，不受影响，重新 open 后读到新实例
+    ::shm_unlink(name_.c_str());
+    int fd = ::shm_open(name_.c_str(), O_CREAT | O_RDWR | O_EXCL, 0644);
+    if (fd < 0) {
+        std::cerr << "[ShmBus] shm_open failed: " << name_ << std::endl;
+        return false;
+    }
+    if (::ftruncate(fd, static_cast<off_t>(size_)) != 0) {
+        std::cerr << "[ShmBus] ftruncate failed (" << size_ << " bytes)" << std::endl;
+        ::close(fd);
+        ::shm_unlink(name_.c_str());
+        return false;
+    }
+    void* p = ::mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) {
+        std::cerr << "[ShmBus] mmap failed" << std::endl;
+        ::shm_unlink(name_.c_str());
+        return false;
+    }
+    base_ = static_cast<char*>(p); // ftruncate 后内容为全零
+
+    // 先写各段，最后写 magic，读者据 magic 判断是否初始化完成
+    header_ = new (base_) shm::ShmBusHeader();
+    header_->version = shm::kBusVersion;
+    header_->record_size = sizeof(TickData);
+    header_->ring_capacity = ring_capacity;
+    header_->table_capacity = table_capacity;
+    header_->ring_offset = sizeof(shm::ShmBusHeader);
+    header_->table_offset = header_->ring_offset + sizeof(shm::ShmTickSlot) * ring_capacity;
+    header_->total_size = size_;
+    header_->session_id = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    header_->writer_pid = static_cast<int32_t>(::getpid());
+    header_->write_seq.store(0, std::memory_order_relaxed);
+    header_->table_count.store(0, std::memory_order_relaxed);
+
+    slots_ = reinterpret_cast<shm::ShmTickSlot*>(base_ + header_->ring_offset);
+    table_ = reinterpret_cast<shm::ShmLastValueEntry*>(base_ + header_->table_offset);
+    mask_ = ring_capacity - 1;
+    write_seq_ = 0;
+
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(header_->magic, shm::kBusMagic, sizeof(header_->magic));
+
+    std::cout << "[ShmBus] Market data bus at /dev/shm" << name_ << " (ring=" << ring_capacity
+              << ", instruments=" << table_capacity << ", " << (size_ >> 20) << " MB)" << std::endl;
+    return true;
+#else
+    (void)name; (void)ring_capacity; (void)table_capacity;
+    std::cerr << "[ShmBus] Shared memory bus is not supported on this platform" << std::endl;
+    return false;
+#endif
+}
+
+void ShmMarketWriter::stop() {
+#ifndef _WIN32
+    if (!header_) return;
+    ::munmap(base_, size_);
+    ::shm_unlink(name_.c_str());
+#endif
+    base_ = nullptr;
+    header_ = nullptr;
+    slots_ = nullptr;
+    table_ = nullptr;
+    index_.clear();
+}
+
+int ShmMarketWriter::entryIndex(const char* instrument_id) {
+    auto it = index_.find(instrument_id);
+    if (it != index_.end()) return it->second;
+
+    uint32_t n = header_->table_count.load(std::memory_order_relaxed);
+    if (n >= header_->table_capacity) {
+        if (!table_full_warned_) {
+            std::cerr << "[ShmBus] Last value table full (" << n << "), " << instrument_id << " not indexed" << std::endl;
+            table_full_warned_ = true;
+        }
+        return -1;
+    }
+
+    // instrument_id 先写入，再以 release 发布 table_count，读者扫描时可见完整的 key
+    shm::ShmLastValueEntry& e = table_[n];
+    std::strncpy(e.instrument_id, instrument_id, sizeof(e.instrument_id) - 1);
+    header_->table_count.store(n + 1, std::memory_order_release);
+    index_.emplace(instrument_id, static_cast<int>(n));
+    return static_cast<int>(n);
+}
+
+void ShmMarketWriter::publish(const TickData& tick) {
+    if (!header_) return;
+
+    // 1. 环形队列 (seqlock: 奇数写入中，偶数写完)
+    const uint64_t n = write_seq_;
+    shm::ShmTickSlot& slot = slots_[n & mask_];
+    slot.version.store(2 * n + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(&slot.tick, &tick, sizeof(TickData));
+    slot.version.store(2 * n + 2, std::memory_order_release);
+    write_seq_ = n + 1;
+    header_->write_seq.store(write_seq_, std::memory_order_release);
+
+    // 2. 最新值表
+    int idx = entryIndex(tick.instrument_id);
+    if (idx < 0) return;
+    shm::ShmLastValueEntry& e = table_[idx];
+    uint64_t v = e.version.load(std::memory_order_relaxed);
+    e.version.store(v + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(&e.tick, &tick, sizeof(TickData));
+    e.version.store(v + 2, std::memory_order_release);
+}
+
+} // namespace QuantLabs
@@ -1,22 +1,16 @@
 #include "position/PositionManager.h"
+#include "market/InstrumentCache.h"
 #include <iostream>
 #include <cstring>
 #include <algorithm>
+#include <cmath>
 
 namespace atrader {
 namespace core {
 
 void PositionManager::UpdateInstrument(const CThostFtdcInstrumentField& instrument) {
     std::lock_guard<std::mutex> lock(m_mutex);
-    // 更新合约元数据
-    InstrumentMeta& meta = instruments_meta_[instrument.InstrumentID];
-    std::strncpy(meta.instrument_id, instrument.InstrumentID, sizeof(meta.instrument_id) - 1);
-    std::strncpy(meta.exchange_id, instrument.ExchangeID, sizeof(meta.exchange_id) - 1);
-    meta.volume_multiple = instrument.VolumeMultiple;
-    meta.price_tick = instrument.PriceTick;
-    meta.position_date_type = instrument.PositionDateType; 
-
-    // 初始化持仓对象 (如果不存在)
+    // 合约属性直接读共享登记表，这里只初始化持仓对象 (如果不存在)
     if (!positions_.count(instrument.InstrumentID)) { 
         positions_[instrument.InstrumentID] = std::make_shared<InstrumentPosition>();
         positions_[instrument.InstrumentID]->InstrumentID = instrument.InstrumentID;
@@ -24,13 +18,6 @@ void PositionManager::UpdateInstrument(const CThostFtdcInstrumentField& instrume
     }
 }
 
-void PositionManager::UpdateInstrumentMeta(const InstrumentMeta& data) {
-    std::lock_guard<std::mutex> lock(m_mutex);
-    InstrumentMeta& meta = instruments_meta_[data.instrument_id];
-    // 全量更新元数据
-    std::memcpy(&meta, &data, sizeof(InstrumentMeta));
-}
-
 std::shared_ptr<InstrumentPosition> PositionManager::GetPosition(const std::string& instrumentID) {
     std::lock_guard<std::mutex> lock(m_mutex);
     auto it = positions_.find(instrumentID);
@@ -45,6 +32,66 @@ std::unordered_map<std::string, std::shared_ptr<InstrumentPosition>> PositionMan
     return positions_;  // 返回快照副本，外部遍历时不再需要持锁
 }
 
+bool PositionManager::UpdateLastPrice(const std::string& instrumentID, double lastPrice,
+                                      QuantLabs::PositionData& outLong, bool& hasLong,
+                                      QuantLabs::PositionData& outShort, bool& hasShort) {
+    hasLong = hasShort = false;
+    if (lastPrice <= 0) return false;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto it = positions_.find(instrumentID);
+    if (it == positions_.end()) return false;
+    InstrumentPosition& pos = *it->second;
+    if (pos.LongPosition <= 0 && pos.ShortPosition <= 0) return false;
+    pos.LastPrice = lastPrice;
+    const int multiple = QuantLabs::InstrumentCache::instance().volumeMultiple(instrumentID);
+    if (!MarkToMarket(pos, multiple)) return false;
+
+    // 持锁生成推送数据，调用方出锁后不再访问 pos
+    if ((hasLong = pos.LongPosition > 0)) outLong = ToPositionData(pos, THOST_FTDC_PD_Long, multiple);
+    if ((hasShort = pos.ShortPosition > 0)) outShort = ToPositionData(pos, THOST_FTDC_PD_Short, multiple);
+    return true;
+}
+
+QuantLabs::PositionData PositionManager::ToPositionData(const InstrumentPosition& pos, char direction, int mult) {
+    QuantLabs::PositionData data = {0};
+    std::strncpy(data.instrument_id, pos.InstrumentID.c_str(), sizeof(data.instrument_id) - 1);
+    std::strncpy(data.exchange_id, pos.ExchangeID.c_str(), sizeof(data.exchange_id) - 1);
+    data.direction = direction;
+    data.margin = pos.Margin;  // TODO: 分多空保证金
+    data.volume_multiple = mult;
+    if (direction == THOST_FTDC_PD_Long) {
+        data.position = pos.LongPosition;
+        data.today_position = pos.LongTodayPosition;
+        data.yd_position = pos.LongYdPosition;
+        data.position_cost = pos.LongPositionCost;
+        data.open_cost = pos.LongOpenCost;
+        data.pos_profit = pos.LongPositionProfit;
+        data.close_profit = pos.LongCloseProfit;
+    } else {
+        data.position = pos.ShortPosition;
+        data.today_position = pos.ShortTodayPosition;
+        data.yd_position = pos.ShortYdPosition;
+        data.position_cost = pos.ShortPositionCost;
+        data.open_cost = pos.ShortOpenCost;
+        data.pos_profit = pos.ShortPositionProfit;
+        data.close_profit = pos.ShortCloseProfit;
+    }
+    return data;
+}
+
+
+bool PositionManager::MarkToMarket(InstrumentPosition& pos, int multiple) {
+    if (pos.LastPrice <= 0) return false;
+    if (multiple <= 0) multiple = 1;
+    double longProfit = pos.LongPosition > 0 ? pos.LastPrice * pos.LongPosition * multiple - pos.LongOpenCost : 0.0;
+    double shortProfit = pos.ShortPosition > 0 ? pos.ShortOpenCost - pos.LastPrice * pos.ShortPosition * multiple : 0.0;
+    bool changed = std::abs(longProfit - pos.LongPositionProfit) > 0.005 ||
+                   std::abs(shortProfit - pos.ShortPositionProfit) > 0.005;
+    pos.LongPositionProfit = longProfit;
+    pos.ShortPositionProfit = shortProfit;
+    return changed;
+}
+
 void PositionManager::Clear() {
     std::lock_guard<std::mutex> lock(m_mutex);
     positions_.clear();
@@ -76,17 +123,19 @@ double PositionManager::UpdateFromTrade(const CThostFtdcTradeField& trade) {
     bool isSHFE = false;
     double multiple = 1.0;
     
-    auto itMeta = instruments_meta_.find(trade.InstrumentID);
-    if (itMeta != instruments_meta_.end()) {
+    QuantLabs::InstrumentMeta meta;
+    if (QuantLabs::InstrumentCache::instance().get(trade.InstrumentID, meta) && meta.position_date_type != 0) {
         // 使用历史持仓
         // #define THOST_FTDC_PDT_UseHistory '1'
         // #define THOST_FTDC_PDT_NoUseHistory '2'
-        isSHFE = (itMeta->second.position_date_type == THOST_FTDC_PDT_UseHistory);
-        multiple = itMeta->second.volume_multiple;
+        isSHFE = (meta.position_date_type == THOST_FTDC_PDT_UseHistory);
+        multiple = meta.volume_multiple;
     } else {
+        // 无属性或 DB 缓存未保存 PositionDateType: 按交易所推断
         if (std::string(trade.ExchangeID) == "SHFE" || std::string(trade.ExchangeID) == "INE") {
             isSHFE = true;
         }
+        if (meta.volume_multiple > 0) multiple = meta.volume_multiple;
     }
 
     // 判断当前成交是否今仓：比较开仓日期与交易日
@@ -236,6 +285,9 @@ double PositionManager::UpdateFromTrade(const CThostFtdcTradeField& trade) {
             }
         }
     }
+
+    // 5. 持仓变动后按最近一次行情价重算浮盈 (尚无行情时保持 0，等首笔 Tick)
+    MarkToMarket(*pos, static_cast<int>(multiple));
     return totalPnl;
 }
 
@@ -1,13 +1,159 @@
 #include "storage/DBManager.h"
+#include "utils/ThreadRoles.h"
+#include "utils/Logger.h"
 #include <chrono>
 #include <thread>
 #include <cstring>
+#include <stdexcept>
 
 namespace QuantLabs {
 
+namespace {
+
+const std::string kConditionOrderCols =
+    "instrument_id, trigger_price, compare_type, status, direction, offset_flag, volume, limit_price, request_id, strategy_id, "
+    "price_type, tick_offset, condition_type, price_source, trail_distance, extreme_price, leg2_instrument_id, oco_group, start_time, end_time";
+
+const std::string kTradeCols =
+    "instrument_id, direction, offset_flag, price, volume, "
+    "trade_id, order_ref, exchange_id, trade_date, trade_time, broker_id, "
+    "commission, close_profit, strategy_id";
+
+// 全部 SQL 集中登记，各连接首次使用时 prepare，之后只传参数
+const std::unordered_map<std::string, std::string>& statements() {
+    static const std::unordered_map<std::string, std::string> s = {
+        // ---- 读 ----
+        {"load_subscriptions", "SELECT instrument_id FROM tb_subscriptions ORDER BY sort_order ASC"},
+        {"load_condition_orders_active",
+         "SELECT " + kConditionOrderCols + " FROM tb_condition_orders WHERE status = 0 ORDER BY request_id DESC"},
+        // 历史给前端 (全部状态，最近 200 条；条件单长期有效，不按 24h 截断)
+        {"load_condition_orders_recent",
+         "SELECT " + kConditionOrderCols + " FROM tb_condition_orders ORDER BY request_id DESC LIMIT 200"},
+        {"load_strategies", "SELECT strategy_id, strategy_name FROM tb_strategies WHERE status != 9"},
+        {"load_strategy_defs",
+         "SELECT strategy_id, strategy_name, strategy_type, instrument_id, library_path, account_id, "
+         "parameters::text, status FROM tb_strategies "
+         "WHERE library_path IS NOT NULL AND library_path != ''"},
+        {"load_instruments",
+         "SELECT instrument_id, instrument_name, exchange_id, product_id, underlying_instr_id, "
+         "volume_multiple, price_tick, "
+         "long_margin_ratio_by_money, long_margin_ratio_by_volume, "
+         "short_margin_ratio_by_money, short_margin_ratio_by_volume, "
+         "open_ratio_by_money, open_ratio_by_volume, "
+         "close_ratio_by_money, close_ratio_by_volume, "
+         "close_today_ratio_by_money, close_today_ratio_by_volume, "
+         "strike_price, trading_day "
+         "FROM tb_instruments"},
+        // 只加载当天的委托，按 id 倒序（最新报单在前）
+        // 多账户: 按 user_id 过滤；未记录 user_id 的旧数据归入所有账户
+        {"load_orders",
+         "SELECT instrument_id, direction, offset_flag, limit_price, "
+         "volume_total_original, volume_traded, volume_total, "
+         "order_status, status_msg, "
+         "order_ref, front_id, session_id, exchange_id, insert_date, insert_time, broker_id "
+         "FROM tb_orders WHERE insert_date = $1 "
+         "AND ($2 = '' OR user_id = $2 OR user_id IS NULL) "
+         "ORDER BY id DESC LIMIT 1000"},
+        // 取最近 1000 条，按入库顺序升序返回: 前端按时间升序插入，逐条追加即可
+        {"load_trades",
+         "SELECT " + kTradeCols + " FROM ("
+         "SELECT id, " + kTradeCols + " FROM tb_trades WHERE trade_date = $1 "
+         "AND ($2 = '' OR user_id = $2 OR user_id IS NULL) "
+         "ORDER BY id DESC LIMIT 1000) t ORDER BY id ASC"},
+        // 加载全部历史成交用于重放状态
+        {"load_trades_asc", "SELECT " + kTradeCols + " FROM tb_trades ORDER BY trade_date ASC, trade_time ASC"},
+        {"load_settings", "SELECT key, value FROM tb_settings"},
+
+        // ---- 写 (写线程) ----
+        // 完整的 Upsert，包含所有费率字段
+        {"upsert_instrument",
+         "INSERT INTO tb_instruments ("
+         "instrument_id, instrument_name, exchange_id, product_id, underlying_instr_id, strike_price, "
+         "volume_multiple, price_tick, "
+         "long_margin_ratio_by_money, long_margin_ratio_by_volume, "
+         "short_margin_ratio_by_money, short_margin_ratio_by_volume, "
+         "open_ratio_by_money, open_ratio_by_volume, "
+         "close_ratio_by_money, close_ratio_by_volume, "
+         "close_today_ratio_by_money, close_today_ratio_by_volume, "
+         "last_update_timestamp, trading_day "
+         ") VALUES ("
+         "$1, $2, $3, $4, $5, $6, "
+         "$7, $8, "
+         "$9, $10, $11, $12, "
+         "$13, $14, $15, $16, $17, $18, NOW(), $19"
+         // 智能更新：如果新数据的静态字段为空或0（说明这可能是一次纯费率更新），则保留原数据库中的值
+         ") ON CONFLICT (instrument_id) DO UPDATE SET "
+         "instrument_name = CASE WHEN $2 IS NOT NULL AND $2 != '' THEN $2 ELSE tb_instruments.instrument_name END, "
+         "exchange_id = CASE WHEN $3 IS NOT NULL AND $3 != '' THEN $3 ELSE tb_instruments.exchange_id END, "
+         "product_id = CASE WHEN $4 IS NOT NULL AND $4 != '' THEN $4 ELSE tb_instruments.product_id END, "
+         "underlying_instr_id = CASE WHEN $5 IS NOT NULL AND $5 != '' THEN $5 ELSE tb_instruments.underlying_instr_id END, "
+         "strike_price = CASE WHEN $6 != 0 THEN $6 ELSE tb_instruments.strike_price END, "
+         "volume_multiple = CASE WHEN $7 != 0 THEN $7 ELSE tb_instruments.volume_multiple END, "
+         "price_tick = CASE WHEN $8 != 0 THEN $8 ELSE tb_instruments.price_tick END, "
+         // 费率字段通常每次都是准的，直接更新
+         "long_margin_ratio_by_money=$9, long_margin_ratio_by_volume=$10, "
+         "short_margin_ratio_by_money=$11, short_margin_ratio_by_volume=$12, "
+         "open_ratio_by_money=$13, open_ratio_by_volume=$14, "
+         "close_ratio_by_money=$15, close_ratio_by_volume=$16, "
+         "close_today_ratio_by_money=$17, close_today_ratio_by_volume=$18,"
+         "last_update_timestamp=NOW(), trading_day=$19"},
+        {"update_order",
+         "UPDATE tb_orders SET order_status=$4, status_msg=$5, "
+         "volume_traded=$6, volume_total=$7, insert_date=$8 "
+         "WHERE front_id=$1 AND session_id=$2 AND order_ref=$3"},
+        {"insert_order",
+         "INSERT INTO tb_orders (front_id, session_id, order_ref, instrument_id, "
+         "exchange_id, limit_price, volume_total_original, direction, offset_flag, "
+         "order_status, status_msg, insert_time, strategy_id, broker_id, "
+         "insert_date, volume_traded, volume_total, user_id) "
+         "VALUES ($1,$2,$3,$4,$5,$6,$7,$8,$9,$10,$11,$12,$13,$14,$15,$16,$17,$18)"},
+        // strategy_id at $10, broker_id at $11, commission at $12, close_profit at $13, trade_date at $14, user_id (账户) at $15
+        {"insert_trade",
+         "INSERT INTO tb_trades (exchange_id, trade_id, order_ref, instrument_id, direction, offset_flag, price, volume, trade_time, "
+         "strategy_id, broker_id, commission, close_profit, trade_date, user_id) "
+         "VALUES ($1, $2, $3, $4, $5, $6, $7, $8, $9, $10, $11, $12, $13, $14, $15) "
+         "ON CONFLICT (exchange_id, trade_id, direction) DO NOTHING"},
+        // 跟踪止损的止损价/极值会移动，冲突时一并更新
+        {"upsert_condition_order",
+         "INSERT INTO tb_condition_orders (request_id, instrument_id, trigger_price, compare_type, status, direction, offset_flag, volume, limit_price, strategy_id, "
+         "price_type, tick_offset, condition_type, price_source, trail_distance, extreme_price, leg2_instrument_id, oco_group, start_time, end_time) "
+         "VALUES ($1, $2, $3, $4, $5, $6, $7, $8, $9, $10, $11, $12, $13, $14, $15, $16, $17, $18, $19, $20) "
+         "ON CONFLICT (request_id) DO UPDATE SET status=$5, trigger_price=$3, extreme_price=$16"},
+        {"update_condition_status", "UPDATE tb_condition_orders SET status = $1 WHERE request_id = $2"},
+        // 只允许修改状态为0（待触发）的条件单
+        {"modify_condition_order",
+         "UPDATE tb_condition_orders SET trigger_price = $1, limit_price = $2, volume = $3 "
+         "WHERE request_id = $4 AND status = 0"},
+        {"add_subscription", "INSERT INTO tb_subscriptions (instrument_id) VALUES ($1) ON CONFLICT (instrument_id) DO NOTHING"},
+        {"remove_subscription", "DELETE FROM tb_subscriptions WHERE instrument_id = $1"},
+        {"update_strategy_status",
+         "UPDATE tb_strategies SET status = $2, status_msg = $3, updated_at = NOW() WHERE strategy_id = $1"},
+        {"upsert_setting",
+         "INSERT INTO tb_settings (key, value, updated_at) VALUES ($1, $2, NOW()) "
+         "ON CONFLICT (key) DO UPDATE SET value = $2, updated_at = NOW()"},
+    };
+    return s;
+}
+
+// 写线程建连时预编译 (事务外)，避免批量事务中途 prepare 失败连带回滚
+const char* const kWriteStatements[] = {
+    "upsert_instrument", "update_order", "insert_order", "insert_trade", "upsert_condition_order",
+    "update_condition_status", "modify_condition_order", "add_subscription", "remove_subscription", "upsert_setting",
+    "update_strategy_status",
+};
+
+} // namespace
+
 void DBManager::init(const std::string& connStr) {
     if (running_) return;
     connStr_ = connStr;
+    // 预建读连接: 登录回调里的恢复查询直接复用，不在 CTP 线程上建连
+    {
+        std::vector<Lease> warm;
+        for (size_t i = 0; i < kReadPoolSize; ++i) warm.push_back(acquireConnection("GB18030"));
+    }
+    // 启动阶段同步读入设置，之后 getSetting 不再访问数据库
+    loadSettings();
     running_ = true;
     workerThread_ = std::thread(&DBManager::workerLoop, this);
 }
@@ -16,6 +162,88 @@ void DBManager::stop() {
     running_ = false;
     cv_.notify_all();
     if (workerThread_.joinable()) workerThread_.join();
+
+    std::lock_guard<std::mutex> lock(poolMutex_);
+    idle_.clear();
+    poolCreated_ = 0;
+}
+
+std::unique_ptr<DBManager::PooledConnection> DBManager::connect(const std::string& connStr, const char* encoding) {
+    auto pc = std::make_unique<PooledConnection>();
+    pc->conn = std::make_unique<pqxx::connection>(connStr);
+    pc->conn->set_client_encoding(encoding);
+    pc->encoding = encoding;
+    return pc;
+}
+
+const char* DBManager::prepare(PooledConnection& pc, const char* name) {
+    if (pc.prepared.count(name) == 0) {
+        const auto& all = statements();
+        auto it = all.find(name);
+        if (it == all.end()) throw std::logic_error(std::string("unknown statement: ") + name);
+        pc.conn->prepare(name, it->second);
+        pc.prepared.insert(name);
+    }
+    return name;
+}
+
+DBManager::Lease DBManager::acquireConnection(const char* encoding) {
+    std::unique_ptr<PooledConnection> pc;
+    {
+        std::unique_lock<std::mutex> lock(poolMutex_);
+        bool ok = poolCv_.wait_for(lock, std::chrono::seconds(10), [this] {
+            return !idle_.empty() || poolCreated_ < kReadPoolSize;
+        });
+        if (!ok) {
+            LOG_ERROR("DB", "Read pool exhausted.");
+            return Lease(*this, nullptr);
+        }
+        if (!idle_.empty()) {
+            pc = std::move(idle_.back());
+            idle_.pop_back();
+        } else {
+            ++poolCreated_;
+        }
+    }
+
+    try {
+        if (!pc) {
+            pc = connect(connStr_, encoding);
+        } else if (pc->encoding != encoding) {
+            pc->conn->set_client_encoding(encoding);
+            pc->encoding = encoding;
+        }
+    } catch (const std::exception& e) {
+        LOG_ERROR("DB", "Read Connection Error: {}", e.what());
+        pc.reset();
+        {
+            std::lock_guard<std::mutex> lock(poolMutex_);
+            --poolCreated_;
+        }
+        poolCv_.notify_one();
+    }
+    return Lease(*this, std::move(pc));
+}
+
+void DBManager::releaseConnection(std::unique_ptr<PooledConnection> pc) {
+    if (!pc) return;
+    {
+        std::lock_guard<std::mutex> lock(poolMutex_);
+        if (pc->conn && pc->conn->is_open()) {
+            idle_.push_back(std::move(pc));
+        } else {
+            --poolCreated_; // 断开的连接丢弃，下次借用时重建
+        }
+    }
+    poolCv_.notify_one();
+}
+
+void DBManager::enqueue(DBTask&& task) {
+    {
+        std::lock_guard<std::mutex> lock(queueMutex_);
+        tasks_.push(std::move(task));
+    }
+    cv_.notify_one();
 }
 
 std::vector<std::string> DBManager::loadSubscriptions() {
@@ -23,71 +251,61 @@ std::vector<std::string> DBManager::loadSubscriptions() {
     try {
         // 等待 connStr 被设置
         if (connStr_.empty()) {
-            std::cerr << "[DB] Cannot load subs: DB not initialized." << std::endl;
+            LOG_ERROR("DB", "Cannot load subs: DB not initialized.");
             return subs;
         }
 
-        pqxx::connection c(connStr_);
-        // 强制设置客户端编码为 GBK (与数据一致性) 或 UTF8 (如果是存的UTF8)
         // 假设表里存的是 UTF8 (Postgres 默认)
-        c.set_client_encoding("UTF8"); 
-        
-        pqxx::work txn(c);
-        // 检查表是否存在
+        Lease lease = acquireConnection("UTF8");
+        if (!lease) return subs;
+
+        // 检查表是否存在 (表缺失时 prepare 失败)
         try {
-            pqxx::result r = txn.exec("SELECT instrument_id FROM tb_subscriptions ORDER BY sort_order ASC");
+            const char* stmt = lease.prepare("load_subscriptions");
+            pqxx::nontransaction txn(lease.conn());
+            pqxx::result r = txn.exec_prepared(stmt);
             for (auto row : r) {
                 subs.push_back(row[0].as<std::string>());
             }
-            std::cout << "[DB] Loaded " << subs.size() << " subscriptions." << std::endl;
+            LOG_INFO("DB", "Loaded {} subscriptions.", subs.size());
         } catch (...) {
-            std::cerr << "[DB] tb_subscriptions table missing or error." << std::endl;
+            LOG_WARN("DB", "tb_subscriptions table missing or error.");
         }
     } catch (const std::exception& e) {
-        std::cerr << "[DB] Load Subs Error: " << e.what() << std::endl;
+        LOG_ERROR("DB", "Load Subs Error: {}", e.what());
     }
     return subs;
 }
 
 void DBManager::addSubscription(const std::string& instrumentId) {
     if (connStr_.empty()) return;
-    try {
-        pqxx::connection c(connStr_);
-        pqxx::work w(c);
-        w.exec_params("INSERT INTO tb_subscriptions (instrument_id) VALUES ($1) ON CONFLICT (instrument_id) DO NOTHING", instrumentId);
-        w.commit();
-        std::cout << "[DB] Added subscription: " << instrumentId << std::endl;
-    } catch (const std::exception& e) {
-        std::cerr << "[DB] Add Sub Error: " << e.what() << std::endl;
-    }
+    DBTask task;
+    task.type = DBTaskType::SUBSCRIPTION_ADD;
+    task.key = instrumentId;
+    enqueue(std::move(task));
 }
 
 void DBManager::removeSubscription(const std::string& instrumentId) {
     if (connStr_.empty()) return;
-    try {
-        pqxx::connection c(connStr_);
-        pqxx::work w(c);
-        w.exec_params("DELETE FROM tb_subscriptions WHERE instrument_id = $1", instrumentId);
-        w.commit();
-        std::cout << "[DB] Removed subscription: " << instrumentId << std::endl;
-    } catch (const std::exception& e) {
-        std::cerr << "[DB] Remove Sub Error: " << e.what() << std::endl;
-    }
+    DBTask task;
+    task.type = DBTaskType::SUBSCRIPTION_REMOVE;
+    task.key = instrumentId;
+    enqueue(std::move(task));
 }
 
 void DBManager::saveInstrument(const InstrumentMeta& data) {
-    std::lock_guard<std::mutex> lock(queueMutex_);
-    if (tasks_.size() > 5000) return; // 防止积压
+    {
+        std::lock_guard<std::mutex> lock(queueMutex_);
+        if (tasks_.size() > 5000) return; // 防止积压
+    }
     DBTask task;
     task.type = DBTaskType::INSTRUMENT;
     task.instr = data;
-    tasks_.push(task);
-    cv_.notify_one();
+    enqueue(std::move(task));
 }
 
 void DBManager::saveOrder(const CThostFtdcOrderField* pOrder, const std::string& strategy_id, const std::string& trading_day) {
     if (!pOrder) return;
-    std::lock_guard<std::mutex> lock(queueMutex_);
     DBTask task;
     task.type = DBTaskType::ORDER;
     task.strategy_id = strategy_id;
@@ -96,13 +314,11 @@ void DBManager::saveOrder(const CThostFtdcOrderField* pOrder, const std::string&
     if (!trading_day.empty()) {
         std::strncpy(task.order.InsertDate, trading_day.c_str(), sizeof(task.order.InsertDate) - 1);
     }
-    tasks_.push(task);
-    cv_.notify_one();
+    enqueue(std::move(task));
 }
 
 void DBManager::saveTrade(const CThostFtdcTradeField* pTrade, const std::string& strategy_id, double commission, double close_profit, const std::string& trading_day) {
     if (!pTrade) return;
-    std::lock_guard<std::mutex> lock(queueMutex_);
     DBTask task;
     task.type = DBTaskType::TRADE;
     task.strategy_id = strategy_id;
@@ -113,49 +329,34 @@ void DBManager::saveTrade(const CThostFtdcTradeField* pTrade, const std::string&
     if (!trading_day.empty()) {
         std::strncpy(task.trade.TradeDate, trading_day.c_str(), sizeof(task.trade.TradeDate) - 1);
     }
-    tasks_.push(task);
-    cv_.notify_one();
+    enqueue(std::move(task));
 }
 
 void DBManager::saveConditionOrder(const ConditionOrderRequest& order) {
-    std::lock_guard<std::mutex> lock(queueMutex_);
     DBTask task;
     task.type = DBTaskType::CONDITION_ORDER;
     task.condition_order = order;
-    tasks_.push(task);
-    cv_.notify_one();
+    enqueue(std::move(task));
 }
 
 void DBManager::updateConditionOrderStatus(uint64_t request_id, int status) {
     if (connStr_.empty()) return;
-    try {
-        pqxx::connection c(connStr_);
-        pqxx::work w(c);
-        w.exec_params("UPDATE tb_condition_orders SET status = $1 WHERE request_id = $2", status, (long long)request_id);
-        w.commit();
-        std::cout << "[DB] Updated Condition Order " << request_id << " to Status " << status << std::endl;
-    } catch (const std::exception& e) {
-        std::cerr << "[DB] Update Order Status Error: " << e.what() << std::endl;
-    }
+    DBTask task;
+    task.type = DBTaskType::CONDITION_STATUS;
+    task.condition_order.request_id = request_id;
+    task.condition_order.status = status;
+    enqueue(std::move(task));
 }
 
 void DBManager::modifyConditionOrder(uint64_t request_id, double trigger_price, double limit_price, int volume) {
     if (connStr_.empty()) return;
-    try {
-        pqxx::connection c(connStr_);
-        pqxx::work w(c);
-        // 只允许修改状态为0（待触发）的条件单
-        w.exec_params(
-            "UPDATE tb_condition_orders SET trigger_price = $1, limit_price = $2, volume = $3 "
-            "WHERE request_id = $4 AND status = 0",
-            trigger_price, limit_price, volume, (long long)request_id
-        );
-        w.commit();
-        std::cout << "[DB] Modified Condition Order " << request_id 
-                  << " (trigger=" << trigger_price << ", limit=" << limit_price << ", vol=" << volume << ")" << std::endl;
-    } catch (const std::exception& e) {
-        std::cerr << "[DB] Modify Condition Order Error: " << e.what() << std::endl;
-    }
+    DBTask task;
+    task.type = DBTaskType::CONDITION_MODIFY;
+    task.condition_order.request_id = request_id;
+    task.condition_order.trigger_price = trigger_price;
+    task.condition_order.limit_price = limit_price;
+    task.condition_order.volume = volume;
+    enqueue(std::move(task));
 }
 
 std::vector<ConditionOrderRequest> DBManager::loadConditionOrders(bool onlyActive) {
@@ -163,31 +364,16 @@ std::vector<ConditionOrderRequest> DBManager::loadConditionOrders(bool onlyActiv
     if (connStr_.empty()) return orders;
     
     try {
-        pqxx::connection c(connStr_);
-        pqxx::work txn(c);
-        
-        // Check if table exists first
-        pqxx::result table_check = txn.exec("SELECT to_regclass('public.tb_condition_orders')");
-        if (table_check[0][0].is_null()) return orders;
-
-        std::string sql;
-        if (onlyActive) {
-            // Load only Pending (0)
-            sql = "SELECT instrument_id, trigger_price, compare_type, status, direction, offset_flag, volume, limit_price, request_id, strategy_id "
-                  "FROM tb_condition_orders WHERE status = 0 ORDER BY request_id DESC";
-        } else {
-            // Load History for Frontend (Show all mixed, Limit 200)
-            // Removed 24h limit because condition orders are long-standing
-            sql = "SELECT instrument_id, trigger_price, compare_type, status, direction, offset_flag, volume, limit_price, request_id, strategy_id "
-                  "FROM tb_condition_orders "
-                  "ORDER BY request_id DESC LIMIT 200";
-        }
+        Lease lease = acquireConnection("UTF8");
+        if (!lease) return orders;
 
-        pqxx::result r = txn.exec(sql);
+        // Load only Pending (0) for recovery, or recent history for Frontend
+        const char* stmt = lease.prepare(onlyActive ? "load_condition_orders_active" : "load_condition_orders_recent");
+        pqxx::nontransaction txn(lease.conn());
+        pqxx::result r = txn.exec_prepared(stmt);
         
         for (auto row : r) {
             ConditionOrderRequest o;
-            std::memset(&o, 0, sizeof(o));
             
             std::string instr = row[0].as<std::string>();
             std::strncpy(o.instrument_id, instr.c_str(), sizeof(o.instrument_id));
@@ -211,14 +397,26 @@ std::vector<ConditionOrderRequest> DBManager::loadConditionOrders(bool onlyActiv
                  std::strncpy(o.strategy_id, strat.c_str(), sizeof(o.strategy_id));
             }
             
-            // Pending defaults
-            o.price_type = '1'; // Limit
+            std::string pt = row[10].is_null() ? std::string() : row[10].as<std::string>();
+            o.price_type = pt.empty() ? '1' : pt[0];
+            o.tick_offset = row[11].is_null() ? 0 : row[11].as<int>();
+            o.condition_type = static_cast<ConditionType>(row[12].is_null() ? 0 : row[12].as<int>());
+            o.price_source = static_cast<PriceSource>(row[13].is_null() ? 0 : row[13].as<int>());
+            o.trail_distance = row[14].is_null() ? 0.0 : row[14].as<double>();
+            o.extreme_price = row[15].is_null() ? 0.0 : row[15].as<double>();
+            if (!row[16].is_null()) {
+                std::string leg2 = row[16].as<std::string>();
+                std::strncpy(o.leg2_instrument_id, leg2.c_str(), sizeof(o.leg2_instrument_id) - 1);
+            }
+            o.oco_group = row[17].is_null() ? 0 : row[17].as<long long>();
+            o.start_time = row[18].is_null() ? 0 : row[18].as<int>();
+            o.end_time = row[19].is_null() ? 0 : row[19].as<int>();
             
             orders.push_back(o);
         }
-        std::cout << "[DB] Loaded " << orders.size() << " pending condition orders." << std::endl;
+        LOG_INFO("DB", "Loaded {} pending condition orders.", orders.size());
     } catch (const std::exception& e) {
-        std::cerr << "[DB] Load Condition Orders Error: " << e.what() << std::endl;
+        LOG_ERROR("DB", "Load Condition Orders Error: {}", e.what());
     }
     return orders;
 }
@@ -227,48 +425,73 @@ std::vector<std::pair<std::string, std::string>> DBManager::loadStrategies() {
     std::vector<std::pair<std::string, std::string>> strategies;
     if (connStr_.empty()) return strategies;
     try {
-        pqxx::connection c(connStr_);
-        // c.set_client_encoding("GB18030"); // Or UTF8 depending on strategy table 
         // Assuming Strategies have UTF8 or compatible names.
-        
-        pqxx::work txn(c);
-        // Check table
-        pqxx::result table_check = txn.exec("SELECT to_regclass('public.tb_strategies')");
-        if (table_check[0][0].is_null()) return strategies;
+        Lease lease = acquireConnection("UTF8");
+        if (!lease) return strategies;
 
-        pqxx::result r = txn.exec("SELECT strategy_id, strategy_name FROM tb_strategies WHERE status != 9");
+        const char* stmt = lease.prepare("load_strategies");
+        pqxx::nontransaction txn(lease.conn());
+        pqxx::result r = txn.exec_prepared(stmt);
         for (auto row : r) {
             std::string id = row[0].as<std::string>();
             std::string name = row[1].as<std::string>();
             strategies.push_back({id, name});
         }
     } catch (const std::exception& e) {
-        std::cerr << "[DB] Load Strategies Error: " << e.what() << std::endl;
+        LOG_ERROR("DB", "Load Strategies Error: {}", e.what());
     }
     return strategies;
 }
 
+std::vector<StrategyDef> DBManager::loadStrategyDefs() {
+    std::vector<StrategyDef> defs;
+    if (connStr_.empty()) return defs;
+    try {
+        Lease lease = acquireConnection("UTF8");
+        if (!lease) return defs;
+
+        const char* stmt = lease.prepare("load_strategy_defs");
+        pqxx::nontransaction txn(lease.conn());
+        pqxx::result r = txn.exec_prepared(stmt);
+        for (auto row : r) {
+            StrategyDef d;
+            d.strategy_id = row[0].as<std::string>();
+            d.strategy_name = row[1].as<std::string>(std::string());
+            d.strategy_type = row[2].as<std::string>(std::string());
+            d.instrument_id = row[3].as<std::string>(std::string());
+            d.library_path = row[4].as<std::string>(std::string());
+            d.account_id = row[5].as<std::string>(std::string());
+            d.parameters = row[6].as<std::string>(std::string("{}"));
+            d.status = row[7].as<int>(0);
+            defs.push_back(std::move(d));
+        }
+        LOG_INFO("DB", "Loaded {} strategy definitions.", defs.size());
+    } catch (const std::exception& e) {
+        LOG_ERROR("DB", "Load Strategy Defs Error: {}", e.what());
+    }
+    return defs;
+}
+
+void DBManager::updateStrategyStatus(const std::string& strategy_id, int status, const std::string& msg) {
+    if (connStr_.empty()) return;
+    DBTask task;
+    task.type = DBTaskType::STRATEGY_STATUS;
+    task.key = strategy_id;
+    task.status = status;
+    task.value = msg.substr(0, 256); // status_msg VARCHAR(256)
+    enqueue(std::move(task));
+}
+
 std::vector<InstrumentMeta> DBManager::loadAllInstruments() {
     std::vector<InstrumentMeta> instruments;
     if (connStr_.empty()) return instruments;
     try {
-        pqxx::connection c(connStr_);
-        c.set_client_encoding("GB18030");
-        pqxx::work txn(c);
-        
-        // Ensure table has trading_day column (handled by schema update, but runtime check keeps it safe-ish)
-        // We just run query.
-        pqxx::result r = txn.exec(
-            "SELECT instrument_id, instrument_name, exchange_id, product_id, underlying_instr_id, "
-            "volume_multiple, price_tick, "
-            "long_margin_ratio_by_money, long_margin_ratio_by_volume, "
-            "short_margin_ratio_by_money, short_margin_ratio_by_volume, "
-            "open_ratio_by_money, open_ratio_by_volume, "
-            "close_ratio_by_money, close_ratio_by_volume, "
-            "close_today_ratio_by_money, close_today_ratio_by_volume, "
-            "strike_price, trading_day "
-            "FROM tb_instruments"
-        );
+        Lease lease = acquireConnection("GB18030");
+        if (!lease) return instruments;
+
+        const char* stmt = lease.prepare("load_instruments");
+        pqxx::nontransaction txn(lease.conn());
+        pqxx::result r = txn.exec_prepared(stmt);
         
         for (auto row : r) {
             InstrumentMeta data;
@@ -304,26 +527,36 @@ std::vector<InstrumentMeta> DBManager::loadAllInstruments() {
 
             instruments.push_back(data);
         }
-        std::cout << "[DB] Loaded " << instruments.size() << " cached instruments." << std::endl;
+        LOG_INFO("DB", "Loaded {} cached instruments.", instruments.size());
     } catch (const std::exception& e) {
-            std::cerr << "[DB] Load Instruments Error: " << e.what() << std::endl;
+        LOG_ERROR("DB", "Load Instruments Error: {}", e.what());
     }
     return instruments;
 }
 
 void DBManager::workerLoop() {
+    ThreadRoles::instance().apply("db");
     while (running_) {
         try {
-            if (!conn_ || !conn_->is_open()) {
-                std::cout << "[DB] Connecting to DB Encod=GB18030..." << std::endl;
-                // 添加 client_encoding 参数以支持 CTP 的 GBK 字符
-                conn_ = std::make_unique<pqxx::connection>(connStr_);
+            if (!conn_ || !conn_->conn->is_open()) {
+                LOG_INFO("DB", "Connecting to DB Encod=GB18030...");
                 // 强制设置客户端编码为 GBK (CTP 默认编码)
-                conn_->set_client_encoding("GB18030");
-                std::cout << "[DB] Connected." << std::endl;
+                conn_ = connect(connStr_, "GB18030");
+                {
+                    pqxx::nontransaction ddl(*conn_->conn);
+                    ddl.exec("CREATE TABLE IF NOT EXISTS tb_settings (key VARCHAR(64) PRIMARY KEY, value TEXT, updated_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP)");
+                }
+                for (const char* name : kWriteStatements) {
+                    try {
+                        prepare(*conn_, name);
+                    } catch (const std::exception& e) {
+                        LOG_ERROR("DB", "Prepare {} Error: {}", name, e.what());
+                    }
+                }
+                LOG_INFO("DB", "Connected.");
             }
 
-            pqxx::work txn(*conn_);
+            pqxx::work txn(*conn_->conn);
             
             int count = 0;
             while (running_ && count < 200) { // 批量提交 200 条
@@ -335,68 +568,45 @@ void DBManager::workerLoop() {
                         cv_.wait_for(lock, std::chrono::milliseconds(500));
                         if (tasks_.empty()) continue;
                     }
-                    task = tasks_.front();
+                    task = std::move(tasks_.front());
                     tasks_.pop();
                 }
                 
-                processTask(txn, task);
+                // 每个任务一个保存点: 单条失败 (表缺失、prepare 失败、约束冲突) 只回滚并丢弃该条，
+                // 同批的成交/报单照常提交；连接断开仍交给外层重连
+                try {
+                    pqxx::subtransaction sp(txn, "task");
+                    processTask(sp, task);
+                    sp.commit();
+                } catch (const pqxx::broken_connection&) {
+                    throw;
+                } catch (const std::exception& e) {
+                    LOG_ERROR("DB", "Task dropped (type={}): {}", static_cast<int>(task.type), e.what());
+                }
                 count++;
             }
             
             if (count > 0) {
                 txn.commit();
-                // std::cout << "[DB] Committed " << count << " records." << std::endl;
+                // LOG_DEBUG("DB", "Committed {} records.", count);
             } else {
                 // 如果空闲，休息一下
                 std::this_thread::sleep_for(std::chrono::milliseconds(200));
             }
 
         } catch (const std::exception& e) {
-            std::cerr << "[DB] Connection Error: " << e.what() << std::endl;
+            LOG_ERROR("DB", "Connection Error: {}", e.what());
             std::this_thread::sleep_for(std::chrono::seconds(5));
             conn_.reset(); 
         }
     }
 }
 
-void DBManager::processTask(pqxx::work& txn, const DBTask& task) {
+void DBManager::processTask(pqxx::transaction_base& txn, const DBTask& task) {
     try {
         if (task.type == DBTaskType::INSTRUMENT) {
             const auto& d = task.instr;
-            // 完整的 Upsert，包含所有费率字段
-            txn.exec_params(
-                "INSERT INTO tb_instruments ("
-                "instrument_id, instrument_name, exchange_id, product_id, underlying_instr_id, strike_price, "
-                "volume_multiple, price_tick, "
-                "long_margin_ratio_by_money, long_margin_ratio_by_volume, "
-                "short_margin_ratio_by_money, short_margin_ratio_by_volume, "
-                "open_ratio_by_money, open_ratio_by_volume, "
-                "close_ratio_by_money, close_ratio_by_volume, "
-                "close_today_ratio_by_money, close_today_ratio_by_volume, "
-                "last_update_timestamp, trading_day "
-                ") VALUES ("
-                "$1, $2, $3, $4, $5, $6, "
-                "$7, $8, "
-                "$9, $10, $11, $12, "
-                "$13, $14, $15, $16, $17, $18, NOW(), $19"
-                // 智能更新：如果新数据的静态字段为空或0（说明这可能是一次纯费率更新），则保留原数据库中的值
-                ") ON CONFLICT (instrument_id) DO UPDATE SET "
-                "instrument_name = CASE WHEN $2 IS NOT NULL AND $2 != '' THEN $2 ELSE tb_instruments.instrument_name END, "
-                "exchange_id = CASE WHEN $3 IS NOT NULL AND $3 != '' THEN $3 ELSE tb_instruments.exchange_id END, "
-                "product_id = CASE WHEN $4 IS NOT NULL AND $4 != '' THEN $4 ELSE tb_instruments.product_id END, "
-                "underlying_instr_id = CASE WHEN $5 IS NOT NULL AND $5 != '' THEN $5 ELSE tb_instruments.underlying_instr_id END, "
-                "strike_price = CASE WHEN $6 != 0 THEN $6 ELSE tb_instruments.strike_price END, "
-                "volume_multiple = CASE WHEN $7 != 0 THEN $7 ELSE tb_instruments.volume_multiple END, "
-                "price_tick = CASE WHEN $8 != 0 THEN $8 ELSE tb_instruments.price_tick END, "
-                
-                // 费率字段通常每次都是准的，可以直接更新 (或者也应用类似逻辑，视需求而定，这里假设费率更新总是带有有效值)
-                "long_margin_ratio_by_money=$9, long_margin_ratio_by_volume=$10, "
-                "short_margin_ratio_by_money=$11, short_margin_ratio_by_volume=$12, "
-                "open_ratio_by_money=$13, open_ratio_by_volume=$14, "
-                "close_ratio_by_money=$15, close_ratio_by_volume=$16, "
-                "close_today_ratio_by_money=$17, close_today_ratio_by_volume=$18,"
-                "last_update_timestamp=NOW(), trading_day=$19",
-                
+            txn.exec_prepared(prepare(*conn_, "upsert_instrument"),
                 d.instrument_id, d.instrument_name, d.exchange_id, d.product_id, d.underlying_instr_id, d.strike_price,
                 d.volume_multiple, d.price_tick,
                 d.long_margin_ratio_by_money, d.long_margin_ratio_by_volume,
@@ -415,25 +625,17 @@ void DBManager::processTask(pqxx::work& txn, const DBTask& task) {
             std::string status(1, o.OrderStatus);
             
             // 先尝试更新已有报单（状态回报场景）
-            auto r = txn.exec_params(
-                "UPDATE tb_orders SET order_status=$4, status_msg=$5, "
-                "volume_traded=$6, volume_total=$7, insert_date=$8 "
-                "WHERE front_id=$1 AND session_id=$2 AND order_ref=$3",
+            auto r = txn.exec_prepared(prepare(*conn_, "update_order"),
                 o.FrontID, o.SessionID, o.OrderRef,
                 status, o.StatusMsg, o.VolumeTraded, o.VolumeTotal, o.InsertDate);
             
             // 没有匹配行 = 新报单，才 INSERT（消耗一个 SERIAL id）
             if (r.affected_rows() == 0) {
-                txn.exec_params(
-                    "INSERT INTO tb_orders (front_id, session_id, order_ref, instrument_id, "
-                    "exchange_id, limit_price, volume_total_original, direction, offset_flag, "
-                    "order_status, status_msg, insert_time, strategy_id, broker_id, "
-                    "insert_date, volume_traded, volume_total) "
-                    "VALUES ($1,$2,$3,$4,$5,$6,$7,$8,$9,$10,$11,$12,$13,$14,$15,$16,$17)",
+                txn.exec_prepared(prepare(*conn_, "insert_order"),
                     o.FrontID, o.SessionID, o.OrderRef, o.InstrumentID, o.ExchangeID,
                     o.LimitPrice, o.VolumeTotalOriginal, dir, offset,
                     status, o.StatusMsg, o.InsertTime, task.strategy_id, o.BrokerID,
-                    o.InsertDate, o.VolumeTraded, o.VolumeTotal);
+                    o.InsertDate, o.VolumeTraded, o.VolumeTotal, o.InvestorID);
             }
         }
         else if (task.type == DBTaskType::TRADE) {
@@ -441,52 +643,67 @@ void DBManager::processTask(pqxx::work& txn, const DBTask& task) {
             std::string dir(1, t.Direction);
             std::string offset(1, t.OffsetFlag);
             
-            // Added strategy_id at param $10, broker_id at $11
-            // Added commission at $12, close_profit at $13, trade_date at $14
-            txn.exec_params("INSERT INTO tb_trades (exchange_id, trade_id, order_ref, instrument_id, direction, offset_flag, price, volume, trade_time, strategy_id, broker_id, commission, close_profit, trade_date) VALUES ($1, $2, $3, $4, $5, $6, $7, $8, $9, $10, $11, $12, $13, $14) ON CONFLICT (exchange_id, trade_id, direction) DO NOTHING",
-                 t.ExchangeID, t.TradeID, t.OrderRef, t.InstrumentID, dir, offset, t.Price, t.Volume, t.TradeTime, task.strategy_id, t.BrokerID, task.commission, task.close_profit, t.TradeDate);
+            txn.exec_prepared(prepare(*conn_, "insert_trade"),
+                 t.ExchangeID, t.TradeID, t.OrderRef, t.InstrumentID, dir, offset, t.Price, t.Volume, t.TradeTime, task.strategy_id, t.BrokerID, task.commission, task.close_profit, t.TradeDate, t.InvestorID);
         }
         else if (task.type == DBTaskType::CONDITION_ORDER) {
             const auto& o = task.condition_order;
-            
-
             std::string dir(1, o.direction);
             std::string off(1, o.offset_flag);
+            std::string pt(1, o.price_type ? o.price_type : '1');
 
-            txn.exec_params("INSERT INTO tb_condition_orders (request_id, instrument_id, trigger_price, compare_type, status, direction, offset_flag, volume, limit_price, strategy_id) "
-                            "VALUES ($1, $2, $3, $4, $5, $6, $7, $8, $9, $10) "
-                            "ON CONFLICT (request_id) DO UPDATE SET status=$5",
+            txn.exec_prepared(prepare(*conn_, "upsert_condition_order"),
                             (long long)o.request_id, o.instrument_id, o.trigger_price, (int)o.compare_type, o.status,
-                            dir, off, o.volume, o.limit_price, o.strategy_id);
+                            dir, off, o.volume, o.limit_price, o.strategy_id,
+                            pt, o.tick_offset, (int)o.condition_type, (int)o.price_source, o.trail_distance, o.extreme_price,
+                            o.leg2_instrument_id, (long long)o.oco_group, o.start_time, o.end_time);
+        }
+        else if (task.type == DBTaskType::CONDITION_STATUS) {
+            const auto& o = task.condition_order;
+            txn.exec_prepared(prepare(*conn_, "update_condition_status"), o.status, (long long)o.request_id);
+            LOG_INFO("DB", "Updated Condition Order {} to Status {}", o.request_id, o.status);
+        }
+        else if (task.type == DBTaskType::CONDITION_MODIFY) {
+            const auto& o = task.condition_order;
+            txn.exec_prepared(prepare(*conn_, "modify_condition_order"),
+                              o.trigger_price, o.limit_price, o.volume, (long long)o.request_id);
+            LOG_INFO("DB", "Modified Condition Order {} (trigger={}, limit={}, vol={})",
+                     o.request_id, o.trigger_price, o.limit_price, o.volume);
+        }
+        else if (task.type == DBTaskType::SUBSCRIPTION_ADD) {
+            txn.exec_prepared(prepare(*conn_, "add_subscription"), task.key);
+            LOG_INFO("DB", "Added subscription: {}", task.key);
+        }
+        else if (task.type == DBTaskType::SUBSCRIPTION_REMOVE) {
+            txn.exec_prepared(prepare(*conn_, "remove_subscription"), task.key);
+            LOG_INFO("DB", "Removed subscription: {}", task.key);
+        }
+        else if (task.type == DBTaskType::SETTING) {
+            txn.exec_prepared(prepare(*conn_, "upsert_setting"), task.key, task.value);
+        }
+        else if (task.type == DBTaskType::STRATEGY_STATUS) {
+            txn.exec_prepared(prepare(*conn_, "update_strategy_status"), task.key, task.status, task.value);
         }
     } catch (const std::exception& e) {
-        std::cerr << "[DB] Processing Task Error: " << e.what() << std::endl;
-        // 如果出错，可能需要回滚等处理，这里依靠 txn 析构时的自动回滚（如果没 commit）
-        // 但这里 txn 是外层传进来的，外层 catch 后会决定是否 commit
-        throw; // 抛出让外层知道
+        LOG_ERROR("DB", "Processing Task Error: {}", e.what());
+        // 由外层回滚该任务的保存点
+        throw;
     }
 }
 
-std::vector<CThostFtdcOrderField> DBManager::loadOrders(const std::string& trading_day) {
+std::vector<CThostFtdcOrderField> DBManager::loadOrders(const std::string& trading_day, const std::string& user_id) {
     std::vector<CThostFtdcOrderField> list;
     if (connStr_.empty()) return list;
     
     try {
-        pqxx::connection c(connStr_);
-        c.set_client_encoding("GB18030"); // Ensure retrieved data is GBK to match CTP behavior for Publisher
-        pqxx::work txn(c);
-        
-        // 只加载当天的委托，按 id 倒序（最新报单在前）
-        // 兼容历史数据：insert_date 为空或 NULL 的也加载
-        std::string sql = "SELECT instrument_id, direction, offset_flag, limit_price, "
-                          "volume_total_original, volume_traded, volume_total, "
-                          "order_status, status_msg, "
-                          "order_ref, front_id, session_id, exchange_id, insert_date, insert_time, broker_id "
-                          "FROM tb_orders WHERE insert_date = $1 "
-                          "ORDER BY id DESC LIMIT 1000";
-        
-        pqxx::result r = txn.exec_params(sql, trading_day);
-        std::cout << "[DB] loadOrders sql result size: " << r.size() << std::endl;
+        // Ensure retrieved data is GBK to match CTP behavior for Publisher
+        Lease lease = acquireConnection("GB18030");
+        if (!lease) return list;
+
+        const char* stmt = lease.prepare("load_orders");
+        pqxx::nontransaction txn(lease.conn());
+        pqxx::result r = txn.exec_prepared(stmt, trading_day, user_id);
+        LOG_DEBUG("DB", "loadOrders sql result size: {}", r.size());
         
         for (auto row : r) {
             try {
@@ -517,30 +734,26 @@ std::vector<CThostFtdcOrderField> DBManager::loadOrders(const std::string& tradi
                 
                 list.push_back(o);
             } catch (const std::exception& inner_e) {
-                std::cerr << "[DB] Error parsing order row " << row.rownumber() << ": " << inner_e.what() << std::endl;
+                LOG_ERROR("DB", "Error parsing order row {}: {}", row.rownumber(), inner_e.what());
             }
         }
     } catch (const std::exception& e) {
-        std::cerr << "[DB] loadOrders Error: " << e.what() << std::endl;
+        LOG_ERROR("DB", "loadOrders Error: {}", e.what());
     }
     return list;
 }
 
-std::vector<TradeData> DBManager::loadTrades(const std::string& trading_day) {
+std::vector<TradeData> DBManager::loadTrades(const std::string& trading_day, const std::string& user_id) {
     std::vector<TradeData> list;
     if (connStr_.empty()) return list;
 
     try {
-        pqxx::connection c(connStr_);
-        c.set_client_encoding("GB18030"); // Ensure retrieved data is GBK
-        pqxx::work txn(c);
+        Lease lease = acquireConnection("GB18030"); // Ensure retrieved data is GBK
+        if (!lease) return list;
 
-        std::string sql = "SELECT instrument_id, direction, offset_flag, price, volume, "
-                          "trade_id, order_ref, exchange_id, trade_date, trade_time, broker_id, "
-                          "commission, close_profit, strategy_id "
-                          "FROM tb_trades WHERE trade_date = $1 ORDER BY id DESC LIMIT 1000";
-
-        pqxx::result r = txn.exec_params(sql, trading_day);
+        const char* stmt = lease.prepare("load_trades");
+        pqxx::nontransaction txn(lease.conn());
+        pqxx::result r = txn.exec_prepared(stmt, trading_day, user_id);
         for (auto row : r) {
             TradeData t = {};
             std::memset(&t, 0, sizeof(t));
@@ -564,7 +777,7 @@ std::vector<TradeData> DBManager::loadTrades(const std::string& trading_day) {
             list.push_back(t);
         }
     } catch (const std::exception& e) {
-        std::cerr << "[DB] loadTrades Error: " << e.what() << std::endl;
+        LOG_ERROR("DB", "loadTrades Error: {}", e.what());
     }
     return list;
 }
@@ -574,17 +787,12 @@ std::vector<TradeData> DBManager::loadAllTradesAsc() {
     if (connStr_.empty()) return list;
 
     try {
-        pqxx::connection c(connStr_);
-        c.set_client_encoding("GB18030");
-        pqxx::work txn(c);
-
-        // 加载全部历史成交用于重放状态
-        std::string sql = "SELECT instrument_id, direction, offset_flag, price, volume, "
-                          "trade_id, order_ref, exchange_id, trade_date, trade_time, broker_id, "
-                          "commission, close_profit, strategy_id "
-                          "FROM tb_trades ORDER BY trade_date ASC, trade_time ASC";
+        Lease lease = acquireConnection("GB18030");
+        if (!lease) return list;
 
-        pqxx::result r = txn.exec(sql);
+        const char* stmt = lease.prepare("load_trades_asc");
+        pqxx::nontransaction txn(lease.conn());
+        pqxx::result r = txn.exec_prepared(stmt);
         for (auto row : r) {
             TradeData t = {};
             std::memset(&t, 0, sizeof(t));
@@ -607,7 +815,7 @@ std::vector<TradeData> DBManager::loadAllTradesAsc() {
             list.push_back(t);
         }
     } catch (const std::exception& e) {
-        std::cerr << "[DB] loadAllTradesAsc Error: " << e.what() << std::endl;
+        LOG_ERROR("DB", "loadAllTradesAsc Error: {}", e.what());
     }
     return list;
 }
@@ -615,47 +823,44 @@ std::vector<TradeData> DBManager::loadAllTradesAsc() {
 
 
 // Global Settings Implementation
-void DBManager::setSetting(const std::string& key, const std::string& value) {
+void DBManager::loadSettings() {
     if (connStr_.empty()) return;
     try {
-        pqxx::connection c(connStr_);
-        pqxx::work txn(c);
-        
-        // Check table
-        pqxx::result table_check = txn.exec("SELECT to_regclass('public.tb_settings')");
-        if (table_check[0][0].is_null()) {
-             txn.exec("CREATE TABLE IF NOT EXISTS tb_settings (key VARCHAR(64) PRIMARY KEY, value TEXT, updated_at TIMESTAMP DEFAULT CURRENT_TIMESTAMP)");
+        Lease lease = acquireConnection("UTF8");
+        if (!lease) return;
+
+        const char* stmt = lease.prepare("load_settings");
+        pqxx::nontransaction txn(lease.conn());
+        pqxx::result r = txn.exec_prepared(stmt);
+
+        std::lock_guard<std::mutex> lock(settingsMutex_);
+        for (auto row : r) {
+            settings_[row[0].as<std::string>()] = row[1].is_null() ? std::string() : row[1].as<std::string>();
         }
-        
-        // Upsert
-        txn.exec_params(
-            "INSERT INTO tb_settings (key, value, updated_at) VALUES ($1, $2, NOW()) "
-            "ON CONFLICT (key) DO UPDATE SET value = $2, updated_at = NOW()",
-            key, value
-        );
-        txn.commit();
+        LOG_INFO("DB", "Loaded {} settings.", r.size());
     } catch (const std::exception& e) {
-        std::cerr << "[DB] setSetting Error: " << e.what() << std::endl;
+        // tb_settings 尚未创建时为空，首次 setSetting 由写线程建表
+        LOG_ERROR("DB", "loadSettings Error: {}", e.what());
     }
 }
 
-std::string DBManager::getSetting(const std::string& key) {
-    if (connStr_.empty()) return "";
-    try {
-        pqxx::connection c(connStr_);
-        pqxx::nontransaction txn(c);
-        
-        pqxx::result table_check = txn.exec("SELECT to_regclass('public.tb_settings')");
-        if (table_check[0][0].is_null()) return "";
-
-        pqxx::result r = txn.exec_params("SELECT value FROM tb_settings WHERE key = $1", key);
-        if (!r.empty() && !r[0][0].is_null()) {
-            return r[0][0].c_str();
-        }
-    } catch (const std::exception& e) {
-        // quiet for get
+void DBManager::setSetting(const std::string& key, const std::string& value) {
+    {
+        std::lock_guard<std::mutex> lock(settingsMutex_);
+        settings_[key] = value;
     }
-    return "";
+    if (connStr_.empty()) return;
+    DBTask task;
+    task.type = DBTaskType::SETTING;
+    task.key = key;
+    task.value = value;
+    enqueue(std::move(task));
+}
+
+std::string DBManager::getSetting(const std::string& key) {
+    std::lock_guard<std::mutex> lock(settingsMutex_);
+    auto it = settings_.find(key);
+    return it != settings_.end() ? it->second : std::string();
 }
 
 } // namespace QuantLabs
@@ -0,0 +1,170 @@
+#include "storage/TickStore.h"
+#include "utils/TimeUtils.h"
+#include "utils/ThreadRoles.h"
+#include <iostream>
+#include <filesystem>
+#include <cstring>
+
+namespace QuantLabs {
+
+// 队列积压上限 (约 700MB)，超出时丢弃新数据，避免磁盘故障拖垮进程
+static constexpr size_t kMaxPendingTasks = 1000000;
+
+void TickStore::init(const std::string& root_dir, bool record_ticks, bool record_bars) {
+    if (running_) return;
+    root_ = root_dir;
+    record_ticks_ = record_ticks;
+    record_bars_ = record_bars;
+
+    try {
+        std::filesystem::create_directories(root_);
+    } catch (const std::exception& e) {
+        std::cerr << "[TickStore] Failed to create root directory: " << e.what() << std::endl;
+        return;
+    }
+
+    running_ = true;
+    workerThread_ = std::thread(&TickStore::workerLoop, this);
+    std::cout << "[TickStore] Recording to " << root_
+              << " (ticks=" << record_ticks_ << ", bars=" << record_bars_ << ")" << std::endl;
+}
+
+void TickStore::stop() {
+    running_ = false;
+    cv_.notify_all();
+    if (workerThread_.joinable()) workerThread_.join();
+}
+
+std::string TickStore::tickFilePath(const std::string& root, const std::string& trading_day, const std::string& instrument_id) {
+    return root + "/tick/" + trading_day + "/" + instrument_id + ".tick";
+}
+
+std::string TickStore::barFilePath(const std::string& root, int period, const std::string& trading_day, const std::string& instrument_id) {
+    return root + "/bar/" + std::to_string(period) + "/" + trading_day + "/" + instrument_id + ".bar";
+}
+
+void TickStore::appendTick(const TickData& tick) {
+    if (!running_ || !record_ticks_) return;
+
+    int sod = utils::parseTimeOfDay(tick.update_time);
+    if (sod < 0) return;
+
+    std::lock_guard<std::mutex> lock(queueMutex_);
+    if (tasks_.size() >= kMaxPendingTasks) return;
+    tasks_.emplace_back();
+    StoreTask& task = tasks_.back();
+    task.type = StoreRecordType::TICK;
+    task.tick.ts = utils::toEpochMs(utils::resolveActionDay(sod), sod, tick.update_millisec);
+    task.tick.tick = tick;
+    cv_.notify_one();
+}
+
+void TickStore::appendBar(const BarData& bar) {
+    if (!running_ || !record_bars_) return;
+
+    std::lock_guard<std::mutex> lock(queueMutex_);
+    if (tasks_.size() >= kMaxPendingTasks) return;
+    tasks_.emplace_back();
+    StoreTask& task = tasks_.back();
+    task.type = StoreRecordType::BAR;
+    task.bar = bar;
+    cv_.notify_one();
+}
+
+FILE* TickStore::openFile(const std::string& path, StoreRecordType type, int period, uint32_t record_size) {
+    auto it = files_.find(path);
+    if (it != files_.end()) return it->second;
+
+    std::filesystem::path p(path);
+    std::error_code ec;
+    std::filesystem::create_directories(p.parent_path(), ec);
+
+    FILE* fp = std::fopen(path.c_str(), "ab");
+    if (!fp) {
+        std::cerr << "[TickStore] Cannot open " << path << std::endl;
+        return nullptr;
+    }
+
+    // 新文件写入文件头；已有文件截掉末尾不完整的记录 (上次异常退出)
+    std::fseek(fp, 0, SEEK_END);
+    long size = std::ftell(fp);
+    if (size <= 0) {
+        TickStoreHeader header;
+        std::memset(&header, 0, sizeof(header));
+        std::strncpy(header.magic, kTickStoreMagic, sizeof(header.magic));
+        header.version = kTickStoreVersion;
+        header.record_type = static_cast<uint32_t>(type);
+        header.record_size = record_size;
+        header.period = period;
+        std::fwrite(&header, sizeof(header), 1, fp);
+    } else {
+        long body = size - static_cast<long>(sizeof(TickStoreHeader));
+        long tail = body > 0 ? body % static_cast<long>(record_size) : 0;
+        if (tail != 0) {
+            std::fclose(fp);
+            std::filesystem::resize_file(p, static_cast<uintmax_t>(size - tail), ec);
+            fp = std::fopen(path.c_str(), "ab");
+            if (!fp) return nullptr;
+        }
+    }
+
+    files_[path] = fp;
+    return fp;
+}
+
+void TickStore::closeAll() {
+    for (auto& [path, fp] : files_) {
+        if (fp) std::fclose(fp);
+    }
+    files_.clear();
+}
+
+void TickStore::writeTask(const StoreTask& task) {
+    const char* trading_day = task.type == StoreRecordType::TICK ? task.tick.tick.trading_day : task.bar.trading_day;
+    if (trading_day[0] == '\0') return;
+
+    // 交易日切换: 关闭旧文件句柄
+    if (current_day_ != trading_day) {
+        closeAll();
+        current_day_ = trading_day;
+    }
+
+    if (task.type == StoreRecordType::TICK) {
+        FILE* fp = openFile(tickFilePath(root_, trading_day, task.tick.tick.instrument_id),
+                            StoreRecordType::TICK, 0, sizeof(TickRecord));
+        if (fp) std::fwrite(&task.tick, sizeof(TickRecord), 1, fp);
+    } else {
+        FILE* fp = openFile(barFilePath(root_, task.bar.period, trading_day, task.bar.instrument_id),
+                            StoreRecordType::BAR, task.bar.period, sizeof(BarData));
+        if (fp) std::fwrite(&task.bar, sizeof(BarData), 1, fp);
+    }
+}
+
+void TickStore::workerLoop() {
+    ThreadRoles::instance().apply("tickstore");
+    std::vector<StoreTask> batch;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(queueMutex_);
+            cv_.wait_for(lock, std::chrono::milliseconds(500), [this] { return !tasks_.empty() || !running_; });
+            batch.swap(tasks_);
+        }
+
+        for (const auto& task : batch) writeTask(task);
+
+        // 每批刷盘一次，读端 (历史查询) 能看到最新数据
+        if (!batch.empty()) {
+            for (auto& [path, fp] : files_) std::fflush(fp);
+        }
+        batch.clear();
+
+        if (!running_) {
+            std::lock_guard<std::mutex> lock(queueMutex_);
+            if (tasks_.empty()) break;
+        }
+    }
+    closeAll();
+    std::cout << "[TickStore] Worker stopped." << std::endl;
+}
+
+} // namespace QuantLabs
@@ -0,0 +1,100 @@
+#include "storage/TickStoreReader.h"
+#include "utils/MappedFile.h"
+#include "utils/TimeUtils.h"
+#include <filesystem>
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+
+namespace QuantLabs {
+
+static_assert(offsetof(TickRecord, ts) == 0, "TickRecord must start with its timestamp");
+static_assert(offsetof(BarData, bar_time) == 0, "BarData must start with its timestamp");
+
+// 夜盘数据归属下一交易日 (周五夜盘 -> 周一)，目录范围向后多取几天
+static constexpr int64_t kTradingDaySlackMs = 7LL * 86400 * 1000;
+
+static inline int64_t recordTime(const char* rec) {
+    int64_t ts;
+    std::memcpy(&ts, rec, sizeof(ts));
+    return ts;
+}
+
+std::vector<std::string> TickStoreReader::listDays(const std::string& dir, int64_t start_ms, int64_t end_ms) const {
+    std::vector<std::string> days;
+    std::error_code ec;
+    if (!std::filesystem::is_directory(dir, ec)) return days;
+
+    int first = utils::dateFromEpochMs(start_ms);
+    int last = utils::dateFromEpochMs(end_ms + kTradingDaySlackMs);
+    for (const auto& entry : std::filesystem::directory_iterator(dir, ec)) {
+        if (!entry.is_directory()) continue;
+        std::string name = entry.path().filename().string();
+        int day = utils::parseDate(name.c_str());
+        if (day != 0 && day >= first && day <= last) days.push_back(name);
+    }
+    std::sort(days.begin(), days.end());
+    return days;
+}
+
+size_t TickStoreReader::scan(StoreRecordType type, const std::string& instrument_id, int period,
+                             int64_t start_ms, int64_t end_ms, size_t limit, const Sink& sink) const {
+    if (instrument_id.empty() || start_ms > end_ms || limit == 0) return 0;
+
+    const size_t rec_size = recordSize(type);
+    std::string dir = (type == StoreRecordType::TICK)
+        ? root_ + "/tick"
+        : root_ + "/bar/" + std::to_string(period);
+
+    size_t count = 0;
+    for (const auto& day : listDays(dir, start_ms, end_ms)) {
+        std::string path = (type == StoreRecordType::TICK)
+            ? TickStore::tickFilePath(root_, day, instrument_id)
+            : TickStore::barFilePath(root_, period, day, instrument_id);
+
+        utils::MappedFile file;
+        if (!file.open(path) || file.size() < sizeof(TickStoreHeader)) continue;
+
+        TickStoreHeader header;
+        std::memcpy(&header, file.data(), sizeof(header));
+        if (std::strncmp(header.magic, kTickStoreMagic, sizeof(header.magic)) != 0 ||
+            header.version != kTickStoreVersion || header.record_size != rec_size) {
+            continue; // 格式不兼容
+        }
+
+        const char* base = file.data() + sizeof(TickStoreHeader);
+        size_t n = (file.size() - sizeof(TickStoreHeader)) / rec_size;
+        if (n == 0) continue;
+        if (recordTime(base) > end_ms || recordTime(base + (n - 1) * rec_size) < start_ms) continue;
+
+        // 二分查找第一条 ts >= start_ms
+        size_t lo = 0, hi = n;
+        while (lo < hi) {
+            size_t mid = lo + (hi - lo) / 2;
+            if (recordTime(base + mid * rec_size) < start_ms) lo = mid + 1;
+            else hi = mid;
+        }
+
+        // [span, i) 为尚未交出的连续段
+        size_t span = lo;
+        size_t i = lo;
+        for (; i < n && count < limit; ++i) {
+            int64_t ts = recordTime(base + i * rec_size);
+            if (ts > end_ms) break;
+
+            // BarEngine 每根 Bar 只完成一次；同 ts 的重复记录来自旧版本数据或重启前后各落盘一次，
+            // 保留最后一条: 跳过后面还有同 ts 的记录
+            if (type == StoreRecordType::BAR && i + 1 < n && recordTime(base + (i + 1) * rec_size) == ts) {
+                if (i > span && !sink(base + span * rec_size, i - span)) return count;
+                span = i + 1;
+                continue;
+            }
+            ++count;
+        }
+        if (i > span && !sink(base + span * rec_size, i - span)) return count;
+        if (count >= limit) break;
+    }
+    return count;
+}
+
+} // namespace QuantLabs
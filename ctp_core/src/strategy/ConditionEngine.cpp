@@ -1,132 +1,523 @@
 #include "strategy/ConditionEngine.h"
 #include "storage/DBManager.h" // Added
+#include "market/InstrumentCache.h"
+#include "utils/ThreadRoles.h"
+#include "utils/Logger.h"
+#include <atomic>
 #include <iostream>
 #include <cstring>
 #include <algorithm>
 
 namespace QuantLabs {
 
+// 跟踪止损价变动的落库/推送间隔
+static constexpr auto kTrailFlushInterval = std::chrono::seconds(1);
+
 ConditionEngine::ConditionEngine(TraderHandler& trader) 
-    : trader_(trader) {
+    : trader_(trader),
+      trigger_queue_(std::make_unique<SpscQueue<TriggerEvent, kTriggerQueueSize>>()) {
+    // id 高位为启动时间 (秒)，与历史运行分配的 id 不重复 (数据库主键)
+    epoch_ = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::seconds>(
+                 std::chrono::system_clock::now().time_since_epoch()).count()) & 0x7FFFFFFFull;
 }
 
 ConditionEngine::~ConditionEngine() {
+    stop();
 }
 
 void ConditionEngine::setStatusCallback(StatusCallback cb) {
     status_callback_ = cb;
 }
 
-void ConditionEngine::addConditionOrder(const ConditionOrderRequest& order) {
-    std::lock_guard<std::mutex> lock(mtx_);
-    order_book_[order.instrument_id].push_back(order);
+void ConditionEngine::start() {
+    if (running_) return;
+    running_ = true;
+    exec_thread_ = std::thread(&ConditionEngine::executionLoop, this);
+}
+
+void ConditionEngine::stop() {
+    if (!running_) return;
+    running_ = false;
+    {
+        std::lock_guard<std::mutex> lock(wake_mtx_);
+        wake_cv_.notify_one();
+    }
+    if (exec_thread_.joinable()) exec_thread_.join();
+}
+
+uint64_t ConditionEngine::addConditionOrder(const ConditionOrderRequest& request) {
+    ConditionOrderRequest order = request;
+    // 条件单可能先于合约查询到达: 先登记代码取得句柄，属性稍后写入
+    auto& registry = InstrumentCache::instance();
+    const InstrumentId instrument = registry.intern(std::string_view(order.instrument_id, strnlen(order.instrument_id, sizeof(order.instrument_id))));
+    InstrumentId leg2 = kInvalidInstrument;
+    if (order.condition_type == ConditionType::Spread && order.leg2_instrument_id[0] != '\0') {
+        leg2 = registry.intern(std::string_view(order.leg2_instrument_id, strnlen(order.leg2_instrument_id, sizeof(order.leg2_instrument_id))));
+        if (leg2 == kInvalidInstrument) {
+            LOG_ERROR("ConditionEngine", "Unknown spread leg {}, order rejected", order.leg2_instrument_id);
+            return 0;
+        }
+    }
+    if (instrument == kInvalidInstrument) {
+        LOG_ERROR("ConditionEngine", "Unknown instrument {}, order rejected", order.instrument_id);
+        return 0;
+    }
+    {
+        Shard& shard = shardOf(instrument);
+        std::lock_guard<std::mutex> lock(shard.mtx);
+        {
+            std::lock_guard<std::mutex> index_lock(index_mtx_);
+
+            uint32_t index;
+            if (!free_slots_.empty()) {
+                index = free_slots_.front();
+                free_slots_.pop_front();
+            } else if (slot_count_ < kMaxSlots) {
+                index = slot_count_++;
+                auto& chunk = slot_chunks_[index >> kSlotChunkBits];
+                if (!chunk) chunk = std::make_unique<Slot[]>(kSlotChunkSize);
+            } else {
+                LOG_ERROR("ConditionEngine", "Slot capacity exhausted, order rejected");
+                return 0;
+            }
+            Slot& slot = slotAt(index);
+
+            if (order.request_id == 0) {
+                order.request_id = (epoch_ << 32) |
+                                   (static_cast<uint64_t>(slot.generation) << kSlotBits) | index;
+            }
+            if (!id_index_.emplace(order.request_id, index).second) {
+                free_slots_.push_front(index);
+                LOG_WARN("ConditionEngine", "Duplicate request_id {}, ignored", order.request_id);
+                return 0;
+            }
+
+            OrderBucket& bucket = shard.order_book[instrument];
+            slot.order = order;
+            slot.instrument = instrument;
+            slot.leg2 = leg2;
+            slot.bucket = &bucket;
+            slot.bucket_pos = static_cast<uint32_t>(bucket.size());
+            bucket.push_back(index);
+
+            if (order.oco_group != 0) oco_groups_[order.oco_group].push_back(index);
+        }
+        if (leg2 != kInvalidInstrument) {
+            std::lock_guard<std::mutex> spread_lock(spread_mtx_);
+            ++spread_links_[leg2][instrument];
+            spread_count_.fetch_add(1, std::memory_order_relaxed);
+        }
+        pending_count_.fetch_add(1, std::memory_order_relaxed);
+    }
     
-    // Persist to DB
+    // Persist to DB (锁外执行，不阻塞行情线程的触发判定)
     DBManager::instance().saveConditionOrder(order);
 
     // Push status
     if (status_callback_) status_callback_(order);
 
-    std::cout << "[ConditionEngine] Added order for " << order.instrument_id 
-              << ", Trigger: " << order.trigger_price 
-              << ", Type: " << (int)order.compare_type << std::endl;
+    LOG_INFO("ConditionEngine", "Added order {} for {}, Trigger: {}, Type: {}",
+             order.request_id, order.instrument_id, order.trigger_price, order.compare_type);
+    return order.request_id;
 }
 
-bool ConditionEngine::removeConditionOrder(uint64_t request_id) {
-    std::lock_guard<std::mutex> lock(mtx_);
-    bool found = false;
-    for (auto& pair : order_book_) {
-        auto& list = pair.second;
-        
-        // Use find_if first to get the object for callback
-        auto it = std::find_if(list.begin(), list.end(), 
-            [request_id](const ConditionOrderRequest& order) {
-                return order.request_id == request_id;
-            });
-
-        if (it != list.end()) {
-            // Found, create copy for callback
-            ConditionOrderRequest o = *it;
-            o.status = 2; // Cancelled
-            
-            // Remove from memory
-            list.erase(it);
-            found = true;
-            
-            // Update DB status to Cancelled (2)
-            DBManager::instance().updateConditionOrderStatus(request_id, 2);
-            
-            // Push status
-            if (status_callback_) status_callback_(o);
+uint32_t ConditionEngine::findSlot(uint64_t request_id) {
+    auto it = id_index_.find(request_id);
+    if (it == id_index_.end()) return kNoSlot;
+    const Slot& slot = slotAt(it->second);
+    // 槽位已被释放或复用 (代数变化) 时 id 不再有效
+    if (!slot.bucket || slot.order.request_id != request_id) return kNoSlot;
+    return it->second;
+}
+
+InstrumentId ConditionEngine::instrumentOf(uint64_t request_id) {
+    std::lock_guard<std::mutex> index_lock(index_mtx_);
+    uint32_t index = findSlot(request_id);
+    return index == kNoSlot ? kInvalidInstrument : slotAt(index).instrument;
+}
 
-            break; 
+bool ConditionEngine::removeConditionOrder(uint64_t request_id) {
+    ConditionOrderRequest o;
+    {
+        // 先定位分片，加分片锁后再确认一次 (期间可能已触发或被撤)
+        const InstrumentId instrument = instrumentOf(request_id);
+        if (instrument == kInvalidInstrument) return false;
+        std::lock_guard<std::mutex> lock(shardOf(instrument).mtx);
+        uint32_t index;
+        {
+            std::lock_guard<std::mutex> index_lock(index_mtx_);
+            index = findSlot(request_id);
         }
+        if (index == kNoSlot) return false;
+
+        // Found, create copy for callback
+        o = slotAt(index).order;
+        o.status = 2; // Cancelled
+
+        // Remove from memory
+        eraseOrder(index);
     }
-    return found;
+
+    // Update DB status to Cancelled (2)
+    DBManager::instance().updateConditionOrderStatus(request_id, 2);
+    
+    // Push status
+    if (status_callback_) status_callback_(o);
+    return true;
 }
 
 bool ConditionEngine::modifyConditionOrder(uint64_t request_id, double trigger_price, double limit_price, int volume) {
-    std::lock_guard<std::mutex> lock(mtx_);
+    ConditionOrderRequest modified;
     bool found = false;
-    
-    // 遍历所有合约的条件单
-    for (auto& [instrument, list] : order_book_) {
-        for (auto& order : list) {
-            if (order.request_id == request_id && order.status == 0) {
-                // 只允许修改待触发的条件单
-                order.trigger_price = trigger_price;
-                order.limit_price = limit_price;
-                order.volume = volume;
-                found = true;
-                
-                // 更新数据库
-                DBManager::instance().modifyConditionOrder(request_id, trigger_price, limit_price, volume);
-                
-                // 推送状态更新（可选）
-                if (status_callback_) status_callback_(order);
-                
-                std::cout << "[ConditionEngine] Modified Order " << request_id 
-                          << " (trigger=" << trigger_price << ", limit=" << limit_price << ", vol=" << volume << ")" << std::endl;
-                return true;
-            }
+    const InstrumentId instrument = instrumentOf(request_id);
+    if (instrument != kInvalidInstrument) {
+        std::lock_guard<std::mutex> lock(shardOf(instrument).mtx);
+        uint32_t index;
+        {
+            std::lock_guard<std::mutex> index_lock(index_mtx_);
+            index = findSlot(request_id);
+        }
+        // 只允许修改待触发的条件单
+        if (index != kNoSlot && slotAt(index).order.status == 0) {
+            ConditionOrderRequest& order = slotAt(index).order;
+            order.trigger_price = trigger_price;
+            order.limit_price = limit_price;
+            order.volume = volume;
+            modified = order;
+            found = true;
         }
     }
     
-    if (!found) {
-        std::cerr << "[ConditionEngine] Modify failed: Order " << request_id << " not found or already triggered/cancelled" << std::endl;
+    if (found) {
+        // 更新数据库
+        DBManager::instance().modifyConditionOrder(request_id, trigger_price, limit_price, volume);
+        
+        // 推送状态更新（可选）
+        if (status_callback_) status_callback_(modified);
+        
+        LOG_INFO("ConditionEngine", "Modified Order {} (trigger={}, limit={}, vol={})",
+                 request_id, trigger_price, limit_price, volume);
+    } else {
+        LOG_WARN("ConditionEngine", "Modify failed: Order {} not found or already triggered/cancelled", request_id);
     }
     return found;
 }
 
 void ConditionEngine::onTick(const CThostFtdcDepthMarketDataField *pDepthMarketData) {
     if (!pDepthMarketData) return;
+    if (pending_count_.load(std::memory_order_relaxed) == 0) return;
     
-    std::string instrument = pDepthMarketData->InstrumentID;
-    
-    // Quick check without lock if possible? No, map access needs lock.
-    // Just lock. Ticks are high freq, but map lookup is fast.
-    std::lock_guard<std::mutex> lock(mtx_);
-    
-    auto map_it = order_book_.find(instrument);
-    if (map_it == order_book_.end()) {
-        return;
+    // 锁外查句柄 (无锁)，未登记的合约不可能有条件单
+    const InstrumentId instrument = InstrumentCache::instance().find(pDepthMarketData->InstrumentID);
+    if (instrument == kInvalidInstrument) return;
+
+    // UpdateTime "HH:MM:SS" -> HHMMSS
+    const char* t = pDepthMarketData->UpdateTime;
+    int hhmmss = ((t[0] - '0') * 10 + (t[1] - '0')) * 10000 + ((t[3] - '0') * 10 + (t[4] - '0')) * 100 +
+                 (t[6] - '0') * 10 + (t[7] - '0');
+
+    bool triggered = false;
+    scratch_legs_.clear();
+    {
+        Shard& shard = shardOf(instrument);
+        std::lock_guard<std::mutex> lock(shard.mtx);
+
+        auto map_it = shard.order_book.find(instrument);
+        const bool has_orders = map_it != shard.order_book.end() && !map_it->second.empty();
+        // 本合约是价差第二腿: 先拷出第一腿列表，稍后逐个加第一腿的分片锁重新评估
+        if (spread_count_.load(std::memory_order_relaxed) > 0) {
+            std::lock_guard<std::mutex> spread_lock(spread_mtx_);
+            auto link_it = spread_links_.find(instrument);
+            if (link_it != spread_links_.end()) {
+                for (const auto& [leg1, count] : link_it->second) scratch_legs_.push_back(leg1);
+            }
+        }
+        if (!has_orders && scratch_legs_.empty()) return;
+
+        Quote& quote = quotes_[instrument];
+        quote.last_price = pDepthMarketData->LastPrice;
+        quote.bid_price1 = pDepthMarketData->BidPrice1;
+        quote.ask_price1 = pDepthMarketData->AskPrice1;
+        quote.upper_limit_price = pDepthMarketData->UpperLimitPrice;
+        quote.lower_limit_price = pDepthMarketData->LowerLimitPrice;
+
+        if (has_orders) triggered |= scanOrders(shard, map_it->second, quote, hhmmss, false);
+    }
+    // 同组其余条件单须在下一次扫描前撤掉 (可能就在价差第一腿的 bucket 中)
+    if (!fired_groups_.empty()) cancelOcoSiblings();
+
+    // 用第一腿最近的盘口重新评估其价差条件单
+    for (InstrumentId leg1 : scratch_legs_) {
+        auto q_it = quotes_.find(leg1);
+        if (q_it == quotes_.end()) continue;
+        {
+            Shard& shard = shardOf(leg1);
+            std::lock_guard<std::mutex> lock(shard.mtx);
+            auto book_it = shard.order_book.find(leg1);
+            if (book_it == shard.order_book.end()) continue;
+            triggered |= scanOrders(shard, book_it->second, q_it->second, hhmmss, true);
+        }
+        if (!fired_groups_.empty()) cancelOcoSiblings();
     }
 
-    auto& orders = map_it->second;
-    if (orders.empty()) return;
+    // 执行线程休眠时才唤醒 (与 executionLoop 中的 exec_sleeping_ 配对，避免丢失唤醒)。
+    // 队列的 release 写与随后的读之间需要 StoreLoad 屏障，否则两边可能都读到旧值
+    if (triggered) std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (triggered && exec_sleeping_.load()) {
+        std::lock_guard<std::mutex> wake_lock(wake_mtx_);
+        wake_cv_.notify_one();
+    }
+}
 
-    double last_price = pDepthMarketData->LastPrice;
+bool ConditionEngine::scanOrders(Shard& shard, OrderBucket& bucket, const Quote& quote, int hhmmss, bool spread_only) {
+    bool triggered = false;
 
-    for (auto it = orders.begin(); it != orders.end(); ) {
-        if (checkCondition(last_price, *it)) {
-            // Triggered
-            executeOrder(*it, pDepthMarketData);
-            
-            // Remove triggered order
-            it = orders.erase(it);
-        } else {
-            ++it;
+    // 删除时末尾元素换到当前位置，因此命中后不前进下标
+    for (size_t i = 0; i < bucket.size(); ) {
+        const uint32_t index = bucket[i];
+        Slot& slot = slotAt(index);
+        ConditionOrderRequest& order = slot.order;
+        if (spread_only && order.condition_type != ConditionType::Spread) {
+            ++i;
+            continue;
+        }
+        // 同组已有一张在本次触发，其余等待撤销
+        if (order.oco_group != 0 &&
+            std::find(fired_groups_.begin(), fired_groups_.end(), order.oco_group) != fired_groups_.end()) {
+            ++i;
+            continue;
+        }
+        if (!evaluate(shard, slot, quote, hhmmss)) {
+            ++i;
+            continue;
         }
+
+        TriggerEvent ev;
+        ev.order = order;
+        ev.quote = quote;
+        ev.instrument = slot.instrument;
+
+        // 队列满 (执行线程卡住) 时保留在簿中，下一笔 Tick 重试
+        if (!trigger_queue_->push(ev)) break;
+
+        // Remove triggered order (同组其余条件单由调用方释放分片锁后撤销)
+        if (order.oco_group != 0) fired_groups_.push_back(order.oco_group);
+        eraseOrder(index);
+        triggered = true;
+    }
+    return triggered;
+}
+
+bool ConditionEngine::evaluate(Shard& shard, Slot& slot, const Quote& quote, int hhmmss) {
+    ConditionOrderRequest& order = slot.order;
+    if (!inTimeWindow(order, hhmmss)) return false;
+
+    switch (order.condition_type) {
+        case ConditionType::Price: {
+            double price = sourcePrice(quote, order.price_source);
+            return price > 0 && checkCondition(price, order);
+        }
+        case ConditionType::TrailingStop: {
+            double price = sourcePrice(quote, order.price_source);
+            if (price <= 0 || order.trail_distance <= 0) return false;
+            if (order.direction == THOST_FTDC_D_Sell) {
+                // 卖出止损 (保护多头): 跟踪最高价，回落 trail_distance 触发
+                if (order.extreme_price <= 0 || price > order.extreme_price) {
+                    order.extreme_price = price;
+                    order.trigger_price = price - order.trail_distance;
+                    shard.trail_dirty.insert(order.request_id);
+                }
+                return price <= order.trigger_price;
+            }
+            // 买入止损 (保护空头): 跟踪最低价，反弹 trail_distance 触发
+            if (order.extreme_price <= 0 || price < order.extreme_price) {
+                order.extreme_price = price;
+                order.trigger_price = price + order.trail_distance;
+                shard.trail_dirty.insert(order.request_id);
+            }
+            return price >= order.trigger_price;
+        }
+        case ConditionType::Spread: {
+            auto it = quotes_.find(slot.leg2);
+            if (it == quotes_.end()) return false;
+            double p1 = sourcePrice(quote, order.price_source);
+            double p2 = sourcePrice(it->second, order.price_source);
+            if (p1 <= 0 || p2 <= 0) return false;
+            return checkCondition(p1 - p2, order);
+        }
+        default:
+            return false;
+    }
+}
+
+double ConditionEngine::sourcePrice(const Quote& q, PriceSource source) {
+    // MdHandler 已将无效价 (DBL_MAX) 清洗为 0
+    auto valid = [](double p) { return p > 0.0001; };
+    switch (source) {
+        case PriceSource::Bid:
+            return valid(q.bid_price1) ? q.bid_price1 : 0.0;
+        case PriceSource::Ask:
+            return valid(q.ask_price1) ? q.ask_price1 : 0.0;
+        case PriceSource::Mid:
+            return (valid(q.bid_price1) && valid(q.ask_price1)) ? (q.bid_price1 + q.ask_price1) / 2 : 0.0;
+        case PriceSource::Last:
+        default:
+            return valid(q.last_price) ? q.last_price : 0.0;
+    }
+}
+
+bool ConditionEngine::inTimeWindow(const ConditionOrderRequest& order, int hhmmss) {
+    if (order.start_time == order.end_time) return true;
+    if (order.start_time < order.end_time) {
+        return hhmmss >= order.start_time && hhmmss < order.end_time;
+    }
+    // 跨午夜 (如 21:00 - 02:30)
+    return hhmmss >= order.start_time || hhmmss < order.end_time;
+}
+
+void ConditionEngine::eraseOrder(uint32_t slot_index) {
+    Slot& slot = slotAt(slot_index);
+    const ConditionOrderRequest& order = slot.order;
+
+    // bucket 中与末尾交换后弹出，更新被换位条件单的下标 (同一 bucket，同一分片)
+    OrderBucket& bucket = *slot.bucket;
+    uint32_t last = bucket.back();
+    bucket[slot.bucket_pos] = last;
+    slotAt(last).bucket_pos = slot.bucket_pos;
+    bucket.pop_back();
+    shardOf(slot.instrument).trail_dirty.erase(order.request_id);
+
+    if (slot.leg2 != kInvalidInstrument) {
+        std::lock_guard<std::mutex> spread_lock(spread_mtx_);
+        auto link_it = spread_links_.find(slot.leg2);
+        if (link_it != spread_links_.end()) {
+            auto leg_it = link_it->second.find(slot.instrument);
+            if (leg_it != link_it->second.end() && --leg_it->second <= 0) link_it->second.erase(leg_it);
+            if (link_it->second.empty()) spread_links_.erase(link_it);
+        }
+        spread_count_.fetch_sub(1, std::memory_order_relaxed);
+    }
+    {
+        std::lock_guard<std::mutex> index_lock(index_mtx_);
+        if (order.oco_group != 0) {
+            auto group_it = oco_groups_.find(order.oco_group);
+            if (group_it != oco_groups_.end()) {
+                auto& members = group_it->second;
+                members.erase(std::remove(members.begin(), members.end(), slot_index), members.end());
+                if (members.empty()) oco_groups_.erase(group_it);
+            }
+        }
+        id_index_.erase(order.request_id);
+
+        // 释放槽位: 代数 +1 使旧 id 失效；代数用尽的槽位不再复用，保证本次运行内 id 不重复
+        slot.bucket = nullptr;
+        if (++slot.generation < (1u << kGenBits)) free_slots_.push_back(slot_index);
+    }
+    pending_count_.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void ConditionEngine::cancelOcoSiblings() {
+    for (uint64_t group : fired_groups_) {
+        // 组内成员可能分布在不同分片: 先拷出 (id, 合约)，再逐个加所属分片锁撤销
+        std::vector<std::pair<uint64_t, InstrumentId>> members;
+        {
+            std::lock_guard<std::mutex> index_lock(index_mtx_);
+            auto it = oco_groups_.find(group);
+            if (it == oco_groups_.end()) continue;
+            for (uint32_t i : it->second) members.emplace_back(slotAt(i).order.request_id, slotAt(i).instrument);
+        }
+        for (const auto& [request_id, instrument] : members) {
+            ConditionOrderRequest o;
+            {
+                std::lock_guard<std::mutex> lock(shardOf(instrument).mtx);
+                uint32_t index;
+                {
+                    std::lock_guard<std::mutex> index_lock(index_mtx_);
+                    index = findSlot(request_id);
+                }
+                if (index == kNoSlot) continue; // 期间已被撤销
+                o = slotAt(index).order;
+                o.status = 2; // Cancelled
+                eraseOrder(index);
+            }
+            std::lock_guard<std::mutex> index_lock(index_mtx_);
+            oco_cancelled_.push_back(o);
+        }
+    }
+    fired_groups_.clear();
+    has_cancels_.store(true, std::memory_order_release);
+}
+
+void ConditionEngine::executionLoop() {
+    std::cout << "[ConditionEngine] Execution thread started." << std::endl;
+    ThreadRoles::instance().apply("condition");
+    const bool busy_poll = ThreadRoles::instance().busyPoll("condition");
+    TriggerEvent ev;
+    auto last_trail_flush = std::chrono::steady_clock::now();
+    while (running_) {
+        bool worked = false;
+        while (trigger_queue_->pop(ev)) {
+            executeOrder(ev);
+            worked = true;
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        bool trail_due = now - last_trail_flush >= kTrailFlushInterval;
+        if (trail_due) last_trail_flush = now;
+        flushDeferred(trail_due);
+        if (worked) continue;
+        if (busy_poll) {
+            cpuRelax();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(wake_mtx_);
+        exec_sleeping_.store(true);
+        // 与 onTick 中的屏障配对
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        // 置位后再检查一次: 生产者要么看到 sleeping 并通知，要么其 push 在此可见
+        wake_cv_.wait_for(lock, std::chrono::milliseconds(100),
+                          [this] { return !trigger_queue_->empty() || !running_; });
+        exec_sleeping_.store(false);
+    }
+
+    // 退出前把已触发的执行完，避免丢单
+    while (trigger_queue_->pop(ev)) executeOrder(ev);
+    flushDeferred(true);
+}
+
+void ConditionEngine::flushDeferred(bool include_trailing) {
+    if (!include_trailing && !has_cancels_.load(std::memory_order_acquire)) return;
+
+    std::vector<ConditionOrderRequest> cancelled;
+    std::vector<ConditionOrderRequest> trailing;
+    {
+        std::lock_guard<std::mutex> index_lock(index_mtx_);
+        cancelled.swap(oco_cancelled_);
+        has_cancels_.store(false, std::memory_order_relaxed);
+    }
+    if (include_trailing) {
+        for (auto& shard : shards_) {
+            std::lock_guard<std::mutex> lock(shard.mtx);
+            if (shard.trail_dirty.empty()) continue;
+            std::lock_guard<std::mutex> index_lock(index_mtx_);
+            for (uint64_t id : shard.trail_dirty) {
+                uint32_t index = findSlot(id);
+                if (index != kNoSlot) trailing.push_back(slotAt(index).order);
+            }
+            shard.trail_dirty.clear();
+        }
+    }
+
+    for (const auto& o : cancelled) {
+        LOG_INFO("ConditionEngine", "OCO cancelled {} (group {})", o.request_id, o.oco_group);
+        DBManager::instance().updateConditionOrderStatus(o.request_id, 2);
+        if (status_callback_) status_callback_(o);
+    }
+    // 止损价移动: 落库 (重启后继续跟踪) 并推送给前端
+    for (const auto& o : trailing) {
+        DBManager::instance().saveConditionOrder(o);
+        if (status_callback_) status_callback_(o);
     }
 }
 
@@ -145,12 +536,11 @@ bool ConditionEngine::checkCondition(double last_price, const ConditionOrderRequ
     }
 }
 
-void ConditionEngine::executeOrder(ConditionOrderRequest& order, const CThostFtdcDepthMarketDataField* pDepthData) {
-    if (!pDepthData) return;
-    double last_price = pDepthData->LastPrice;
+void ConditionEngine::executeOrder(TriggerEvent& ev) {
+    ConditionOrderRequest& order = ev.order;
+    double last_price = ev.quote.last_price;
 
-    std::cout << "[ConditionEngine] Triggered! " << order.instrument_id 
-              << " Last: " << last_price << " Trigger: " << order.trigger_price << std::endl;
+    LOG_INFO("ConditionEngine", "Triggered! {} Last: {} Trigger: {}", order.instrument_id, last_price, order.trigger_price);
 
     // Update status and persist
     order.status = 1; // Triggered
@@ -160,11 +550,7 @@ void ConditionEngine::executeOrder(ConditionOrderRequest& order, const CThostFtd
     if (status_callback_) status_callback_(order);
     
     // 1. Get PriceTick
-    InstrumentMeta instr_data;
-    double price_tick = 1.0; 
-    if (trader_.getInstrumentMeta(order.instrument_id, instr_data)) {
-        price_tick = instr_data.price_tick;
-    }
+    double price_tick = InstrumentCache::instance().priceTick(ev.instrument);
     if (price_tick < 1e-6) price_tick = 1.0; // Fallback
 
     // 2. Calculate Base Price
@@ -177,20 +563,20 @@ void ConditionEngine::executeOrder(ConditionOrderRequest& order, const CThostFtd
         base_price = last_price;
     } else if (order.price_type == '2') { // Opponent
         if (order.direction == THOST_FTDC_D_Buy) {
-            // Helper: check if AskPrice1 is valid (usually < very big number)
-            if (pDepthData->AskPrice1 < 1e16 && pDepthData->AskPrice1 > 0.0001) 
-                 base_price = pDepthData->AskPrice1;
+            // 无效价已在行情规整阶段置 0
+            if (ev.quote.ask_price1 > 0.0001) 
+                 base_price = ev.quote.ask_price1;
             else base_price = last_price;
         } else {
-             if (pDepthData->BidPrice1 < 1e16 && pDepthData->BidPrice1 > 0.0001) 
-                 base_price = pDepthData->BidPrice1;
+             if (ev.quote.bid_price1 > 0.0001) 
+                 base_price = ev.quote.bid_price1;
              else base_price = last_price;
         }
     } else if (order.price_type == '3') { // Market
         if (order.direction == THOST_FTDC_D_Buy) {
-            base_price = pDepthData->UpperLimitPrice;
+            base_price = ev.quote.upper_limit_price;
         } else {
-            base_price = pDepthData->LowerLimitPrice;
+            base_price = ev.quote.lower_limit_price;
         }
     } else {
         // Fallback default
@@ -205,12 +591,8 @@ void ConditionEngine::executeOrder(ConditionOrderRequest& order, const CThostFtd
         base_price += (order.tick_offset * price_tick);
     }
 
-    std::cout << "[ConditionEngine] Executing: " << order.instrument_id 
-              << " PriceType:" << order.price_type 
-              << " Base:" << base_price 
-              << " Vol:" << order.volume 
-              << " Flag:" << order.offset_flag
-              << " Tick:" << price_tick << std::endl;
+    LOG_INFO("ConditionEngine", "Executing: {} PriceType:{} Base:{} Vol:{} Flag:{} Tick:{}",
+             order.instrument_id, order.price_type, base_price, order.volume, order.offset_flag, price_tick);
 
     // 4. Send Order (带 strategy_id)
     trader_.insertOrder(order.instrument_id, base_price, order.volume, order.direction, order.offset_flag, '2', order.strategy_id);
@@ -0,0 +1,633 @@
+#include "strategy/StrategyHost.h"
+#include "api/TraderHandler.h"
+#include "market/InstrumentCache.h"
+#include "utils/ThreadRoles.h"
+#include <nlohmann/json.hpp>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <set>
+#include <thread>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <dlfcn.h>
+#endif
+
+namespace QuantLabs {
+
+namespace {
+
+using AbiVersionFn = int (*)();
+using CreateFn = IStrategy* (*)();
+using DestroyFn = void (*)(IStrategy*);
+
+void* openLibrary(const std::string& path, std::string& err) {
+#ifdef _WIN32
+    HMODULE h = ::LoadLibraryA(path.c_str());
+    if (!h) err = "LoadLibrary failed: " + std::to_string(::GetLastError());
+    return reinterpret_cast<void*>(h);
+#else
+    void* h = ::dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+    if (!h) err = ::dlerror();
+    return h;
+#endif
+}
+
+void* findSymbol(void* lib, const char* name) {
+#ifdef _WIN32
+    return reinterpret_cast<void*>(::GetProcAddress(reinterpret_cast<HMODULE>(lib), name));
+#else
+    return ::dlsym(lib, name);
+#endif
+}
+
+void closeLibrary(void* lib) {
+    if (!lib) return;
+#ifdef _WIN32
+    ::FreeLibrary(reinterpret_cast<HMODULE>(lib));
+#else
+    ::dlclose(lib);
+#endif
+}
+
+// 行情线程 -> 策略线程
+struct MarketEvent {
+    enum Kind : uint8_t { Tick, Bar } kind;
+    union {
+        TickData tick;
+        BarData bar;
+    };
+};
+
+// 交易线程 -> 策略线程
+struct ReturnEvent {
+    enum Kind : uint8_t { Order, Trade } kind;
+    union {
+        CThostFtdcOrderField order;
+        CThostFtdcTradeField trade;
+    };
+};
+
+constexpr size_t kMarketQueueSize = 4096;
+constexpr size_t kReturnQueueSize = 1024;
+// 策略线程每轮最多处理的行情条数，之后先处理回报/控制
+constexpr int kMarketBatch = 256;
+
+} // namespace
+
+/**
+ * @brief 单个策略: 动态库句柄 + 策略实例 + 工作线程与入队队列
+ */
+class StrategyHost::Runner : public IStrategyContext {
+public:
+    Runner(StrategyHost& host, StrategyDef def, TraderHandler& td)
+        : host_(host), def_(std::move(def)), td_(td),
+          market_queue_(std::make_unique<SpscQueue<MarketEvent, kMarketQueueSize>>()),
+          return_queue_(std::make_unique<SpscQueue<ReturnEvent, kReturnQueueSize>>()) {
+        if (def_.account_id.empty()) def_.account_id = td_.accountId();
+        try {
+            auto params = nlohmann::json::parse(def_.parameters.empty() ? "{}" : def_.parameters);
+            if (params.is_object()) cpu_ = params.value("cpu", -1);
+        } catch (const std::exception&) {
+            // 参数非 JSON 时原样交给策略
+        }
+    }
+
+    ~Runner() override {
+        stop();
+        if (strategy_) destroy_(strategy_);
+        closeLibrary(lib_);
+    }
+
+    bool load(std::string& err) {
+        lib_ = openLibrary(def_.library_path, err);
+        if (!lib_) return false;
+
+        auto abi = reinterpret_cast<AbiVersionFn>(findSymbol(lib_, "atrader_strategy_abi_version"));
+        auto create = reinterpret_cast<CreateFn>(findSymbol(lib_, "atrader_create_strategy"));
+        destroy_ = reinterpret_cast<DestroyFn>(findSymbol(lib_, "atrader_destroy_strategy"));
+        if (!abi || !create || !destroy_) {
+            err = "missing ATRADER_EXPORT_STRATEGY entry points";
+            return false;
+        }
+        if (abi() != ATRADER_STRATEGY_ABI_VERSION) {
+            err = "ABI version mismatch: " + std::to_string(abi());
+            return false;
+        }
+        strategy_ = create();
+        if (!strategy_) {
+            err = "atrader_create_strategy returned null";
+            return false;
+        }
+        return true;
+    }
+
+    void start() {
+        if (running_) return;
+        if (thread_.joinable()) thread_.join(); // 出错退出的旧线程
+        // Stop 时路由已摘除，重新启动需恢复此前的全部订阅 (首次启动为空，由 onInit 订阅)
+        std::vector<std::string> symbols;
+        {
+            std::lock_guard<std::mutex> lock(subs_mtx_);
+            symbols.assign(subscriptions_.begin(), subscriptions_.end());
+        }
+        for (const auto& s : symbols) host_.addRoute(this, s);
+        running_ = true;
+        thread_ = std::thread(&Runner::loop, this);
+    }
+
+    void stop() {
+        if (!running_ && !thread_.joinable()) return;
+        running_ = false;
+        {
+            std::lock_guard<std::mutex> lock(wake_mtx_);
+            wake_cv_.notify_one();
+        }
+        if (thread_.joinable()) thread_.join();
+    }
+
+    bool isRunning() const { return running_; }
+    int status() const { return status_.load(); }
+
+    void postParams(const std::string& params) {
+        {
+            std::lock_guard<std::mutex> lock(wake_mtx_);
+            pending_params_.push_back(params);
+            def_params_ = params;
+        }
+        wake_cv_.notify_one();
+    }
+
+    // 行情线程
+    void pushTick(const TickData& tick) {
+        if (!running_) return;
+        MarketEvent ev;
+        ev.kind = MarketEvent::Tick;
+        ev.tick = tick;
+        pushMarket(ev);
+    }
+
+    void pushBar(const BarData& bar) {
+        if (!running_) return;
+        MarketEvent ev;
+        ev.kind = MarketEvent::Bar;
+        ev.bar = bar;
+        pushMarket(ev);
+    }
+
+    // 账户交易线程
+    void pushOrder(const CThostFtdcOrderField& order) {
+        if (!running_) return;
+        ReturnEvent ev;
+        ev.kind = ReturnEvent::Order;
+        ev.order = order;
+        pushReturn(ev);
+    }
+
+    void pushTrade(const CThostFtdcTradeField& trade) {
+        if (!running_) return;
+        ReturnEvent ev;
+        ev.kind = ReturnEvent::Trade;
+        ev.trade = trade;
+        pushReturn(ev);
+    }
+
+    // --- IStrategyContext ---
+    int sendOrder(const std::string& instrument, double price, int volume,
+                  char direction, char offset, char price_type) override {
+        return td_.insertOrder(instrument, price, volume, direction, offset, price_type, def_.strategy_id);
+    }
+
+    int cancelOrder(const CThostFtdcOrderField& order) override {
+        return td_.cancelOrder(order.InstrumentID, order.OrderSysID, order.OrderRef,
+                               order.ExchangeID, order.FrontID, order.SessionID);
+    }
+
+    void subscribe(const std::string& instrument) override {
+        {
+            std::lock_guard<std::mutex> lock(subs_mtx_);
+            subscriptions_.insert(instrument);
+        }
+        host_.addRoute(this, instrument);
+    }
+
+    bool getInstrument(const std::string& instrument, InstrumentMeta& out) override {
+        return InstrumentCache::instance().get(instrument, out);
+    }
+
+    const std::string& strategyId() const override { return def_.strategy_id; }
+    const std::string& accountId() const override { return def_.account_id; }
+
+    void log(const std::string& msg) override {
+        std::cout << "[Strategy:" << def_.strategy_id << "] " << msg << std::endl;
+    }
+
+    const StrategyDef& def() const { return def_; }
+
+private:
+    void pushMarket(const MarketEvent& ev) {
+        if (!market_queue_->push(ev)) {
+            // 策略处理不过来: 丢弃，不拖慢行情线程
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        // 入队 (release) 与读 sleeping_ 之间的 StoreLoad 屏障，与 loop() 中的屏障配对
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (sleeping_.load()) {
+            std::lock_guard<std::mutex> lock(wake_mtx_);
+            wake_cv_.notify_one();
+        }
+    }
+
+    void pushReturn(const ReturnEvent& ev) {
+        // 回报不能丢，也不能阻塞交易线程: 队列满时转入溢出队列。
+        // 溢出队列非空期间后续回报也进溢出队列，保证顺序
+        if (return_overflow_pending_.load(std::memory_order_acquire) || !return_queue_->push(ev)) {
+            std::lock_guard<std::mutex> lock(overflow_mtx_);
+            if (return_overflow_.empty()) {
+                std::cerr << "[Strategy:" << def_.strategy_id << "] Return queue full, spilling to overflow" << std::endl;
+            }
+            return_overflow_.push_back(ev);
+            return_overflow_pending_.store(true, std::memory_order_release);
+        }
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (sleeping_.load()) {
+            std::lock_guard<std::mutex> lock(wake_mtx_);
+            wake_cv_.notify_one();
+        }
+    }
+
+    void setStatus(int status, const std::string& msg) {
+        status_ = status;
+        host_.reportStatus(def_.strategy_id, status, msg);
+    }
+
+    void pinThread() {
+        ThreadRoles::instance().apply("strategy", "st:" + def_.strategy_id);
+        // 参数里的 cpu 优先于角色配置
+        if (cpu_ >= 0 && !ThreadRoles::pin({cpu_})) {
+            std::cerr << "[Strategy:" << def_.strategy_id << "] Failed to pin to CPU " << cpu_ << std::endl;
+        }
+    }
+
+    // 返回是否处理了事件
+    bool drainOnce() {
+        bool worked = false;
+
+        std::deque<std::string> params;
+        {
+            std::lock_guard<std::mutex> lock(wake_mtx_);
+            params.swap(pending_params_);
+        }
+        for (const auto& p : params) {
+            strategy_->onParams(p);
+            worked = true;
+        }
+
+        // 先处理回报，保证策略看到下一笔行情时委托状态已更新
+        if (drainReturns()) worked = true;
+
+        MarketEvent mev;
+        for (int n = 0; n < kMarketBatch && market_queue_->pop(mev); ++n) {
+            if (mev.kind == MarketEvent::Tick) strategy_->onTick(mev.tick);
+            else strategy_->onBar(mev.bar);
+            worked = true;
+        }
+        return worked;
+    }
+
+    void dispatchReturn(const ReturnEvent& ev) {
+        if (ev.kind == ReturnEvent::Order) strategy_->onOrder(ev.order);
+        else strategy_->onTrade(ev.trade);
+    }
+
+    // 先取无锁队列，再取溢出队列: 溢出期间的回报都晚于无锁队列中已有的
+    bool drainReturns() {
+        bool worked = false;
+        ReturnEvent rev;
+        while (return_queue_->pop(rev)) {
+            dispatchReturn(rev);
+            worked = true;
+        }
+        if (!return_overflow_pending_.load(std::memory_order_acquire)) return worked;
+
+        std::deque<ReturnEvent> overflow;
+        {
+            std::lock_guard<std::mutex> lock(overflow_mtx_);
+            overflow.swap(return_overflow_);
+            return_overflow_pending_.store(false, std::memory_order_release);
+        }
+        for (const auto& ev : overflow) dispatchReturn(ev);
+        return worked || !overflow.empty();
+    }
+
+    void loop() {
+        pinThread();
+        try {
+            if (!initialized_) {
+                std::string params;
+                {
+                    std::lock_guard<std::mutex> lock(wake_mtx_);
+                    params = def_params_.empty() ? def_.parameters : def_params_;
+                    pending_params_.clear(); // onInit 已带最新参数
+                }
+                if (!def_.instrument_id.empty()) subscribe(def_.instrument_id);
+                strategy_->onInit(*this, params);
+                initialized_ = true;
+            }
+            strategy_->onStart();
+            setStatus(kRunning, "running");
+
+            const bool busy_poll = ThreadRoles::instance().busyPoll("strategy");
+            while (running_) {
+                if (drainOnce()) continue;
+                if (busy_poll) {
+                    cpuRelax();
+                    continue;
+                }
+
+                std::unique_lock<std::mutex> lock(wake_mtx_);
+                sleeping_.store(true);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                // 置位后再检查一次: 生产者要么看到 sleeping 并通知，要么其 push 在此可见
+                wake_cv_.wait_for(lock, std::chrono::milliseconds(100), [this] {
+                    return !market_queue_->empty() || !return_queue_->empty() ||
+                           return_overflow_pending_.load() || !pending_params_.empty() || !running_;
+                });
+                sleeping_.store(false);
+            }
+
+            // 停止前把已到达的回报交给策略，行情直接丢弃
+            drainReturns();
+            MarketEvent mev;
+            while (market_queue_->pop(mev)) {}
+            if (uint64_t dropped = dropped_.exchange(0)) {
+                std::cerr << "[Strategy:" << def_.strategy_id << "] Dropped " << dropped << " market events (queue full)" << std::endl;
+            }
+
+            strategy_->onStop();
+            setStatus(kStopped, "stopped");
+        } catch (const std::exception& e) {
+            running_ = false;
+            std::cerr << "[Strategy:" << def_.strategy_id << "] Exception: " << e.what() << std::endl;
+            setStatus(kError, e.what());
+        } catch (...) {
+            running_ = false;
+            std::cerr << "[Strategy:" << def_.strategy_id << "] Unknown exception" << std::endl;
+            setStatus(kError, "unknown exception");
+        }
+    }
+
+    StrategyHost& host_;
+    StrategyDef def_;
+    TraderHandler& td_;
+    int cpu_ = -1;
+
+    void* lib_ = nullptr;
+    DestroyFn destroy_ = nullptr;
+    IStrategy* strategy_ = nullptr;
+    bool initialized_ = false; // 只在策略线程访问 (start/stop 之间串行)
+
+    std::unique_ptr<SpscQueue<MarketEvent, kMarketQueueSize>> market_queue_;
+    std::unique_ptr<SpscQueue<ReturnEvent, kReturnQueueSize>> return_queue_;
+    std::atomic<uint64_t> dropped_{0};
+
+    std::mutex overflow_mtx_;
+    std::deque<ReturnEvent> return_overflow_; // 回报队列满时的无界后备
+    std::atomic<bool> return_overflow_pending_{false};
+
+    std::mutex subs_mtx_;
+    std::set<std::string> subscriptions_; // 策略订阅过的合约，重新启动时恢复路由
+
+    std::mutex wake_mtx_; // 同时保护 pending_params_ / def_params_
+    std::condition_variable wake_cv_;
+    std::deque<std::string> pending_params_;
+    std::string def_params_; // 最近一次 UpdateParams，重新启动时作为 onInit 参数
+    std::atomic<bool> sleeping_{false};
+    std::atomic<bool> running_{false};
+    std::atomic<int> status_{kStopped};
+    std::thread thread_;
+};
+
+StrategyHost::StrategyHost(AccountResolver resolve_account, SubscribeFn subscribe)
+    : resolve_account_(std::move(resolve_account)), subscribe_(std::move(subscribe)) {}
+
+StrategyHost::~StrategyHost() {
+    stopAll();
+    unloadAll();
+}
+
+void StrategyHost::loadFromDB() {
+    std::lock_guard<std::mutex> control_lock(control_mtx_);
+    loadDefs();
+}
+
+void StrategyHost::loadDefs() {
+    auto defs = DBManager::instance().loadStrategyDefs();
+    int started = 0;
+    for (const auto& def : defs) {
+        if (findRunner(def.strategy_id)) continue;
+        if (def.status != kRunning) continue; // 其余等待 Start 指令时再加载
+        std::string err;
+        if (startRunner(def, err)) {
+            ++started;
+        } else {
+            std::cerr << "[StrategyHost] Failed to start " << def.strategy_id << ": " << err << std::endl;
+            reportStatus(def.strategy_id, kError, err);
+        }
+    }
+    std::cout << "[StrategyHost] " << defs.size() << " in-process strategies, " << started << " started." << std::endl;
+}
+
+bool StrategyHost::startRunner(const StrategyDef& def, std::string& err) {
+    TraderHandler* td = resolve_account_(def.account_id);
+    if (!td) {
+        err = "unknown account: " + def.account_id;
+        return false;
+    }
+    auto runner = std::make_shared<Runner>(*this, def, *td);
+    if (!runner->load(err)) return false;
+
+    Runner* r = runner.get();
+    {
+        std::unique_lock<std::shared_mutex> lock(routes_mtx_);
+        runners_[def.strategy_id] = std::move(runner);
+    }
+    r->start();
+    std::cout << "[StrategyHost] Started " << def.strategy_id << " (" << def.library_path
+              << ", account " << r->accountId() << ")" << std::endl;
+    return true;
+}
+
+bool StrategyHost::control(const StrategyControl& ctl, std::string& err) {
+    std::lock_guard<std::mutex> control_lock(control_mtx_);
+    std::string id(ctl.strategy_id, strnlen(ctl.strategy_id, sizeof(ctl.strategy_id)));
+
+    switch (ctl.type) {
+    case StrategyCommandType::Start: {
+        if (Runner* r = findRunner(id)) {
+            r->start();
+            return true;
+        }
+        // 未加载: 从数据库取定义
+        for (const auto& def : DBManager::instance().loadStrategyDefs()) {
+            if (def.strategy_id != id) continue;
+            if (!startRunner(def, err)) {
+                reportStatus(id, kError, err);
+                return false;
+            }
+            return true;
+        }
+        err = "strategy not found or has no library_path";
+        return false;
+    }
+    case StrategyCommandType::Stop: {
+        Runner* r = findRunner(id);
+        if (!r) {
+            err = "strategy not loaded";
+            return false;
+        }
+        // 先停线程再摘路由: 策略在 onStop 中的订阅也会被清掉
+        r->stop();
+        removeRoutes(r);
+        return true;
+    }
+    case StrategyCommandType::UpdateParams: {
+        Runner* r = findRunner(id);
+        if (!r) {
+            err = "strategy not loaded";
+            return false;
+        }
+        r->postParams(std::string(ctl.json_payload, strnlen(ctl.json_payload, sizeof(ctl.json_payload))));
+        return true;
+    }
+    case StrategyCommandType::Reload:
+        stopAll();
+        unloadAll();
+        loadDefs();
+        return true;
+    default:
+        err = "unknown command type";
+        return false;
+    }
+}
+
+void StrategyHost::stopAll() {
+    std::vector<Runner*> list;
+    {
+        std::shared_lock<std::shared_mutex> lock(routes_mtx_);
+        for (auto& kv : runners_) list.push_back(kv.second.get());
+    }
+    // runners_ 只在持有 control_mtx_ 或析构时修改，这里的指针在停止期间有效
+    for (Runner* r : list) {
+        r->stop();
+        removeRoutes(r);
+    }
+}
+
+void StrategyHost::unloadAll() {
+    std::unordered_map<std::string, std::shared_ptr<Runner>> old;
+    {
+        std::unique_lock<std::shared_mutex> lock(routes_mtx_);
+        old.swap(runners_);
+        routes_.clear();
+        has_routes_ = false;
+    }
+    old.clear(); // 出锁后释放: 交易线程不再持有时销毁策略实例并卸载动态库
+}
+
+std::vector<std::pair<std::string, int>> StrategyHost::statuses() {
+    std::vector<std::pair<std::string, int>> out;
+    std::shared_lock<std::shared_mutex> lock(routes_mtx_);
+    for (auto& kv : runners_) out.emplace_back(kv.first, kv.second->status());
+    return out;
+}
+
+StrategyHost::Runner* StrategyHost::findRunner(const std::string& strategy_id) {
+    std::shared_lock<std::shared_mutex> lock(routes_mtx_);
+    auto it = runners_.find(strategy_id);
+    return it != runners_.end() ? it->second.get() : nullptr;
+}
+
+void StrategyHost::addRoute(Runner* runner, const std::string& instrument) {
+    const InstrumentId handle = InstrumentCache::instance().intern(instrument);
+    if (handle == kInvalidInstrument) {
+        std::cerr << "[StrategyHost] Cannot route invalid instrument " << instrument << std::endl;
+        return;
+    }
+    bool first = false;
+    {
+        std::unique_lock<std::shared_mutex> lock(routes_mtx_);
+        auto& list = routes_[handle];
+        if (std::find(list.begin(), list.end(), runner) != list.end()) return;
+        first = list.empty();
+        list.push_back(runner);
+        has_routes_ = true;
+    }
+    // 首个订阅该合约的策略负责向行情前置订阅
+    if (first && subscribe_) subscribe_(instrument);
+}
+
+void StrategyHost::removeRoutes(Runner* runner) {
+    std::unique_lock<std::shared_mutex> lock(routes_mtx_);
+    for (auto it = routes_.begin(); it != routes_.end();) {
+        auto& list = it->second;
+        list.erase(std::remove(list.begin(), list.end(), runner), list.end());
+        if (list.empty()) it = routes_.erase(it);
+        else ++it;
+    }
+    has_routes_ = !routes_.empty();
+}
+
+void StrategyHost::reportStatus(const std::string& strategy_id, int status, const std::string& msg) {
+    DBManager::instance().updateStrategyStatus(strategy_id, status, msg);
+    if (status_callback_) status_callback_(strategy_id, status, msg);
+}
+
+void StrategyHost::onTick(const TickData& tick) {
+    if (!has_routes_.load(std::memory_order_relaxed)) return;
+    const InstrumentId handle = InstrumentCache::instance().find(tick.instrument_id);
+    if (handle == kInvalidInstrument) return;
+    std::shared_lock<std::shared_mutex> lock(routes_mtx_);
+    auto it = routes_.find(handle);
+    if (it == routes_.end()) return;
+    for (Runner* r : it->second) r->pushTick(tick);
+}
+
+void StrategyHost::onBar(const BarData& bar) {
+    if (!has_routes_.load(std::memory_order_relaxed)) return;
+    const InstrumentId handle = InstrumentCache::instance().find(bar.instrument_id);
+    if (handle == kInvalidInstrument) return;
+    std::shared_lock<std::shared_mutex> lock(routes_mtx_);
+    auto it = routes_.find(handle);
+    if (it == routes_.end()) return;
+    for (Runner* r : it->second) r->pushBar(bar);
+}
+
+std::shared_ptr<StrategyHost::Runner> StrategyHost::returnTarget(const std::string& account_id, const std::string& strategy_id) {
+    if (strategy_id.empty()) return nullptr;
+    std::shared_lock<std::shared_mutex> lock(routes_mtx_);
+    auto it = runners_.find(strategy_id);
+    // 只接受绑定账户的回报: 每个回报队列只有一个生产者线程
+    if (it == runners_.end() || it->second->accountId() != account_id) return nullptr;
+    return it->second;
+}
+
+// 出锁后入队: 策略回调中的 subscribe() 需要路由写锁
+void StrategyHost::onOrder(const std::string& account_id, const std::string& strategy_id, const CThostFtdcOrderField& order) {
+    if (auto r = returnTarget(account_id, strategy_id)) r->pushOrder(order);
+}
+
+void StrategyHost::onTrade(const std::string& account_id, const std::string& strategy_id, const CThostFtdcTradeField& trade) {
+    if (auto r = returnTarget(account_id, strategy_id)) r->pushTrade(trade);
+}
+
+} // namespace QuantLabs
@@ -0,0 +1,301 @@
+#include "utils/Logger.h"
+#include "utils/ThreadRoles.h"
+#include <algorithm>
+#include <charconv>
+#include <ctime>
+#include <filesystem>
+#include <iostream>
+
+namespace QuantLabs {
+
+namespace {
+
+const char kLevelChar[] = {'D', 'I', 'W', 'E', '-'};
+
+// 解码一个参数追加到 out，返回下一个参数位置
+const char* appendArg(const char* p, std::string& out) {
+    using namespace log_detail;
+    char buf[32];
+    const auto tag = static_cast<ArgTag>(*p++);
+    switch (tag) {
+    case I64: {
+        int64_t v;
+        std::memcpy(&v, p, sizeof(v));
+        out.append(buf, std::to_chars(buf, buf + sizeof(buf), v).ptr);
+        return p + sizeof(v);
+    }
+    case U64: {
+        uint64_t v;
+        std::memcpy(&v, p, sizeof(v));
+        out.append(buf, std::to_chars(buf, buf + sizeof(buf), v).ptr);
+        return p + sizeof(v);
+    }
+    case F64: {
+        double v;
+        std::memcpy(&v, p, sizeof(v));
+        int n = std::snprintf(buf, sizeof(buf), "%.10g", v);
+        out.append(buf, n > 0 ? static_cast<size_t>(n) : 0);
+        return p + sizeof(v);
+    }
+    case Char:
+        out.push_back(*p);
+        return p + 1;
+    case Bool:
+        out.append(*p ? "true" : "false");
+        return p + 1;
+    case Str: {
+        uint16_t len;
+        std::memcpy(&len, p, 2);
+        out.append(p + 2, len);
+        return p + 2 + len;
+    }
+    }
+    return p;
+}
+
+} // namespace
+
+Logger::~Logger() {
+    stop();
+}
+
+LogLevel Logger::parseLevel(const std::string& name) {
+    if (name == "debug") return LogLevel::Debug;
+    if (name == "warn") return LogLevel::Warn;
+    if (name == "error") return LogLevel::Error;
+    if (name == "off") return LogLevel::Off;
+    return LogLevel::Info;
+}
+
+void Logger::start(const nlohmann::json& config) {
+    if (running_) return;
+    if (config.is_object()) {
+        setLevel(parseLevel(config.value("level", std::string("info"))));
+        console_ = config.value("console", true);
+        path_ = config.value("path", std::string());
+        max_size_ = static_cast<size_t>(std::max(1, config.value("max_size_mb", 64))) << 20;
+        max_files_ = std::max(0, config.value("max_files", 5));
+    }
+    if (!path_.empty() && !openFile()) {
+        std::cerr << "[Logger] Cannot open " << path_ << ", console only" << std::endl;
+        path_.clear();
+    }
+
+    calibrate();
+    batch_.reserve(kThreadQueueSize * 4);
+    line_.reserve(512);
+    running_ = true;
+    thread_ = std::thread(&Logger::run, this);
+    std::cout << "[Logger] Started. level=" << kLevelChar[level_.load()]
+              << " file=" << (path_.empty() ? "-" : path_) << std::endl;
+}
+
+void Logger::stop() {
+    if (!running_.exchange(false)) return;
+    wake_cv_.notify_all();
+    if (thread_.joinable()) thread_.join();
+    if (file_) {
+        std::fclose(file_);
+        file_ = nullptr;
+    }
+}
+
+Logger::ThreadBuffer* Logger::registerThread() {
+    // 线程退出时只标记，缓冲由后台线程写完后回收
+    struct Holder {
+        std::shared_ptr<ThreadBuffer> buf;
+        ~Holder() {
+            if (buf) buf->alive.store(false, std::memory_order_release);
+            tls_buffer_ = nullptr;
+        }
+    };
+    thread_local Holder holder;
+    holder.buf = std::make_shared<ThreadBuffer>();
+    {
+        Logger& self = instance();
+        std::lock_guard<std::mutex> lock(self.buffers_mtx_);
+        self.buffers_.push_back(holder.buf);
+    }
+    tls_buffer_ = holder.buf.get();
+    return tls_buffer_;
+}
+
+// 用墙上时间标定 TSC 频率；锚点取启动时刻，基线越长越准
+void Logger::calibrate() {
+#ifdef ATRADER_LOG_TSC
+    int64_t s = stamp();
+    int64_t w = wallNanos();
+    if (wall0_ == 0) {
+        stamp0_ = s;
+        wall0_ = w;
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        s = stamp();
+        w = wallNanos();
+    }
+    if (s > stamp0_) ns_per_tick_ = static_cast<double>(w - wall0_) / static_cast<double>(s - stamp0_);
+    next_calibrate_ = s + static_cast<int64_t>(10e9 / ns_per_tick_); // 10 秒后再标定
+#endif
+}
+
+int64_t Logger::toWallNanos(int64_t s) const {
+#ifdef ATRADER_LOG_TSC
+    return wall0_ + static_cast<int64_t>(static_cast<double>(s - stamp0_) * ns_per_tick_);
+#else
+    return s;
+#endif
+}
+
+void Logger::run() {
+    ThreadRoles::instance().apply("log");
+    while (running_) {
+        if (drain() > 0) continue;
+        std::unique_lock<std::mutex> lock(wake_mtx_);
+        // 生产者不通知 (保持调用开销最小)，后台按固定间隔轮询
+        wake_cv_.wait_for(lock, std::chrono::milliseconds(2), [this] { return !running_; });
+    }
+    drain();
+}
+
+size_t Logger::drain() {
+    batch_.clear();
+    uint64_t dropped = 0;
+    {
+        std::lock_guard<std::mutex> lock(buffers_mtx_);
+        for (auto it = buffers_.begin(); it != buffers_.end();) {
+            ThreadBuffer& buf = **it;
+            // 先读 alive 再取数据: 线程退出前写入的记录一定能在本轮取到
+            bool alive = buf.alive.load(std::memory_order_acquire);
+            LogRecord rec;
+            for (size_t n = 0; n < kThreadQueueSize && buf.queue.pop(rec); ++n) {
+                batch_.push_back(rec);
+            }
+            dropped += buf.dropped.exchange(0, std::memory_order_relaxed);
+            if (!alive && buf.queue.empty()) {
+                it = buffers_.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+    if (batch_.empty() && dropped == 0) return 0;
+
+    // 各线程缓冲内有序，合并后按时间输出
+    std::stable_sort(batch_.begin(), batch_.end(),
+                     [](const LogRecord& a, const LogRecord& b) { return a.stamp < b.stamp; });
+    for (const auto& rec : batch_) {
+        format(rec, line_);
+        output(rec, line_);
+    }
+    if (dropped > 0) {
+        static constexpr LogSite site{LogLevel::Warn, "Logger", "{} log records dropped (thread buffer full)"};
+        LogRecord rec;
+        rec.stamp = stamp();
+        rec.site = &site;
+        log_detail::ArgWriter w{rec.args, rec.args + LogRecord::kArgBytes};
+        log_detail::encode(w, dropped);
+        rec.size = static_cast<uint16_t>(w.p - rec.args);
+        rec.truncated = false;
+        format(rec, line_);
+        output(rec, line_);
+    }
+
+    if (console_) {
+        std::fflush(stdout);
+        std::fflush(stderr);
+    }
+    if (file_) {
+        std::fflush(file_);
+        rotateIfNeeded();
+    }
+#ifdef ATRADER_LOG_TSC
+    if (stamp() >= next_calibrate_) calibrate();
+#endif
+    return batch_.size() + (dropped > 0 ? 1 : 0);
+}
+
+void Logger::format(const LogRecord& rec, std::string& out) {
+    out.clear();
+
+    // 时间前缀按秒缓存: "YYYY-MM-DD HH:MM:SS"
+    const int64_t ns = toWallNanos(rec.stamp);
+    const int64_t sec = ns / 1000000000;
+    if (sec != cached_sec_) {
+        std::time_t t = static_cast<std::time_t>(sec);
+        struct tm tm;
+#ifdef _WIN32
+        localtime_s(&tm, &t);
+#else
+        localtime_r(&t, &tm);
+#endif
+        std::strftime(cached_time_, sizeof(cached_time_), "%Y-%m-%d %H:%M:%S", &tm);
+        cached_sec_ = sec;
+    }
+    char us[16];
+    std::snprintf(us, sizeof(us), ".%06d", static_cast<int>((ns / 1000) % 1000000));
+    out.append(cached_time_).append(us);
+    out.push_back(' ');
+    out.push_back(kLevelChar[static_cast<uint8_t>(rec.site->level)]);
+    out.append(" [").append(rec.site->module).append("] ");
+
+    const char* f = rec.site->fmt;
+    const char* arg = rec.args;
+    const char* arg_end = rec.args + rec.size;
+    while (const char* ph = std::strstr(f, "{}")) {
+        out.append(f, ph - f);
+        if (arg < arg_end) {
+            arg = appendArg(arg, out);
+        } else {
+            out.append(rec.truncated ? "..." : "{}");
+        }
+        f = ph + 2;
+    }
+    out.append(f);
+    if (rec.truncated && arg >= arg_end) out.append(" (truncated)");
+    out.push_back('\n');
+}
+
+void Logger::output(const LogRecord& rec, const std::string& line) {
+    if (console_) {
+        std::fwrite(line.data(), 1, line.size(), rec.site->level >= LogLevel::Warn ? stderr : stdout);
+    }
+    if (file_) {
+        file_size_ += std::fwrite(line.data(), 1, line.size(), file_);
+    }
+}
+
+bool Logger::openFile() {
+    namespace fs = std::filesystem;
+    std::error_code ec;
+    fs::path p(path_);
+    if (p.has_parent_path()) fs::create_directories(p.parent_path(), ec);
+    file_ = std::fopen(path_.c_str(), "ab");
+    if (!file_) return false;
+    std::fseek(file_, 0, SEEK_END);
+    long pos = std::ftell(file_);
+    file_size_ = pos > 0 ? static_cast<size_t>(pos) : 0;
+    return true;
+}
+
+void Logger::rotateIfNeeded() {
+    if (file_size_ < max_size_) return;
+    namespace fs = std::filesystem;
+    std::error_code ec;
+    std::fclose(file_);
+    file_ = nullptr;
+
+    // core.log.N-1 -> core.log.N ... core.log -> core.log.1
+    if (max_files_ > 0) {
+        fs::remove(path_ + "." + std::to_string(max_files_), ec);
+        for (int i = max_files_ - 1; i >= 1; --i) {
+            fs::rename(path_ + "." + std::to_string(i), path_ + "." + std::to_string(i + 1), ec);
+        }
+        fs::rename(path_, path_ + ".1", ec);
+    } else {
+        fs::remove(path_, ec);
+    }
+    if (!openFile()) {
+        std::cerr << "[Logger] Cannot reopen " << path_ << " after rotation" << std::endl;
+    }
+}
+
+} // namespace QuantLabs
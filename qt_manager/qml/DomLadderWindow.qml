@@ -0,0 +1,210 @@
+// qmllint disable import
+import QtQuick
+import QtQuick.Controls
+import QtQuick.Layouts
+
+/**
+ * 价格阶梯 (点价下单) 窗口
+ * 数据来自 OrderController.ladder (固定档位，每笔行情只刷新变化的行)
+ * 左键点买量列下买单、点卖量列下卖单；右键点本方挂单列撤该价位挂单
+ */
+Window {
+    id: ladderWindow
+    width: 420
+    height: 760
+    minimumWidth: 360
+    minimumHeight: 400
+    title: "价格阶梯 - " + (orderController ? orderController.instrumentId : "")
+    color: "#1e1e1e"
+
+    property var orderController: AppOrderController
+    property var ladder: orderController ? orderController.ladder : null
+    property string offset: "OPEN"   // OPEN / CLOSE / CLOSETODAY
+    readonly property int rowHeight: 22
+
+    onClosing: {
+        visible = false
+    }
+
+    function centerOnLast() {
+        if (ladder && ladder.lastRow >= 0) ladderView.positionViewAtIndex(ladder.lastRow, ListView.Center)
+    }
+
+    onVisibleChanged: if (visible) centerOnLast()
+
+    Connections {
+        target: ladderWindow.ladder
+        function onRecentered() { ladderWindow.centerOnLast() }
+    }
+
+    ColumnLayout {
+        anchors.fill: parent
+        spacing: 0
+
+        // 工具栏: 开平选择 + 手数 + 居中
+        Rectangle {
+            Layout.fillWidth: true
+            height: 34
+            color: "#2d2d30"
+
+            RowLayout {
+                anchors.fill: parent
+                anchors.leftMargin: 8
+                anchors.rightMargin: 8
+                spacing: 4
+
+                Repeater {
+                    model: [ { key: "OPEN", text: "开仓" }, { key: "CLOSE", text: "平仓" }, { key: "CLOSETODAY", text: "平今" } ]
+                    delegate: Rectangle {
+                        required property var modelData
+                        readonly property bool active: ladderWindow.offset === modelData.key
+                        width: 46; height: 22
+                        radius: 3
+                        color: active ? "#2c5d87" : "#3a3a3d"
+                        border.color: active ? "#5599cc" : "#555555"
+                        border.width: 1
+
+                        Text {
+                            anchors.centerIn: parent
+                            text: modelData.text
+                            color: parent.active ? "white" : "#aaaaaa"
+                            font.pixelSize: 11
+                        }
+                        MouseArea {
+                            anchors.fill: parent
+                            cursorShape: Qt.PointingHandCursor
+                            onClicked: ladderWindow.offset = modelData.key
+                        }
+                    }
+                }
+
+                Text {
+                    text: "手数 " + (orderController ? orderController.volume : 0)
+                    color: "#cccccc"
+                    font.pixelSize: 11
+                    Layout.leftMargin: 8
+                }
+
+                Item { Layout.fillWidth: true }
+
+                Button {
+                    text: "居中"
+                    implicitHeight: 24
+                    onClicked: {
+                        if (ladder) ladder.recenter()
+                        ladderWindow.centerOnLast()
+                    }
+                }
+            }
+        }
+
+        // 表头
+        Rectangle {
+            Layout.fillWidth: true
+            height: 26
+            color: "#1e1e1e"
+
+            Row {
+                anchors.fill: parent
+                Text { width: parent.width * 0.18; height: parent.height; text: "我的买"; color: "#aaaaaa"; horizontalAlignment: Text.AlignHCenter; verticalAlignment: Text.AlignVCenter }
+                Text { width: parent.width * 0.20; height: parent.height; text: "买量"; color: "#aaaaaa"; horizontalAlignment: Text.AlignHCenter; verticalAlignment: Text.AlignVCenter }
+                Text { width: parent.width * 0.24; height: parent.height; text: "价格"; color: "#aaaaaa"; horizontalAlignment: Text.AlignHCenter; verticalAlignment: Text.AlignVCenter }
+                Text { width: parent.width * 0.20; height: parent.height; text: "卖量"; color: "#aaaaaa"; horizontalAlignment: Text.AlignHCenter; verticalAlignment: Text.AlignVCenter }
+                Text { width: parent.width * 0.18; height: parent.height; text: "我的卖"; color: "#aaaaaa"; horizontalAlignment: Text.AlignHCenter; verticalAlignment: Text.AlignVCenter }
+            }
+        }
+
+        ListView {
+            id: ladderView
+            Layout.fillWidth: true
+            Layout.fillHeight: true
+            model: ladderWindow.ladder
+            clip: true
+            boundsBehavior: Flickable.StopAtBounds
+            ScrollBar.vertical: ScrollBar {}
+
+            delegate: Rectangle {
+                id: levelRow
+                width: ladderView.width
+                height: ladderWindow.rowHeight
+                color: isLast ? "#3a3a1e" : (index % 2 === 0 ? "#1e1e1e" : "#232325")
+
+                required property int index
+                required property double price
+                required property int bidVolume
+                required property int askVolume
+                required property int myBuy
+                required property int mySell
+                required property bool isLast
+                required property bool isBestBid
+                required property bool isBestAsk
+
+                Row {
+                    anchors.fill: parent
+
+                    // 我的买: 右键撤单
+                    Rectangle {
+                        width: parent.width * 0.18; height: parent.height
+                        color: levelRow.myBuy > 0 ? "#4a2c2c" : "transparent"
+                        Text { anchors.centerIn: parent; text: levelRow.myBuy > 0 ? levelRow.myBuy : ""; color: "#ff8a80"; font.family: "Consolas" }
+                        MouseArea {
+                            anchors.fill: parent
+                            acceptedButtons: Qt.RightButton
+                            onClicked: if (levelRow.myBuy > 0) orderController.cancelLadderOrders(levelRow.price, "BUY")
+                        }
+                    }
+
+                    // 买量: 左键以该价买入
+                    Rectangle {
+                        width: parent.width * 0.20; height: parent.height
+                        color: buyMouse.containsMouse ? "#2c3f5a" : (levelRow.isBestBid ? "#1f3a2a" : "transparent")
+                        Text { anchors.centerIn: parent; text: levelRow.bidVolume > 0 ? levelRow.bidVolume : ""; color: "#69f0ae"; font.family: "Consolas" }
+                        MouseArea {
+                            id: buyMouse
+                            anchors.fill: parent
+                            hoverEnabled: true
+                            cursorShape: Qt.PointingHandCursor
+                            onClicked: orderController.sendLadderOrder(levelRow.price, "BUY", ladderWindow.offset)
+                        }
+                    }
+
+                    Text {
+                        width: parent.width * 0.24; height: parent.height
+                        text: levelRow.price > 0 ? levelRow.price.toFixed(2) : ""
+                        color: levelRow.isLast ? "#ffcc00" : "white"
+                        font.family: "Consolas"
+                        font.bold: levelRow.isLast
+                        horizontalAlignment: Text.AlignHCenter
+                        verticalAlignment: Text.AlignVCenter
+                    }
+
+                    // 卖量: 左键以该价卖出
+                    Rectangle {
+                        width: parent.width * 0.20; height: parent.height
+                        color: sellMouse.containsMouse ? "#2c3f5a" : (levelRow.isBestAsk ? "#3a1f1f" : "transparent")
+                        Text { anchors.centerIn: parent; text: levelRow.askVolume > 0 ? levelRow.askVolume : ""; color: "#ff5252"; font.family: "Consolas" }
+                        MouseArea {
+                            id: sellMouse
+                            anchors.fill: parent
+                            hoverEnabled: true
+                            cursorShape: Qt.PointingHandCursor
+                            onClicked: orderController.sendLadderOrder(levelRow.price, "SELL", ladderWindow.offset)
+                        }
+                    }
+
+                    // 我的卖: 右键撤单
+                    Rectangle {
+                        width: parent.width * 0.18; height: parent.height
+                        color: levelRow.mySell > 0 ? "#2c4a2c" : "transparent"
+                        Text { anchors.centerIn: parent; text: levelRow.mySell > 0 ? levelRow.mySell : ""; color: "#b9f6ca"; font.family: "Consolas" }
+                        MouseArea {
+                            anchors.fill: parent
+                            acceptedButtons: Qt.RightButton
+                            onClicked: if (levelRow.mySell > 0) orderController.cancelLadderOrders(levelRow.price, "SELL")
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,232 @@
+// qmllint disable import
+import QtQuick
+import QtQuick.Controls
+import QtQuick.Layouts
+
+/**
+ * 全市场行情排行榜窗口
+ * 排序在 C++ 端增量维护，这里只显示 windowStart 起的 windowSize 行；
+ * 滚动条/滚轮只改 windowStart，不创建屏幕外的 delegate
+ */
+Window {
+    id: boardWindow
+    width: 900
+    height: 640
+    minimumWidth: 700
+    minimumHeight: 300
+    title: "全市场行情"
+    color: "#1e1e1e"
+
+    property var boardModel: AppQuoteBoardModel
+    property var orderController: AppOrderController
+    readonly property int rowHeight: 26
+
+    onClosing: {
+        visible = false
+    }
+
+    // 表头列: sortKey 对应 QuoteBoardModel::SortKey，0 表示该列不可排序
+    readonly property var columns: [
+        { title: "#",      width: 0.06, sortKey: 0 },
+        { title: "合约",   width: 0.12, sortKey: 0 },
+        { title: "名称",   width: 0.14, sortKey: 0 },
+        { title: "最新价", width: 0.11, sortKey: 0 },
+        { title: "涨跌幅", width: 0.10, sortKey: 1 },
+        { title: "成交量", width: 0.12, sortKey: 2 },
+        { title: "持仓量", width: 0.12, sortKey: 3 },
+        { title: "成交额", width: 0.13, sortKey: 4 },
+        { title: "时间",   width: 0.10, sortKey: 0 }
+    ]
+
+    function formatAmount(v) {
+        if (v >= 1e8) return (v / 1e8).toFixed(2) + "亿"
+        if (v >= 1e4) return (v / 1e4).toFixed(1) + "万"
+        return v.toFixed(0)
+    }
+
+    ColumnLayout {
+        anchors.fill: parent
+        spacing: 0
+
+        // 工具栏: 交易所过滤
+        Rectangle {
+            Layout.fillWidth: true
+            height: 34
+            color: "#2d2d30"
+
+            RowLayout {
+                anchors.fill: parent
+                anchors.leftMargin: 8
+                anchors.rightMargin: 8
+                spacing: 4
+
+                Text {
+                    text: "📊 全市场排行"
+                    color: "#cccccc"
+                    font.pixelSize: 13
+                    font.bold: true
+                }
+
+                Item { Layout.fillWidth: true }
+
+                Repeater {
+                    model: ["", "SHFE", "DCE", "CZCE", "CFFEX", "INE", "GFEX"]
+                    delegate: Rectangle {
+                        required property string modelData
+                        readonly property bool active: boardModel && boardModel.exchangeFilter === modelData
+                        width: 56; height: 22
+                        radius: 3
+                        color: active ? "#2c5d87" : "#3a3a3d"
+                        border.color: active ? "#5599cc" : "#555555"
+                        border.width: 1
+
+                        Text {
+                            anchors.centerIn: parent
+                            text: modelData === "" ? "全部" : modelData
+                            color: parent.active ? "white" : "#aaaaaa"
+                            font.pixelSize: 11
+                        }
+                        MouseArea {
+                            anchors.fill: parent
+                            cursorShape: Qt.PointingHandCursor
+                            onClicked: boardModel.exchangeFilter = modelData
+                        }
+                    }
+                }
+
+                Text {
+                    text: boardModel ? ("共 " + boardModel.totalCount) : ""
+                    color: "#888888"
+                    font.pixelSize: 11
+                    Layout.leftMargin: 8
+                }
+            }
+        }
+
+        // 表头 (点击切换排序字段，再次点击切换升降序)
+        Rectangle {
+            Layout.fillWidth: true
+            height: 28
+            color: "#1e1e1e"
+
+            Row {
+                anchors.fill: parent
+                anchors.rightMargin: boardScroll.width
+                Repeater {
+                    model: boardWindow.columns
+                    delegate: Text {
+                        required property var modelData
+                        readonly property bool sorted: modelData.sortKey !== 0 && boardModel && boardModel.sortKey === modelData.sortKey
+                        width: parent.width * modelData.width
+                        height: parent.height
+                        text: modelData.title + (sorted ? (boardModel.descending ? " ▼" : " ▲") : "")
+                        color: sorted ? "#ffcc00" : "#aaaaaa"
+                        horizontalAlignment: Text.AlignHCenter
+                        verticalAlignment: Text.AlignVCenter
+
+                        MouseArea {
+                            anchors.fill: parent
+                            enabled: modelData.sortKey !== 0
+                            cursorShape: enabled ? Qt.PointingHandCursor : Qt.ArrowCursor
+                            onClicked: {
+                                if (boardModel.sortKey === modelData.sortKey) {
+                                    boardModel.descending = !boardModel.descending
+                                } else {
+                                    boardModel.sortKey = modelData.sortKey
+                                }
+                                boardModel.windowStart = 0
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+        // 可见窗口: 行数由高度决定，模型只提供这些行
+        Item {
+            id: viewport
+            Layout.fillWidth: true
+            Layout.fillHeight: true
+            clip: true
+
+            onHeightChanged: if (boardModel) boardModel.windowSize = Math.max(1, Math.floor(height / boardWindow.rowHeight))
+            Component.onCompleted: if (boardModel) boardModel.windowSize = Math.max(1, Math.floor(height / boardWindow.rowHeight))
+
+            Column {
+                anchors.left: parent.left
+                anchors.right: boardScroll.left
+                Repeater {
+                    model: boardWindow.boardModel
+                    delegate: Rectangle {
+                        id: rowDelegate
+                        width: parent.width
+                        height: boardWindow.rowHeight
+                        color: rowMouse.containsMouse ? "#2a2a2a" : (index % 2 === 0 ? "#1e1e1e" : "#252526")
+
+                        required property int index
+                        required property int rank
+                        required property string instrumentId
+                        required property string instrumentName
+                        required property double lastPrice
+                        required property double changePercent
+                        required property int volume
+                        required property double openInterest
+                        required property double turnover
+                        required property string updateTime
+
+                        readonly property color trendColor: changePercent > 0 ? "#f44336" : (changePercent < 0 ? "#4caf50" : "white")
+
+                        Row {
+                            anchors.fill: parent
+                            Text { width: parent.width * 0.06; text: rank; color: "#888888"; horizontalAlignment: Text.AlignHCenter; anchors.verticalCenter: parent.verticalCenter }
+                            Text { width: parent.width * 0.12; text: instrumentId; color: "white"; horizontalAlignment: Text.AlignHCenter; anchors.verticalCenter: parent.verticalCenter }
+                            Text { width: parent.width * 0.14; text: instrumentName; color: "#cccccc"; elide: Text.ElideRight; horizontalAlignment: Text.AlignHCenter; anchors.verticalCenter: parent.verticalCenter }
+                            Text { width: parent.width * 0.11; text: lastPrice > 0 ? lastPrice.toFixed(2) : "-"; color: rowDelegate.trendColor; horizontalAlignment: Text.AlignHCenter; anchors.verticalCenter: parent.verticalCenter }
+                            Text { width: parent.width * 0.10; text: changePercent.toFixed(2) + "%"; color: rowDelegate.trendColor; horizontalAlignment: Text.AlignHCenter; anchors.verticalCenter: parent.verticalCenter }
+                            Text { width: parent.width * 0.12; text: volume; color: "white"; horizontalAlignment: Text.AlignHCenter; anchors.verticalCenter: parent.verticalCenter }
+                            Text { width: parent.width * 0.12; text: openInterest.toFixed(0); color: "white"; horizontalAlignment: Text.AlignHCenter; anchors.verticalCenter: parent.verticalCenter }
+                            Text { width: parent.width * 0.13; text: boardWindow.formatAmount(turnover); color: "white"; horizontalAlignment: Text.AlignHCenter; anchors.verticalCenter: parent.verticalCenter }
+                            Text { width: parent.width * 0.10; text: updateTime; color: "#aaaaaa"; horizontalAlignment: Text.AlignHCenter; anchors.verticalCenter: parent.verticalCenter }
+                        }
+
+                        MouseArea {
+                            id: rowMouse
+                            anchors.fill: parent
+                            hoverEnabled: true
+                            // 单击把合约带到下单面板
+                            onClicked: {
+                                if (!boardWindow.orderController) return
+                                boardWindow.orderController.instrumentId = rowDelegate.instrumentId
+                                if (rowDelegate.lastPrice > 0) boardWindow.orderController.price = rowDelegate.lastPrice
+                            }
+                        }
+                    }
+                }
+            }
+
+            // 滚轮按行移动窗口
+            WheelHandler {
+                onWheel: (event)=> {
+                    if (!boardModel) return
+                    var step = event.angleDelta.y > 0 ? -3 : 3
+                    boardModel.windowStart = boardModel.windowStart + step
+                }
+            }
+
+            ScrollBar {
+                id: boardScroll
+                anchors.top: parent.top
+                anchors.bottom: parent.bottom
+                anchors.right: parent.right
+                orientation: Qt.Vertical
+                policy: ScrollBar.AlwaysOn
+                readonly property int total: boardModel ? boardModel.totalCount : 0
+                size: total > 0 ? Math.min(1.0, boardModel.windowSize / total) : 1.0
+                position: total > 0 ? boardModel.windowStart / total : 0.0
+                onPositionChanged: {
+                    if (pressed && boardModel) boardModel.windowStart = Math.round(position * total)
+                }
+            }
+        }
+    }
+}
@@ -195,6 +195,16 @@ ApplicationWindow {
             
             MenuSeparator {}
             
+            MenuItem {
+                text: "📊 全市场行情"
+                onTriggered: quoteBoardWin.visible = true
+            }
+
+            MenuItem {
+                text: "📶 价格阶梯"
+                onTriggered: domLadderWin.visible = true
+            }
+
             MenuItem {
                 text: "⚙ 设置"
                 onTriggered: settingsWin.visible = true
@@ -520,6 +530,16 @@ ApplicationWindow {
         soundSettings: soundSettings
     }
     
+    // 全市场行情排行榜窗口
+    QuoteBoardWindow {
+        id: quoteBoardWin
+    }
+
+    // 价格阶梯 (点价下单) 窗口
+    DomLadderWindow {
+        id: domLadderWin
+    }
+    
     // 快捷条件单弹窗
     ConditionOrderDialog {
         id: conditionDlg
@@ -0,0 +1,270 @@
+#include "bench/BenchmarkMonitor.h"
+#include "bench/SyntheticPublisher.h"
+#include "network/TickBatcher.h"
+#include <QCoreApplication>
+#include <QDebug>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QQuickWindow>
+#include <QScreen>
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <sys/resource.h>
+#endif
+
+namespace QuantLabs {
+
+namespace {
+
+// 延迟/间隔分布: 样本数、均值与分位数
+QJsonObject distribution(std::vector<double>& v) {
+    QJsonObject o;
+    o["count"] = static_cast<double>(v.size());
+    if (v.empty()) return o;
+    std::sort(v.begin(), v.end());
+    auto pct = [&v](double p) {
+        const size_t i = std::min(v.size() - 1, static_cast<size_t>(p * (v.size() - 1) + 0.5));
+        return v[i];
+    };
+    o["mean"] = std::accumulate(v.begin(), v.end(), 0.0) / v.size();
+    o["p50"] = pct(0.50);
+    o["p90"] = pct(0.90);
+    o["p99"] = pct(0.99);
+    o["p999"] = pct(0.999);
+    o["max"] = v.back();
+    return o;
+}
+
+QString brief(const QJsonObject& d) {
+    return QStringLiteral("p50 %1 / p99 %2 / max %3")
+        .arg(d["p50"].toDouble(), 0, 'f', 0)
+        .arg(d["p99"].toDouble(), 0, 'f', 0)
+        .arg(d["max"].toDouble(), 0, 'f', 0);
+}
+
+} // namespace
+
+BenchmarkMonitor::BenchmarkMonitor(const Options& options, TickBatcher* batcher, QObject *parent)
+    : QObject(parent),
+      _options(options),
+      _batcher(batcher) {
+    connect(&_cpuTimer, &QTimer::timeout, this, &BenchmarkMonitor::sampleCpu);
+}
+
+int64_t BenchmarkMonitor::nowNs() {
+    // 与 MessageHeader.publish_time 同一时钟 (UTC epoch)，发布端在本机时可直接相减
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+double BenchmarkMonitor::processCpuSeconds() {
+#ifdef _WIN32
+    FILETIME created, exited, kernel, user;
+    if (!GetProcessTimes(GetCurrentProcess(), &created, &exited, &kernel, &user)) return 0.0;
+    auto toSeconds = [](const FILETIME& ft) {
+        return ((static_cast<uint64_t>(ft.dwHighDateTime) << 32) | ft.dwLowDateTime) * 1e-7;
+    };
+    return toSeconds(kernel) + toSeconds(user);
+#else
+    rusage usage{};
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0.0;
+    return usage.ru_utime.tv_sec + usage.ru_utime.tv_usec * 1e-6 +
+           usage.ru_stime.tv_sec + usage.ru_stime.tv_usec * 1e-6;
+#endif
+}
+
+void BenchmarkMonitor::attachWindow(QQuickWindow* window) {
+    if (!window) {
+        qWarning() << "[Benchmark] No QQuickWindow, frame latency will not be measured";
+        return;
+    }
+    _window = window;
+    if (window->screen() && window->screen()->refreshRate() > 1.0) {
+        _refreshIntervalMs = 1000.0 / window->screen()->refreshRate();
+    }
+    // 线程化渲染循环下 frameSwapped 在渲染线程发出，直接在该线程记录时间
+    connect(window, &QQuickWindow::frameSwapped, this, [this]() { onFrameSwapped(); }, Qt::DirectConnection);
+}
+
+void BenchmarkMonitor::start() {
+    qDebug() << "[Benchmark] Warmup" << _options.warmupSec << "s, measure" << _options.durationSec << "s";
+    QTimer::singleShot(std::max(0, _options.warmupSec) * 1000, this, &BenchmarkMonitor::beginMeasuring);
+}
+
+void BenchmarkMonitor::beginMeasuring() {
+    _measureStart = std::chrono::steady_clock::now();
+    _cpuStart = _lastCpu = processCpuSeconds();
+    _lastCpuAt = _measureStart;
+    if (_publisher) {
+        _pubTicksStart = _publisher->ticksSent();
+        _pubOrdersStart = _publisher->ordersSent();
+        _pubTradesStart = _publisher->tradesSent();
+    }
+    {
+        std::lock_guard<std::mutex> lock(_frameMutex);
+        _awaitingFrame.clear();
+        _lastFrameNs = 0;
+    }
+    _measuring = true;
+    _cpuTimer.start(1000);
+    QTimer::singleShot(std::max(1, _options.durationSec) * 1000, this, &BenchmarkMonitor::finish);
+    qDebug() << "[Benchmark] Measuring...";
+}
+
+void BenchmarkMonitor::onTicksReady(const std::vector<TickData>& ticks) {
+    if (!_measuring) return;
+    const int64_t now = nowNs();
+    ++_batches;
+    _ticksApplied += ticks.size();
+
+    Series& s = _series[Tick];
+    const auto& times = _batcher->publishTimes();
+    s.received += times.size();
+
+    std::lock_guard<std::mutex> lock(_frameMutex);
+    for (int64_t publishNs : times) {
+        if (publishNs <= 0) continue;
+        s.modelUs.push_back((now - publishNs) / 1000.0);
+        _awaitingFrame.push_back({publishNs, now, Tick});
+    }
+}
+
+void BenchmarkMonitor::onOrderReceived(const QJsonObject& json) {
+    if (!_measuring) return;
+    ++_series[Order].received;
+    if (json.contains("bench_publish_us")) {
+        recordModelUpdate(Order, static_cast<int64_t>(json["bench_publish_us"].toDouble()) * 1000, nowNs());
+    }
+}
+
+void BenchmarkMonitor::onTradeReceived(const QJsonObject& json) {
+    if (!_measuring) return;
+    ++_series[Trade].received;
+    if (json.contains("bench_publish_us")) {
+        recordModelUpdate(Trade, static_cast<int64_t>(json["bench_publish_us"].toDouble()) * 1000, nowNs());
+    }
+}
+
+void BenchmarkMonitor::recordModelUpdate(Kind kind, int64_t publishNs, int64_t now) {
+    _series[kind].modelUs.push_back((now - publishNs) / 1000.0);
+    std::lock_guard<std::mutex> lock(_frameMutex);
+    _awaitingFrame.push_back({publishNs, now, kind});
+}
+
+void BenchmarkMonitor::onFrameSwapped() {
+    if (!_measuring) return;
+    const int64_t now = nowNs();
+
+    std::lock_guard<std::mutex> lock(_frameMutex);
+    ++_frames;
+    if (_lastFrameNs != 0) _frameIntervalsMs.push_back((now - _lastFrameNs) / 1e6);
+    _lastFrameNs = now;
+    if (_awaitingFrame.empty()) return;
+
+    // 数据进入模型后超过 1.5 个刷新周期才上屏，其间错过的刷新计为掉帧
+    int64_t oldestModelNs = now;
+    for (const Pending& p : _awaitingFrame) {
+        _series[p.kind].frameUs.push_back((now - p.publishNs) / 1000.0);
+        oldestModelNs = std::min(oldestModelNs, p.modelNs);
+    }
+    _awaitingFrame.clear();
+
+    const double waitedMs = (now - oldestModelNs) / 1e6;
+    if (waitedMs > 1.5 * _refreshIntervalMs) {
+        _droppedFrames += static_cast<uint64_t>(std::llround(waitedMs / _refreshIntervalMs)) - 1;
+    }
+}
+
+void BenchmarkMonitor::sampleCpu() {
+    const auto now = std::chrono::steady_clock::now();
+    const double cpu = processCpuSeconds();
+    const double wall = std::chrono::duration<double>(now - _lastCpuAt).count();
+    if (wall > 0) _cpuSamples.push_back((cpu - _lastCpu) / wall * 100.0);
+    _lastCpu = cpu;
+    _lastCpuAt = now;
+}
+
+QJsonObject BenchmarkMonitor::seriesReport(Series& series, double seconds) const {
+    QJsonObject o;
+    o["received"] = static_cast<double>(series.received);
+    o["rate_per_sec"] = seconds > 0 ? series.received / seconds : 0.0;
+    o["publish_to_model_us"] = distribution(series.modelUs);
+    o["publish_to_frame_us"] = distribution(series.frameUs);
+    return o;
+}
+
+void BenchmarkMonitor::finish() {
+    _measuring = false;
+    _cpuTimer.stop();
+
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - _measureStart).count();
+    const double cpuTotal = processCpuSeconds() - _cpuStart;
+
+    QJsonObject report;
+    report["config"] = _options.config;
+    report["measured_sec"] = seconds;
+
+    std::lock_guard<std::mutex> lock(_frameMutex);
+
+    QJsonObject ticks = seriesReport(_series[Tick], seconds);
+    ticks["applied_to_models"] = static_cast<double>(_ticksApplied);
+    ticks["batches"] = static_cast<double>(_batches);
+    report["ticks"] = ticks;
+    report["orders"] = seriesReport(_series[Order], seconds);
+    report["trades"] = seriesReport(_series[Trade], seconds);
+
+    QJsonObject frames;
+    frames["count"] = static_cast<double>(_frames);
+    frames["fps"] = seconds > 0 ? _frames / seconds : 0.0;
+    frames["refresh_hz"] = 1000.0 / _refreshIntervalMs;
+    frames["dropped"] = static_cast<double>(_droppedFrames);
+    frames["interval_ms"] = distribution(_frameIntervalsMs);
+    report["frames"] = frames;
+
+    QJsonObject cpu;
+    cpu["avg_percent"] = seconds > 0 ? cpuTotal / seconds * 100.0 : 0.0;
+    cpu["max_percent"] = _cpuSamples.empty() ? 0.0 : *std::max_element(_cpuSamples.begin(), _cpuSamples.end());
+    QJsonArray samples;
+    for (double v : _cpuSamples) samples.append(std::round(v * 10.0) / 10.0);
+    cpu["samples"] = samples;
+    cpu["includes_publisher"] = (_publisher != nullptr);
+    report["cpu"] = cpu;
+
+    if (_publisher) {
+        QJsonObject pub;
+        pub["ticks_sent"] = static_cast<double>(_publisher->ticksSent() - _pubTicksStart);
+        pub["orders_sent"] = static_cast<double>(_publisher->ordersSent() - _pubOrdersStart);
+        pub["trades_sent"] = static_cast<double>(_publisher->tradesSent() - _pubTradesStart);
+        report["publisher"] = pub;
+    }
+
+    QFile file(_options.reportPath);
+    if (file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        file.write(QJsonDocument(report).toJson(QJsonDocument::Indented));
+        file.close();
+        qDebug() << "[Benchmark] Report written to" << _options.reportPath;
+    } else {
+        qWarning() << "[Benchmark] Cannot write report:" << _options.reportPath;
+    }
+
+    const QJsonObject tickModel = ticks["publish_to_model_us"].toObject();
+    const QJsonObject tickFrame = ticks["publish_to_frame_us"].toObject();
+    qDebug().noquote() << "[Benchmark] ticks/s:" << QString::number(ticks["rate_per_sec"].toDouble(), 'f', 0)
+                       << "| model us:" << brief(tickModel) << "| frame us:" << brief(tickFrame);
+    qDebug().noquote() << "[Benchmark] fps:" << QString::number(frames["fps"].toDouble(), 'f', 1)
+                       << "dropped:" << _droppedFrames
+                       << "| cpu avg:" << QString::number(cpu["avg_percent"].toDouble(), 'f', 1) << "%";
+
+    QCoreApplication::exit(0);
+}
+
+} // namespace QuantLabs
@@ -0,0 +1,113 @@
+#pragma once
+
+#include <QJsonObject>
+#include <QObject>
+#include <QPointer>
+#include <QString>
+#include <QTimer>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+#include "protocol/message_schema.h"
+
+class QQuickWindow;
+
+namespace QuantLabs {
+
+class TickBatcher;
+class SyntheticPublisher;
+
+/**
+ * @brief 界面性能基准测试 (--benchmark)
+ *
+ * 在 GUI 线程按三个时间点统计延迟 (均以发布端 publish_time 为起点):
+ * - 模型: 各模型处理完本帧行情 / 报单 / 成交之后 (ticksReady 等信号上最后连接的槽)
+ * - 上屏: 其后第一次 QQuickWindow::frameSwapped
+ * 另统计帧间隔、掉帧 (有待显示数据时帧间隔超过 1.5 个刷新周期)、进程 CPU，
+ * 预热结束后开始计数，到时写出 JSON 报告并退出程序。
+ */
+class BenchmarkMonitor : public QObject {
+    Q_OBJECT
+public:
+    struct Options {
+        int durationSec = 30;
+        int warmupSec = 3;
+        QString reportPath = "bench_report.json";
+        QJsonObject config;     // 原样写入报告 (速率、合约数等)
+    };
+
+    BenchmarkMonitor(const Options& options, TickBatcher* batcher, QObject *parent = nullptr);
+
+    // 监听主窗口的上屏时间
+    void attachWindow(QQuickWindow* window);
+    // 嵌入式发布端 (可选)，报告中附带发送计数
+    void setPublisher(SyntheticPublisher* publisher) { _publisher = publisher; }
+    void start();
+
+public slots:
+    // 须在各模型之后连接
+    void onTicksReady(const std::vector<TickData>& ticks);
+    void onOrderReceived(const QJsonObject& json);
+    void onTradeReceived(const QJsonObject& json);
+
+private slots:
+    void beginMeasuring();
+    void sampleCpu();
+    void finish();
+
+private:
+    enum Kind { Tick = 0, Order, Trade, KindCount };
+
+    struct Series {
+        std::vector<double> modelUs;   // 发布 -> 模型更新
+        std::vector<double> frameUs;   // 发布 -> 上屏
+        uint64_t received = 0;
+    };
+
+    // 渲染线程调用
+    void onFrameSwapped();
+    void recordModelUpdate(Kind kind, int64_t publishNs, int64_t nowNs);
+    QJsonObject seriesReport(Series& series, double seconds) const;
+
+    static int64_t nowNs();
+    static double processCpuSeconds();
+
+    Options _options;
+    TickBatcher* _batcher = nullptr;
+    QPointer<QQuickWindow> _window;
+    SyntheticPublisher* _publisher = nullptr;
+    std::atomic<bool> _measuring{false};
+
+    // 已进入模型、等待上屏的更新 (GUI 线程写入，渲染线程取走)
+    struct Pending {
+        int64_t publishNs;
+        int64_t modelNs;    // 进入模型的时刻，用于判断掉帧
+        Kind kind;
+    };
+    std::mutex _frameMutex;
+    std::vector<Pending> _awaitingFrame;
+    std::array<Series, KindCount> _series;
+
+    // 帧统计 (渲染线程写入，结束时在 GUI 线程读取，同受 _frameMutex 保护)
+    double _refreshIntervalMs = 1000.0 / 60.0;
+    int64_t _lastFrameNs = 0;
+    uint64_t _frames = 0;
+    uint64_t _droppedFrames = 0;
+    std::vector<double> _frameIntervalsMs;
+
+    uint64_t _batches = 0;
+    uint64_t _ticksApplied = 0;    // 合并后实际写入模型的行情数
+
+    QTimer _cpuTimer;
+    std::chrono::steady_clock::time_point _measureStart;
+    double _cpuStart = 0.0;
+    double _lastCpu = 0.0;
+    std::chrono::steady_clock::time_point _lastCpuAt;
+    std::vector<double> _cpuSamples;   // 每秒进程 CPU 占用 (%，多核可超过 100)
+    uint64_t _pubTicksStart = 0, _pubOrdersStart = 0, _pubTradesStart = 0;
+};
+
+} // namespace QuantLabs
@@ -0,0 +1,253 @@
+#include "bench/SyntheticPublisher.h"
+#include "protocol/zmq_topics.h"
+#include <QDebug>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTime>
+#include <algorithm>
+#include <cstring>
+
+namespace QuantLabs {
+
+namespace {
+
+constexpr double kPriceTick = 1.0;
+constexpr size_t kMaxWorkingOrders = 1000;
+
+void copyString(char* dst, size_t size, const QByteArray& src) {
+    const size_t n = std::min(size - 1, static_cast<size_t>(src.size()));
+    std::memcpy(dst, src.constData(), n);
+    dst[n] = '\0';
+}
+
+} // namespace
+
+SyntheticPublisher::SyntheticPublisher(const std::string& bindAddr, const Rates& rates, QObject *parent)
+    : QObject(parent),
+      _bindAddr(bindAddr),
+      _orderTopic(zmq_topics::accountTopic(zmq_topics::ORDER_DATA, kAccountId)),
+      _tradeTopic(zmq_topics::accountTopic(zmq_topics::TRADE_DATA, kAccountId)),
+      _rates(rates),
+      _context(1),
+      _publisher(_context, zmq::socket_type::pub) {
+    _rates.instruments = std::max(1, _rates.instruments);
+}
+
+SyntheticPublisher::~SyntheticPublisher() {
+    stop();
+    _context.close();
+}
+
+QString SyntheticPublisher::instrumentId(int index) {
+    return QStringLiteral("BENCH%1").arg(index + 1, 4, 10, QLatin1Char('0'));
+}
+
+int64_t SyntheticPublisher::nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+void SyntheticPublisher::start() {
+    try {
+        // 发布端跟不上时丢弃，而不是无限堆积内存 (与 Core 行为一致)
+        _publisher.set(zmq::sockopt::sndhwm, 100000);
+        _publisher.set(zmq::sockopt::linger, 0);
+        _publisher.bind(_bindAddr);
+    } catch (const zmq::error_t& e) {
+        qCritical() << "[SyntheticPublisher] Bind error:" << e.what() << QString::fromStdString(_bindAddr);
+        return;
+    }
+
+    _ticks.assign(_rates.instruments, TickData{});
+    for (int i = 0; i < _rates.instruments; ++i) {
+        TickData& t = _ticks[i];
+        std::memset(&t, 0, sizeof(t));
+        copyString(t.instrument_id, sizeof(t.instrument_id), instrumentId(i).toLatin1());
+        t.pre_close_price = t.pre_settlement_price = t.open_price = 1000.0 + i;
+        t.last_price = t.highest_price = t.lowest_price = t.pre_close_price;
+        t.upper_limit_price = t.pre_close_price * 1.1;
+        t.lower_limit_price = t.pre_close_price * 0.9;
+        t.open_interest = 10000;
+    }
+
+    _running = true;
+    _startedAt = std::chrono::steady_clock::now();
+
+    // 1ms 精确定时器，每次按"应发数量 - 已发数量"补齐，速率不受定时器抖动影响
+    _timer = new QTimer(this);
+    _timer->setTimerType(Qt::PreciseTimer);
+    connect(_timer, &QTimer::timeout, this, &SyntheticPublisher::publishDue);
+    _timer->start(1);
+
+    // 合约信息定期重发: PUB 无历史，晚连上的订阅者也能拿到
+    _instrumentTimer = new QTimer(this);
+    connect(_instrumentTimer, &QTimer::timeout, this, &SyntheticPublisher::publishInstruments);
+    _instrumentTimer->start(5000);
+    publishInstruments();
+
+    qDebug() << "[SyntheticPublisher] Publishing on" << QString::fromStdString(_bindAddr)
+             << "instruments:" << _rates.instruments << "ticks/s:" << _rates.ticksPerSec
+             << "orders/s:" << _rates.ordersPerSec << "trades/s:" << _rates.tradesPerSec;
+}
+
+void SyntheticPublisher::stop() {
+    if (!_running) return;
+    _running = false;
+    if (_timer) _timer->stop();
+    if (_instrumentTimer) _instrumentTimer->stop();
+    try {
+        _publisher.close();
+    } catch (const zmq::error_t& e) {
+        qWarning() << "[SyntheticPublisher] Close error:" << e.what();
+    }
+    qDebug() << "[SyntheticPublisher] Stopped, ticks:" << ticksSent() << "orders:" << ordersSent() << "trades:" << tradesSent();
+}
+
+void SyntheticPublisher::publishDue() {
+    if (!_running) return;
+    const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - _startedAt).count();
+
+    // 单次最多补 10ms 的量，发布端被抢占后不会一次性突发
+    auto due = [elapsed](int rate, uint64_t sent) -> uint64_t {
+        const uint64_t target = static_cast<uint64_t>(rate * elapsed);
+        const uint64_t cap = std::max<uint64_t>(1, static_cast<uint64_t>(rate) / 100);
+        return target > sent ? std::min(target - sent, cap) : 0;
+    };
+
+    for (uint64_t n = due(_rates.ticksPerSec, ticksSent()); n > 0; --n) {
+        publishTick(static_cast<int>(ticksSent() % _ticks.size()));
+    }
+    for (uint64_t n = due(_rates.ordersPerSec, ordersSent()); n > 0; --n) publishOrder();
+    for (uint64_t n = due(_rates.tradesPerSec, tradesSent()); n > 0; --n) publishTrade();
+}
+
+void SyntheticPublisher::publishInstruments() {
+    if (!_running) return;
+    for (int i = 0; i < _rates.instruments; ++i) {
+        QJsonObject j;
+        j["instrument_id"] = instrumentId(i);
+        j["instrument_name"] = QStringLiteral("模拟合约%1").arg(i + 1);
+        j["exchange_id"] = "BENCH";
+        j["price_tick"] = kPriceTick;
+        j["volume_multiple"] = 10;
+        const QByteArray payload = QJsonDocument(j).toJson(QJsonDocument::Compact);
+        send(zmq_topics::INSTRUMENT_DATA, payload.constData(), payload.size(), nowNs());
+    }
+}
+
+void SyntheticPublisher::publishTick(int index) {
+    TickData& t = _ticks[index];
+
+    // 最新价随机游走，五档围绕最新价展开
+    const int step = static_cast<int>(_rng() % 3) - 1;
+    t.last_price = std::clamp(t.last_price + step * kPriceTick, t.lower_limit_price, t.upper_limit_price);
+    t.highest_price = std::max(t.highest_price, t.last_price);
+    t.lowest_price = std::min(t.lowest_price, t.last_price);
+    const int traded = 1 + static_cast<int>(_rng() % 10);
+    t.volume += traded;
+    t.turnover += traded * t.last_price * 10;
+    t.open_interest += static_cast<int>(_rng() % 5) - 2;
+
+    double* bidPrices[5] = {&t.bid_price1, &t.bid_price2, &t.bid_price3, &t.bid_price4, &t.bid_price5};
+    int* bidVolumes[5] = {&t.bid_volume1, &t.bid_volume2, &t.bid_volume3, &t.bid_volume4, &t.bid_volume5};
+    double* askPrices[5] = {&t.ask_price1, &t.ask_price2, &t.ask_price3, &t.ask_price4, &t.ask_price5};
+    int* askVolumes[5] = {&t.ask_volume1, &t.ask_volume2, &t.ask_volume3, &t.ask_volume4, &t.ask_volume5};
+    for (int l = 0; l < 5; ++l) {
+        *bidPrices[l] = t.last_price - (l + 1) * kPriceTick;
+        *askPrices[l] = t.last_price + (l + 1) * kPriceTick;
+        *bidVolumes[l] = 1 + static_cast<int>(_rng() % 200);
+        *askVolumes[l] = 1 + static_cast<int>(_rng() % 200);
+    }
+
+    const QTime now = QTime::currentTime();
+    copyString(t.update_time, sizeof(t.update_time), now.toString("HH:mm:ss").toLatin1());
+    t.update_millisec = now.msec();
+
+    send(zmq_topics::MARKET_DATA_BIN, &t, sizeof(t), nowNs());
+    _ticksSent.fetch_add(1, std::memory_order_relaxed);
+}
+
+void SyntheticPublisher::publishOrder() {
+    const int64_t publishTime = nowNs();
+    QJsonObject j;
+
+    // 约三成为已有报单的终态 (成交/撤单)，其余为新报单
+    const bool finish = !_working.empty() && (_working.size() >= kMaxWorkingOrders || _rng() % 10 < 3);
+
+    WorkingOrder order;
+    if (finish) {
+        const size_t pick = _rng() % _working.size();
+        order = _working[pick];
+        _working[pick] = _working.back();
+        _working.pop_back();
+    } else {
+        order.sysId = QString::number(_nextOrderId++);
+        order.index = static_cast<int>(_rng() % _ticks.size());
+        order.buy = (_rng() % 2 == 0);
+        order.price = _ticks[order.index].last_price;
+        _working.push_back(order);
+    }
+    const bool traded = finish && (_rng() % 2 == 0);
+
+    j["instrument_id"] = QString::fromLatin1(_ticks[order.index].instrument_id);
+    j["order_sys_id"] = order.sysId;
+    j["order_ref"] = order.sysId;
+    j["direction"] = order.buy ? "0" : "1";
+    j["comb_offset_flag"] = "0";
+    j["limit_price"] = order.price;
+    j["volume_total_original"] = 1;
+    j["volume_traded"] = traded ? 1 : 0;
+    j["volume_total"] = finish ? 0 : 1;
+    j["order_status"] = finish ? (traded ? "0" : "5") : "3";
+    j["status_msg"] = finish ? (traded ? "全部成交" : "已撤单") : "未成交";
+    j["insert_time"] = QTime::currentTime().toString("HH:mm:ss");
+    j["exchange_id"] = "BENCH";
+    j["account_id"] = kAccountId;
+    j["front_id"] = 1;
+    j["session_id"] = 1;
+    // 微秒精度保证在 double 中无损
+    j["bench_publish_us"] = static_cast<double>(publishTime / 1000);
+
+    const QByteArray payload = QJsonDocument(j).toJson(QJsonDocument::Compact);
+    send(_orderTopic.c_str(), payload.constData(), payload.size(), publishTime);
+    _ordersSent.fetch_add(1, std::memory_order_relaxed);
+}
+
+void SyntheticPublisher::publishTrade() {
+    const int64_t publishTime = nowNs();
+    const TickData& t = _ticks[_rng() % _ticks.size()];
+
+    QJsonObject j;
+    j["instrument_id"] = QString::fromLatin1(t.instrument_id);
+    j["trade_id"] = QString::number(_nextTradeId++);
+    j["order_sys_id"] = QString::number(_nextOrderId++);
+    j["direction"] = (_rng() % 2 == 0) ? "0" : "1";
+    j["offset_flag"] = "0";
+    j["price"] = t.last_price;
+    j["volume"] = 1;
+    j["commission"] = 1.0;
+    j["close_profit"] = 0.0;
+    j["trade_time"] = QTime::currentTime().toString("HH:mm:ss");
+    j["account_id"] = kAccountId;
+    j["bench_publish_us"] = static_cast<double>(publishTime / 1000);
+
+    const QByteArray payload = QJsonDocument(j).toJson(QJsonDocument::Compact);
+    send(_tradeTopic.c_str(), payload.constData(), payload.size(), publishTime);
+    _tradesSent.fetch_add(1, std::memory_order_relaxed);
+}
+
+void SyntheticPublisher::send(const char* topic, const void* data, size_t size, int64_t publishTime) {
+    // [topic][MessageHeader][payload]，seq 为 0 表示不参与序号衔接
+    MessageHeader header;
+    header.seq = 0;
+    header.publish_time = publishTime;
+    try {
+        _publisher.send(zmq::message_t(topic, std::strlen(topic)), zmq::send_flags::sndmore);
+        _publisher.send(zmq::message_t(&header, sizeof(header)), zmq::send_flags::sndmore);
+        _publisher.send(zmq::message_t(data, size), zmq::send_flags::none);
+    } catch (const zmq::error_t& e) {
+        qWarning() << "[SyntheticPublisher] Send error:" << e.what();
+    }
+}
+
+} // namespace QuantLabs
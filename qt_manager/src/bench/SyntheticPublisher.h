@@ -0,0 +1,96 @@
+#pragma once
+
+#include <QObject>
+#include <QString>
+#include <QTimer>
+#include <zmq.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+#include "protocol/message_schema.h"
+
+namespace QuantLabs {
+
+/**
+ * @brief 基准测试用的模拟 Core 行情端 (PUB)
+ *
+ * 按设定速率发布二进制行情 (MB)、报单 (OT) 与成交 (TT)，格式与 ctp_core 的 Publisher 一致。
+ * 每条消息的 MessageHeader.publish_time 为发送时刻，JSON 报单/成交另带 bench_publish_time 字段，
+ * 供 BenchmarkMonitor 计算端到端延迟。seq 固定为 0，客户端直接分发，不走快照衔接。
+ *
+ * 可嵌入 qt_manager 进程 (独立线程)，也可用 --bench-publish-only 单独启动，
+ * 后者测得的 CPU 不含发布端开销。
+ */
+class SyntheticPublisher : public QObject {
+    Q_OBJECT
+public:
+    struct Rates {
+        int instruments = 200;
+        int ticksPerSec = 20000;
+        int ordersPerSec = 50;
+        int tradesPerSec = 20;
+    };
+
+    SyntheticPublisher(const std::string& bindAddr, const Rates& rates, QObject *parent = nullptr);
+    ~SyntheticPublisher();
+
+    // 报单/成交所属的模拟账户 (发布为账户 topic "OT|BENCH|")
+    static constexpr const char* kAccountId = "BENCH";
+
+    // 第 i 个模拟合约的代码 ("BENCH0001")
+    static QString instrumentId(int index);
+
+    uint64_t ticksSent() const { return _ticksSent.load(std::memory_order_relaxed); }
+    uint64_t ordersSent() const { return _ordersSent.load(std::memory_order_relaxed); }
+    uint64_t tradesSent() const { return _tradesSent.load(std::memory_order_relaxed); }
+
+public slots:
+    /**
+     * @brief 绑定 PUB 并开始发布 (在发布线程调用)
+     */
+    void start();
+    void stop();
+
+private slots:
+    void publishDue();
+    void publishInstruments();
+
+private:
+    void publishTick(int index);
+    void publishOrder();
+    void publishTrade();
+    void send(const char* topic, const void* data, size_t size, int64_t publishTime);
+    static int64_t nowNs();
+
+    std::string _bindAddr;
+    std::string _orderTopic;
+    std::string _tradeTopic;
+    Rates _rates;
+    zmq::context_t _context;
+    zmq::socket_t _publisher;
+    QTimer* _timer = nullptr;
+    QTimer* _instrumentTimer = nullptr;
+    bool _running = false;
+
+    std::vector<TickData> _ticks;        // 各合约当前行情 (随机游走)
+    struct WorkingOrder {
+        QString sysId;
+        int index = 0;      // 合约序号
+        bool buy = true;
+        double price = 0.0;
+    };
+    std::vector<WorkingOrder> _working;  // 未结束的模拟报单
+    std::mt19937 _rng{20240601};
+    uint64_t _nextOrderId = 1;
+    uint64_t _nextTradeId = 1;
+
+    std::chrono::steady_clock::time_point _startedAt;
+    std::atomic<uint64_t> _ticksSent{0};
+    std::atomic<uint64_t> _ordersSent{0};
+    std::atomic<uint64_t> _tradesSent{0};
+};
+
+} // namespace QuantLabs
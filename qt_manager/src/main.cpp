@@ -6,19 +6,29 @@
 #include <QFile>
 #include <QJsonDocument>
 #include <QJsonObject>
+#include <QJsonArray>
 #include <QSettings>
+#include <QCommandLineParser>
+#include <QQuickWindow>
 #include "network/ZmqWorker.h"
 #include "network/CommandWorker.h"
+#include "network/HistoryClient.h"
+#include "network/TickBatcher.h"
 #include "models/MarketModel.h"
 #include "models/PositionModel.h"
 #include "models/AccountInfo.h"
 #include "models/OrderController.h"
 #include "models/OrderModel.h"
 #include "models/TradeModel.h"
+#include "models/QuoteBoardModel.h"
+#include "models/TickCache.h"
+#include "bench/BenchmarkMonitor.h"
+#include "bench/SyntheticPublisher.h"
 #include "protocol/zmq_topics.h"
 
 #include <QFont>
 #include <QIcon>  // Added
+#include <algorithm>
 
 int main(int argc, char *argv[]) {
     QGuiApplication app(argc, argv);
@@ -28,6 +38,60 @@ int main(int argc, char *argv[]) {
     app.setOrganizationName("QuantLabs");
     app.setOrganizationDomain("quantlabs.local");
     app.setApplicationName("qt_manager");
+
+    // 基准测试模式: 连接模拟行情端，测量 发布 -> 模型 -> 上屏 延迟、掉帧与 CPU，结束后输出报告
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    QCommandLineOption benchOpt("benchmark", "Run the UI benchmark against a synthetic publisher and exit.");
+    QCommandLineOption publishOnlyOpt("bench-publish-only", "Only run the synthetic publisher (no UI).");
+    QCommandLineOption externalOpt("bench-external", "Benchmark against an already running --bench-publish-only process.");
+    QCommandLineOption hostOpt("bench-host", "Publisher host for --bench-external.", "host", "127.0.0.1");
+    QCommandLineOption portOpt("bench-port", "Publisher port.", "port", "15555");
+    QCommandLineOption instrumentsOpt("bench-instruments", "Number of synthetic instruments.", "n", "200");
+    QCommandLineOption rowsOpt("bench-rows", "Instruments added to the market list.", "n", "50");
+    QCommandLineOption tickRateOpt("bench-tick-rate", "Ticks per second.", "n", "20000");
+    QCommandLineOption orderRateOpt("bench-order-rate", "Order updates per second.", "n", "50");
+    QCommandLineOption tradeRateOpt("bench-trade-rate", "Trades per second.", "n", "20");
+    QCommandLineOption durationOpt("bench-duration", "Measured seconds.", "sec", "30");
+    QCommandLineOption warmupOpt("bench-warmup", "Warmup seconds before measuring.", "sec", "3");
+    QCommandLineOption reportOpt("bench-report", "Report file (JSON).", "path", "bench_report.json");
+    parser.addOptions({benchOpt, publishOnlyOpt, externalOpt, hostOpt, portOpt, instrumentsOpt, rowsOpt,
+                       tickRateOpt, orderRateOpt, tradeRateOpt, durationOpt, warmupOpt, reportOpt});
+    parser.process(app);
+
+    const bool benchmark = parser.isSet(benchOpt);
+    const bool publishOnly = parser.isSet(publishOnlyOpt);
+    QuantLabs::SyntheticPublisher::Rates benchRates;
+    benchRates.instruments = parser.value(instrumentsOpt).toInt();
+    benchRates.ticksPerSec = parser.value(tickRateOpt).toInt();
+    benchRates.ordersPerSec = parser.value(orderRateOpt).toInt();
+    benchRates.tradesPerSec = parser.value(tradeRateOpt).toInt();
+    const int benchPort = parser.value(portOpt).toInt();
+
+    // 模拟发布端跑在独立线程，与 Core 的 Publisher 一样只负责发送
+    QThread* publisherThread = nullptr;
+    QuantLabs::SyntheticPublisher* publisher = nullptr;
+    auto startPublisher = [&](const std::string& bindAddr) {
+        publisherThread = new QThread();
+        publisher = new QuantLabs::SyntheticPublisher(bindAddr, benchRates);
+        publisher->moveToThread(publisherThread);
+        QObject::connect(publisherThread, &QThread::started, publisher, &QuantLabs::SyntheticPublisher::start);
+        QObject::connect(&app, &QGuiApplication::aboutToQuit, publisher, &QuantLabs::SyntheticPublisher::stop, Qt::BlockingQueuedConnection);
+        QObject::connect(&app, &QGuiApplication::aboutToQuit, publisherThread, &QThread::quit);
+        QObject::connect(publisherThread, &QThread::finished, publisher, &QObject::deleteLater);
+        QObject::connect(publisherThread, &QThread::finished, publisherThread, &QObject::deleteLater);
+        publisherThread->start();
+    };
+
+    if (publishOnly) {
+        startPublisher("tcp://*:" + std::to_string(benchPort));
+        return app.exec();
+    }
+
+    if (benchmark) {
+        // 独立的设置文件，不影响正常使用时保存的布局与自选合约
+        app.setApplicationName("qt_manager_bench");
+    }
     
     // 将配置文件存储到可执行程序同级目录，便于跟随程序分发
     QSettings::setDefaultFormat(QSettings::IniFormat);
@@ -46,23 +110,39 @@ int main(int argc, char *argv[]) {
             QString serverAddr = conn["server_address"].toString("127.0.0.1");
             int pubPort = conn["pub_port"].toInt(5555);
             int repPort = conn["rep_port"].toInt(5556);
+            int historyPort = conn["history_port"].toInt(5557);
+            QString accountId = conn["account_id"].toString();
             
             // 配置 ZMQ 地址
             QuantLabs::zmq_topics::Config::instance().setServerAddress(serverAddr.toStdString());
             QuantLabs::zmq_topics::Config::instance().setPubPort(pubPort);
             QuantLabs::zmq_topics::Config::instance().setRepPort(repPort);
+            QuantLabs::zmq_topics::Config::instance().setHistoryPort(historyPort);
+            QuantLabs::zmq_topics::Config::instance().setAccountId(accountId.toStdString());
             
             qDebug() << "[Main] Loaded config: Server =" << serverAddr 
-                     << "PubPort =" << pubPort << "RepPort =" << repPort;
+                     << "PubPort =" << pubPort << "RepPort =" << repPort
+                     << "Account =" << (accountId.isEmpty() ? QStringLiteral("<all>") : accountId);
         }
     } else {
         qDebug() << "[Main] No config.json found, using default (127.0.0.1:5555/5556)";
     }
     
+    if (benchmark) {
+        // 覆盖 config.json: 连接模拟发布端，绑定其模拟账户
+        const QString host = parser.isSet(externalOpt) ? parser.value(hostOpt) : QStringLiteral("127.0.0.1");
+        QuantLabs::zmq_topics::Config::instance().setServerAddress(host.toStdString());
+        QuantLabs::zmq_topics::Config::instance().setPubPort(benchPort);
+        QuantLabs::zmq_topics::Config::instance().setRepPort(benchPort + 1);
+        QuantLabs::zmq_topics::Config::instance().setAccountId(QuantLabs::SyntheticPublisher::kAccountId);
+        if (!parser.isSet(externalOpt)) startPublisher("tcp://127.0.0.1:" + std::to_string(benchPort));
+    }
+
     // 从 QSettings 加载字体大小
     QSettings settings;
     settings.beginGroup("UI");  // UI 设置
     int fontSize = settings.value("fontSize", 16).toInt();
+    int tickFps = settings.value("tickFps", 0).toInt(); // 行情刷新帧率，0 跟随屏幕
     settings.endGroup();
     
     // 设置全局字体（使用跨平台字体）
@@ -72,6 +152,7 @@ int main(int argc, char *argv[]) {
     app.setFont(font);
     
     qRegisterMetaType<QuantLabs::TickData>("TickData");
+    qRegisterMetaType<QuantLabs::PositionData>("PositionData");
     
     qDebug() << "[Main] Font size:" << fontSize;
 
@@ -83,6 +164,7 @@ int main(int argc, char *argv[]) {
     QuantLabs::OrderController* orderController = new QuantLabs::OrderController(&app);
     QuantLabs::OrderModel* orderModel = new QuantLabs::OrderModel(&app);
     QuantLabs::TradeModel* tradeModel = new QuantLabs::TradeModel(&app);
+    QuantLabs::QuoteBoardModel* quoteBoardModel = new QuantLabs::QuoteBoardModel(&app);
 
     qDebug() << "[Main] Created marketModel:" << marketModel << "rows:" << marketModel->rowCount();
     
@@ -93,15 +175,33 @@ int main(int argc, char *argv[]) {
     engine.rootContext()->setContextProperty("AppOrderController", orderController);
     engine.rootContext()->setContextProperty("AppOrderModel", orderModel);
     engine.rootContext()->setContextProperty("AppTradeModel", tradeModel);
+    engine.rootContext()->setContextProperty("AppQuoteBoardModel", quoteBoardModel);
     
     qDebug() << "[Main] Set context properties";
 
+    // 最新行情缓存: 启动时一次映射即恢复上次的合约信息与最新价，之后由实时数据刷新
+    QuantLabs::TickCache* tickCache = new QuantLabs::TickCache(&app);
+    if (tickCache->open(QCoreApplication::applicationDirPath() + "/" + app.applicationName() + "_ticks.cache")) {
+        for (const QJsonObject& inst : tickCache->instruments()) {
+            positionModel->updateInstrument(inst);
+            orderController->updateInstrument(inst);
+            quoteBoardModel->updateInstrument(inst);
+        }
+        quoteBoardModel->updateTicksBinary(tickCache->ticks());
+        marketModel->setTickCache(tickCache);
+        orderController->setTickCache(tickCache);
+    }
+
 // 2. 创建 ZMQ 工作线程 (Market Data)
     QThread* workerThread = new QThread();
     QuantLabs::ZmqWorker* worker = new QuantLabs::ZmqWorker();
     worker->moveToThread(workerThread);
+
+    // 二进制行情按帧合并: Worker 线程写入，GUI 线程每帧取走一次
+    QuantLabs::TickBatcher* tickBatcher = new QuantLabs::TickBatcher(&app);
+    worker->setTickBatcher(tickBatcher);
     
-    // 3. 创建 Command 工作线程 (REQ-REP)
+    // 3. 创建 Command 工作线程 (DEALER-ROUTER)
     QThread* commandThread = new QThread();
     QuantLabs::CommandWorker* commandWorker = new QuantLabs::CommandWorker();
     commandWorker->moveToThread(commandThread);
@@ -114,13 +214,25 @@ int main(int argc, char *argv[]) {
 
     // 分发不同主题的消息
     QObject::connect(worker, &QuantLabs::ZmqWorker::tickReceived, marketModel, &QuantLabs::MarketModel::updateTick);
-    QObject::connect(worker, &QuantLabs::ZmqWorker::tickReceivedBinary, marketModel, &QuantLabs::MarketModel::updateTickBinary);
+    QObject::connect(tickBatcher, &QuantLabs::TickBatcher::ticksReady, marketModel, &QuantLabs::MarketModel::updateTicksBinary);
 
-    // 行情同时也发给持仓模型计算盈亏
+    // 行情同时也发给持仓模型 (只刷新价格列，浮盈由 core 推送)
     QObject::connect(worker, &QuantLabs::ZmqWorker::tickReceived, positionModel, &QuantLabs::PositionModel::updatePrice);
-    QObject::connect(worker, &QuantLabs::ZmqWorker::tickReceivedBinary, positionModel, &QuantLabs::PositionModel::updatePriceBinary);
+    QObject::connect(tickBatcher, &QuantLabs::TickBatcher::ticksReady, positionModel, &QuantLabs::PositionModel::updatePricesBinary);
 
-    QObject::connect(worker, &QuantLabs::ZmqWorker::positionReceived, positionModel, &QuantLabs::PositionModel::updatePosition);
+    // 全市场排行榜: 所有合约的行情与合约信息
+    QObject::connect(tickBatcher, &QuantLabs::TickBatcher::ticksReady, quoteBoardModel, &QuantLabs::QuoteBoardModel::updateTicksBinary);
+    QObject::connect(worker, &QuantLabs::ZmqWorker::instrumentReceived, quoteBoardModel, &QuantLabs::QuoteBoardModel::updateInstrument);
+
+    // 实时数据写回缓存 (直接写映射内存)
+    QObject::connect(tickBatcher, &QuantLabs::TickBatcher::ticksReady, tickCache, &QuantLabs::TickCache::updateTicks);
+    QObject::connect(worker, &QuantLabs::ZmqWorker::instrumentReceived, tickCache, &QuantLabs::TickCache::updateInstrument);
+
+    QObject::connect(worker, &QuantLabs::ZmqWorker::positionReceivedBinary, positionModel, &QuantLabs::PositionModel::updatePositionBinary);
+    QObject::connect(worker, &QuantLabs::ZmqWorker::positionSnapshotReceived, positionModel, &QuantLabs::PositionModel::resetPositions);
+    QObject::connect(worker, &QuantLabs::ZmqWorker::positionSnapshotReceived, orderController, [orderController](const QJsonArray& positions) {
+        for (const auto& v : positions) orderController->onPositionReceived(v.toObject());
+    });
     QObject::connect(worker, &QuantLabs::ZmqWorker::accountReceived, accountInfo, &QuantLabs::AccountInfo::updateAccount);
     // 连接合约信息到 MarketModel，确保订阅后能立即显示条目
     QObject::connect(worker, &QuantLabs::ZmqWorker::instrumentReceived, marketModel, &QuantLabs::MarketModel::handleInstrument);
@@ -129,8 +241,12 @@ int main(int argc, char *argv[]) {
     QObject::connect(worker, &QuantLabs::ZmqWorker::instrumentReceived, orderController, &QuantLabs::OrderController::updateInstrument);
     
     QObject::connect(worker, &QuantLabs::ZmqWorker::orderReceived, orderModel, &QuantLabs::OrderModel::onOrderReceived);
+
+    // 价格阶梯: 切换合约时取在途报单，之后按价位增量更新
+    orderController->setOrderModel(orderModel);
+    QObject::connect(orderModel, &QuantLabs::OrderModel::workingVolumeChanged, orderController->ladder(), &QuantLabs::DomLadderModel::onWorkingVolumeChanged);
     QObject::connect(worker, &QuantLabs::ZmqWorker::tradeReceived, tradeModel, &QuantLabs::TradeModel::onTradeReceived);
-    QObject::connect(worker, &QuantLabs::ZmqWorker::positionReceived, orderController, &QuantLabs::OrderController::onPositionReceived);
+    QObject::connect(worker, &QuantLabs::ZmqWorker::positionReceivedBinary, orderController, &QuantLabs::OrderController::onPositionReceivedBinary);
     
     // 连接状态更新 (Worker -> OrderController)
     // 连接状态更新 (Separated)
@@ -147,7 +263,8 @@ int main(int argc, char *argv[]) {
 
     // 连接行情到 OrderController 以实现自动跟价
     QObject::connect(worker, &QuantLabs::ZmqWorker::tickReceived, orderController, &QuantLabs::OrderController::onTick);
-    QObject::connect(worker, &QuantLabs::ZmqWorker::tickReceivedBinary, orderController, &QuantLabs::OrderController::onTickBinary);
+    QObject::connect(tickBatcher, &QuantLabs::TickBatcher::ticksReady, orderController, &QuantLabs::OrderController::onTicksBinary);
+    tickBatcher->start(tickFps);
     
     // 发送指令链路 (UI -> Controller -> CommandWorker -> Core)
     // 显式使用 QueuedConnection (跨线程)
@@ -156,10 +273,24 @@ int main(int argc, char *argv[]) {
                                      Qt::QueuedConnection);
     qDebug() << "[Main] orderController.orderSent -> commandWorker.sendCommand connection:" << (connected ? "SUCCESS" : "FAILED");
     
-    // Market Worker 需要发送指令时 (如 SYNC_STATE)，转给 Command Worker
+    // 历史 Bar/Tick 查询: 指令走 Command Worker，分块结果由 HistoryClient 在自己的线程接收
+    QThread* historyThread = new QThread();
+    QuantLabs::HistoryClient* historyClient = new QuantLabs::HistoryClient();
+    historyClient->moveToThread(historyThread);
+    QObject::connect(historyThread, &QThread::started, historyClient, &QuantLabs::HistoryClient::connectToCore);
+    QObject::connect(historyClient, &QuantLabs::HistoryClient::commandRequired,
+                     commandWorker, &QuantLabs::CommandWorker::sendCommand,
+                     Qt::QueuedConnection);
+    engine.rootContext()->setContextProperty("AppHistoryClient", historyClient);
+
+    // Market Worker 需要发送指令时 (如 req_snapshot)，转给 Command Worker
     QObject::connect(worker, &QuantLabs::ZmqWorker::commandRequired,
                      commandWorker, &QuantLabs::CommandWorker::sendCommand,
                      Qt::QueuedConnection);
+    // 快照应答回到 Market Worker，与缓存的增量按序号衔接
+    QObject::connect(commandWorker, &QuantLabs::CommandWorker::commandReplyReceived,
+                     worker, &QuantLabs::ZmqWorker::onCommandReply,
+                     Qt::QueuedConnection);
 
     // 连接持仓总盈亏到资金面板
     QObject::connect(positionModel, &QuantLabs::PositionModel::totalProfitChanged, accountInfo, &QuantLabs::AccountInfo::setFloatingProfit);
@@ -171,19 +302,26 @@ int main(int argc, char *argv[]) {
     QObject::connect(worker, &QuantLabs::ZmqWorker::conditionOrderReceived, orderController, &QuantLabs::OrderController::onConditionOrderReturn);
     
     // Cleanup Market Worker
-    QObject::connect(&app, &QGuiApplication::aboutToQuit, worker, &QuantLabs::ZmqWorker::stop);
+    // stop 在 Worker 线程同步执行完 (关闭 socket) 再退出线程事件循环
+    QObject::connect(&app, &QGuiApplication::aboutToQuit, worker, &QuantLabs::ZmqWorker::stop, Qt::BlockingQueuedConnection);
     QObject::connect(&app, &QGuiApplication::aboutToQuit, workerThread, &QThread::quit);
     QObject::connect(workerThread, &QThread::finished, worker, &QObject::deleteLater);
     QObject::connect(workerThread, &QThread::finished, workerThread, &QObject::deleteLater);
 
     // Cleanup Command Worker
-    // CommandWorker 没有 loop，只需要 quit 线程
+    // CommandWorker 由定时器/QSocketNotifier 驱动，quit 线程即可
     QObject::connect(&app, &QGuiApplication::aboutToQuit, commandThread, &QThread::quit);
     QObject::connect(commandThread, &QThread::finished, commandWorker, &QObject::deleteLater);
     QObject::connect(commandThread, &QThread::finished, commandThread, &QObject::deleteLater);
 
+    // Cleanup History Client
+    QObject::connect(&app, &QGuiApplication::aboutToQuit, historyThread, &QThread::quit);
+    QObject::connect(historyThread, &QThread::finished, historyClient, &QObject::deleteLater);
+    QObject::connect(historyThread, &QThread::finished, historyThread, &QObject::deleteLater);
+
     workerThread->start();
     commandThread->start();
+    historyThread->start();
 
     // 3. 加载 QML
     const QUrl url(QStringLiteral("qrc:/main.qml"));
@@ -196,5 +334,37 @@ int main(int argc, char *argv[]) {
 
     engine.load(url);
 
+    if (benchmark) {
+        QuantLabs::BenchmarkMonitor::Options benchOptions;
+        benchOptions.durationSec = parser.value(durationOpt).toInt();
+        benchOptions.warmupSec = parser.value(warmupOpt).toInt();
+        benchOptions.reportPath = parser.value(reportOpt);
+        benchOptions.config = QJsonObject{
+            {"instruments", benchRates.instruments},
+            {"rows", parser.value(rowsOpt).toInt()},
+            {"tick_rate", benchRates.ticksPerSec},
+            {"order_rate", benchRates.ordersPerSec},
+            {"trade_rate", benchRates.tradesPerSec},
+            {"tick_fps", tickFps},
+            {"external_publisher", parser.isSet(externalOpt)},
+        };
+
+        // 在各模型之后连接，槽函数执行时模型已处理完同一批数据
+        auto* monitor = new QuantLabs::BenchmarkMonitor(benchOptions, tickBatcher, &app);
+        tickBatcher->setRecordPublishTimes(true);
+        QObject::connect(tickBatcher, &QuantLabs::TickBatcher::ticksReady, monitor, &QuantLabs::BenchmarkMonitor::onTicksReady);
+        QObject::connect(worker, &QuantLabs::ZmqWorker::orderReceived, monitor, &QuantLabs::BenchmarkMonitor::onOrderReceived);
+        QObject::connect(worker, &QuantLabs::ZmqWorker::tradeReceived, monitor, &QuantLabs::BenchmarkMonitor::onTradeReceived);
+        monitor->setPublisher(publisher);
+        monitor->attachWindow(engine.rootObjects().isEmpty() ? nullptr
+                              : qobject_cast<QQuickWindow*>(engine.rootObjects().first()));
+
+        // 行情列表显示前 N 个模拟合约，当前合约设为第一个 (下单面板/价格阶梯随之刷新)
+        const int rows = std::min(parser.value(rowsOpt).toInt(), benchRates.instruments);
+        for (int i = 0; i < rows; ++i) marketModel->addInstrument(QuantLabs::SyntheticPublisher::instrumentId(i));
+        if (rows > 0) orderController->setInstrumentId(QuantLabs::SyntheticPublisher::instrumentId(0));
+        monitor->start();
+    }
+
     return app.exec();
 }
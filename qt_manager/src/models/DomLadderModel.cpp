@@ -0,0 +1,239 @@
+#include "models/DomLadderModel.h"
+
+#include <QDebug>
+#include <algorithm>
+#include <cmath>
+
+namespace QuantLabs {
+
+namespace {
+
+// 五档盘口按 (价格, 量) 展开
+struct DepthLevel {
+    double price;
+    int volume;
+};
+
+void bidLevels(const TickData& d, DepthLevel (&out)[5]) {
+    out[0] = {d.bid_price1, d.bid_volume1};
+    out[1] = {d.bid_price2, d.bid_volume2};
+    out[2] = {d.bid_price3, d.bid_volume3};
+    out[3] = {d.bid_price4, d.bid_volume4};
+    out[4] = {d.bid_price5, d.bid_volume5};
+}
+
+void askLevels(const TickData& d, DepthLevel (&out)[5]) {
+    out[0] = {d.ask_price1, d.ask_volume1};
+    out[1] = {d.ask_price2, d.ask_volume2};
+    out[2] = {d.ask_price3, d.ask_volume3};
+    out[3] = {d.ask_price4, d.ask_volume4};
+    out[4] = {d.ask_price5, d.ask_volume5};
+}
+
+} // namespace
+
+DomLadderModel::DomLadderModel(QObject *parent)
+    : QAbstractListModel(parent) {
+}
+
+int DomLadderModel::rowCount(const QModelIndex &parent) const {
+    if (parent.isValid()) return 0;
+    return _top == kNone ? 0 : kLevels;
+}
+
+QVariant DomLadderModel::data(const QModelIndex &index, int role) const {
+    if (!index.isValid() || _top == kNone || index.row() >= kLevels) return QVariant();
+
+    const int row = index.row();
+    switch (role) {
+        case PriceRole: return _price[row];
+        case BidVolumeRole: return _bidVolume[row];
+        case AskVolumeRole: return _askVolume[row];
+        case MyBuyRole: return _myBuy[row];
+        case MySellRole: return _mySell[row];
+        case IsLastRole: return rowOf(_lastIdx) == row;
+        case IsBestBidRole: return rowOf(_bestBidIdx) == row;
+        case IsBestAskRole: return rowOf(_bestAskIdx) == row;
+        default: return QVariant();
+    }
+}
+
+QHash<int, QByteArray> DomLadderModel::roleNames() const {
+    QHash<int, QByteArray> roles;
+    roles[PriceRole] = "price";
+    roles[BidVolumeRole] = "bidVolume";
+    roles[AskVolumeRole] = "askVolume";
+    roles[MyBuyRole] = "myBuy";
+    roles[MySellRole] = "mySell";
+    roles[IsLastRole] = "isLast";
+    roles[IsBestBidRole] = "isBestBid";
+    roles[IsBestAskRole] = "isBestAsk";
+    return roles;
+}
+
+void DomLadderModel::setInstrument(const QString& instrumentId, double priceTick, const std::vector<OrderItem>& working) {
+    beginResetModel();
+    _instrumentId = instrumentId;
+    _priceTick = (priceTick < 1e-6) ? 1.0 : priceTick;
+    _top = kNone;
+    _lastIdx = _bestBidIdx = _bestAskIdx = kNone;
+    _hasTick = false;
+    _working[0].clear();
+    _working[1].clear();
+    for (const OrderItem& o : working) {
+        if (o.volume_total > 0) _working[o.direction == "0" ? 0 : 1][o.limit_price] += o.volume_total;
+    }
+    endResetModel();
+
+    emit instrumentChanged();
+    emit lastRowChanged();
+}
+
+void DomLadderModel::setPriceTick(double priceTick) {
+    if (priceTick < 1e-6) priceTick = 1.0;
+    if (priceTick == _priceTick) return;
+    _priceTick = priceTick;
+    emit instrumentChanged();
+    // 价位序号随最小变动价位变化，整体重排
+    if (_hasTick) recenter();
+}
+
+void DomLadderModel::updateDepth(const TickData& data) {
+    _lastTick = data;
+    _hasTick = true;
+
+    // 首笔行情或最新价离开中间一半区域时整体平移
+    if (validPrice(data.last_price)) {
+        const int64_t idx = tickIndex(data.last_price);
+        const int row = (_top == kNone) ? -1 : static_cast<int>(std::clamp<int64_t>(_top - idx, -1, kLevels));
+        if (row < kLevels / 4 || row > kLevels * 3 / 4) {
+            recenter();
+            return;
+        }
+    }
+    if (_top == kNone) return;
+
+    int first = kLevels, last = -1;
+    auto touch = [&](int row) {
+        if (row < 0) return;
+        first = std::min(first, row);
+        last = std::max(last, row);
+    };
+
+    // 新盘口与当前列逐行比较
+    std::array<int, kLevels> bid{}, ask{};
+    depthColumns(data, bid, ask);
+    for (int row = 0; row < kLevels; ++row) {
+        if (bid[row] != _bidVolume[row] || ask[row] != _askVolume[row]) touch(row);
+    }
+    _bidVolume = bid;
+    _askVolume = ask;
+
+    auto moveMarker = [&](int64_t& marker, double price) {
+        const int64_t idx = validPrice(price) ? tickIndex(price) : kNone;
+        if (idx == marker) return false;
+        touch(rowOf(marker));
+        marker = idx;
+        touch(rowOf(marker));
+        return true;
+    };
+    moveMarker(_bestBidIdx, data.bid_price1);
+    moveMarker(_bestAskIdx, data.ask_price1);
+    const bool lastMoved = moveMarker(_lastIdx, data.last_price);
+
+    if (last >= first) {
+        emit dataChanged(index(first), index(last),
+                         {BidVolumeRole, AskVolumeRole, IsLastRole, IsBestBidRole, IsBestAskRole});
+    }
+    if (lastMoved) emit lastRowChanged();
+}
+
+bool DomLadderModel::isLadderPrice(double price) const {
+    if (_top == kNone || !validPrice(price)) return false;
+    if (std::abs(price - tickIndex(price) * _priceTick) > _priceTick * 1e-6) return false;
+    if (_hasTick) {
+        const double halfTick = _priceTick / 2;
+        if (validPrice(_lastTick.upper_limit_price) && price > _lastTick.upper_limit_price + halfTick) return false;
+        if (validPrice(_lastTick.lower_limit_price) && price < _lastTick.lower_limit_price - halfTick) return false;
+    }
+    return true;
+}
+
+void DomLadderModel::recenter() {
+    if (!_hasTick || !validPrice(_lastTick.last_price)) return;
+
+    const bool wasEmpty = (_top == kNone);
+    if (wasEmpty) beginResetModel();
+    _top = tickIndex(_lastTick.last_price) + kLevels / 2;
+    fillRows();
+    if (wasEmpty) endResetModel();
+    else emit dataChanged(index(0), index(kLevels - 1));
+
+    emit lastRowChanged();
+    emit recentered();
+}
+
+void DomLadderModel::onWorkingVolumeChanged(const QString& instrumentId, const QString& direction, double price, int delta) {
+    if (instrumentId != _instrumentId || delta == 0) return;
+
+    const int side = (direction == "0") ? 0 : 1;
+    auto& book = _working[side];
+    auto it = book.emplace(price, 0).first;
+    it->second += delta;
+    if (it->second <= 0) book.erase(it);
+
+    const int row = rowOf(tickIndex(price));
+    if (row < 0) return;
+    auto& column = side == 0 ? _myBuy : _mySell;
+    column[row] = std::max(0, column[row] + delta);
+    emit dataChanged(index(row), index(row), {side == 0 ? MyBuyRole : MySellRole});
+}
+
+int64_t DomLadderModel::tickIndex(double price) const {
+    return std::llround(price / _priceTick);
+}
+
+int DomLadderModel::rowOf(int64_t idx) const {
+    if (idx == kNone || _top == kNone) return -1;
+    const int64_t row = _top - idx;
+    return (row >= 0 && row < kLevels) ? static_cast<int>(row) : -1;
+}
+
+void DomLadderModel::depthColumns(const TickData& data, std::array<int, kLevels>& bid, std::array<int, kLevels>& ask) const {
+    DepthLevel levels[5];
+    bidLevels(data, levels);
+    for (const auto& l : levels) {
+        const int row = validPrice(l.price) ? rowOf(tickIndex(l.price)) : -1;
+        if (row >= 0) bid[row] = l.volume;
+    }
+    askLevels(data, levels);
+    for (const auto& l : levels) {
+        const int row = validPrice(l.price) ? rowOf(tickIndex(l.price)) : -1;
+        if (row >= 0) ask[row] = l.volume;
+    }
+}
+
+void DomLadderModel::fillRows() {
+    for (int row = 0; row < kLevels; ++row) {
+        _price[row] = static_cast<double>(_top - row) * _priceTick;
+    }
+    _bidVolume.fill(0);
+    _askVolume.fill(0);
+    _myBuy.fill(0);
+    _mySell.fill(0);
+
+    depthColumns(_lastTick, _bidVolume, _askVolume);
+    _lastIdx = validPrice(_lastTick.last_price) ? tickIndex(_lastTick.last_price) : kNone;
+    _bestBidIdx = validPrice(_lastTick.bid_price1) ? tickIndex(_lastTick.bid_price1) : kNone;
+    _bestAskIdx = validPrice(_lastTick.ask_price1) ? tickIndex(_lastTick.ask_price1) : kNone;
+
+    for (int side = 0; side < 2; ++side) {
+        auto& column = side == 0 ? _myBuy : _mySell;
+        for (const auto& [price, volume] : _working[side]) {
+            const int row = rowOf(tickIndex(price));
+            if (row >= 0) column[row] += volume;
+        }
+    }
+}
+
+} // namespace QuantLabs
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <QAbstractListModel>
+#include <QHash>
+#include <QString>
+#include <array>
+#include <cstdint>
+#include <map>
+#include <vector>
+#include "models/OrderModel.h"
+#include "protocol/message_schema.h"
+
+namespace QuantLabs {
+
+/**
+ * @brief 价格阶梯 (DOM) 模型，当前合约一份
+ *
+ * - 固定 kLevels 档价位，第 0 行为最高价，行号 = _top - round(price / priceTick)
+ * - 最新价偏离中间区域时整体平移 (recentered)，其余情况每笔行情只通知变化的行区间
+ * - 每档同时挂出本账户在途报单的剩余手数 (买/卖)，由 OrderModel::workingVolumeChanged 增量维护
+ */
+class DomLadderModel : public QAbstractListModel {
+    Q_OBJECT
+    Q_PROPERTY(QString instrumentId READ instrumentId NOTIFY instrumentChanged)
+    Q_PROPERTY(double priceTick READ priceTick NOTIFY instrumentChanged)
+    Q_PROPERTY(int lastRow READ lastRow NOTIFY lastRowChanged)
+public:
+    static constexpr int kLevels = 41;
+
+    enum LadderRoles {
+        PriceRole = Qt::UserRole + 1,
+        BidVolumeRole,
+        AskVolumeRole,
+        MyBuyRole,          // 本账户该价位买单剩余手数
+        MySellRole,         // 本账户该价位卖单剩余手数
+        IsLastRole,
+        IsBestBidRole,
+        IsBestAskRole
+    };
+
+    explicit DomLadderModel(QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+    QString instrumentId() const { return _instrumentId; }
+    double priceTick() const { return _priceTick; }
+    int lastRow() const { return rowOf(_lastIdx); }
+
+    /**
+     * @brief 切换合约 (清空阶梯，working 为该合约当前在途报单)
+     */
+    void setInstrument(const QString& instrumentId, double priceTick, const std::vector<OrderItem>& working);
+    // 合约信息晚到时补上最小变动价位
+    void setPriceTick(double priceTick);
+
+    // 当前合约的一笔行情 (由 OrderController 每帧调用一次)
+    void updateDepth(const TickData& data);
+
+    // 点价校验: 界面显示的价位是否为当前合约的有效档位 (在最小变动价位网格上且不超出涨跌停)
+    bool isLadderPrice(double price) const;
+    // 以最新价为中心重新排列
+    Q_INVOKABLE void recenter();
+
+public slots:
+    void onWorkingVolumeChanged(const QString& instrumentId, const QString& direction, double price, int delta);
+
+signals:
+    void instrumentChanged();
+    void lastRowChanged();
+    void recentered();
+
+private:
+    static constexpr int64_t kNone = INT64_MIN;
+
+    int64_t tickIndex(double price) const;
+    int rowOf(int64_t idx) const;
+    bool validPrice(double price) const { return price > 0.0001 && price < 1e12; }
+    // 按当前 _top 把五档盘口落到行上
+    void depthColumns(const TickData& data, std::array<int, kLevels>& bid, std::array<int, kLevels>& ask) const;
+    // 按当前 _top 从最近一笔行情与在途报单重算整列，不发信号
+    void fillRows();
+
+    QString _instrumentId;
+    double _priceTick = 1.0;
+    int64_t _top = kNone;           // 第 0 行的价位序号 (price / priceTick)
+    int64_t _lastIdx = kNone;
+    int64_t _bestBidIdx = kNone;
+    int64_t _bestAskIdx = kNone;
+
+    // 按行存储的列
+    std::array<double, kLevels> _price{};
+    std::array<int, kLevels> _bidVolume{};
+    std::array<int, kLevels> _askVolume{};
+    std::array<int, kLevels> _myBuy{};
+    std::array<int, kLevels> _mySell{};
+
+    // 在途报单剩余手数: 报单价 -> 手数 ([0] 买 / [1] 卖)，不受阶梯范围限制
+    std::map<double, int> _working[2];
+    TickData _lastTick{};
+    bool _hasTick = false;
+};
+
+} // namespace QuantLabs
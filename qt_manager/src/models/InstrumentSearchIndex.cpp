@@ -0,0 +1,269 @@
+#include "models/InstrumentSearchIndex.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace QuantLabs {
+
+namespace {
+
+// 期货/期权合约名称用字的拼音首字母 (按码位升序，二分查找)
+// 覆盖国内各交易所品种名及"期权/看涨/连续"等常见字；表外汉字不参与首字母匹配
+struct PinyinInitial {
+    uint16_t cp;
+    char letter;
+};
+
+constexpr PinyinInitial kInitials[] = {
+    {0x4E00,'Y'}, {0x4E01,'D'}, {0x4E07,'W'}, {0x4E09,'S'}, {0x4E0A,'S'}, {0x4E0D,'B'}, {0x4E19,'B'}, {0x4E1A,'Y'},
+    {0x4E1C,'D'}, {0x4E2D,'Z'}, {0x4E3B,'Z'}, {0x4E59,'Y'}, {0x4E8C,'E'}, {0x4E94,'W'}, {0x4EBA,'R'}, {0x4F4E,'D'},
+    {0x503A,'Z'}, {0x5143,'Y'}, {0x5168,'Q'}, {0x521B,'C'}, {0x5229,'L'}, {0x529B,'L'}, {0x52A8,'D'}, {0x5316,'H'},
+    {0x5317,'B'}, {0x5341,'S'}, {0x5343,'Q'}, {0x534E,'H'}, {0x5357,'N'}, {0x5377,'J'}, {0x539F,'Y'}, {0x53F7,'H'},
+    {0x5408,'H'}, {0x54C1,'P'}, {0x5546,'S'}, {0x56FD,'G'}, {0x578B,'X'}, {0x5851,'S'}, {0x591A,'D'}, {0x5927,'D'},
+    {0x5929,'T'}, {0x5BC6,'M'}, {0x5BF9,'D'}, {0x5C0F,'X'}, {0x5C3F,'N'}, {0x5DE5,'G'}, {0x5E01,'B'}, {0x5E72,'G'},
+    {0x5E74,'N'}, {0x5EA6,'D'}, {0x5F3A,'Q'}, {0x606F,'X'}, {0x6210,'C'}, {0x6240,'S'}, {0x6307,'Z'}, {0x6563,'S'},
+    {0x6570,'S'}, {0x6599,'L'}, {0x65B0,'X'}, {0x65B9,'F'}, {0x65E9,'Z'}, {0x665A,'W'}, {0x666E,'P'}, {0x6676,'J'},
+    {0x671F,'Q'}, {0x6728,'M'}, {0x6743,'Q'}, {0x6750,'C'}, {0x677F,'B'}, {0x679C,'G'}, {0x67A3,'Z'}, {0x68C9,'M'},
+    {0x68D5,'Z'}, {0x6988,'L'}, {0x6A61,'X'}, {0x6B27,'O'}, {0x6C11,'M'}, {0x6C14,'Q'}, {0x6C27,'Y'}, {0x6C2F,'L'},
+    {0x6C47,'H'}, {0x6CA5,'L'}, {0x6CAA,'H'}, {0x6CB9,'Y'}, {0x6CBD,'G'}, {0x6D46,'J'}, {0x6DA8,'Z'}, {0x6DB2,'Y'},
+    {0x6DC0,'D'}, {0x6DF1,'S'}, {0x6E90,'Y'}, {0x70AD,'T'}, {0x70E7,'S'}, {0x70ED,'R'}, {0x70EF,'X'}, {0x70F7,'W'},
+    {0x7126,'J'}, {0x7136,'R'}, {0x7164,'M'}, {0x71C3,'R'}, {0x7247,'P'}, {0x7269,'W'}, {0x732A,'Z'}, {0x7387,'L'},
+    {0x7389,'Y'}, {0x73BB,'B'}, {0x7403,'Q'}, {0x7483,'L'}, {0x74F6,'P'}, {0x751F,'S'}, {0x7532,'J'}, {0x767D,'B'},
+    {0x767E,'B'}, {0x76D8,'P'}, {0x770B,'K'}, {0x77ED,'D'}, {0x77F3,'S'}, {0x77FF,'K'}, {0x7845,'G'}, {0x786B,'L'},
+    {0x786C,'Y'}, {0x78B1,'J'}, {0x78B3,'T'}, {0x79D1,'K'}, {0x7A3B,'D'}, {0x7B4B,'J'}, {0x7BB1,'X'}, {0x7C73,'M'},
+    {0x7C7C,'X'}, {0x7C7D,'Z'}, {0x7C89,'F'}, {0x7C95,'P'}, {0x7CB3,'J'}, {0x7CBE,'J'}, {0x7CD6,'T'}, {0x7D20,'S'},
+    {0x7EA2,'H'}, {0x7EA4,'X'}, {0x7EA7,'J'}, {0x7EAF,'C'}, {0x7EB1,'S'}, {0x7EB8,'Z'}, {0x7EB9,'W'}, {0x7EBF,'X'},
+    {0x7EED,'X'}, {0x7EF4,'W'}, {0x7F8E,'M'}, {0x805A,'J'}, {0x80A1,'G'}, {0x80F6,'J'}, {0x80FD,'N'}, {0x8102,'Z'},
+    {0x822A,'H'}, {0x8239,'C'}, {0x82B1,'H'}, {0x82EF,'B'}, {0x82F9,'P'}, {0x83DC,'C'}, {0x86CB,'D'}, {0x87BA,'L'},
+    {0x8BC1,'Z'}, {0x8C37,'G'}, {0x8C46,'D'}, {0x8D27,'H'}, {0x8D2D,'G'}, {0x8DCC,'D'}, {0x8F67,'Z'}, {0x8F6F,'R'},
+    {0x8FD0,'Y'}, {0x8FDE,'L'}, {0x9020,'Z'}, {0x90D1,'Z'}, {0x9178,'S'}, {0x9187,'C'}, {0x91D1,'J'}, {0x94A2,'G'},
+    {0x94AF,'B'}, {0x94C1,'T'}, {0x94C2,'B'}, {0x94C5,'Q'}, {0x94DC,'T'}, {0x94DD,'L'}, {0x94F6,'Y'}, {0x94F8,'Z'},
+    {0x9502,'L'}, {0x9508,'X'}, {0x950C,'X'}, {0x9521,'X'}, {0x9530,'M'}, {0x954D,'N'}, {0x9645,'J'}, {0x96C6,'J'},
+    {0x9752,'Q'}, {0x9AD8,'G'}, {0x9E21,'J'}, {0x9EA6,'M'}, {0x9EC4,'H'},
+};
+
+char initialOf(uint32_t cp) {
+    auto it = std::lower_bound(std::begin(kInitials), std::end(kInitials), cp,
+                               [](const PinyinInitial& e, uint32_t v) { return e.cp < v; });
+    return (it != std::end(kInitials) && it->cp == cp) ? it->letter : '*';
+}
+
+std::string asciiUpper(std::string_view s) {
+    std::string out(s);
+    for (char& c : out) {
+        if (c >= 'a' && c <= 'z') c = static_cast<char>(c - 'a' + 'A');
+    }
+    return out;
+}
+
+} // namespace
+
+std::vector<uint32_t> InstrumentSearchIndex::codepoints(std::string_view s) {
+    std::vector<uint32_t> out;
+    out.reserve(s.size());
+    size_t i = 0;
+    while (i < s.size()) {
+        const auto b = static_cast<unsigned char>(s[i]);
+        int len = b < 0x80 ? 1 : (b >> 5) == 0x6 ? 2 : (b >> 4) == 0xE ? 3 : (b >> 3) == 0x1E ? 4 : 0;
+        if (len == 0 || i + len > s.size()) {
+            out.push_back(b); // 非法字节按单字节处理
+            ++i;
+            continue;
+        }
+        uint32_t cp = len == 1 ? b : len == 2 ? (b & 0x1F) : len == 3 ? (b & 0x0F) : (b & 0x07);
+        for (int k = 1; k < len; ++k) cp = (cp << 6) | (static_cast<unsigned char>(s[i + k]) & 0x3F);
+        out.push_back(cp);
+        i += len;
+    }
+    return out;
+}
+
+std::string InstrumentSearchIndex::initials(std::string_view utf8) {
+    std::string out;
+    for (uint32_t cp : codepoints(utf8)) {
+        if (cp < 0x80) {
+            char c = static_cast<char>(cp);
+            out.push_back((c >= 'a' && c <= 'z') ? static_cast<char>(c - 'a' + 'A') : c);
+        } else {
+            out.push_back(initialOf(cp));
+        }
+    }
+    return out;
+}
+
+uint32_t InstrumentSearchIndex::childOf(uint32_t node, char ch) const {
+    for (uint32_t c = _nodes[node].child; c != 0; c = _nodes[c].sibling) {
+        if (_nodes[c].ch == ch) return c;
+        if (_nodes[c].ch > ch) break;
+    }
+    return 0;
+}
+
+uint32_t InstrumentSearchIndex::insertChild(uint32_t node, char ch) {
+    uint32_t prev = 0;
+    uint32_t cur = _nodes[node].child;
+    while (cur != 0 && _nodes[cur].ch < ch) {
+        prev = cur;
+        cur = _nodes[cur].sibling;
+    }
+    if (cur != 0 && _nodes[cur].ch == ch) return cur;
+
+    // push_back 可能使引用失效，全程用下标
+    const auto created = static_cast<uint32_t>(_nodes.size());
+    Node n;
+    n.ch = ch;
+    n.sibling = cur;
+    _nodes.push_back(n);
+    if (prev == 0) _nodes[node].child = created;
+    else _nodes[prev].sibling = created;
+    return created;
+}
+
+void InstrumentSearchIndex::trieInsert(const std::string& key, uint32_t doc) {
+    uint32_t node = 0;
+    for (char ch : key) node = insertChild(node, ch);
+    _docs[doc].sameKeyNext = _nodes[node].doc;
+    _nodes[node].doc = doc;
+}
+
+void InstrumentSearchIndex::addGrams(const std::string& text, uint32_t doc) {
+    auto add = [&](uint64_t key) {
+        auto& list = _grams[key];
+        // 新文档号最大，通常直接追加
+        if (list.empty() || list.back() < doc) {
+            list.push_back(doc);
+            return;
+        }
+        auto pos = std::lower_bound(list.begin(), list.end(), doc);
+        if (pos == list.end() || *pos != doc) list.insert(pos, doc);
+    };
+    const auto cps = codepoints(text);
+    for (size_t i = 0; i < cps.size(); ++i) {
+        add(gramKey(0, cps[i]));
+        if (i + 1 < cps.size()) add(gramKey(cps[i], cps[i + 1]));
+    }
+}
+
+void InstrumentSearchIndex::removeGrams(const std::string& text, uint32_t doc) {
+    auto remove = [&](uint64_t key) {
+        auto it = _grams.find(key);
+        if (it == _grams.end()) return;
+        auto& list = it->second;
+        auto pos = std::lower_bound(list.begin(), list.end(), doc);
+        if (pos != list.end() && *pos == doc) list.erase(pos);
+    };
+    const auto cps = codepoints(text);
+    for (size_t i = 0; i < cps.size(); ++i) {
+        remove(gramKey(0, cps[i]));
+        if (i + 1 < cps.size()) remove(gramKey(cps[i], cps[i + 1]));
+    }
+}
+
+void InstrumentSearchIndex::upsert(std::string_view id, std::string_view name, std::string_view exchange) {
+    if (id.empty()) return;
+
+    auto it = _byId.find(std::string(id));
+    if (it != _byId.end()) {
+        Doc& d = _docs[it->second];
+        if (!exchange.empty()) d.exchange.assign(exchange);
+        if (name.empty() || name == d.name) return;
+
+        // 名称变化 (如首次推送只有代码): 重建该文档的 n-gram
+        removeGrams(d.nameKey, it->second);
+        removeGrams(d.initialsKey, it->second);
+        d.name.assign(name);
+        d.nameKey = asciiUpper(name);
+        d.initialsKey = initials(name);
+        addGrams(d.nameKey, it->second);
+        addGrams(d.initialsKey, it->second);
+        return;
+    }
+
+    const auto doc = static_cast<uint32_t>(_docs.size());
+    Doc d;
+    d.id.assign(id);
+    d.name.assign(name);
+    d.exchange.assign(exchange);
+    d.nameKey = asciiUpper(name);
+    d.initialsKey = initials(name);
+    _docs.push_back(std::move(d));
+    _byId.emplace(std::string(id), doc);
+
+    trieInsert(asciiUpper(id), doc);
+    addGrams(_docs[doc].nameKey, doc);
+    addGrams(_docs[doc].initialsKey, doc);
+}
+
+std::vector<uint32_t> InstrumentSearchIndex::search(std::string_view keyword, size_t maxResults) const {
+    std::vector<uint32_t> results;
+    const std::string key = asciiUpper(keyword);
+    if (key.empty() || maxResults == 0) return results;
+    results.reserve(maxResults);
+
+    // 1. 代码前缀: 从前缀节点逐层展开，先短后长、同层按字典序
+    uint32_t node = 0;
+    for (char ch : key) {
+        node = childOf(node, ch);
+        if (node == 0) break;
+    }
+    if (node != 0) {
+        std::vector<uint32_t> level{node};
+        std::vector<uint32_t> next;
+        while (!level.empty() && results.size() < maxResults) {
+            next.clear();
+            for (uint32_t n : level) {
+                for (uint32_t d = _nodes[n].doc; d != npos && results.size() < maxResults; d = _docs[d].sameKeyNext) {
+                    results.push_back(d);
+                }
+                for (uint32_t c = _nodes[n].child; c != 0; c = _nodes[c].sibling) next.push_back(c);
+            }
+            level.swap(next);
+        }
+    }
+    if (results.size() >= maxResults) return results;
+
+    // 2. 名称/首字母: 取最短的倒排表作为候选，再逐个校验包含关系
+    const auto cps = codepoints(key);
+    const std::vector<uint32_t>* candidates = nullptr;
+    if (cps.size() == 1) {
+        auto it = _grams.find(gramKey(0, cps[0]));
+        if (it != _grams.end()) candidates = &it->second;
+    } else {
+        for (size_t i = 0; i + 1 < cps.size(); ++i) {
+            auto it = _grams.find(gramKey(cps[i], cps[i + 1]));
+            if (it == _grams.end()) {
+                candidates = nullptr;
+                break;
+            }
+            if (!candidates || it->second.size() < candidates->size()) candidates = &it->second;
+        }
+    }
+    if (!candidates) return results;
+
+    struct Hit {
+        int score;  // 0 前缀 / 1 包含
+        uint32_t doc;
+    };
+    std::vector<Hit> hits;
+    for (uint32_t doc : *candidates) {
+        const Doc& d = _docs[doc];
+        const size_t inName = d.nameKey.find(key);
+        const size_t inInitials = d.initialsKey.find(key);
+        if (inName == std::string::npos && inInitials == std::string::npos) continue;
+        if (std::find(results.begin(), results.end(), doc) != results.end()) continue;
+        hits.push_back({(inName == 0 || inInitials == 0) ? 0 : 1, doc});
+    }
+
+    const size_t take = std::min(hits.size(), maxResults - results.size());
+    std::partial_sort(hits.begin(), hits.begin() + take, hits.end(), [this](const Hit& a, const Hit& b) {
+        if (a.score != b.score) return a.score < b.score;
+        const std::string& ia = _docs[a.doc].id;
+        const std::string& ib = _docs[b.doc].id;
+        if (ia.size() != ib.size()) return ia.size() < ib.size();
+        return ia < ib;
+    });
+    for (size_t i = 0; i < take; ++i) results.push_back(hits[i].doc);
+    return results;
+}
+
+} // namespace QuantLabs
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace QuantLabs {
+
+/**
+ * @brief 合约搜索索引 (下单面板输入框联想)
+ *
+ * - 合约代码: 大写后建前缀 Trie，按 (长度, 字典序) 逐层取结果，"m2501" 排在其期权之前
+ * - 合约名称: 按 Unicode 字符建 1-gram/2-gram 倒排，查询取最短倒排表再逐个校验
+ * - 拼音首字母: 名称转首字母串 ("螺纹钢2501" -> "LWG2501") 与名称一起建 n-gram
+ *
+ * 合约到达时增量更新 (同名重复推送不重建)，合约只增不删。纯 C++ 实现，不依赖 Qt。
+ * 只在 GUI 线程使用，内部无锁。
+ */
+class InstrumentSearchIndex {
+public:
+    static constexpr uint32_t npos = UINT32_MAX;
+
+    /**
+     * @brief 新增或更新合约 (名称变化时重建该合约的 n-gram)
+     * @param name UTF-8
+     */
+    void upsert(std::string_view id, std::string_view name, std::string_view exchange);
+
+    /**
+     * @brief 搜索，返回文档号 (已排序并截断到 maxResults)
+     * 排序: 代码完全匹配 > 代码前缀 > 名称/首字母前缀 > 名称/首字母包含；同级按代码长度、字典序
+     */
+    std::vector<uint32_t> search(std::string_view keyword, size_t maxResults) const;
+
+    const std::string& id(uint32_t doc) const { return _docs[doc].id; }
+    const std::string& name(uint32_t doc) const { return _docs[doc].name; }
+    const std::string& exchange(uint32_t doc) const { return _docs[doc].exchange; }
+    size_t size() const { return _docs.size(); }
+
+    // 名称的拼音首字母串 (ASCII 大写；表外汉字记为 '*')
+    static std::string initials(std::string_view utf8);
+
+private:
+    struct Doc {
+        std::string id;
+        std::string name;
+        std::string exchange;
+        std::string nameKey;      // 名称 (ASCII 转大写)
+        std::string initialsKey;  // 拼音首字母串
+        uint32_t sameKeyNext = npos; // 大写后代码相同的下一个文档 (Trie 节点只挂链表头)
+    };
+
+    // Trie 节点: 子节点按字符升序串成兄弟链表
+    struct Node {
+        uint32_t child = 0;   // 0 表示无 (根节点为 0 号，不会是任何节点的子节点)
+        uint32_t sibling = 0;
+        uint32_t doc = npos;  // 在此结束的代码
+        char ch = 0;
+    };
+
+    uint32_t childOf(uint32_t node, char ch) const;
+    uint32_t insertChild(uint32_t node, char ch);
+    void trieInsert(const std::string& key, uint32_t doc);
+    void addGrams(const std::string& text, uint32_t doc);
+    void removeGrams(const std::string& text, uint32_t doc);
+
+    static std::vector<uint32_t> codepoints(std::string_view utf8);
+    static uint64_t gramKey(uint32_t a, uint32_t b) { return (static_cast<uint64_t>(a) << 32) | b; }
+
+    std::vector<Doc> _docs;
+    std::unordered_map<std::string, uint32_t> _byId;
+    std::vector<Node> _nodes{Node{}};
+    // 1-gram 键为 (0, c)，2-gram 键为 (c1, c2)；倒排表按文档号升序、无重复
+    std::unordered_map<uint64_t, std::vector<uint32_t>> _grams;
+};
+
+} // namespace QuantLabs
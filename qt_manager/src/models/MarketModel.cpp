@@ -1,6 +1,8 @@
 #include "models/MarketModel.h"
+#include "models/TickCache.h"
 
 #include <QDebug>
+#include <algorithm>
 #include <cstring> // for strncpy, memset
 
 namespace QuantLabs {
@@ -158,6 +160,9 @@ void MarketModel::addInstrument(const QString& instrumentId) {
     // UI defaults
     item.updateTime = "等待数据...";
     item.preClose = 0; item.change = 0; item.changePercent = 0;
+
+    TickData cached;
+    if (_tickCache && _tickCache->lookup(instrumentId, cached)) applyTick(item, cached);
     
     _market_data.append(item);
     
@@ -172,12 +177,7 @@ void MarketModel::removeInstrument(const QString& instrumentId) {
     beginRemoveRows(QModelIndex(), row, row);
     _market_data.removeAt(row);
     _instrument_to_index.remove(instrumentId);
-    
-    // 更新受影响的索引
-    for (int i = row; i < _market_data.size(); ++i) {
-        _instrument_to_index[_market_data[i].instrumentId] = i;
-    }
-    
+    reindex(row, _market_data.size() - 1);
     endRemoveRows();
 }
 
@@ -189,17 +189,18 @@ void MarketModel::move(int from, int to) {
 
     if (beginMoveRows(QModelIndex(), from, from, QModelIndex(), destIndex)) {
         _market_data.move(from, to); 
-        
-        // 重建索引
-        _instrument_to_index.clear();
-        for (int i = 0; i < _market_data.size(); ++i) {
-            _instrument_to_index[_market_data[i].instrumentId] = i;
-        }
-        
+        reindex(std::min(from, to), std::max(from, to));
         endMoveRows();
     }
 }
 
+void MarketModel::reindex(int first, int last) {
+    // 只有 [first, last] 区间内的行号发生变化
+    for (int i = first; i <= last; ++i) {
+        _instrument_to_index[_market_data[i].instrumentId] = i;
+    }
+}
+
 QStringList MarketModel::getAllInstruments() const {
     QStringList list;
     for (const auto& item : _market_data) {
@@ -212,13 +213,8 @@ void MarketModel::moveToTop(int index) {
     if (index <= 0 || index >= _market_data.size()) return;
     
     beginMoveRows(QModelIndex(), index, index, QModelIndex(), 0);
-    MarketItem item = _market_data.takeAt(index);
-    _market_data.prepend(item);
-    
-    // 重建索引
-    for (int i = 0; i < _market_data.size(); ++i) {
-        _instrument_to_index[_market_data[i].instrumentId] = i;
-    }
+    _market_data.move(index, 0);
+    reindex(0, index);
     endMoveRows();
 }
 
@@ -226,13 +222,8 @@ void MarketModel::moveToBottom(int index) {
     if (index < 0 || index >= _market_data.size() - 1) return;
     
     beginMoveRows(QModelIndex(), index, index, QModelIndex(), _market_data.size());
-    MarketItem item = _market_data.takeAt(index);
-    _market_data.append(item);
-    
-    // 重建索引
-    for (int i = 0; i < _market_data.size(); ++i) {
-        _instrument_to_index[_market_data[i].instrumentId] = i;
-    }
+    _market_data.move(index, _market_data.size() - 1);
+    reindex(index, _market_data.size() - 1);
     endMoveRows();
 }
 
@@ -308,39 +299,80 @@ QVariantMap MarketModel::getMarketData(const QString& instrumentId) const {
 }
 
 // 二进制行情更新 (极速路径)
-void MarketModel::updateTickBinary(const TickData& data) {
-    QString id = QString::fromLatin1(data.instrument_id);
-    
-    // 只更新已存在的合约，不自动添加
-    if (!_instrument_to_index.contains(id)) return;
+// 按帧批量处理: 只比较、写入变化的字段，整批合并为一次 dataChanged (脏行范围 + 变化角色)，
+// 避免 TableView 逐笔重算全部角色绑定
+void MarketModel::updateTicksBinary(const std::vector<TickData>& ticks) {
+    int firstRow = -1;
+    int lastRow = -1;
+    uint32_t mask = 0;
+
+    for (const TickData& data : ticks) {
+        // 只更新已存在的合约，不自动添加
+        auto it = _instrument_to_index.constFind(QString::fromLatin1(data.instrument_id));
+        if (it == _instrument_to_index.constEnd()) continue;
+        int row = it.value();
+        if (row < 0 || row >= _market_data.size()) continue;
+
+        uint32_t changed = applyTick(_market_data[row], data);
+        if (!changed) continue;
+        mask |= changed;
+        firstRow = (firstRow < 0) ? row : std::min(firstRow, row);
+        lastRow = std::max(lastRow, row);
+    }
+
+    if (mask) emit dataChanged(index(firstRow), index(lastRow), rolesFromMask(mask));
+}
+
+uint32_t MarketModel::applyTick(MarketItem& item, const TickData& data) {
+    auto bit = [](int role) { return 1u << (role - IdRole); };
+    TickData& d = item.data;
+    uint32_t changed = 0;
+
+    if (d.last_price != data.last_price) changed |= bit(PriceRole);
+    if (d.volume != data.volume) changed |= bit(VolumeRole);
+    if (d.open_interest != data.open_interest) changed |= bit(OpenInterestRole);
+    if (d.turnover != data.turnover) changed |= bit(TurnoverRole);
+    if (d.bid_price1 != data.bid_price1) changed |= bit(BidPrice1Role);
+    if (d.bid_volume1 != data.bid_volume1) changed |= bit(BidVolume1Role);
+    if (d.ask_price1 != data.ask_price1) changed |= bit(AskPrice1Role);
+    if (d.ask_volume1 != data.ask_volume1) changed |= bit(AskVolume1Role);
+    if (d.upper_limit_price != data.upper_limit_price) changed |= bit(UpperLimitRole);
+    if (d.lower_limit_price != data.lower_limit_price) changed |= bit(LowerLimitRole);
+    if (d.open_price != data.open_price) changed |= bit(OpenPriceRole);
+    if (d.highest_price != data.highest_price) changed |= bit(HighestPriceRole);
+    if (d.lowest_price != data.lowest_price) changed |= bit(LowestPriceRole);
+    if (d.average_price != data.average_price) changed |= bit(AveragePriceRole);
+    // 时间字符串只在变化时重建 QString
+    if (std::strncmp(d.update_time, data.update_time, sizeof(d.update_time)) != 0) {
+        item.updateTime = QString::fromLatin1(data.update_time);
+        changed |= bit(TimeRole);
+    }
 
-    // [更新逻辑] 如果已存在，则更新对应行的数据
-    int row = _instrument_to_index[id];
-    auto& item = _market_data[row];
-    
-    // 3. 核心数据更新
     // 使用结构体赋值，一次性更新所有价格/量/持仓等字段 (内存拷贝，极快)
-    item.data = data;
-    
-    // 4. 更新 UI 缓存字段
-    item.updateTime = QString::fromLatin1(data.update_time);
-    
+    d = data;
+
+    // UI 缓存字段
     double basePrice = data.pre_settlement_price;
     if (basePrice < 0.0001) basePrice = data.pre_close_price;
-    item.preClose = basePrice;
-    
+    double change = 0.0;
+    double changePercent = 0.0;
     if (basePrice > 0.0001) {
-        item.change = data.last_price - basePrice;
-        item.changePercent = (item.change / basePrice * 100.0);
-    } else {
-        item.change = 0.0;
-        item.changePercent = 0.0;
+        change = data.last_price - basePrice;
+        changePercent = change / basePrice * 100.0;
     }
-    
-    // 5. 触发信号通知界面重绘
-    // index(row) 生成对应行的 QModelIndex
-    // dataChanged 告诉 TableView 这一行的数据变了，需要重新读取 roleNames() 绑定的字段
-    emit dataChanged(index(row), index(row));
+    if (item.preClose != basePrice) { item.preClose = basePrice; changed |= bit(PreCloseRole); }
+    if (item.change != change) { item.change = change; changed |= bit(ChangeRole); }
+    if (item.changePercent != changePercent) { item.changePercent = changePercent; changed |= bit(ChangePercentRole); }
+
+    return changed;
+}
+
+QList<int> MarketModel::rolesFromMask(uint32_t mask) const {
+    QList<int> roles;
+    for (int role = IdRole; role <= AveragePriceRole; ++role) {
+        if (mask & (1u << (role - IdRole))) roles.append(role);
+    }
+    return roles;
 }
 
 } // namespace QuantLabs
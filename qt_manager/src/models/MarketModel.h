@@ -5,10 +5,14 @@
 #include <QVector>
 #include <QString>
 #include <QJsonObject>
+#include <cstdint>
+#include <vector>
 #include "../../../shared/protocol/message_schema.h"
 
 namespace QuantLabs {
 
+class TickCache;
+
 struct MarketItem {
     TickData data;
     
@@ -47,6 +51,9 @@ public:
 
     explicit MarketModel(QObject *parent = nullptr);
 
+    // 新增行先显示缓存的最新行情 (上次运行保存)，不再停在"等待数据..."
+    void setTickCache(const TickCache* cache) { _tickCache = cache; }
+
     int rowCount(const QModelIndex &parent = QModelIndex()) const override;
     QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
     QHash<int, QByteArray> roleNames() const override;
@@ -57,7 +64,8 @@ public slots:
      * @param json 来自 ZmqWorker 的消息
      */
     void updateTick(const QJsonObject& json);
-    void updateTickBinary(const TickData& data);
+    // 一帧内合并后的二进制行情 (TickBatcher::ticksReady)，整批只发一次 dataChanged
+    void updateTicksBinary(const std::vector<TickData>& ticks);
     // 处理合约信息 (订阅后立即显示)
     void handleInstrument(const QJsonObject& json);
     void removeInstrument(const QString& instrumentId);
@@ -82,8 +90,15 @@ public slots:
     Q_INVOKABLE QVariantMap getMarketData(const QString& instrumentId) const;
 
 private:
+    // 写入一笔行情，返回变化的角色位掩码 (bit = role - IdRole)
+    uint32_t applyTick(MarketItem& item, const TickData& data);
+    QList<int> rolesFromMask(uint32_t mask) const;
+    // 重写 [first, last] 行的索引 (删行/移动后只更新受影响区间)
+    void reindex(int first, int last);
+
     QVector<MarketItem> _market_data;
     QHash<QString, int> _instrument_to_index; // 快速索引
+    const TickCache* _tickCache = nullptr;
 };
 
 } // namespace QuantLabs
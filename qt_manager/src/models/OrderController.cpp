@@ -3,13 +3,31 @@
 #include <cstring>
 #include <QJsonArray>
 #include <QJsonDocument>
+#include "protocol/zmq_topics.h"
+#include "models/TickCache.h"
 
 namespace QuantLabs {
 
 OrderController::OrderController(QObject *parent) : QObject(parent) {
+    _ladder = new DomLadderModel(this);
     connect(this, &OrderController::orderParamsChanged, this, &OrderController::recalculate);
 }
 
+void OrderController::setInstrumentId(const QString& id) {
+    if (_instrumentId == id) return;
+    _instrumentId = id;
+    _isManualPrice = false;
+    updateCurrentPos(id);
+    _bidPrice.fill(0.0); _bidVolume.fill(0);
+    _askPrice.fill(0.0); _askVolume.fill(0);
+    _ladder->setInstrument(id, priceTick(), _orderModel ? _orderModel->workingOrders(id) : std::vector<OrderItem>{});
+    emit orderParamsChanged();
+    emit marketDataChanged();
+
+    TickData cached;
+    if (_tickCache && _tickCache->lookup(id, cached)) onTickBinary(cached);
+}
+
 // 新增 onTick 实现
 void OrderController::onTick(const QJsonObject& j) {
     if (_instrumentId.isEmpty() || _isManualPrice) return;
@@ -29,41 +47,18 @@ void OrderController::onTick(const QJsonObject& j) {
                 emit orderParamsChanged();
             }
             
-            // 解析 5 档行情
-            _bidPrices.clear(); _bidVolumes.clear();
-            _askPrices.clear(); _askVolumes.clear();
-            
-            // Bid 1-5
-            for(int i=1; i<=5; ++i) {
-               QString pKey = "bid_price" + QString::number(i);
-               QString vKey = "bid_volume" + QString::number(i);
-               // compat
-               QString oldP = "b" + QString::number(i);
-               QString oldV = "bv" + QString::number(i);
-
-               if (j.contains(pKey)) _bidPrices.append(j[pKey].toDouble());
-               else if (j.contains(oldP)) _bidPrices.append(j[oldP].toDouble());
-               else _bidPrices.append(0.0);
-
-               if (j.contains(vKey)) _bidVolumes.append(j[vKey].toInt());
-               else if (j.contains(oldV)) _bidVolumes.append(j[oldV].toInt());
-               else _bidVolumes.append(0);
-            }
-
-            // Ask 1-5
-            for(int i=1; i<=5; ++i) {
-               QString pKey = "ask_price" + QString::number(i);
-               QString vKey = "ask_volume" + QString::number(i);
-               QString oldP = "a" + QString::number(i);
-               QString oldV = "av" + QString::number(i);
-
-               if (j.contains(pKey)) _askPrices.append(j[pKey].toDouble());
-               else if (j.contains(oldP)) _askPrices.append(j[oldP].toDouble());
-               else _askPrices.append(0.0);
-
-               if (j.contains(vKey)) _askVolumes.append(j[vKey].toInt());
-               else if (j.contains(oldV)) _askVolumes.append(j[oldV].toInt());
-               else _askVolumes.append(0);
+            // 解析 5 档行情 (兼容旧字段名 b1/bv1/a1/av1)
+            auto number = [&j](const QString& key, const QString& oldKey) {
+                if (j.contains(key)) return j[key].toDouble();
+                if (j.contains(oldKey)) return j[oldKey].toDouble();
+                return 0.0;
+            };
+            for (int i = 0; i < 5; ++i) {
+               const QString n = QString::number(i + 1);
+               _bidPrice[i] = number("bid_price" + n, "b" + n);
+               _bidVolume[i] = static_cast<int>(number("bid_volume" + n, "bv" + n));
+               _askPrice[i] = number("ask_price" + n, "a" + n);
+               _askVolume[i] = static_cast<int>(number("ask_volume" + n, "av" + n));
             }
             
             emit marketDataChanged();
@@ -71,6 +66,18 @@ void OrderController::onTick(const QJsonObject& j) {
     } catch (...) {}
 }
 
+void OrderController::onTicksBinary(const std::vector<TickData>& ticks) {
+    if (_instrumentId.isEmpty()) return;
+    const QByteArray id = _instrumentId.toLatin1();
+    for (const TickData& data : ticks) {
+        // 每帧每合约至多一笔
+        if (std::strncmp(data.instrument_id, id.constData(), sizeof(data.instrument_id)) == 0) {
+            onTickBinary(data);
+            return;
+        }
+    }
+}
+
 void OrderController::onTickBinary(const TickData& data) {
     if (_instrumentId.isEmpty()) return;
     
@@ -85,19 +92,19 @@ void OrderController::onTickBinary(const TickData& data) {
         }
     }
     
-    // Market Depth Refresh
-    QVariantList newBids, newBidVols, newAsks, newAskVols;
-    
-    newBids << data.bid_price1 << data.bid_price2 << data.bid_price3 << data.bid_price4 << data.bid_price5;
-    newBidVols << data.bid_volume1 << data.bid_volume2 << data.bid_volume3 << data.bid_volume4 << data.bid_volume5;
-    
-    newAsks << data.ask_price1 << data.ask_price2 << data.ask_price3 << data.ask_price4 << data.ask_price5;
-    newAskVols << data.ask_volume1 << data.ask_volume2 << data.ask_volume3 << data.ask_volume4 << data.ask_volume5;
-    
-    _bidPrices = newBids; _bidVolumes = newBidVols;
-    _askPrices = newAsks; _askVolumes = newAskVols;
-    
-    emit marketDataChanged();
+    // Market Depth Refresh: 定长数组原地比较，五档未变时不通知 QML
+    const std::array<double, 5> bids{data.bid_price1, data.bid_price2, data.bid_price3, data.bid_price4, data.bid_price5};
+    const std::array<int, 5> bidVols{data.bid_volume1, data.bid_volume2, data.bid_volume3, data.bid_volume4, data.bid_volume5};
+    const std::array<double, 5> asks{data.ask_price1, data.ask_price2, data.ask_price3, data.ask_price4, data.ask_price5};
+    const std::array<int, 5> askVols{data.ask_volume1, data.ask_volume2, data.ask_volume3, data.ask_volume4, data.ask_volume5};
+
+    if (bids != _bidPrice || bidVols != _bidVolume || asks != _askPrice || askVols != _askVolume) {
+        _bidPrice = bids; _bidVolume = bidVols;
+        _askPrice = asks; _askVolume = askVols;
+        emit marketDataChanged();
+    }
+
+    _ladder->updateDepth(data);
 }
 
 void OrderController::updateInstrument(const QJsonObject& j) {
@@ -160,8 +167,12 @@ void OrderController::updateInstrument(const QJsonObject& j) {
                  << "Margin:" << info.long_margin_ratio_by_money;
 
         _instrument_dict[idStr] = info;
+        _searchIndex.upsert(std::string_view(info.instrument_id, strnlen(info.instrument_id, sizeof(info.instrument_id))),
+                            std::string_view(info.instrument_name, strnlen(info.instrument_name, sizeof(info.instrument_name))),
+                            std::string_view(info.exchange_id, strnlen(info.exchange_id, sizeof(info.exchange_id))));
         
         if (idStr == _instrumentId) {
+            _ladder->setPriceTick(priceTick());
             recalculate();
             emit orderParamsChanged();
         } else if (!_instrumentId.isEmpty() && _instrument_dict.contains(_instrumentId)) {
@@ -223,66 +234,82 @@ void OrderController::recalculate() {
 void OrderController::sendOrder(const QString& direction, const QString& offset, const QString& priceType) {
     if (_instrumentId.isEmpty() || _volume <= 0) return;
 
-    nlohmann::json j;
-    j["type"] = QuantLabs::CmdType::Order;
-    j["id"] = _instrumentId.toStdString();
-    
-    // Map Direction
-    if (direction == "BUY") j["dir"] = "0"; // CTP Buy
-    else if (direction == "SELL") j["dir"] = "1"; // CTP Sell
-    else j["dir"] = direction.toStdString();
-    
-    // Map Offset
-    if (offset == "OPEN") j["off"] = "0"; // CTP Open
-    else if (offset == "CLOSE") j["off"] = "1"; // CTP Close
-    else if (offset == "CLOSETODAY") j["off"] = "3"; // CTP CloseToday
-    else j["off"] = offset.toStdString();
+    const bool isBuy = (direction == "BUY" || direction == "0" || direction == "2");
 
-    // Map Price Type & Price
     // Map Price Type & Price
     if (priceType == "MARKET") {
-        j["price_type"] = "1"; // CTP AnyPrice
-        
         // Pass the manually set price (calculated in QML) for simulation
         // If _price is 0, try to fallback to opponent price
         double finalPrice = _price;
         if (finalPrice < 0.0001) {
-             bool isBuy = (direction == "BUY" || direction == "0" || direction == "2");
-             if (isBuy && !_askPrices.isEmpty() && _askPrices[0].toDouble() > 0.0001) {
-                 finalPrice = _askPrices[0].toDouble();
-             } else if (!isBuy && !_bidPrices.isEmpty() && _bidPrices[0].toDouble() > 0.0001) {
-                 finalPrice = _bidPrices[0].toDouble();
+             if (isBuy && _askPrice[0] > 0.0001) {
+                 finalPrice = _askPrice[0];
+             } else if (!isBuy && _bidPrice[0] > 0.0001) {
+                 finalPrice = _bidPrice[0];
              }
         }
-        j["price"] = finalPrice;
+        publishOrder(direction, offset, "1", finalPrice); // CTP AnyPrice
     } else if (priceType == "OPPONENT") {
-        j["price_type"] = "2"; // CTP LimitPrice
-        
+        // Buying -> Ask Price, Selling -> Bid Price
         double targetPrice = _price;
-        bool isBuy = (direction == "BUY" || direction == "0" || direction == "2");
-        
-        if (isBuy) {
-            // Buying -> Ask Price
-            if (!_askPrices.isEmpty() && _askPrices[0].toDouble() > 0.0001) {
-                targetPrice = _askPrices[0].toDouble();
-            }
-        } else {
-            // Selling -> Bid Price
-            if (!_bidPrices.isEmpty() && _bidPrices[0].toDouble() > 0.0001) {
-                targetPrice = _bidPrices[0].toDouble();
-            }
+        if (isBuy && _askPrice[0] > 0.0001) {
+            targetPrice = _askPrice[0];
+        } else if (!isBuy && _bidPrice[0] > 0.0001) {
+            targetPrice = _bidPrice[0];
         }
-        j["price"] = targetPrice;
+        publishOrder(direction, offset, "2", targetPrice); // CTP LimitPrice
     } else {
-        j["price_type"] = "2"; // CTP LimitPrice
-        j["price"] = _price;
+        publishOrder(direction, offset, "2", _price); // CTP LimitPrice
+    }
+
+    qDebug() << "Order Published:" << _instrumentId << direction << offset << priceType;
+}
+
+void OrderController::sendLadderOrder(double price, const QString& direction, const QString& offset) {
+    if (_instrumentId.isEmpty() || _volume <= 0) return;
+    if (!_ladder->isLadderPrice(price)) {
+        qWarning() << "[OrderController] Ladder order rejected, invalid price:" << price;
+        return;
+    }
+    publishOrder(direction, offset, "2", price);
+    qDebug() << "[OrderController] Ladder order:" << _instrumentId << direction << offset << price;
+}
+
+void OrderController::cancelLadderOrders(double price, const QString& direction) {
+    if (!_orderModel || _instrumentId.isEmpty() || !_ladder->isLadderPrice(price)) return;
+
+    const QString dir = (direction == "BUY") ? "0" : (direction == "SELL") ? "1" : direction;
+    const double halfTick = priceTick() / 2;
+    for (const OrderItem& o : _orderModel->workingOrders(_instrumentId)) {
+        if (o.direction != dir || std::abs(o.limit_price - price) >= halfTick) continue;
+        cancelOrder(o.instrument_id, o.order_sys_id, o.order_ref, o.exchange_id, o.front_id, o.session_id);
     }
+}
+
+void OrderController::publishOrder(const QString& direction, const QString& offset, const char* priceType, double price) {
+    nlohmann::json j;
+    j["type"] = QuantLabs::CmdType::Order;
+    j["id"] = _instrumentId.toStdString();
+    
+    // Map Direction
+    if (direction == "BUY") j["dir"] = "0"; // CTP Buy
+    else if (direction == "SELL") j["dir"] = "1"; // CTP Sell
+    else j["dir"] = direction.toStdString();
+    
+    // Map Offset
+    if (offset == "OPEN") j["off"] = "0"; // CTP Open
+    else if (offset == "CLOSE") j["off"] = "1"; // CTP Close
+    else if (offset == "CLOSETODAY") j["off"] = "3"; // CTP CloseToday
+    else j["off"] = offset.toStdString();
 
+    j["price_type"] = priceType;
+    j["price"] = price;
     j["vol"] = _volume;
     j["strategy_id"] = _currentStrategy.toStdString();
+    const auto& account = QuantLabs::zmq_topics::Config::instance().getAccountId();
+    if (!account.empty()) j["account_id"] = account;
 
     emit orderSent(QString::fromStdString(j.dump()));
-    qDebug() << "Order Published:" << _instrumentId << direction << offset << priceType;
 }
 
 void OrderController::cancelOrder(const QString& instrumentId, const QString& orderSysId, const QString& orderRef, const QString& exchangeId, int frontId, int sessionId) {
@@ -298,6 +325,8 @@ void OrderController::cancelOrder(const QString& instrumentId, const QString& or
     data["ExchangeID"] = exchangeId.toStdString(); 
     data["FrontID"] = frontId;
     data["SessionID"] = sessionId;
+    const auto& account = QuantLabs::zmq_topics::Config::instance().getAccountId();
+    if (!account.empty()) j["account_id"] = account;
     
     // 我们需要在 Core 侧解析这个结构，或者简化协议。
     // 为了保持一致，我们构造一个简单协议，类似 Order insert
@@ -354,29 +383,37 @@ void OrderController::onPositionReceived(const QJsonObject& j) {
         int yd = 0;
         if(j.contains("yd_position")) yd = j["yd_position"].toInt();
 
-        // Update cache
-        if (!_pos_cache.contains(id)) {
-            _pos_cache[id] = PosSummary{};
-        }
-        
-        auto& summary = _pos_cache[id];
-        
-        if (dir == '2' || dir == '0') { // Long
-            summary.longTotal = pos;
-            summary.longTd = td;
-            summary.longYd = yd; 
-        } else { // Short (1 or 3)
-            summary.shortTotal = pos;
-            summary.shortTd = td;
-            summary.shortYd = yd;
-        }
+        applyPosition(id, dir, pos, td, yd);
+    } catch (...) {}
+}
 
-        if (id == _instrumentId) {
-            _currentPos = summary;
-            emit positionChanged();
-        }
+void OrderController::onPositionReceivedBinary(const PositionData& data) {
+    QString id = QString::fromUtf8(data.instrument_id, static_cast<int>(strnlen(data.instrument_id, sizeof(data.instrument_id))));
+    if (id.isEmpty()) return;
+    applyPosition(id, data.direction, data.position, data.today_position, data.yd_position);
+}
 
-    } catch (...) {}
+void OrderController::applyPosition(const QString& id, char dir, int pos, int td, int yd) {
+    // Update cache
+    auto& summary = _pos_cache[id];
+
+    if (dir == '2' || dir == '0') { // Long
+        // 盯市推送只改浮盈，手数不变时不必通知界面
+        if (summary.longTotal == pos && summary.longTd == td && summary.longYd == yd) return;
+        summary.longTotal = pos;
+        summary.longTd = td;
+        summary.longYd = yd;
+    } else { // Short (1 or 3)
+        if (summary.shortTotal == pos && summary.shortTd == td && summary.shortYd == yd) return;
+        summary.shortTotal = pos;
+        summary.shortTd = td;
+        summary.shortYd = yd;
+    }
+
+    if (id == _instrumentId) {
+        _currentPos = summary;
+        emit positionChanged();
+    }
 }
 
 void OrderController::updateCurrentPos(const QString& id) {
@@ -599,36 +636,17 @@ double OrderController::getInstrumentPriceTick(const QString& instrumentId) cons
 
 QVariantList OrderController::searchInstruments(const QString& keyword, int maxResults) const {
     QVariantList results;
-    if (keyword.isEmpty()) return results;
-    
-    QString upper = keyword.toUpper();
-    
-    // 遍历合约字典，匹配 ID 前缀或名称包含关键字
-    for (auto it = _instrument_dict.begin(); it != _instrument_dict.end(); ++it) {
-        if (results.size() >= maxResults) break;
-        
-        const QString& id = it.key();
-        QString name = QString::fromUtf8(it.value().instrument_name);
-        QString exchange = QString::fromLatin1(it.value().exchange_id);
-        
-        // 大小写不敏感：ID 前缀匹配 或 名称包含
-        if (id.toUpper().startsWith(upper) || name.contains(keyword)) {
-            QVariantMap item;
-            item["id"] = id;
-            item["name"] = name;
-            item["exchange"] = exchange;
-            results.append(item);
-        }
+    if (keyword.isEmpty() || maxResults <= 0) return results;
+
+    // 索引已排序并截断，这里只为命中的几条构造 QString
+    QByteArray key = keyword.toUtf8();
+    for (uint32_t doc : _searchIndex.search(std::string_view(key.constData(), key.size()), static_cast<size_t>(maxResults))) {
+        QVariantMap item;
+        item["id"] = QString::fromStdString(_searchIndex.id(doc));
+        item["name"] = QString::fromStdString(_searchIndex.name(doc));
+        item["exchange"] = QString::fromLatin1(_searchIndex.exchange(doc).c_str());
+        results.append(item);
     }
-    
-    // 按合约 ID 排序，方便阅读
-    std::sort(results.begin(), results.end(), [](const QVariant& a, const QVariant& b) {
-        return a.toMap()["id"].toString() < b.toMap()["id"].toString();
-    });
-    
-    // 截断到 maxResults
-    while (results.size() > maxResults) results.removeLast();
-    
     return results;
 }
 
@@ -645,6 +663,8 @@ void OrderController::setCurrentStrategy(const QString& s) {
         nlohmann::json j;
         j["type"] = "SET_STRATEGY";
         j["id"] = s.toStdString();
+        const auto& account = QuantLabs::zmq_topics::Config::instance().getAccountId();
+        if (!account.empty()) j["account_id"] = account;
         emit orderSent(QString::fromStdString(j.dump()));
         qDebug() << "[OrderController] Set Strategy:" << s;
     }
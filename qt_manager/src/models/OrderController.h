@@ -7,10 +7,16 @@
 #include <QList>
 #include <QJsonObject>
 #include <nlohmann/json.hpp>
+#include <array>
+#include <vector>
 #include "protocol/message_schema.h" // Shared Schema
+#include "models/InstrumentSearchIndex.h"
+#include "models/DomLadderModel.h"
 
 namespace QuantLabs {
 
+class TickCache;
+
 class OrderController : public QObject {
     Q_OBJECT
     
@@ -30,6 +36,8 @@ class OrderController : public QObject {
     Q_PROPERTY(QVariantList bidVolumes READ bidVolumes NOTIFY marketDataChanged)
     Q_PROPERTY(QVariantList askPrices READ askPrices NOTIFY marketDataChanged)
     Q_PROPERTY(QVariantList askVolumes READ askVolumes NOTIFY marketDataChanged)
+    // 当前合约的价格阶梯 (点价下单)
+    Q_PROPERTY(QuantLabs::DomLadderModel* ladder READ ladder CONSTANT)
 
     // 连接状态
     Q_PROPERTY(bool coreConnected READ coreConnected NOTIFY connectionChanged)
@@ -53,14 +61,11 @@ public:
     explicit OrderController(QObject *parent = nullptr);
 
     QString instrumentId() const { return _instrumentId; }
-    void setInstrumentId(const QString& id) { 
-        if(_instrumentId != id) { 
-            _instrumentId = id; 
-            _isManualPrice = false; 
-            updateCurrentPos(id);
-            emit orderParamsChanged(); 
-        } 
-    }
+    void setInstrumentId(const QString& id);
+    // 价格阶梯切换合约时从 OrderModel 取在途报单
+    void setOrderModel(OrderModel* model) { _orderModel = model; }
+    // 切换合约时先用缓存的最新行情填充盘口与价格阶梯
+    void setTickCache(const TickCache* cache) { _tickCache = cache; }
 
     double price() const { return _price; }
     void setPrice(double p) { if(_price != p) { _price = p; emit orderParamsChanged(); } }
@@ -85,10 +90,12 @@ public:
     bool isTestMode() const { return _isTestMode; }
     void setTestMode(bool v) { if(_isTestMode!=v){_isTestMode=v; emit orderParamsChanged();} }
 
-    QVariantList bidPrices() const { return _bidPrices; }
-    QVariantList bidVolumes() const { return _bidVolumes; }
-    QVariantList askPrices() const { return _askPrices; }
-    QVariantList askVolumes() const { return _askVolumes; }
+    // 五档按定长数组存储，只在 QML 读取时装箱
+    QVariantList bidPrices() const { return toVariantList(_bidPrice); }
+    QVariantList bidVolumes() const { return toVariantList(_bidVolume); }
+    QVariantList askPrices() const { return toVariantList(_askPrice); }
+    QVariantList askVolumes() const { return toVariantList(_askVolume); }
+    DomLadderModel* ladder() const { return _ladder; }
     
     bool coreConnected() const { return _coreConnected; }
     bool ctpConnected() const { return _ctpConnected; }
@@ -101,8 +108,14 @@ public:
 public slots:
     void onTick(const QJsonObject& json);
     void onTickBinary(const TickData& data);
+    // 一帧内合并后的二进制行情 (TickBatcher::ticksReady)，只取当前合约
+    void onTicksBinary(const std::vector<TickData>& ticks);
     void updateInstrument(const QJsonObject& json);
     Q_INVOKABLE void sendOrder(const QString& direction, const QString& offset, const QString& priceType = "LIMIT");
+    // 价格阶梯点价: 按第 row 档价位下限价单 / 撤掉该档本方向的在途报单
+    // price 为点击时该行显示的价位 (阶梯可能已自动居中，不能按行号重新取价)
+    Q_INVOKABLE void sendLadderOrder(double price, const QString& direction, const QString& offset);
+    Q_INVOKABLE void cancelLadderOrders(double price, const QString& direction);
     void cancelOrder(const QString& instrumentId, const QString& orderSysId, const QString& orderRef, const QString& exchangeId, int frontId, int sessionId); // Added
     void subscribe(const QString& instrumentId);
     void unsubscribe(const QString& instrumentId);
@@ -116,6 +129,7 @@ public slots:
     void updateCoreStatus(bool connected);
     void updateCtpStatus(bool connected);
     void onPositionReceived(const QJsonObject& json);
+    void onPositionReceivedBinary(const PositionData& data);
 
     // QML 调用此方法发送指令 (中转到 Worker)
     Q_INVOKABLE void sendCommand(const QString& cmd);
@@ -131,7 +145,7 @@ public slots:
     void modifyConditionOrder(const QString& requestId, double triggerPrice, double limitPrice, int volume); // 修改条件单
     Q_INVOKABLE double getInstrumentPriceTick(const QString& instrumentId) const; // 获取合约最小变动价位
     
-    // 自动补全：模糊搜索合约（ID 或名称），返回最多 maxResults 条匹配结果
+    // 自动补全：按代码前缀、名称片段或拼音首字母搜索合约，返回排序后的前 maxResults 条
     Q_INVOKABLE QVariantList searchInstruments(const QString& keyword, int maxResults = 10) const;
     // 精确验证：合约 ID 是否存在于 instrument_dict
     Q_INVOKABLE bool isValidInstrument(const QString& instrumentId) const;
@@ -151,6 +165,16 @@ signals:
 private:
     void recalculate();
     void updateCurrentPos(const QString& id);
+    // 组装报单指令并发出 (priceType 为 CTP 价格类型)
+    void publishOrder(const QString& direction, const QString& offset, const char* priceType, double price);
+
+    template <typename T>
+    static QVariantList toVariantList(const std::array<T, 5>& levels) {
+        QVariantList list;
+        list.reserve(5);
+        for (const T& v : levels) list.append(v);
+        return list;
+    }
     
     QString _instrumentId;
     double _price = 0.0;
@@ -164,9 +188,14 @@ private:
     bool _coreConnected = false;
     bool _ctpConnected = false;
     
-    QVariantList _bidPrices, _bidVolumes, _askPrices, _askVolumes;
+    std::array<double, 5> _bidPrice{}, _askPrice{};
+    std::array<int, 5> _bidVolume{}, _askVolume{};
+    DomLadderModel* _ladder = nullptr;
+    OrderModel* _orderModel = nullptr;
+    const TickCache* _tickCache = nullptr;
     
     QHash<QString, InstrumentMeta> _instrument_dict;
+    InstrumentSearchIndex _searchIndex; // 合约联想 (随 updateInstrument 增量维护)
 
     struct PosSummary {
         int longTotal = 0;
@@ -178,6 +207,7 @@ private:
     };
     QHash<QString, PosSummary> _pos_cache;
     PosSummary _currentPos;
+    void applyPosition(const QString& id, char dir, int pos, int td, int yd);
 
     int longPosition() const { return _currentPos.longTotal; }
     int shortPosition() const { return _currentPos.shortTotal; }
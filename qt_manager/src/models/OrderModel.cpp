@@ -21,7 +21,7 @@ QVariant OrderModel::data(const QModelIndex &index, int role) const {
     // Safety check for bounds
     if (index.row() < 0 || index.row() >= static_cast<int>(_orders.size())) return QVariant();
 
-    const auto& item = _orders[index.row()];
+    const auto& item = _orders[_orders.size() - 1 - index.row()];
 
     switch (role) {
         case InstrumentIdRole: return item.instrument_id;
@@ -102,8 +102,15 @@ void OrderModel::onOrderReceived(const QJsonObject& j) {
                  << "order_ref=" << item.order_ref
                  << "status=" << item.order_status;
         
-        // 查找是否存在: Pass InstrumentID for accurate matching
-        int idx = findOrderIndex(item.order_sys_id, item.order_ref, item.instrument_id);
+        // 查找是否存在
+        int idx = findOrderIndex(item);
+
+        // 在途手数变化 (价格阶梯按价位累计)
+        const int oldWorking = (idx >= 0 && isWorking(_orders[idx])) ? _orders[idx].volume_total : 0;
+        const int newWorking = isWorking(item) ? item.volume_total : 0;
+        if (newWorking != oldWorking) {
+            emit workingVolumeChanged(item.instrument_id, item.direction, item.limit_price, newWorking - oldWorking);
+        }
         
         if (idx >= 0) {
             // Sound Logic: Check for Cancellation
@@ -111,10 +118,16 @@ void OrderModel::onOrderReceived(const QJsonObject& j) {
                 emit orderSoundTriggered("cancel");
             }
 
+            // 报单被交易所接受后才有 SysID，此时补登索引
+            if (_orders[idx].order_sys_id.isEmpty() && !item.order_sys_id.isEmpty()) {
+                _bySysId.insert(sysIdKey(item), idx);
+            }
+
             // 更新
             _orders[idx] = item;
             // 通知 View 更新
-            emit dataChanged(index(idx), index(idx));
+            const int row = rowOf(idx);
+            emit dataChanged(index(row), index(row));
         } else {
             // Sound Logic: New Order
             if (item.order_status == "3" || item.order_status == "1") {
@@ -123,9 +136,12 @@ void OrderModel::onOrderReceived(const QJsonObject& j) {
                  emit orderSoundTriggered("fail");
             }
             
-            // 新增
+            // 新增: 追加到存储末尾，即界面第 0 行
             beginInsertRows(QModelIndex(), 0, 0);
-            _orders.insert(_orders.begin(), item);
+            const int newIdx = static_cast<int>(_orders.size());
+            _orders.push_back(item);
+            if (!item.order_sys_id.isEmpty()) _bySysId.insert(sysIdKey(item), newIdx);
+            if (!item.order_ref.isEmpty()) _byRef.insert(refKey(item), newIdx);
             endInsertRows();
         }
 
@@ -134,20 +150,30 @@ void OrderModel::onOrderReceived(const QJsonObject& j) {
     }
 }
 
-int OrderModel::findOrderIndex(const QString& sysId, const QString& ref, const QString& instrumentId) {
-    // 优先匹配 SysID，其次 Ref (因为报单初期没有 SysID)
-    for (int i = 0; i < static_cast<int>(_orders.size()); ++i) {
-        const auto& o = _orders[i];
-        
-        // Strict Match: SysID must match AND Instrument must match (avoid cross-instrument collision)
-        if (!sysId.isEmpty() && !o.order_sys_id.isEmpty()) {
-            if (o.order_sys_id == sysId && o.instrument_id == instrumentId) return i;
-            // Also relaxed match if instrument missing? No, InstrumentID is critical.
-        }
-        
-        // Fallback: Match by Ref if SysID unavailable (AND Instrument same)
-        // Ref is unique per Session+Front. Instrument check adds safety.
-        if (o.order_ref == ref && !ref.isEmpty() && o.instrument_id == instrumentId) return i;
+bool OrderModel::isWorking(const OrderItem& item) {
+    // "1":部分成交还在队列中 / "3":未成交还在队列中 / "a":未知 (已报未回)
+    const QString& s = item.order_status;
+    return item.volume_total > 0 && (s == "1" || s == "3" || s == "a");
+}
+
+std::vector<OrderItem> OrderModel::workingOrders(const QString& instrumentId) const {
+    std::lock_guard<std::mutex> lock(_mutex);
+    std::vector<OrderItem> result;
+    for (const OrderItem& item : _orders) {
+        if (item.instrument_id == instrumentId && isWorking(item)) result.push_back(item);
+    }
+    return result;
+}
+
+int OrderModel::findOrderIndex(const OrderItem& item) const {
+    // 优先匹配 SysID (同合约)，其次 FrontID:SessionID:OrderRef (报单初期没有 SysID)
+    if (!item.order_sys_id.isEmpty()) {
+        auto it = _bySysId.constFind(sysIdKey(item));
+        if (it != _bySysId.constEnd()) return it.value();
+    }
+    if (!item.order_ref.isEmpty()) {
+        auto it = _byRef.constFind(refKey(item));
+        if (it != _byRef.constEnd() && _orders[it.value()].instrument_id == item.instrument_id) return it.value();
     }
     return -1;
 }
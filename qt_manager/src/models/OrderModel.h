@@ -1,6 +1,7 @@
 #pragma once
 
 #include <QAbstractListModel>
+#include <QHash>
 #include <vector>
 #include <mutex>
 #include <QJsonObject>
@@ -52,20 +53,38 @@ public:
     int rowCount(const QModelIndex &parent = QModelIndex()) const override;
     QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
     QHash<int, QByteArray> roleNames() const override;
+
+    // 在途报单 (排队中/未知状态，剩余手数 > 0)
+    static bool isWorking(const OrderItem& item);
+    // 指定合约的在途报单 (切换合约时整体取一次)
+    std::vector<OrderItem> workingOrders(const QString& instrumentId) const;
     
 signals:
     void orderSoundTriggered(const QString& type); // "success", "fail", "cancel"
+    // 某价位在途手数的变化量 (新报单、部分成交、撤单/全成时发出)
+    void workingVolumeChanged(const QString& instrumentId, const QString& direction, double price, int delta);
 
 public slots:
     void onOrderReceived(const QJsonObject& json);
 
 private:
+    // 按到达顺序追加 (最早的在前)，界面倒序显示: 第 row 行对应 _orders[size - 1 - row]
     std::vector<OrderItem> _orders;
     mutable std::mutex _mutex;
-    
-    // 简单的 key-index 映射，用于快速更新 (Key: OrderSysID or OrderRef if sysid empty)
-    // 简化起见，我们遍历查找或者用 OrderSysID
-    int findOrderIndex(const QString& sysId, const QString& ref, const QString& instrumentId);
+
+    // 报单索引 (值为 _orders 下标，追加存储下标不变)
+    // 报单初期没有 OrderSysID，先按 FrontID:SessionID:OrderRef 定位，拿到 SysID 后补登
+    QHash<QString, int> _bySysId;  // "InstrumentID|OrderSysID"
+    QHash<QString, int> _byRef;    // "FrontID:SessionID:OrderRef"
+
+    static QString sysIdKey(const OrderItem& item) { return item.instrument_id + '|' + item.order_sys_id; }
+    static QString refKey(const OrderItem& item) {
+        return QString::number(item.front_id) + ':' + QString::number(item.session_id) + ':' + item.order_ref;
+    }
+    int rowOf(int storageIndex) const { return static_cast<int>(_orders.size()) - 1 - storageIndex; }
+
+    // 返回 _orders 下标，未找到返回 -1
+    int findOrderIndex(const OrderItem& item) const;
 };
 
 } // namespace QuantLabs
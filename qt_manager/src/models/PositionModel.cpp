@@ -1,6 +1,7 @@
 #include "models/PositionModel.h"
 
 #include <QDebug>
+#include <algorithm>
 #include <cstring>
 #include <cmath>
 
@@ -10,52 +11,42 @@ PositionModel::PositionModel(QObject *parent) : QAbstractListModel(parent) {}
 
 int PositionModel::rowCount(const QModelIndex &parent) const {
     if (parent.isValid()) return 0;
-    return _position_data.count();
+    return _rowSlot.count();
 }
 
 QVariant PositionModel::data(const QModelIndex &index, int role) const {
-    if (!index.isValid() || index.row() >= _position_data.count())
+    if (!index.isValid() || index.row() >= _rowSlot.count())
         return QVariant();
 
-    const auto &item = _position_data.at(index.row());
+    const int s = _rowSlot[index.row()];
+    const Entry& e = *_entry[s];
     switch (role) {
-        case IdRole: return item.instrumentId;
-        case DirectionRole: return (item.data.direction == '2' || item.data.direction == '0') ? "BUY" : "SELL";
-        case PosRole: return item.data.position;
-        case TodayPosRole: return item.data.today_position;
-        case YdPosRole: return item.data.yd_position;
+        case IdRole: return e.id;
+        case DirectionRole: return sideOf(_direction[s]) == 0 ? "BUY" : "SELL";
+        case PosRole: return _position[s];
+        case TodayPosRole: return _todayPosition[s];
+        case YdPosRole: return _ydPosition[s];
         case AvgPriceRole: {
             // 均价 = open_cost / (position × volume_multiple)
-            // volume_multiple 优先用 core 推送的值，其次查合约字典
-            int mult = item.data.volume_multiple;
-            if (mult <= 0 && _instrument_dict.contains(item.instrumentId)) {
-                mult = _instrument_dict[item.instrumentId].volume_multiple;
-            }
+            // volume_multiple 优先用 core 推送的值，其次查合约属性
+            int mult = _volumeMultiple[s] > 0 ? _volumeMultiple[s] : e.volumeMultiple;
             if (mult <= 0) mult = 1;  // 兜底
-            
-            if (item.data.position > 0 && item.data.open_cost > 0) {
-                return QString::number(item.data.open_cost / (item.data.position * mult), 'f', 2);
+
+            if (_position[s] > 0 && _openCost[s] > 0) {
+                return QString::number(_openCost[s] / (_position[s] * mult), 'f', 2);
             }
             return "0.00";
         }
-        case LastPriceRole: return item.lastPrice;
-        case PosProfitRole: return QString::number(item.data.pos_profit, 'f', 2);
-        case CloseProfitRole: return QString::number(item.data.close_profit, 'f', 2);
-        case MarginRole: return QString::number(item.data.margin, 'f', 2);
-        case BidPrice1Role: return item.bidPrice1;
-        case AskPrice1Role: return item.askPrice1;
-        case PriceTickRole: return item.priceTick;
-        case UpperLimitRole: return item.upperLimit;
-        case LowerLimitRole: return item.lowerLimit;
-        case ExchangeRole: {
-             QString exId = QString::fromUtf8(item.data.exchange_id);
-             if (!exId.isEmpty()) return exId;
-             
-             if (_instrument_dict.contains(item.instrumentId)) {
-                 return QString::fromUtf8(_instrument_dict[item.instrumentId].exchange_id);
-             }
-             return "";
-        }
+        case LastPriceRole: return e.lastPrice;
+        case PosProfitRole: return QString::number(_posProfit[s], 'f', 2);
+        case CloseProfitRole: return QString::number(_closeProfit[s], 'f', 2);
+        case MarginRole: return QString::number(_margin[s], 'f', 2);
+        case BidPrice1Role: return e.bidPrice1;
+        case AskPrice1Role: return e.askPrice1;
+        case PriceTickRole: return e.priceTick;
+        case UpperLimitRole: return e.upperLimit;
+        case LowerLimitRole: return e.lowerLimit;
+        case ExchangeRole: return _exchange[s].isEmpty() ? e.exchangeId : _exchange[s];
         default: return QVariant();
     }
 }
@@ -81,287 +72,259 @@ QHash<int, QByteArray> PositionModel::roleNames() const {
     return roles;
 }
 
-void PositionModel::updatePosition(const QJsonObject& j) {
-    try {
-        QString id;
-        if (j.contains("instrument_id")) id = j["instrument_id"].toString();
-        else if (j.contains("id")) id = j["id"].toString();
-        else return;
-
-        // Parse direction
-        char dir = '0';
-        if (j.contains("direction")) {
-            QJsonValue v = j["direction"];
-            if (v.isString()) dir = v.toString().toStdString()[0];
-            else dir = (char)v.toInt();
-        } else if (j.contains("dir")) {
-             QJsonValue v = j["dir"];
-             if (v.isString()) dir = v.toString().toStdString()[0];
-             else dir = (char)v.toInt();
-        }
-        
-        // 检查快照批次号
-        int64_t snapshot_seq = 0;
-        if (j.contains("snapshot_seq")) {
-            snapshot_seq = (int64_t)j["snapshot_seq"].toDouble();
-        } else if (j.contains("is_snapshot")) {
-             if (j["is_snapshot"].toBool()) snapshot_seq = 1; 
-        }
+PositionModel::Entry& PositionModel::entryFor(std::string_view id) {
+    auto it = _entries.find(id);
+    if (it == _entries.end()) {
+        it = _entries.emplace(std::string(id), Entry{}).first;
+        it->second.id = QString::fromUtf8(id.data(), static_cast<int>(id.size()));
+    }
+    return it->second;
+}
 
-        // 全量快照时清空旧数据
-        static int64_t last_snapshot_seq = 0;
-        if (snapshot_seq > 0 && snapshot_seq != last_snapshot_seq) {
-            beginResetModel();
-            _position_data.clear();
-            _instrument_to_indices.clear();
-            endResetModel();
-            last_snapshot_seq = snapshot_seq;
-        }
-        
-        // 查找已存在的行
-        int row = -1;
-        if (_instrument_to_indices.contains(id)) {
-            const auto& indices = _instrument_to_indices[id];
-            for (int idx : indices) {
-                if (idx >= 0 && idx < _position_data.size()) {
-                    if (_position_data[idx].data.direction == dir) {
-                        row = idx;
-                        break;
-                    }
-                }
-            }
-        }
+PositionModel::Entry* PositionModel::findEntry(std::string_view id) {
+    auto it = _entries.find(id);
+    return it == _entries.end() ? nullptr : &it->second;
+}
 
-        if (row != -1) {
-            // 更新已有行
-            auto& d = _position_data[row].data;
-            if(j.contains("position")) d.position = j["position"].toInt();
-            if(j.contains("today_position")) d.today_position = j["today_position"].toInt();
-            if(j.contains("yd_position")) d.yd_position = j["yd_position"].toInt();
-            if(j.contains("position_cost")) d.position_cost = j["position_cost"].toDouble();
-            if(j.contains("open_cost")) d.open_cost = j["open_cost"].toDouble();
-            if(j.contains("pos_profit")) d.pos_profit = j["pos_profit"].toDouble();
-            if(j.contains("close_profit")) d.close_profit = j["close_profit"].toDouble();
-            if(j.contains("margin")) d.margin = j["margin"].toDouble();
-            if(j.contains("volume_multiple")) d.volume_multiple = j["volume_multiple"].toInt();
-            if(j.contains("exchange_id")) {
-                std::string s = j["exchange_id"].toString().toStdString();
-                strncpy(d.exchange_id, s.c_str(), sizeof(d.exchange_id)-1);
-            }
-            
-            // 持仓量 <= 0 时删除行
-            if (d.position <= 0) {
-                 beginRemoveRows(QModelIndex(), row, row);
-                 _position_data.removeAt(row);
-                 endRemoveRows();
-                 
-                 // 重建索引
-                 _instrument_to_indices.clear();
-                 for(int i=0; i<_position_data.size(); ++i) {
-                     _instrument_to_indices[QString::fromUtf8(_position_data[i].data.instrument_id)].append(i);
-                 }
-            } else {
-                 emit dataChanged(index(row), index(row));
-            }
+int PositionModel::allocSlot() {
+    if (!_freeSlots.empty()) {
+        int s = _freeSlots.back();
+        _freeSlots.pop_back();
+        return s;
+    }
+    int s = static_cast<int>(_slotRow.size());
+    _entry.push_back(nullptr);
+    _direction.push_back(0);
+    _position.push_back(0);
+    _todayPosition.push_back(0);
+    _ydPosition.push_back(0);
+    _volumeMultiple.push_back(0);
+    _openCost.push_back(0.0);
+    _posProfit.push_back(0.0);
+    _closeProfit.push_back(0.0);
+    _margin.push_back(0.0);
+    _exchange.emplace_back();
+    _slotRow.push_back(-1);
+    return s;
+}
+
+void PositionModel::removeRow(int row) {
+    // 末行补到被删位置，再删末行: 其余行的行号不变
+    const int last = _rowSlot.count() - 1;
+    const int s = _rowSlot[row];
+    if (row != last) {
+        const int moved = _rowSlot[last];
+        _rowSlot[row] = moved;
+        _slotRow[moved] = row;
+        emit dataChanged(index(row), index(row));
+    }
+    beginRemoveRows(QModelIndex(), last, last);
+    _rowSlot.removeLast();
+    endRemoveRows();
+
+    _slotRow[s] = -1;
+    _entry[s] = nullptr;
+    _exchange[s].clear();
+    _freeSlots.push_back(s);
+}
+
+PositionData PositionModel::positionFromJson(const QJsonObject& j) {
+    PositionData d;
+    std::memset(&d, 0, sizeof(d));
+
+    QString id = j.contains("instrument_id") ? j["instrument_id"].toString() : j["id"].toString();
+    QByteArray idUtf8 = id.toUtf8();
+    std::strncpy(d.instrument_id, idUtf8.constData(), sizeof(d.instrument_id) - 1);
+
+    QJsonValue dir = j.contains("direction") ? j["direction"] : j["dir"];
+    if (dir.isString()) {
+        QString s = dir.toString();
+        d.direction = s.isEmpty() ? '0' : s.at(0).toLatin1();
+    } else {
+        d.direction = static_cast<char>(dir.toInt('0'));
+    }
+
+    d.position = j["position"].toInt();
+    d.today_position = j["today_position"].toInt();
+    d.yd_position = j["yd_position"].toInt();
+    d.position_cost = j["position_cost"].toDouble();
+    d.open_cost = j["open_cost"].toDouble();
+    d.pos_profit = j["pos_profit"].toDouble();
+    d.close_profit = j["close_profit"].toDouble();
+    d.margin = j["margin"].toDouble();
+    d.volume_multiple = j["volume_multiple"].toInt();
+    QByteArray ex = j["exchange_id"].toString().toUtf8();
+    std::strncpy(d.exchange_id, ex.constData(), sizeof(d.exchange_id) - 1);
+    return d;
+}
+
+void PositionModel::resetPositions(const QJsonArray& positions) {
+    // 行情/合约属性按合约存在 _entries 中，重置持仓不影响价格显示
+    beginResetModel();
+    _rowSlot.clear();
+    for (auto& [id, e] : _entries) e.slot[0] = e.slot[1] = -1;
+    _freeSlots.clear();
+    for (int s = static_cast<int>(_slotRow.size()) - 1; s >= 0; --s) {
+        _slotRow[s] = -1;
+        _entry[s] = nullptr;
+        _freeSlots.push_back(s);
+    }
+    _total_profit = 0.0;
+
+    for (const auto& v : positions) {
+        if (v.isObject()) applyPosition(positionFromJson(v.toObject()), false);
+    }
+    endResetModel();
+
+    notifyTotalProfit();
+}
+
+void PositionModel::updatePositionBinary(const PositionData& data) {
+    applyPosition(data, true);
+    notifyTotalProfit();
+}
+
+void PositionModel::applyPosition(const PositionData& p, bool notify) {
+    std::string_view id(p.instrument_id, strnlen(p.instrument_id, sizeof(p.instrument_id)));
+    if (id.empty()) return;
+
+    Entry& e = entryFor(id);
+    const int side = sideOf(p.direction);
+    int s = e.slot[side];
+
+    if (s < 0) {
+        // 新增行 (仅 position > 0 时)
+        if (p.position <= 0) return;
+        const bool firstRow = e.slot[1 - side] < 0;
+
+        s = allocSlot();
+        e.slot[side] = s;
+        _entry[s] = &e;
+        _direction[s] = p.direction;
+        _exchange[s] = QString::fromUtf8(p.exchange_id, static_cast<int>(strnlen(p.exchange_id, sizeof(p.exchange_id))));
+        _posProfit[s] = 0.0;
+
+        const int row = _rowSlot.count();
+        if (notify) beginInsertRows(QModelIndex(), row, row);
+        _rowSlot.append(s);
+        _slotRow[s] = row;
+        if (notify) endInsertRows();
+
+        // 该合约首次出现持仓时，通知行情列表自动添加并订阅
+        if (firstRow) emit instrumentNeeded(e.id);
+    } else if (p.position <= 0) {
+        // 持仓量 <= 0 时删除行
+        _total_profit -= _posProfit[s];
+        e.slot[side] = -1;
+        if (notify) {
+            removeRow(_slotRow[s]);
         } else {
-            // 新增行（仅 position > 0 时）
-            int pos = 0;
-            if(j.contains("position")) pos = j["position"].toInt();
-            
-            if (pos > 0) {
-                beginInsertRows(QModelIndex(), _position_data.count(), _position_data.count());
-                
-                PositionItem item;
-                std::memset(&item.data, 0, sizeof(item.data));
-                item.instrumentId = id;
-                strncpy(item.data.instrument_id, id.toStdString().c_str(), sizeof(item.data.instrument_id)-1);
-                item.data.direction = dir;
-                item.data.position = pos;
-                
-                if(j.contains("today_position")) item.data.today_position = j["today_position"].toInt();
-                if(j.contains("yd_position")) item.data.yd_position = j["yd_position"].toInt();
-                if(j.contains("position_cost")) item.data.position_cost = j["position_cost"].toDouble();
-                if(j.contains("open_cost")) item.data.open_cost = j["open_cost"].toDouble();
-                if(j.contains("pos_profit")) item.data.pos_profit = j["pos_profit"].toDouble();
-                if(j.contains("close_profit")) item.data.close_profit = j["close_profit"].toDouble();
-                if(j.contains("margin")) item.data.margin = j["margin"].toDouble();
-                if(j.contains("volume_multiple")) item.data.volume_multiple = j["volume_multiple"].toInt();
-                if(j.contains("exchange_id")) {
-                    std::string s = j["exchange_id"].toString().toStdString();
-                    strncpy(item.data.exchange_id, s.c_str(), sizeof(item.data.exchange_id)-1);
-                }
-                
-                _position_data.append(item);
-                _instrument_to_indices[id].append(_position_data.count() - 1);
-                endInsertRows();
-                
-                // 该合约首次出现持仓时，通知行情列表自动添加并订阅
-                if (_instrument_to_indices[id].size() == 1) {
-                    emit instrumentNeeded(id);
-                }
-            }
+            // 重置期间: 同样末行补位，但不发信号
+            const int row = _slotRow[s];
+            const int moved = _rowSlot.last();
+            _rowSlot[row] = moved;
+            _slotRow[moved] = row;
+            _rowSlot.removeLast();
+            _slotRow[s] = -1;
+            _entry[s] = nullptr;
+            _freeSlots.push_back(s);
         }
-        
-        recalcTotalProfit();
-    } catch (...) {}
+        return;
+    }
+
+    _total_profit += p.pos_profit - _posProfit[s];
+    _position[s] = p.position;
+    _todayPosition[s] = p.today_position;
+    _ydPosition[s] = p.yd_position;
+    _openCost[s] = p.open_cost;
+    _posProfit[s] = p.pos_profit;
+    _closeProfit[s] = p.close_profit;
+    _margin[s] = p.margin;
+    _volumeMultiple[s] = p.volume_multiple;
+
+    if (notify && _slotRow[s] >= 0) {
+        const QModelIndex idx = index(_slotRow[s]);
+        emit dataChanged(idx, idx);
+    }
 }
 
 void PositionModel::updatePrice(const QJsonObject& j) {
-    try {
-        QString id;
-        if (j.contains("instrument_id")) id = j["instrument_id"].toString();
-        else if (j.contains("id")) id = j["id"].toString();
-        else return;
-
-        double lastPrice = 0.0;
-        if (j.contains("last_price")) lastPrice = j["last_price"].toDouble();
-        else if (j.contains("price")) lastPrice = j["price"].toDouble(); 
-        else return;
-        
-        double bidPrice1 = 0.0;
-        double askPrice1 = 0.0;
-        if (j.contains("bid_price1")) bidPrice1 = j["bid_price1"].toDouble();
-        if (j.contains("ask_price1")) askPrice1 = j["ask_price1"].toDouble();
-        
-        double upperLimit = 0.0;
-        double lowerLimit = 0.0;
-        if (j.contains("upper_limit_price")) upperLimit = j["upper_limit_price"].toDouble();
-        if (j.contains("lower_limit_price")) lowerLimit = j["lower_limit_price"].toDouble();
-        
-        if (!_instrument_to_indices.contains(id)) return;
-
-        bool profitChanged = false;
-        for (int row : _instrument_to_indices[id]) {
-            if (row < 0 || row >= _position_data.size()) continue;
-            
-            PositionItem& item = _position_data[row];
-            item.lastPrice = lastPrice;
-            item.bidPrice1 = bidPrice1;
-            item.askPrice1 = askPrice1;
-            item.upperLimit = upperLimit;
-            item.lowerLimit = lowerLimit;
-            
-            if (_instrument_dict.contains(id)) {
-                item.priceTick = _instrument_dict[id].price_tick;
-            }
-            
-            // 实时计算浮动盈亏: (最新价 - 均价) × 持仓量 × 合约乘数 × 方向系数
-            if (item.data.position > 0 && lastPrice > 0) {
-                int mult = item.data.volume_multiple;
-                if (mult <= 0 && _instrument_dict.contains(id)) {
-                    mult = _instrument_dict[id].volume_multiple;
-                }
-                if (mult <= 0) mult = 1;
-                
-                double avgPrice = item.data.open_cost / (item.data.position * mult);
-                double dirSign = (item.data.direction == '2' || item.data.direction == '0') ? 1.0 : -1.0;
-                double oldProfit = item.data.pos_profit;
-                item.data.pos_profit = (lastPrice - avgPrice) * item.data.position * mult * dirSign;
-                
-                if (std::abs(oldProfit - item.data.pos_profit) > 0.001) profitChanged = true;
-            }
-            
-            emit dataChanged(index(row), index(row), 
-                {LastPriceRole, PosProfitRole, BidPrice1Role, AskPrice1Role, PriceTickRole, UpperLimitRole, LowerLimitRole});
-        }
-        
-        if (profitChanged) recalcTotalProfit();
-    } catch (...) {}
+    QString id;
+    if (j.contains("instrument_id")) id = j["instrument_id"].toString();
+    else if (j.contains("id")) id = j["id"].toString();
+    else return;
+
+    double lastPrice = 0.0;
+    if (j.contains("last_price")) lastPrice = j["last_price"].toDouble();
+    else if (j.contains("price")) lastPrice = j["price"].toDouble();
+    else return;
+
+    QByteArray key = id.toUtf8();
+    Entry* e = findEntry(std::string_view(key.constData(), key.size()));
+    if (!e) return;
+
+    e->lastPrice = lastPrice;
+    e->bidPrice1 = j["bid_price1"].toDouble();
+    e->askPrice1 = j["ask_price1"].toDouble();
+    e->upperLimit = j["upper_limit_price"].toDouble();
+    e->lowerLimit = j["lower_limit_price"].toDouble();
+
+    for (int s : e->slot) {
+        if (s < 0) continue;
+        const QModelIndex idx = index(_slotRow[s]);
+        emit dataChanged(idx, idx, {LastPriceRole, BidPrice1Role, AskPrice1Role, UpperLimitRole, LowerLimitRole});
+    }
 }
 
-void PositionModel::updatePriceBinary(const TickData& data) {
-    QString id = QString::fromLatin1(data.instrument_id);
-    if (!_instrument_to_indices.contains(id)) return;
-    
-    bool profitChanged = false;
-    for (int row : _instrument_to_indices[id]) {
-        if (row < 0 || row >= _position_data.size()) continue;
-        
-        PositionItem& item = _position_data[row];
-        item.lastPrice = data.last_price;
-        item.bidPrice1 = data.bid_price1;
-        item.askPrice1 = data.ask_price1;
-        item.upperLimit = data.upper_limit_price;
-        item.lowerLimit = data.lower_limit_price;
-        
-        if (_instrument_dict.contains(id)) {
-            item.priceTick = _instrument_dict[id].price_tick;
-        }
-        
-        // 实时计算浮动盈亏: (最新价 - 均价) × 持仓量 × 合约乘数 × 方向系数
-        if (item.data.position > 0 && data.last_price > 0) {
-            int mult = item.data.volume_multiple;
-            if (mult <= 0 && _instrument_dict.contains(id)) {
-                mult = _instrument_dict[id].volume_multiple;
-            }
-            if (mult <= 0) mult = 1;
-            
-            double avgPrice = item.data.open_cost / (item.data.position * mult);
-            double dirSign = (item.data.direction == '2' || item.data.direction == '0') ? 1.0 : -1.0;
-            double oldProfit = item.data.pos_profit;
-            item.data.pos_profit = (data.last_price - avgPrice) * item.data.position * mult * dirSign;
-            
-            if (std::abs(oldProfit - item.data.pos_profit) > 0.001) profitChanged = true;
+void PositionModel::updatePricesBinary(const std::vector<TickData>& ticks) {
+    // 只更新行情列；浮动盈亏由 core 盯市后随持仓推送
+    int firstRow = -1;
+    int lastRow = -1;
+
+    for (const TickData& data : ticks) {
+        Entry* e = findEntry(std::string_view(data.instrument_id, strnlen(data.instrument_id, sizeof(data.instrument_id))));
+        if (!e || (e->slot[0] < 0 && e->slot[1] < 0)) continue;
+
+        e->lastPrice = data.last_price;
+        e->bidPrice1 = data.bid_price1;
+        e->askPrice1 = data.ask_price1;
+        e->upperLimit = data.upper_limit_price;
+        e->lowerLimit = data.lower_limit_price;
+
+        for (int s : e->slot) {
+            if (s < 0) continue;
+            const int row = _slotRow[s];
+            firstRow = (firstRow < 0) ? row : std::min(firstRow, row);
+            lastRow = std::max(lastRow, row);
         }
-        
-        emit dataChanged(index(row), index(row), 
-            {LastPriceRole, PosProfitRole, BidPrice1Role, AskPrice1Role, PriceTickRole, UpperLimitRole, LowerLimitRole});
     }
-    
-    if (profitChanged) recalcTotalProfit();
+
+    if (firstRow >= 0) {
+        emit dataChanged(index(firstRow), index(lastRow),
+            {LastPriceRole, BidPrice1Role, AskPrice1Role, UpperLimitRole, LowerLimitRole});
+    }
 }
 
 void PositionModel::updateInstrument(const QJsonObject& j) {
-    try {
-        QString id;
-        if (j.contains("instrument_id")) id = j["instrument_id"].toString();
-        else return;
-        
-        InstrumentMeta info;  // 默认构造已全零初始化
-        
-        strncpy(info.instrument_id, id.toStdString().c_str(), sizeof(info.instrument_id)-1);
-        if(j.contains("instrument_name")) {
-             std::string name = j["instrument_name"].toString().toStdString();
-             strncpy(info.instrument_name, name.c_str(), sizeof(info.instrument_name)-1);
-        }
-        if(j.contains("exchange_id")) {
-             std::string ex = j["exchange_id"].toString().toStdString();
-             strncpy(info.exchange_id, ex.c_str(), sizeof(info.exchange_id)-1);
-        }
+    if (!j.contains("instrument_id")) return;
+    QByteArray key = j["instrument_id"].toString().toUtf8();
 
-        if(j.contains("volume_multiple")) info.volume_multiple = j["volume_multiple"].toInt();
-        if(j.contains("price_tick")) info.price_tick = j["price_tick"].toDouble();
-        
-        // 保证金率
-        if(j.contains("long_margin_ratio_by_money")) info.long_margin_ratio_by_money = j["long_margin_ratio_by_money"].toDouble();
-        if(j.contains("short_margin_ratio_by_money")) info.short_margin_ratio_by_money = j["short_margin_ratio_by_money"].toDouble();
-        
-        // 手续费率
-        if(j.contains("open_ratio_by_money")) info.open_ratio_by_money = j["open_ratio_by_money"].toDouble();
-        if(j.contains("close_ratio_by_money")) info.close_ratio_by_money = j["close_ratio_by_money"].toDouble();
-        if(j.contains("close_today_ratio_by_money")) info.close_today_ratio_by_money = j["close_today_ratio_by_money"].toDouble();
-
-        _instrument_dict[id] = info;
-
-        // 合约信息更新后触发相关持仓行刷新（均价可能需要 volume_multiple）
-        if (_instrument_to_indices.contains(id)) {
-            for (int row : _instrument_to_indices[id]) {
-                if (row >= 0 && row < _position_data.size()) {
-                    emit dataChanged(index(row), index(row));
-                }
-            }
-        }
-    } catch (...) {}
-}
+    Entry& e = entryFor(std::string_view(key.constData(), key.size()));
+    if (j.contains("volume_multiple")) e.volumeMultiple = j["volume_multiple"].toInt();
+    if (j.contains("price_tick")) e.priceTick = j["price_tick"].toDouble();
+    if (j.contains("exchange_id")) e.exchangeId = j["exchange_id"].toString();
 
-void PositionModel::recalcTotalProfit() {
-    double newTotal = 0.0;
-    for (const auto& item : _position_data) {
-        newTotal += item.data.pos_profit;
+    // 合约信息更新后触发相关持仓行刷新（均价可能需要 volume_multiple）
+    for (int s : e.slot) {
+        if (s < 0) continue;
+        const QModelIndex idx = index(_slotRow[s]);
+        emit dataChanged(idx, idx, {AvgPriceRole, PriceTickRole, ExchangeRole});
     }
-    
-    if (std::abs(newTotal - _total_profit) > 0.01) {
-        _total_profit = newTotal;
+}
+
+void PositionModel::notifyTotalProfit() {
+    if (std::abs(_total_profit - _reported_profit) > 0.01) {
+        _reported_profit = _total_profit;
         emit totalProfitChanged(_total_profit);
     }
 }
@@ -5,22 +5,24 @@
 #include <QVector>
 #include <QString>
 #include <QJsonObject>
+#include <QJsonArray>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
 #include "../../../shared/protocol/message_schema.h"
 
 namespace QuantLabs {
 
-struct PositionItem {
-    PositionData data;
-    // UI 辅助字段（行情推送填充）
-    QString instrumentId; 
-    double lastPrice = 0.0;
-    double bidPrice1 = 0.0;   // 买一价
-    double askPrice1 = 0.0;   // 卖一价
-    double priceTick = 0.0;   // 最小变动价位
-    double upperLimit = 0.0;  // 涨停板
-    double lowerLimit = 0.0;  // 跌停板
-};
-
+/**
+ * @brief 持仓表 (按列存储)
+ *
+ * - 每个 (合约, 方向) 占一个 slot，slot 下标在持仓存续期间不变，各字段按 slot 存成独立列
+ * - 合约 -> {多头 slot, 空头 slot} 的索引只在开/清仓时增删，不随行删除重建
+ * - 删行用末行补位 (O(1))，显示顺序不保证为开仓顺序
+ * - 浮动盈亏由 core 盯市后随二进制持仓 (PB) 推送，模型只做展示；合计按变化量增减
+ */
 class PositionModel : public QAbstractListModel {
 
     Q_OBJECT
@@ -53,24 +55,72 @@ public:
     double totalProfit() const { return _total_profit; }
 
 public slots:
-    void updatePosition(const QJsonObject& json);
-    void updatePrice(const QJsonObject& json); 
-    void updatePriceBinary(const TickData& data);
-    void updateInstrument(const QJsonObject& json); 
+    // 单条持仓 (二进制 PB，成交变动或 core 盯市)
+    void updatePositionBinary(const PositionData& data);
+    void updatePrice(const QJsonObject& json);
+    // 一帧内合并后的二进制行情 (TickBatcher::ticksReady)，整批只发一次 dataChanged
+    void updatePricesBinary(const std::vector<TickData>& ticks);
+    void updateInstrument(const QJsonObject& json);
+    // 用快照 (rtn_snapshot.positions) 整体替换持仓
+    void resetPositions(const QJsonArray& positions);
 
 signals:
     void totalProfitChanged(double totalProfit);
     void instrumentNeeded(const QString& instrumentId);  // 持仓合约需要订阅行情
 
 private:
-    void recalcTotalProfit();
-    QVector<PositionItem> _position_data;
-    QHash<QString, QVector<int>> _instrument_to_indices; 
-    
-    // 合约信息字典（复用 shared 的 InstrumentMeta）
-    QHash<QString, InstrumentMeta> _instrument_dict;
-    
-    double _total_profit = 0.0;
+    // 每个合约一项 (只增不删，节点地址稳定)，行情与合约属性按合约只存一份
+    struct Entry {
+        QString id;
+        int slot[2] = {-1, -1};   // [0] 多头 / [1] 空头，-1 表示无持仓
+        double lastPrice = 0.0;
+        double bidPrice1 = 0.0;
+        double askPrice1 = 0.0;
+        double upperLimit = 0.0;
+        double lowerLimit = 0.0;
+        double priceTick = 0.0;
+        int volumeMultiple = 0;   // 合约属性中的乘数 (持仓未带乘数时兜底)
+        QString exchangeId;
+    };
+
+    // 支持 string_view 直接查找，行情路径无需构造 QString/std::string
+    struct KeyHash {
+        using is_transparent = void;
+        size_t operator()(std::string_view s) const { return std::hash<std::string_view>{}(s); }
+    };
+
+    static int sideOf(char direction) { return (direction == '2' || direction == '0') ? 0 : 1; }
+    static PositionData positionFromJson(const QJsonObject& json);
+
+    Entry& entryFor(std::string_view id);
+    Entry* findEntry(std::string_view id);
+    // notify=false 时在 beginResetModel/endResetModel 之间调用，不发行级信号
+    void applyPosition(const PositionData& data, bool notify);
+    int allocSlot();
+    void removeRow(int row);
+    void notifyTotalProfit();
+
+    std::unordered_map<std::string, Entry, KeyHash, std::equal_to<>> _entries;
+
+    // 按 slot 存储的列
+    std::vector<Entry*> _entry;
+    std::vector<char> _direction;
+    std::vector<int> _position;
+    std::vector<int> _todayPosition;
+    std::vector<int> _ydPosition;
+    std::vector<int> _volumeMultiple;
+    std::vector<double> _openCost;
+    std::vector<double> _posProfit;
+    std::vector<double> _closeProfit;
+    std::vector<double> _margin;
+    std::vector<QString> _exchange;
+    std::vector<int> _slotRow;      // slot -> 行号 (-1 表示空闲)
+    std::vector<int> _freeSlots;
+
+    QVector<int> _rowSlot;          // 行号 -> slot
+
+    double _total_profit = 0.0;     // 各行浮盈之和 (按变化量维护)
+    double _reported_profit = 0.0;  // 上次通知出去的值
 };
 
 
@@ -0,0 +1,234 @@
+#include "models/QuoteBoardModel.h"
+
+#include <QDebug>
+#include <algorithm>
+#include <cstring>
+
+namespace QuantLabs {
+
+QuoteBoardModel::QuoteBoardModel(QObject *parent)
+    : QAbstractListModel(parent) {
+    _quotes.reserve(1024);
+}
+
+int QuoteBoardModel::rowCount(const QModelIndex &parent) const {
+    if (parent.isValid()) return 0;
+    return _rowCount;
+}
+
+QVariant QuoteBoardModel::data(const QModelIndex &index, int role) const {
+    if (!index.isValid() || index.row() >= _rowCount) return QVariant();
+    const size_t pos = static_cast<size_t>(_windowStart + index.row());
+    if (pos >= _rank.size()) return QVariant();
+
+    const Quote& q = _quotes[_rank.at(pos)];
+    switch (role) {
+        case IdRole: return q.id;
+        case NameRole: return q.name;
+        case ExchangeRole: return q.exchange;
+        case RankRole: return static_cast<int>(pos) + 1;
+        case PriceRole: return q.lastPrice;
+        case ChangeRole: return q.change;
+        case ChangePercentRole: return q.changePercent;
+        case VolumeRole: return q.volume;
+        case OpenInterestRole: return q.openInterest;
+        case TurnoverRole: return q.turnover;
+        case BidPrice1Role: return q.bidPrice1;
+        case AskPrice1Role: return q.askPrice1;
+        case TimeRole: return QString::fromLatin1(q.updateTime);
+        default: return QVariant();
+    }
+}
+
+QHash<int, QByteArray> QuoteBoardModel::roleNames() const {
+    QHash<int, QByteArray> roles;
+    roles[IdRole] = "instrumentId";
+    roles[NameRole] = "instrumentName";
+    roles[ExchangeRole] = "exchangeId";
+    roles[RankRole] = "rank";
+    roles[PriceRole] = "lastPrice";
+    roles[ChangeRole] = "change";
+    roles[ChangePercentRole] = "changePercent";
+    roles[VolumeRole] = "volume";
+    roles[OpenInterestRole] = "openInterest";
+    roles[TurnoverRole] = "turnover";
+    roles[BidPrice1Role] = "bidPrice1";
+    roles[AskPrice1Role] = "askPrice1";
+    roles[TimeRole] = "updateTime";
+    return roles;
+}
+
+void QuoteBoardModel::setSortKey(int key) {
+    if (key == _sortKey || key < SortNone || key > SortTurnover) return;
+    _sortKey = key;
+    rebuild();
+    emit sortChanged();
+}
+
+void QuoteBoardModel::setDescending(bool descending) {
+    if (descending == _rank.descending()) return;
+    _rank.setDescending(descending);
+    rebuild();
+    emit sortChanged();
+}
+
+void QuoteBoardModel::setExchangeFilter(const QString& exchange) {
+    if (exchange == _exchangeFilter) return;
+    _exchangeFilter = exchange;
+    rebuild();
+    emit exchangeFilterChanged();
+}
+
+void QuoteBoardModel::setWindowStart(int start) {
+    start = std::clamp(start, 0, std::max(0, totalCount() - _windowSize));
+    if (start == _windowStart) return;
+    _windowStart = start;
+    refreshWindow();
+    emit windowChanged();
+}
+
+void QuoteBoardModel::setWindowSize(int size) {
+    size = std::max(size, 0);
+    if (size == _windowSize) return;
+    _windowSize = size;
+    _windowStart = std::clamp(_windowStart, 0, std::max(0, totalCount() - _windowSize));
+    refreshWindow();
+    emit windowChanged();
+}
+
+void QuoteBoardModel::updateTicksBinary(const std::vector<TickData>& ticks) {
+    const size_t oldTotal = _rank.size();
+    bool dirty = false;
+
+    for (const TickData& t : ticks) {
+        std::string_view id(t.instrument_id, strnlen(t.instrument_id, sizeof(t.instrument_id)));
+        if (id.empty()) continue;
+
+        const uint32_t slot = slotFor(id);
+        Quote& q = _quotes[slot];
+
+        double basePrice = t.pre_settlement_price;
+        if (basePrice < 0.0001) basePrice = t.pre_close_price;
+        q.lastPrice = t.last_price;
+        q.change = 0.0;
+        q.changePercent = 0.0;
+        if (basePrice > 0.0001 && t.last_price > 0.0) {
+            q.change = t.last_price - basePrice;
+            q.changePercent = q.change / basePrice * 100.0;
+        }
+        q.volume = t.volume;
+        q.openInterest = t.open_interest;
+        q.turnover = t.turnover;
+        q.bidPrice1 = t.bid_price1;
+        q.askPrice1 = t.ask_price1;
+        std::memcpy(q.updateTime, t.update_time, sizeof(q.updateTime));
+        q.updateTime[sizeof(q.updateTime) - 1] = '\0';
+
+        if (!_rank.contains(slot)) {
+            if (!passesFilter(slot)) continue;
+            const size_t pos = _rank.insert(slot, keyOf(slot));
+            // 插在窗口之前或之中都会使窗口内的名次整体下移
+            dirty = dirty || pos < static_cast<size_t>(_windowStart + _windowSize);
+        } else {
+            const auto [from, to] = _rank.update(slot, keyOf(slot));
+            dirty = dirty || touchesWindow(std::min(from, to), std::max(from, to));
+        }
+    }
+
+    if (dirty) refreshWindow();
+    if (_rank.size() != oldTotal) emit totalCountChanged();
+}
+
+void QuoteBoardModel::updateInstrument(const QJsonObject& j) {
+    if (!j.contains("instrument_id")) return;
+    QByteArray key = j["instrument_id"].toString().toUtf8();
+    if (key.isEmpty()) return;
+
+    const uint32_t slot = slotFor(std::string_view(key.constData(), key.size()));
+    Quote& q = _quotes[slot];
+    if (j.contains("instrument_name")) q.name = j["instrument_name"].toString();
+    if (j.contains("exchange_id")) q.exchange = j["exchange_id"].toString();
+
+    // 交易所信息可能晚于行情到达，按过滤条件补进或移出榜单
+    const bool listed = _rank.contains(slot);
+    const bool wanted = passesFilter(slot);
+    if (listed == wanted) {
+        if (listed) {
+            const auto [from, to] = _rank.update(slot, keyOf(slot));
+            if (touchesWindow(std::min(from, to), std::max(from, to))) refreshWindow();
+        }
+        return;
+    }
+
+    size_t pos = 0;
+    if (wanted) pos = _rank.insert(slot, keyOf(slot));
+    else pos = _rank.erase(slot);
+    if (pos < static_cast<size_t>(_windowStart + _windowSize)) refreshWindow();
+    emit totalCountChanged();
+}
+
+uint32_t QuoteBoardModel::slotFor(std::string_view id) {
+    auto it = _slotById.find(id);
+    if (it != _slotById.end()) return it->second;
+    const uint32_t slot = static_cast<uint32_t>(_quotes.size());
+    _slotById.emplace(std::string(id), slot);
+    _quotes.emplace_back();
+    _quotes.back().id = QString::fromUtf8(id.data(), static_cast<int>(id.size()));
+    return slot;
+}
+
+double QuoteBoardModel::keyOf(uint32_t slot) const {
+    const Quote& q = _quotes[slot];
+    switch (_sortKey) {
+        case SortChangePercent: return q.changePercent;
+        case SortVolume: return q.volume;
+        case SortOpenInterest: return q.openInterest;
+        case SortTurnover: return q.turnover;
+        default: return 0.0;  // 键值相同，按 slot (到达顺序) 排
+    }
+}
+
+bool QuoteBoardModel::passesFilter(uint32_t slot) const {
+    return _exchangeFilter.isEmpty() || _quotes[slot].exchange == _exchangeFilter;
+}
+
+bool QuoteBoardModel::touchesWindow(size_t first, size_t last) const {
+    const size_t begin = static_cast<size_t>(_windowStart);
+    const size_t end = begin + static_cast<size_t>(_rowCount);
+    return first < end && last >= begin;
+}
+
+void QuoteBoardModel::rebuild() {
+    std::vector<std::pair<double, uint32_t>> entries;
+    entries.reserve(_quotes.size());
+    for (uint32_t slot = 0; slot < _quotes.size(); ++slot) {
+        if (passesFilter(slot)) entries.emplace_back(keyOf(slot), slot);
+    }
+
+    beginResetModel();
+    _rank.assign(std::move(entries));
+    _windowStart = std::clamp(_windowStart, 0, std::max(0, totalCount() - _windowSize));
+    _rowCount = std::min(_windowSize, totalCount() - _windowStart);
+    endResetModel();
+
+    emit totalCountChanged();
+    emit windowChanged();
+    qDebug() << "[QuoteBoardModel] Rebuilt ranking, sortKey:" << _sortKey << "total:" << totalCount();
+}
+
+void QuoteBoardModel::refreshWindow() {
+    // 窗口只会在尾部增减行 (名次 = windowStart + 行号)
+    const int rows = std::max(0, std::min(_windowSize, totalCount() - _windowStart));
+    if (rows > _rowCount) {
+        beginInsertRows(QModelIndex(), _rowCount, rows - 1);
+        _rowCount = rows;
+        endInsertRows();
+    } else if (rows < _rowCount) {
+        beginRemoveRows(QModelIndex(), rows, _rowCount - 1);
+        _rowCount = rows;
+        endRemoveRows();
+    }
+    if (_rowCount > 0) emit dataChanged(index(0), index(_rowCount - 1));
+}
+
+} // namespace QuantLabs
@@ -0,0 +1,131 @@
+#pragma once
+
+#include <QAbstractListModel>
+#include <QHash>
+#include <QString>
+#include <QJsonObject>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "models/RankedIndex.h"
+#include "../../../shared/protocol/message_schema.h"
+
+namespace QuantLabs {
+
+/**
+ * @brief 全市场行情排行榜 (虚拟化)
+ *
+ * - 收到合约信息或行情的合约都进入榜单，行情按合约存一份 (slot 下标不变)
+ * - 排名由 RankedIndex 维护: 每笔行情只把该合约移到新名次，不做整体排序
+ * - 模型只暴露 [windowStart, windowStart + windowSize) 这一段名次，QML 滚动时改 windowStart
+ * - 行号即窗口内名次，名次变化不发 move 信号，每帧窗口内有变化时只发一次 dataChanged
+ */
+class QuoteBoardModel : public QAbstractListModel {
+    Q_OBJECT
+    Q_PROPERTY(int sortKey READ sortKey WRITE setSortKey NOTIFY sortChanged)
+    Q_PROPERTY(bool descending READ descending WRITE setDescending NOTIFY sortChanged)
+    Q_PROPERTY(QString exchangeFilter READ exchangeFilter WRITE setExchangeFilter NOTIFY exchangeFilterChanged)
+    Q_PROPERTY(int windowStart READ windowStart WRITE setWindowStart NOTIFY windowChanged)
+    Q_PROPERTY(int windowSize READ windowSize WRITE setWindowSize NOTIFY windowChanged)
+    Q_PROPERTY(int totalCount READ totalCount NOTIFY totalCountChanged)
+public:
+    enum SortKey {
+        SortNone = 0,        // 按合约到达顺序
+        SortChangePercent,
+        SortVolume,
+        SortOpenInterest,
+        SortTurnover
+    };
+    Q_ENUM(SortKey)
+
+    enum QuoteRoles {
+        IdRole = Qt::UserRole + 1,
+        NameRole,
+        ExchangeRole,
+        RankRole,           // 名次 (从 1 开始)
+        PriceRole,
+        ChangeRole,
+        ChangePercentRole,
+        VolumeRole,
+        OpenInterestRole,
+        TurnoverRole,
+        BidPrice1Role,
+        AskPrice1Role,
+        TimeRole
+    };
+
+    explicit QuoteBoardModel(QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QHash<int, QByteArray> roleNames() const override;
+
+    int sortKey() const { return _sortKey; }
+    void setSortKey(int key);
+    bool descending() const { return _rank.descending(); }
+    void setDescending(bool descending);
+    QString exchangeFilter() const { return _exchangeFilter; }
+    void setExchangeFilter(const QString& exchange);
+    int windowStart() const { return _windowStart; }
+    void setWindowStart(int start);
+    int windowSize() const { return _windowSize; }
+    void setWindowSize(int size);
+    int totalCount() const { return static_cast<int>(_rank.size()); }
+
+public slots:
+    // 一帧内合并后的二进制行情 (TickBatcher::ticksReady)
+    void updateTicksBinary(const std::vector<TickData>& ticks);
+    // 合约信息 (名称、交易所)，未见过的合约以空行情进榜
+    void updateInstrument(const QJsonObject& json);
+
+signals:
+    void sortChanged();
+    void exchangeFilterChanged();
+    void windowChanged();
+    void totalCountChanged();
+
+private:
+    struct Quote {
+        QString id;
+        QString name;
+        QString exchange;
+        double lastPrice = 0.0;
+        double change = 0.0;
+        double changePercent = 0.0;
+        double openInterest = 0.0;
+        double turnover = 0.0;
+        double bidPrice1 = 0.0;
+        double askPrice1 = 0.0;
+        int volume = 0;
+        char updateTime[16] = {0};
+    };
+
+    // 支持 string_view 直接查找，行情路径无需构造 QString/std::string
+    struct KeyHash {
+        using is_transparent = void;
+        size_t operator()(std::string_view s) const { return std::hash<std::string_view>{}(s); }
+    };
+
+    uint32_t slotFor(std::string_view id);
+    double keyOf(uint32_t slot) const;
+    bool passesFilter(uint32_t slot) const;
+    // 名次区间 [first, last] 是否与窗口重叠
+    bool touchesWindow(size_t first, size_t last) const;
+    void rebuild();
+    // 同步窗口行数并刷新窗口内容
+    void refreshWindow();
+
+    std::unordered_map<std::string, uint32_t, KeyHash, std::equal_to<>> _slotById;
+    std::vector<Quote> _quotes;     // 按 slot
+    RankedIndex _rank;
+
+    int _sortKey = SortChangePercent;
+    QString _exchangeFilter;        // 空表示全部交易所
+    int _windowStart = 0;
+    int _windowSize = 50;
+    int _rowCount = 0;              // 当前暴露的行数 (只在 begin/end 信号之间修改)
+};
+
+} // namespace QuantLabs
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace QuantLabs {
+
+/**
+ * @brief 按键值排序的 slot 序列 (行情排行榜)
+ *
+ * - 键值与 slot 分两列连续存放，顺序为 (键值, slot)，键值相同按 slot 升序，排名稳定
+ * - 单个 slot 键值变化: 二分找到新旧位置，只旋转两者之间的区间，不做整体排序
+ * - 纯 C++ 实现，不依赖 Qt；只在 GUI 线程使用，内部无锁
+ */
+class RankedIndex {
+public:
+    size_t size() const { return _slots.size(); }
+    uint32_t at(size_t pos) const { return _slots[pos]; }
+    bool contains(uint32_t slot) const { return slot < _listed.size() && _listed[slot]; }
+
+    void setDescending(bool descending) { _descending = descending; }
+    bool descending() const { return _descending; }
+
+    void clear() {
+        _keys.clear();
+        _slots.clear();
+        _listed.assign(_listed.size(), 0);
+    }
+
+    /**
+     * @brief 整体重建 (切换排序字段/方向/过滤条件时)
+     */
+    void assign(std::vector<std::pair<double, uint32_t>> entries) {
+        std::sort(entries.begin(), entries.end(), [this](const auto& a, const auto& b) {
+            return before(a.first, a.second, b.first, b.second);
+        });
+        clear();
+        _keys.reserve(entries.size());
+        _slots.reserve(entries.size());
+        for (const auto& [key, slot] : entries) {
+            _keys.push_back(key);
+            _slots.push_back(slot);
+            mark(slot, key);
+        }
+    }
+
+    // 返回插入位置
+    size_t insert(uint32_t slot, double key) {
+        const size_t pos = lowerBound(key, slot);
+        _keys.insert(_keys.begin() + pos, key);
+        _slots.insert(_slots.begin() + pos, slot);
+        mark(slot, key);
+        return pos;
+    }
+
+    // 返回删除前的位置
+    size_t erase(uint32_t slot) {
+        const size_t pos = lowerBound(_slotKey[slot], slot);
+        _keys.erase(_keys.begin() + pos);
+        _slots.erase(_slots.begin() + pos);
+        _listed[slot] = 0;
+        return pos;
+    }
+
+    /**
+     * @brief 更新 slot 的键值并移到新位置
+     * @return {原位置, 新位置}，两者之间 (含) 的排名都已变化
+     */
+    std::pair<size_t, size_t> update(uint32_t slot, double key) {
+        const double oldKey = _slotKey[slot];
+        const size_t pos = lowerBound(oldKey, slot);
+        if (key == oldKey) return {pos, pos};
+
+        // 在原序列上定位 (原位置处仍是旧键值，序列有序)，再扣掉自身占的一格
+        const size_t hint = lowerBound(key, slot);
+        size_t target = pos;
+        if (hint > pos + 1) {
+            target = hint - 1;
+            std::rotate(_keys.begin() + pos, _keys.begin() + pos + 1, _keys.begin() + hint);
+            std::rotate(_slots.begin() + pos, _slots.begin() + pos + 1, _slots.begin() + hint);
+        } else if (hint < pos) {
+            target = hint;
+            std::rotate(_keys.begin() + hint, _keys.begin() + pos, _keys.begin() + pos + 1);
+            std::rotate(_slots.begin() + hint, _slots.begin() + pos, _slots.begin() + pos + 1);
+        }
+        _keys[target] = key;
+        _slotKey[slot] = key;
+        return {pos, target};
+    }
+
+private:
+    bool before(double ka, uint32_t sa, double kb, uint32_t sb) const {
+        if (ka != kb) return _descending ? ka > kb : ka < kb;
+        return sa < sb;
+    }
+
+    size_t lowerBound(double key, uint32_t slot) const {
+        size_t lo = 0, hi = _keys.size();
+        while (lo < hi) {
+            const size_t mid = (lo + hi) / 2;
+            if (before(_keys[mid], _slots[mid], key, slot)) lo = mid + 1;
+            else hi = mid;
+        }
+        return lo;
+    }
+
+    void mark(uint32_t slot, double key) {
+        if (slot >= _listed.size()) {
+            _listed.resize(slot + 1, 0);
+            _slotKey.resize(slot + 1, 0.0);
+        }
+        _listed[slot] = 1;
+        _slotKey[slot] = key;
+    }
+
+    std::vector<double> _keys;      // 按排名
+    std::vector<uint32_t> _slots;   // 按排名
+    std::vector<double> _slotKey;   // slot -> 当前键值
+    std::vector<char> _listed;      // slot 是否在序列中
+    bool _descending = true;
+};
+
+} // namespace QuantLabs
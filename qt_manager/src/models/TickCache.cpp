@@ -0,0 +1,203 @@
+#include "models/TickCache.h"
+
+#include <QDebug>
+#include <algorithm>
+#include <cstring>
+
+namespace QuantLabs {
+
+namespace {
+
+constexpr char kMagic[8] = {'A', 'T', 'T', 'I', 'C', 'K', 'C', '1'};
+
+template <size_t N>
+void copyField(char (&dst)[N], const char* src, size_t len) {
+    const size_t n = std::min(N - 1, len);
+    std::memcpy(dst, src, n);
+    std::memset(dst + n, 0, N - n);
+}
+
+std::string_view fieldView(const char* s, size_t size) {
+    return std::string_view(s, strnlen(s, size));
+}
+
+} // namespace
+
+TickCache::TickCache(QObject *parent)
+    : QObject(parent) {
+}
+
+TickCache::~TickCache() {
+    close();
+}
+
+bool TickCache::open(const QString& path) {
+    close();
+    _file.setFileName(path);
+    if (!_file.open(QIODevice::ReadWrite)) {
+        qWarning() << "[TickCache] Cannot open" << path << _file.errorString();
+        return false;
+    }
+
+    // 校验已有文件: 魔数/版本/记录长度一致且长度足够才沿用
+    bool valid = false;
+    if (_file.size() >= static_cast<qint64>(sizeof(Header))) {
+        _base = _file.map(0, _file.size());
+        if (_base) {
+            const Header* h = reinterpret_cast<const Header*>(_base);
+            valid = std::memcmp(h->magic, kMagic, sizeof(kMagic)) == 0 &&
+                    h->version == kVersion && h->recordSize == sizeof(Record) &&
+                    h->count <= h->capacity &&
+                    _file.size() >= static_cast<qint64>(sizeof(Header) + static_cast<qint64>(h->capacity) * sizeof(Record));
+        }
+    }
+
+    if (valid) {
+        const Header* h = reinterpret_cast<const Header*>(_base);
+        const Record* r = records();
+        _index.reserve(h->count);
+        for (uint32_t i = 0; i < h->count; ++i) {
+            _index.emplace(std::string(fieldView(r[i].instrument_id, sizeof(r[i].instrument_id))), i);
+        }
+        qDebug() << "[TickCache] Loaded" << h->count << "instruments from" << path;
+        return true;
+    }
+
+    if (_file.size() > 0) qWarning() << "[TickCache] Incompatible cache file, rebuilding:" << path;
+    if (!mapFile(kInitialCapacity, true)) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void TickCache::close() {
+    if (_base) {
+        _file.unmap(_base);
+        _base = nullptr;
+    }
+    if (_file.isOpen()) _file.close();
+    _index.clear();
+}
+
+bool TickCache::mapFile(uint32_t capacity, bool reset) {
+    if (_base) {
+        _file.unmap(_base);
+        _base = nullptr;
+    }
+    const qint64 size = sizeof(Header) + static_cast<qint64>(capacity) * sizeof(Record);
+    if (!_file.resize(size) || !(_base = _file.map(0, size))) {
+        qWarning() << "[TickCache] Map failed:" << _file.errorString();
+        _index.clear();
+        return false;
+    }
+
+    Header* h = reinterpret_cast<Header*>(_base);
+    if (reset) {
+        std::memset(_base, 0, static_cast<size_t>(size));
+        std::memcpy(h->magic, kMagic, sizeof(kMagic));
+        h->version = kVersion;
+        h->recordSize = sizeof(Record);
+        h->count = 0;
+        _index.clear();
+    }
+    // 扩容时新增部分由 resize 补零
+    h->capacity = capacity;
+    return true;
+}
+
+TickCache::Record* TickCache::records() const {
+    return reinterpret_cast<Record*>(_base + sizeof(Header));
+}
+
+TickCache::Record* TickCache::recordFor(std::string_view instrumentId) {
+    if (!_base || instrumentId.empty()) return nullptr;
+
+    auto it = _index.find(instrumentId);
+    if (it != _index.end()) return &records()[it->second];
+
+    Header* h = reinterpret_cast<Header*>(_base);
+    if (h->count == h->capacity) {
+        if (!mapFile(h->capacity * 2, false)) return nullptr;
+        h = reinterpret_cast<Header*>(_base);
+    }
+
+    const uint32_t slot = h->count;
+    Record& r = records()[slot];
+    std::memset(&r, 0, sizeof(r));
+    copyField(r.instrument_id, instrumentId.data(), instrumentId.size());
+    _index.emplace(std::string(instrumentId), slot);
+    // 记录写好后再增加计数，中途退出不会留下半条记录
+    h->count = slot + 1;
+    return &r;
+}
+
+bool TickCache::lookup(std::string_view instrumentId, TickData& out) const {
+    auto it = _index.find(instrumentId);
+    if (it == _index.end()) return false;
+    const Record& r = records()[it->second];
+    if (!r.has_tick) return false;
+    out = r.tick;
+    return true;
+}
+
+bool TickCache::lookup(const QString& instrumentId, TickData& out) const {
+    const QByteArray id = instrumentId.toLatin1();
+    return lookup(std::string_view(id.constData(), id.size()), out);
+}
+
+std::vector<TickData> TickCache::ticks() const {
+    std::vector<TickData> out;
+    out.reserve(_index.size());
+    for (const auto& [id, slot] : _index) {
+        const Record& r = records()[slot];
+        if (r.has_tick) out.push_back(r.tick);
+    }
+    return out;
+}
+
+QList<QJsonObject> TickCache::instruments() const {
+    QList<QJsonObject> out;
+    for (const auto& [id, slot] : _index) {
+        const Record& r = records()[slot];
+        if (!r.has_meta) continue;
+        QJsonObject j;
+        j["instrument_id"] = QString::fromStdString(id);
+        j["instrument_name"] = QString::fromUtf8(r.instrument_name, static_cast<int>(strnlen(r.instrument_name, sizeof(r.instrument_name))));
+        j["exchange_id"] = QString::fromLatin1(r.exchange_id, static_cast<int>(strnlen(r.exchange_id, sizeof(r.exchange_id))));
+        if (r.price_tick > 0) j["price_tick"] = r.price_tick;
+        if (r.volume_multiple > 0) j["volume_multiple"] = r.volume_multiple;
+        out.append(j);
+    }
+    return out;
+}
+
+void TickCache::updateTicks(const std::vector<TickData>& ticks) {
+    for (const TickData& t : ticks) {
+        Record* r = recordFor(fieldView(t.instrument_id, sizeof(t.instrument_id)));
+        if (!r) continue;
+        r->tick = t;
+        r->has_tick = 1;
+    }
+}
+
+void TickCache::updateInstrument(const QJsonObject& j) {
+    const QByteArray id = j["instrument_id"].toString().toLatin1();
+    Record* r = recordFor(std::string_view(id.constData(), id.size()));
+    if (!r) return;
+
+    if (j.contains("instrument_name")) {
+        // 按字节截断可能切开多字节字符，预留的 64 字节对合约名足够
+        const QByteArray name = j["instrument_name"].toString().toUtf8();
+        copyField(r->instrument_name, name.constData(), name.size());
+    }
+    if (j.contains("exchange_id")) {
+        const QByteArray exchange = j["exchange_id"].toString().toLatin1();
+        copyField(r->exchange_id, exchange.constData(), exchange.size());
+    }
+    if (j.contains("price_tick")) r->price_tick = j["price_tick"].toDouble();
+    if (j.contains("volume_multiple")) r->volume_multiple = j["volume_multiple"].toInt();
+    r->has_meta = 1;
+}
+
+} // namespace QuantLabs
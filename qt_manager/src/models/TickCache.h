@@ -0,0 +1,92 @@
+#pragma once
+
+#include <QFile>
+#include <QJsonObject>
+#include <QList>
+#include <QObject>
+#include <QString>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "protocol/message_schema.h"
+
+namespace QuantLabs {
+
+/**
+ * @brief 客户端最新行情缓存 (内存映射文件，跨重启保留)
+ *
+ * 每个合约一条定长记录 (最新 TickData + 合约元数据)，直接写在映射内存上，
+ * 由操作系统负责落盘。启动时 open() 一次映射即可拿到上次退出前的全部最新值，
+ * 无需等待 SYNC_STATE 和新行情；之后由实时行情/合约信息覆盖。
+ *
+ * 文件头记录版本与记录长度，TickData 结构变化后旧文件自动重建。
+ * 只在 GUI 线程使用。
+ */
+class TickCache : public QObject {
+    Q_OBJECT
+public:
+    explicit TickCache(QObject *parent = nullptr);
+    ~TickCache();
+
+    /**
+     * @brief 映射缓存文件，不存在或格式不符时新建
+     */
+    bool open(const QString& path);
+    void close();
+
+    int size() const { return static_cast<int>(_index.size()); }
+
+    // 查最新行情，无缓存时返回 false
+    bool lookup(std::string_view instrumentId, TickData& out) const;
+    bool lookup(const QString& instrumentId, TickData& out) const;
+
+    // 启动回放: 所有缓存的行情 / 合约信息 (与 ZmqWorker::instrumentReceived 同格式)
+    std::vector<TickData> ticks() const;
+    QList<QJsonObject> instruments() const;
+
+public slots:
+    // 一帧合并后的行情 (TickBatcher::ticksReady)
+    void updateTicks(const std::vector<TickData>& ticks);
+    void updateInstrument(const QJsonObject& json);
+
+private:
+    static constexpr uint32_t kVersion = 1;
+    static constexpr uint32_t kInitialCapacity = 1024;
+
+    struct Header {
+        char magic[8];
+        uint32_t version;
+        uint32_t recordSize;    // sizeof(Record)，结构变化即失效
+        uint32_t capacity;
+        uint32_t count;
+    };
+
+    struct Record {
+        TickData tick;
+        char instrument_id[64];         // 与 tick.instrument_id 相同，tick 为空时用于索引
+        char instrument_name[64];       // UTF-8
+        char exchange_id[16];
+        double price_tick;
+        int32_t volume_multiple;
+        uint8_t has_tick;
+        uint8_t has_meta;
+    };
+
+    Record* records() const;
+    Record* recordFor(std::string_view instrumentId);
+    bool mapFile(uint32_t capacity, bool reset);
+
+    QFile _file;
+    uchar* _base = nullptr;
+
+    // 支持 string_view 直接查找
+    struct KeyHash {
+        using is_transparent = void;
+        size_t operator()(std::string_view s) const { return std::hash<std::string_view>{}(s); }
+    };
+    std::unordered_map<std::string, uint32_t, KeyHash, std::equal_to<>> _index; // 合约 -> 记录下标
+};
+
+} // namespace QuantLabs
@@ -4,7 +4,8 @@
 #include <QThread>
 #include <QVariantList>
 #include <QVariantMap>
-#include <map>
+#include <algorithm>
+#include <iterator>
 
 namespace QuantLabs {
 
@@ -16,9 +17,9 @@ int TradeModel::rowCount(const QModelIndex &parent) const {
 }
 
 QVariant TradeModel::data(const QModelIndex &index, int role) const {
-    if (!index.isValid() || index.row() >= _trades.size()) return QVariant();
+    if (!index.isValid() || index.row() >= static_cast<int>(_trades.size())) return QVariant();
 
-    const auto& item = _trades[index.row()];
+    const auto& item = _trades[_trades.size() - 1 - index.row()];
 
     switch (role) {
         case InstrumentIdRole: return item.instrument_id;
@@ -73,92 +74,78 @@ void TradeModel::onTradeReceived(const QJsonObject& j) {
         item.trade_date = j["trade_date"].toString();
         
         // 查重 (TradeID 唯一)
-        bool exists = false;
-        for(const auto& t : _trades) {
-            if (t.trade_id == item.trade_id && t.instrument_id == item.instrument_id) {
-                exists = true; break;
-            }
-        }
-        
-        if (!exists) {
-            std::lock_guard<std::mutex> lock(_mutex);
-            
-            // 保持按时间倒序排列 (最新的在前面)
-            // Comparator: 返回 true 如果 a 应该排在 b 前面 (即 a 比 b 新)
-            auto it = std::lower_bound(_trades.begin(), _trades.end(), item, [](const TradeItem& a, const TradeItem& b) {
-                int dateCmp = QString::compare(a.trade_date, b.trade_date);
-                if (dateCmp > 0) return true;
-                if (dateCmp < 0) return false;
-                
-                int timeCmp = QString::compare(a.trade_time, b.trade_time);
-                if (timeCmp > 0) return true;
-                if (timeCmp < 0) return false;
-                
-                // TradeID 降序
-                return QString::compare(a.trade_id, b.trade_id) > 0;
-            });
-            
-            int index = std::distance(_trades.begin(), it);
-            beginInsertRows(QModelIndex(), index, index);
-            _trades.insert(it, item);
-            endInsertRows();
-            
-            emit tradeSoundTriggered();
-            emit summaryChanged();
-        }
+        const QString key = item.instrument_id + '|' + item.trade_id;
+        if (_tradeKeys.contains(key)) return;
+
+        std::lock_guard<std::mutex> lock(_mutex);
+        _tradeKeys.insert(key);
+
+        // 保持按时间升序 (界面倒序即最新的在前面)。Core 的恢复/快照/重推都按升序发出，
+        // 逐条直接追加；只有迟到的单笔旧成交才需要从末尾向前找位置
+        auto it = _trades.end();
+        while (it != _trades.begin() && earlier(item, *(it - 1))) --it;
+
+        const int pos = static_cast<int>(std::distance(_trades.begin(), it));
+        const int row = static_cast<int>(_trades.size()) - pos;
+        beginInsertRows(QModelIndex(), row, row);
+        _trades.insert(it, item);
+        endInsertRows();
+
+        addToSummary(item);
+
+        emit tradeSoundTriggered();
+        emit summaryChanged();
 
     } catch (const std::exception& e) {
         qDebug() << "[TradeModel] Error:" << e.what();
     }
 }
 
+bool TradeModel::earlier(const TradeItem& a, const TradeItem& b) {
+    // 日期 -> 时间 -> TradeID
+    int dateCmp = QString::compare(a.trade_date, b.trade_date);
+    if (dateCmp != 0) return dateCmp < 0;
+    int timeCmp = QString::compare(a.trade_time, b.trade_time);
+    if (timeCmp != 0) return timeCmp < 0;
+    return QString::compare(a.trade_id, b.trade_id) < 0;
+}
+
+void TradeModel::addToSummary(const TradeItem& t) {
+    // 简化 offset: "1"/"3"/"4" 都归为平仓
+    QString offsetGroup = (t.offset_flag == "0") ? "0" : "1";
+    QString key = t.instrument_id + '|' + t.direction + '|' + offsetGroup;
+
+    auto it = _summaryIndex.constFind(key);
+    int idx;
+    if (it == _summaryIndex.constEnd()) {
+        idx = static_cast<int>(_summary.size());
+        SummaryGroup g;
+        g.instrumentId = t.instrument_id;
+        g.direction = t.direction;
+        g.offsetFlag = offsetGroup;
+        _summary.push_back(g);
+        _summaryIndex.insert(key, idx);
+    } else {
+        idx = it.value();
+    }
+
+    auto& g = _summary[idx];
+    g.totalAmount += t.price * t.volume;
+    g.totalVolume += t.volume;
+    g.totalCommission += t.commission;
+    g.totalCloseProfit += t.close_profit;
+}
+
 QVariantList TradeModel::getTradeSummary() const {
     std::lock_guard<std::mutex> lock(_mutex);
-    
-    // 分组键: instrument_id + direction + offset_flag
-    struct SummaryGroup {
-        double totalAmount = 0.0;  // sum(price * volume)，用于算均价
-        int totalVolume = 0;
-        double totalCommission = 0.0;
-        double totalCloseProfit = 0.0;
-    };
-    
-    // 用 tuple 作为 key：(instrument_id, direction, offset_flag)
-    // 但 std::map 需要 string key，所以拼接
-    std::map<QString, SummaryGroup> groups;
-    // 保持插入顺序，记录首次出现的 key
-    std::vector<QString> keyOrder;
-    // 额外记录每个 key 对应的 direction 和 offset_flag
-    std::map<QString, std::pair<QString, QString>> keyMeta;
-    
-    for (const auto& t : _trades) {
-        // 简化 offset: "1"/"3"/"4" 都归为平仓
-        QString offsetGroup = (t.offset_flag == "0") ? "0" : "1";
-        QString key = t.instrument_id + "|" + t.direction + "|" + offsetGroup;
-        
-        auto& g = groups[key];
-        if (g.totalVolume == 0) {
-            keyOrder.push_back(key);
-            keyMeta[key] = {t.direction, offsetGroup};
-        }
-        g.totalAmount += t.price * t.volume;
-        g.totalVolume += t.volume;
-        g.totalCommission += t.commission;
-        g.totalCloseProfit += t.close_profit;
-    }
-    
+
     QVariantList result;
-    for (const auto& key : keyOrder) {
-        const auto& g = groups[key];
-        const auto& meta = keyMeta[key];
-        
-        // 从 key 中提取 instrument_id
-        QString instrumentId = key.section('|', 0, 0);
-        
+    result.reserve(static_cast<int>(_summary.size()));
+    for (const auto& g : _summary) {
         QVariantMap row;
-        row["instrumentId"] = instrumentId;
-        row["direction"] = meta.first;
-        row["offsetFlag"] = meta.second;
+        row["instrumentId"] = g.instrumentId;
+        row["direction"] = g.direction;
+        row["offsetFlag"] = g.offsetFlag;
         row["avgPrice"] = (g.totalVolume > 0) ? (g.totalAmount / g.totalVolume) : 0.0;
         row["totalVolume"] = g.totalVolume;
         row["totalCommission"] = g.totalCommission;
@@ -2,6 +2,8 @@
 
 #include <QJsonObject>
 #include <QAbstractListModel>
+#include <QHash>
+#include <QSet>
 #include <vector>
 #include <mutex>
 
@@ -55,8 +57,27 @@ public slots:
     Q_INVOKABLE QVariantList getTradeSummary() const;
 
 private:
+    // 按成交时间升序存储 (最新的在末尾)，界面倒序显示: 第 row 行对应 _trades[size - 1 - row]
+    // 实时成交总是追加到末尾；迟到的旧成交从末尾向前找插入位置
     std::vector<TradeItem> _trades;
+    QSet<QString> _tradeKeys;   // "InstrumentID|TradeID" 去重
     mutable std::mutex _mutex;
+
+    // 合计按「合约+方向+开平」分组，随成交增量累加 (组按首次出现顺序)
+    struct SummaryGroup {
+        QString instrumentId;
+        QString direction;
+        QString offsetFlag;     // "0" 开仓 / "1" 平仓 (平今/平昨归为平仓)
+        double totalAmount = 0.0;  // sum(price * volume)，用于算均价
+        int totalVolume = 0;
+        double totalCommission = 0.0;
+        double totalCloseProfit = 0.0;
+    };
+    std::vector<SummaryGroup> _summary;
+    QHash<QString, int> _summaryIndex; // "InstrumentID|Direction|OffsetGroup" -> _summary 下标
+
+    static bool earlier(const TradeItem& a, const TradeItem& b);
+    void addToSummary(const TradeItem& t);
 };
 
 } // namespace QuantLabs
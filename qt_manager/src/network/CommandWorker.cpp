@@ -1,21 +1,50 @@
 #include "network/CommandWorker.h"
+#include "protocol/message_schema.h"
 #include "protocol/zmq_topics.h"
 #include <QDebug>
+#include <QJsonDocument>
+#include <QJsonObject>
 #include <QThread>
 #include <QTimer>
+#include <algorithm>
+#include <vector>
 
 namespace QuantLabs {
 
+namespace {
+
+constexpr int kOrderTimeoutMs = 3000;     // 下单/撤单应答
+constexpr int kQueryTimeoutMs = 10000;    // 查询/同步 (Core 可能在查库)
+constexpr int kPingTimeoutMs = 1500;
+constexpr size_t kMaxInFlight = 32;       // 同时在途的指令上限
+
+bool isOrderCommand(const std::string& type) {
+    return type == CmdType::Order || type == CmdType::OrderAction ||
+           type == CmdType::ConditionOrderInsert || type == CmdType::ConditionOrderCancel ||
+           type == CmdType::ConditionOrderModify;
+}
+
+// 重发不改变 Core 状态的指令
+bool isRetryable(const std::string& type) {
+    return type == CmdType::Subscribe || type == CmdType::Unsubscribe ||
+           type == CmdType::SyncState || type == CmdType::Snapshot ||
+           type == CmdType::ConditionOrderQuery || type == CmdType::StrategyQuery;
+}
+
+} // namespace
+
 CommandWorker::CommandWorker(QObject *parent)
     : QObject(parent),
       _context(1),
-      _requester(_context, zmq::socket_type::req) {
+      _dealer(_context, zmq::socket_type::dealer) {
 }
 
 CommandWorker::~CommandWorker() {
     _connected = false;
     if (_heartbeatTimer) delete _heartbeatTimer;
-    _requester.close();
+    if (_timeoutTimer) delete _timeoutTimer;
+    if (_notifier) delete _notifier;
+    _dealer.close();
     _context.close();
 }
 
@@ -23,16 +52,25 @@ void CommandWorker::connectToCore() {
     try {
         std::string addr = zmq_topics::Config::instance().getReqCmdAddr();
         qDebug() << "[CommandWorker] Connecting to:" << QString::fromStdString(addr);
-        
-        _requester.connect(addr);
-        
-        // 设置默认超时
-        _requester.set(zmq::sockopt::sndtimeo, 2000);
-        _requester.set(zmq::sockopt::rcvtimeo, 2000);
-        _requester.set(zmq::sockopt::linger, 0); // 立即丢弃未发送数据
-        
+
+        _dealer.set(zmq::sockopt::linger, 0); // 立即丢弃未发送数据
+        // 没有可用连接时 send 直接失败，指令留在本地队列里等重连，而不是积压在 ZMQ 内部
+        _dealer.set(zmq::sockopt::immediate, 1);
+        _dealer.connect(addr);
+
+        // ZMQ_FD 为边沿触发，唤醒后需排空到 ZMQ_EVENTS 不含 POLLIN
+        auto fd = _dealer.get(zmq::sockopt::fd);
+        _notifier = new QSocketNotifier(static_cast<qintptr>(fd), QSocketNotifier::Read, this);
+        connect(_notifier, &QSocketNotifier::activated, this, &CommandWorker::drainSocket);
+
+        if (!_timeoutTimer) {
+            _timeoutTimer = new QTimer(this);
+            connect(_timeoutTimer, &QTimer::timeout, this, &CommandWorker::checkTimeouts);
+            _timeoutTimer->start(200);
+        }
+
         _connected = true;
-        qDebug() << "[CommandWorker] REQ Connected";
+        qDebug() << "[CommandWorker] DEALER Connected";
     } catch (const zmq::error_t& e) {
         qCritical() << "[CommandWorker] Connect Error:" << e.what();
     }
@@ -48,151 +86,245 @@ void CommandWorker::startHeartbeat(int intervalMs) {
 }
 
 void CommandWorker::sendPing() {
-    // Ping 逻辑：发送 PING，设置短超时 (300ms)
-    // 如果失败，认为连接断开
-    try {
+    if (!_connected) {
+        connectToCore();
         if (!_connected) {
-            connectToCore();
-            if (!_connected) {
-                if (_lastCoreStatus) {
-                    emit coreStatusUpdated(false);
-                    _lastCoreStatus = false;
-                }
-                return;
-            }
-        }
-
-        // 设置短超时
-        _requester.set(zmq::sockopt::rcvtimeo, 500); 
-        _requester.set(zmq::sockopt::sndtimeo, 500);
-
-        std::string ping = "{\"type\":\"PING\"}";
-        zmq::message_t msg(ping.data(), ping.size());
-        
-        bool sent = false;
-        try {
-            auto res = _requester.send(msg, zmq::send_flags::none);
-            sent = res.has_value();
-        } catch (...) { sent = false; }
-
-        if (!sent) {
-            // 发送失败
-            if (_lastCoreStatus) {
-                qDebug() << "[CommandWorker] Ping Send Failed";
-                emit coreStatusUpdated(false);
-                _lastCoreStatus = false;
-            }
-            // 重建Socket清理状态
-            _requester.close();
-            _requester = zmq::socket_t(_context, zmq::socket_type::req);
-            _connected = false;
+            setCoreStatus(false);
             return;
         }
+    }
+    // 上一个 PING 还在等应答，由超时检查处理
+    if (_pingInFlight) return;
 
-        // 接收
-        zmq::message_t reply;
-        bool received = false;
-        try {
-            auto res = _requester.recv(reply, zmq::recv_flags::none);
-            received = res.has_value();
-        } catch (...) { received = false; }
-
-        if (received) {
-            if (!_lastCoreStatus) {
-                qDebug() << "[CommandWorker] Core Connected (Ping Success)";
-                emit coreStatusUpdated(true);
-                _lastCoreStatus = true;
-                
-                // 首次连上，发送 SYNC_STATE (或者通知 UI 端去请求)
-                // 这里我们暂不发送 SYNC，因为 UI 可能更知道何时发生
-                // 但是 ZMQWorker 以前是发 SYNC 的。
-                // 我们可以 emit 一个 connected 信号，main.cpp 里连到 sendCommand SYNC 
-            }
-        } else {
-            if (_lastCoreStatus) {
-                qDebug() << "[CommandWorker] Ping Timeout";
-                emit coreStatusUpdated(false);
-                _lastCoreStatus = false;
-            }
-            // Timeout -> Socket state bad -> Reconnect
-             _requester.close();
-             _requester = zmq::socket_t(_context, zmq::socket_type::req);
-             _connected = false;
-        }
-
-        // 恢复默认超时
-        _requester.set(zmq::sockopt::rcvtimeo, 2000);
-        _requester.set(zmq::sockopt::sndtimeo, 2000);
-
-    } catch (const std::exception& e) {
-        qWarning() << "[CommandWorker] Ping Exception:" << e.what();
-         // 重建
-         _requester.close();
-         _requester = zmq::socket_t(_context, zmq::socket_type::req);
-         _connected = false;
-         if (_lastCoreStatus) {
-             emit coreStatusUpdated(false);
-             _lastCoreStatus = false;
-         }
+    Command ping = makeCommand("{\"type\":\"PING\"}");
+    ping.id = _nextId++;
+    if (!sendFrames(ping)) {
+        // 没有可用连接 (Core 未启动或网络断开)，ZMQ 会自行重连
+        setCoreStatus(false);
+        return;
     }
+    _pending[std::to_string(ping.id)] = {ping, Clock::now() + std::chrono::milliseconds(ping.timeoutMs)};
+    _pingInFlight = true;
+    drainSocket();
 }
 
 void CommandWorker::sendCommand(const QString& json) {
     if (!_connected) {
         connectToCore();
-        if (!_connected) {
-            qWarning() << "[CommandWorker] Not connected, cannot send command:" << json;
-            return;
+    }
+    enqueue(makeCommand(json.toStdString()));
+    pump();
+}
+
+CommandWorker::Command CommandWorker::makeCommand(const std::string& payload) const {
+    Command cmd;
+    cmd.payload = payload;
+    QJsonDocument doc = QJsonDocument::fromJson(QByteArray::fromStdString(payload));
+    if (doc.isObject()) cmd.type = doc.object()["type"].toString().toStdString();
+
+    cmd.highPriority = isOrderCommand(cmd.type);
+    cmd.retryable = isRetryable(cmd.type);
+    if (cmd.type == CmdType::Ping) cmd.timeoutMs = kPingTimeoutMs;
+    else if (cmd.highPriority) cmd.timeoutMs = kOrderTimeoutMs;
+    else cmd.timeoutMs = kQueryTimeoutMs;
+    return cmd;
+}
+
+void CommandWorker::enqueue(Command cmd) {
+    // 请求号在入队时分配，重发沿用原请求号
+    if (cmd.id == 0) {
+        cmd.id = _nextId++;
+        cmd.queuedAt = Clock::now();
+    }
+    (cmd.highPriority ? _highQueue : _normalQueue).push_back(std::move(cmd));
+}
+
+void CommandWorker::pump() {
+    if (flushQueues()) {
+        // 发送会改变 socket 状态，FD 可能不再触发，主动检查一次
+        drainSocket();
+    }
+}
+
+bool CommandWorker::flushQueues() {
+    expireQueued();
+    if (!_connected) return false;
+
+    bool sent = false;
+    while (_pending.size() < kMaxInFlight && (!_highQueue.empty() || !_normalQueue.empty())) {
+        auto& queue = _highQueue.empty() ? _normalQueue : _highQueue;
+        Command& cmd = queue.front();
+        if (!sendFrames(cmd)) {
+            // 暂不可写 (未连接/高水位)，保留在队列中，由超时检查定时重试
+            break;
         }
+        const std::string reqId = std::to_string(cmd.id);
+        const auto deadline = Clock::now() + std::chrono::milliseconds(cmd.timeoutMs);
+        _pending[reqId] = {std::move(cmd), deadline};
+        queue.pop_front();
+        sent = true;
     }
+    return sent;
+}
+
+void CommandWorker::expireQueued() {
+    const auto cutoff = Clock::now() - std::chrono::milliseconds(kOrderTimeoutMs);
+    while (!_highQueue.empty() && _highQueue.front().queuedAt < cutoff) {
+        Command cmd = std::move(_highQueue.front());
+        _highQueue.pop_front();
+        qWarning() << "[CommandWorker] Core unreachable," << QString::fromStdString(cmd.type)
+                   << "request" << cmd.id << "expired in queue (not sent)";
 
-    // 确保超时设置正确 (2s)
-    _requester.set(zmq::sockopt::rcvtimeo, 2000);
-    _requester.set(zmq::sockopt::sndtimeo, 2000);
+        QJsonObject rep;
+        rep["status"] = "error";
+        rep["msg"] = QStringLiteral("Core unreachable, command not sent within %1 ms").arg(kOrderTimeoutMs);
+        rep["req_type"] = QString::fromStdString(cmd.type);
+        QJsonDocument req = QJsonDocument::fromJson(QByteArray::fromStdString(cmd.payload));
+        if (req.isObject()) rep["request"] = req.object();
+        emit commandReplyReceived(QString::fromUtf8(QJsonDocument(rep).toJson(QJsonDocument::Compact)));
+    }
+}
 
+bool CommandWorker::sendFrames(const Command& cmd) {
     try {
-        std::string payload = json.toStdString();
-        zmq::message_t msg(payload.data(), payload.size());
-        auto res = _requester.send(msg, zmq::send_flags::none);
-        
-        if (!res) {
-            qWarning() << "[CommandWorker] Send failed (EAGAIN/Timeout)";
-             _requester.close();
-             _requester = zmq::socket_t(_context, zmq::socket_type::req);
-             _connected = false;
-             connectToCore(); 
-             // Retry sending once
-             if (_connected) {
-                  zmq::message_t msgRetry(payload.data(), payload.size());
-                  _requester.send(msgRetry, zmq::send_flags::none);
-                  // Wait for reply below
-             } else {
-                 return;
-             }
+        const std::string reqId = std::to_string(cmd.id);
+        if (!_dealer.send(zmq::buffer(reqId), zmq::send_flags::sndmore | zmq::send_flags::dontwait)) {
+            return false;
         }
+        // 首帧已进入管道，其余帧必定可发
+        _dealer.send(zmq::message_t(), zmq::send_flags::sndmore);
+        _dealer.send(zmq::buffer(cmd.payload), zmq::send_flags::none);
+        return true;
+    } catch (const zmq::error_t& e) {
+        qWarning() << "[CommandWorker] Send error:" << e.what();
+        return false;
+    }
+}
+
+void CommandWorker::drainSocket() {
+    if (!_connected) return;
+    try {
+        for (;;) {
+            bool handled = false;
+            while (_dealer.get(zmq::sockopt::events) & ZMQ_POLLIN) {
+                // [reqId][空帧][json]，多帧整体到达
+                std::vector<zmq::message_t> frames;
+                do {
+                    frames.emplace_back();
+                    if (!_dealer.recv(frames.back(), zmq::recv_flags::dontwait)) return;
+                } while (frames.back().more());
+                handled = true;
 
-        zmq::message_t reply;
-        auto recvRes = _requester.recv(reply, zmq::recv_flags::none);
-        
-        if (recvRes) {
-            QString replyStr = QString::fromUtf8(static_cast<char*>(reply.data()), reply.size());
-            emit commandReplyReceived(replyStr);
+                if (frames.size() != 3 || frames[1].size() != 0) {
+                    qWarning() << "[CommandWorker] Malformed reply dropped (" << frames.size() << "frames)";
+                    continue;
+                }
+                handleReply(std::string(static_cast<char*>(frames[0].data()), frames[0].size()),
+                            std::string(static_cast<char*>(frames[2].data()), frames[2].size()));
+            }
+            // 应答腾出了在途名额: 继续发队列，发出后再检查一次可读
+            if (!handled || !flushQueues()) break;
+        }
+    } catch (const zmq::error_t& e) {
+        qWarning() << "[CommandWorker] ZMQ Error:" << e.what();
+    }
+}
+
+void CommandWorker::handleReply(const std::string& reqId, const std::string& body) {
+    // 任何应答都说明 Core 在线
+    setCoreStatus(true);
+
+    auto it = _pending.find(reqId);
+    if (it == _pending.end()) {
+        // 已判超时的迟到应答: 内容仍有效 (如快照)，照常分发
+        qDebug() << "[CommandWorker] Late reply for request" << QString::fromStdString(reqId);
+        emit commandReplyReceived(QString::fromStdString(body));
+        return;
+    }
+
+    const bool isPing = (it->second.cmd.type == CmdType::Ping);
+    _pending.erase(it);
+    if (isPing) {
+        _pingInFlight = false;
+    } else {
+        emit commandReplyReceived(QString::fromStdString(body));
+    }
+}
+
+void CommandWorker::checkTimeouts() {
+    const auto now = Clock::now();
+    bool pingTimedOut = false;
+
+    for (auto it = _pending.begin(); it != _pending.end();) {
+        if (now < it->second.deadline) { ++it; continue; }
+        const Command& cmd = it->second.cmd;
+        if (cmd.type == CmdType::Ping) {
+            pingTimedOut = true;
         } else {
-            qWarning() << "[CommandWorker] No reply received for command (Timeout)";
-            qWarning() << "[CommandWorker] Reconnecting due to timeout...";
-            _requester.close();
-            _requester = zmq::socket_t(_context, zmq::socket_type::req);
-            _connected = false;
-            connectToCore();
+            qWarning() << "[CommandWorker] No reply for" << QString::fromStdString(cmd.type)
+                       << "request" << cmd.id << "within" << cmd.timeoutMs << "ms";
+        }
+        it = _pending.erase(it);
+    }
+
+    if (pingTimedOut) {
+        _pingInFlight = false;
+        qDebug() << "[CommandWorker] Ping Timeout";
+        setCoreStatus(false);
+        resetSocket();
+        return;
+    }
+
+    // 心跳恢复之前因不可写而积压的指令
+    if (!_highQueue.empty() || !_normalQueue.empty()) pump();
+}
+
+void CommandWorker::resetSocket() {
+    // 在途指令: 幂等查询按原顺序放回队首重发，报单不重发 (Core 可能已执行)
+    std::vector<Command> retry;
+    for (auto& [reqId, inflight] : _pending) {
+        Command& cmd = inflight.cmd;
+        if (cmd.retryable) {
+            retry.push_back(std::move(cmd));
+        } else if (cmd.type != CmdType::Ping) {
+            qWarning() << "[CommandWorker] Connection reset, reply lost for" << QString::fromStdString(cmd.type)
+                       << "request" << cmd.id << "(not resent)";
         }
+    }
+    _pending.clear();
+    _pingInFlight = false;
 
+    std::sort(retry.begin(), retry.end(), [](const Command& a, const Command& b) { return a.id > b.id; });
+    for (auto& cmd : retry) {
+        (cmd.highPriority ? _highQueue : _normalQueue).push_front(std::move(cmd));
+    }
+
+    if (_notifier) {
+        _notifier->setEnabled(false);
+        delete _notifier;
+        _notifier = nullptr;
+    }
+    try {
+        _dealer.close();
+        _dealer = zmq::socket_t(_context, zmq::socket_type::dealer);
     } catch (const zmq::error_t& e) {
-        qCritical() << "[CommandWorker] ZMQ Exception:" << e.what();
-        _requester.close();
-        _requester = zmq::socket_t(_context, zmq::socket_type::req);
-        _connected = false;
-        connectToCore();
+        qWarning() << "[CommandWorker] Reset error:" << e.what();
+    }
+    _connected = false;
+
+    // 排队中的指令在重连并恢复可写后发出
+    connectToCore();
+}
+
+void CommandWorker::setCoreStatus(bool connected) {
+    if (_lastCoreStatus == connected) return;
+    _lastCoreStatus = connected;
+    if (connected) {
+        qDebug() << "[CommandWorker] Core Connected";
+    } else {
+        qWarning() << "[CommandWorker] Core Disconnected," << (_highQueue.size() + _normalQueue.size()) << "commands queued";
     }
+    emit coreStatusUpdated(connected);
 }
 
 } // namespace QuantLabs
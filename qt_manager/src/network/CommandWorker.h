@@ -1,15 +1,28 @@
 #pragma once
 
 #include <QObject>
+#include <QSocketNotifier>
 #include <QString>
 #include <QTimer>
 #include <zmq.hpp>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <unordered_map>
 
 namespace QuantLabs {
 
 /**
- * @brief 专门负责处理 REQ-REP 同步指令的 Worker
+ * @brief 指令通道 Worker (DEALER，对端为 Core 的 ROUTER)
  * 运行在独立线程中，避免阻塞行情/UI线程
+ *
+ * - 每条指令带请求号 ([reqId][空帧][json])，可同时有多条在途，应答按请求号对应，
+ *   慢查询不再挡住后面的下单
+ * - 下单/撤单/条件单操作走高优先级队列，先于查询发出
+ * - 每条指令独立超时；心跳超时视为 Core 断开并重建 socket，
+ *   尚未发出的查询保留到重连后发送，已发出的报单不重发 (避免重复下单)，
+ *   下单/撤单排队超过应答超时即作废并回失败应答 (行情已变，不能在恢复连接后才成交)
  */
 class CommandWorker : public QObject {
     Q_OBJECT
@@ -19,13 +32,13 @@ public:
 
 public slots:
     /**
-     * @brief 初始化并连接REQ套接字
+     * @brief 初始化并连接 DEALER 套接字
      */
     void connectToCore();
 
     /**
-     * @brief 向 Core 发送同步指令 (下单/订阅等)
-     * 该函数会阻塞等待响应，但因为在独立线程，不会卡死UI或行情
+     * @brief 向 Core 发送指令 (下单/订阅等)
+     * 只入队不阻塞，应答经 commandReplyReceived 异步返回
      */
     void sendCommand(const QString& json);
 
@@ -46,14 +59,55 @@ signals:
     void coreStatusUpdated(bool connected);
 
 private slots:
-    void sendPing(); 
+    void sendPing();
+    void drainSocket();
+    void checkTimeouts();
 
 private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Command {
+        uint64_t id = 0;
+        std::string type;
+        std::string payload;
+        int timeoutMs = 0;
+        bool highPriority = false;
+        bool retryable = false;     // 幂等查询，断线时可重发
+        Clock::time_point queuedAt; // 入队时间，高优先级指令排队超过应答超时即作废
+    };
+
+    struct InFlight {
+        Command cmd;
+        Clock::time_point deadline;
+    };
+
+    Command makeCommand(const std::string& payload) const;
+    void enqueue(Command cmd);
+    // 发出队列中的指令并检查应答
+    void pump();
+    // 按优先级发出队列中的指令，直到在途数达到上限或 socket 暂不可写；返回是否发出过
+    bool flushQueues();
+    // 丢弃排队过久的下单/撤单 (Core 不可达期间积压)，逐条回失败应答
+    void expireQueued();
+    bool sendFrames(const Command& cmd);
+    void handleReply(const std::string& reqId, const std::string& body);
+    // 重建 socket: 在途的幂等查询放回队首，报单记为超时
+    void resetSocket();
+    void setCoreStatus(bool connected);
+
     zmq::context_t _context;
-    zmq::socket_t _requester;
+    zmq::socket_t _dealer;
+    QSocketNotifier* _notifier = nullptr;
     bool _connected = false;
     QTimer* _heartbeatTimer = nullptr;
+    QTimer* _timeoutTimer = nullptr;
     bool _lastCoreStatus = false;
+
+    uint64_t _nextId = 1;
+    std::deque<Command> _highQueue;     // 下单/撤单
+    std::deque<Command> _normalQueue;   // 订阅/查询/同步
+    std::unordered_map<std::string, InFlight> _pending;  // reqId -> 在途指令
+    bool _pingInFlight = false;
 };
 
 } // namespace QuantLabs
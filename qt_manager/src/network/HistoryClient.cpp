@@ -0,0 +1,154 @@
+#include "network/HistoryClient.h"
+#include "protocol/message_schema.h"
+#include "protocol/zmq_topics.h"
+#include <QCoreApplication>
+#include <QDebug>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QRandomGenerator>
+
+namespace QuantLabs {
+
+namespace {
+
+constexpr int kStaleCheckMs = 5000;
+constexpr int kStaleTimeoutMs = 30000;   // 超过此时间没有新分块视为查询中断
+
+std::string makeClientId() {
+    // routing_id 不能以 0 字节开头；同机多开的客户端需互不相同
+    return QStringLiteral("qt-%1-%2")
+        .arg(QCoreApplication::applicationPid())
+        .arg(QRandomGenerator::global()->generate(), 8, 16, QLatin1Char('0'))
+        .toStdString();
+}
+
+} // namespace
+
+HistoryClient::HistoryClient(QObject *parent)
+    : QObject(parent),
+      _clientId(makeClientId()),
+      _context(1),
+      _dealer(_context, zmq::socket_type::dealer) {
+}
+
+HistoryClient::~HistoryClient() {
+    if (_staleTimer) delete _staleTimer;
+    if (_notifier) delete _notifier;
+    _dealer.close();
+    _context.close();
+}
+
+void HistoryClient::connectToCore() {
+    try {
+        std::string addr = zmq_topics::Config::instance().getHistoryAddr();
+        qDebug() << "[HistoryClient] Connecting to:" << QString::fromStdString(addr)
+                 << "as" << QString::fromStdString(_clientId);
+
+        _dealer.set(zmq::sockopt::routing_id, _clientId);
+        _dealer.set(zmq::sockopt::linger, 0);
+        _dealer.connect(addr);
+
+        // ZMQ_FD 为边沿触发，唤醒后需排空到 ZMQ_EVENTS 不含 POLLIN
+        auto fd = _dealer.get(zmq::sockopt::fd);
+        _notifier = new QSocketNotifier(static_cast<qintptr>(fd), QSocketNotifier::Read, this);
+        connect(_notifier, &QSocketNotifier::activated, this, &HistoryClient::drainSocket);
+
+        _staleTimer = new QTimer(this);
+        connect(_staleTimer, &QTimer::timeout, this, &HistoryClient::checkStale);
+        _staleTimer->start(kStaleCheckMs);
+        drainSocket();
+    } catch (const zmq::error_t& e) {
+        qCritical() << "[HistoryClient] Connect Error:" << e.what();
+    }
+}
+
+void HistoryClient::requestBars(const QString& instrumentId, int period, qint64 startMs, qint64 endMs, int limit) {
+    request(QStringLiteral("bar"), instrumentId, period, startMs, endMs, limit);
+}
+
+void HistoryClient::requestTicks(const QString& instrumentId, qint64 startMs, qint64 endMs, int limit) {
+    request(QStringLiteral("tick"), instrumentId, 0, startMs, endMs, limit);
+}
+
+void HistoryClient::request(const QString& kind, const QString& instrumentId, int period,
+                            qint64 startMs, qint64 endMs, int limit) {
+    QJsonObject data;
+    data["client_id"] = QString::fromStdString(_clientId);
+    data["instrument_id"] = instrumentId;
+    data["kind"] = kind;
+    data["period"] = period;
+    data["start_time"] = startMs;
+    data["end_time"] = endMs;
+    data["limit"] = limit;
+    QJsonObject req;
+    req["type"] = QString::fromStdString(CmdType::HistoryQuery);
+    req["data"] = data;
+    emit commandRequired(QString::fromUtf8(QJsonDocument(req).toJson(QJsonDocument::Compact)));
+}
+
+void HistoryClient::drainSocket() {
+    if (!_notifier) return;
+    try {
+        while (_dealer.get(zmq::sockopt::events) & ZMQ_POLLIN) {
+            // [头 json][数据]，多帧整体到达
+            zmq::message_t header;
+            zmq::message_t data;
+            if (!_dealer.recv(header, zmq::recv_flags::dontwait)) return;
+            if (!header.more() || !_dealer.recv(data, zmq::recv_flags::dontwait)) {
+                qWarning() << "[HistoryClient] Malformed chunk dropped";
+                continue;
+            }
+            if (data.more()) {
+                // 多余的帧丢掉，保持与下一条消息对齐
+                zmq::message_t extra;
+                while (_dealer.recv(extra, zmq::recv_flags::dontwait) && extra.more()) {}
+                qWarning() << "[HistoryClient] Malformed chunk dropped";
+                continue;
+            }
+            handleChunk(header, data);
+        }
+    } catch (const zmq::error_t& e) {
+        qWarning() << "[HistoryClient] ZMQ Error:" << e.what();
+    }
+}
+
+void HistoryClient::handleChunk(const zmq::message_t& header, const zmq::message_t& data) {
+    QJsonDocument doc = QJsonDocument::fromJson(
+        QByteArray::fromRawData(static_cast<const char*>(header.data()), static_cast<qsizetype>(header.size())));
+    QJsonObject h = doc.object();
+    if (h["type"].toString().toStdString() != CmdType::RtnHistory) return;
+
+    const quint64 queryId = static_cast<quint64>(h["query_id"].toInteger());
+    if (h.contains("error")) {
+        _pending.erase(queryId);
+        emit historyFailed(queryId, h["error"].toString());
+        return;
+    }
+
+    Pending& p = _pending[queryId];
+    if (p.records.isEmpty()) p.records.reserve(h["total"].toInteger() * h["record_size"].toInt());
+    p.records.append(static_cast<const char*>(data.data()), static_cast<qsizetype>(data.size()));
+    p.lastChunk = Clock::now();
+
+    if (!h["last"].toBool()) return;
+    QByteArray records = std::move(p.records);
+    _pending.erase(queryId);
+    emit historyReceived(queryId, h["instrument_id"].toString(), h["kind"].toString(),
+                         h["period"].toInt(), h["record_size"].toInt(), records);
+}
+
+void HistoryClient::checkStale() {
+    const auto now = Clock::now();
+    for (auto it = _pending.begin(); it != _pending.end();) {
+        if (now - it->second.lastChunk > std::chrono::milliseconds(kStaleTimeoutMs)) {
+            qWarning() << "[HistoryClient] Query" << it->first << "stalled, dropped";
+            quint64 queryId = it->first;
+            it = _pending.erase(it);
+            emit historyFailed(queryId, QStringLiteral("timeout"));
+        } else {
+            ++it;
+        }
+    }
+}
+
+} // namespace QuantLabs
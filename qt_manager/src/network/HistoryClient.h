@@ -0,0 +1,89 @@
+#pragma once
+
+#include <QByteArray>
+#include <QObject>
+#include <QSocketNotifier>
+#include <QString>
+#include <QTimer>
+#include <zmq.hpp>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+
+namespace QuantLabs {
+
+/**
+ * @brief 历史 Bar/Tick 查询客户端 (DEALER，对端为 Core 的 HistoryServer ROUTER)
+ * 运行在独立线程中，大查询的分块接收不占用 GUI 线程
+ *
+ * - 请求 (req_history_query) 经 commandRequired 交给 CommandWorker 发出，带上本 socket 的 routing_id
+ * - 结果按 query_id 分块推送到本 socket，收齐 (last) 后整体发出 historyReceived
+ * - Core 对不收数据的客户端会丢弃查询，长时间没有新分块的查询按失败处理
+ */
+class HistoryClient : public QObject {
+    Q_OBJECT
+public:
+    explicit HistoryClient(QObject *parent = nullptr);
+    ~HistoryClient();
+
+    /**
+     * @brief 请求 K 线 (可从任意线程调用，只发出 commandRequired)
+     * @param period Bar 周期 (秒)
+     * @param startMs/endMs UTC epoch 毫秒 (含)
+     */
+    Q_INVOKABLE void requestBars(const QString& instrumentId, int period, qint64 startMs, qint64 endMs, int limit = 100000);
+
+    /**
+     * @brief 请求 Tick (可从任意线程调用)
+     */
+    Q_INVOKABLE void requestTicks(const QString& instrumentId, qint64 startMs, qint64 endMs, int limit = 100000);
+
+public slots:
+    /**
+     * @brief 连接 HistoryServer 并把 socket 挂到本线程事件循环
+     */
+    void connectToCore();
+
+signals:
+    /**
+     * @brief 查询指令，需转给 CommandWorker::sendCommand
+     */
+    void commandRequired(const QString& json);
+
+    /**
+     * @brief 一次查询的全部记录 (kind=bar 为 BarData 数组，kind=tick 为 TickRecord 数组)
+     */
+    void historyReceived(quint64 queryId, const QString& instrumentId, const QString& kind,
+                         int period, int recordSize, const QByteArray& records);
+
+    /**
+     * @brief 查询失败 (Core 报错或分块中断)
+     */
+    void historyFailed(quint64 queryId, const QString& error);
+
+private slots:
+    void drainSocket();
+    void checkStale();
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    struct Pending {
+        QByteArray records;
+        Clock::time_point lastChunk;
+    };
+
+    void request(const QString& kind, const QString& instrumentId, int period,
+                 qint64 startMs, qint64 endMs, int limit);
+    void handleChunk(const zmq::message_t& header, const zmq::message_t& data);
+
+    const std::string _clientId;        // DEALER routing_id，构造后不变 (request 可跨线程读)
+    zmq::context_t _context;
+    zmq::socket_t _dealer;
+    QSocketNotifier* _notifier = nullptr;
+    QTimer* _staleTimer = nullptr;
+    std::unordered_map<quint64, Pending> _pending;  // query_id -> 已收到的分块
+};
+
+} // namespace QuantLabs
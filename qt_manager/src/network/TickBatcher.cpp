@@ -0,0 +1,55 @@
+#include "network/TickBatcher.h"
+#include <QDebug>
+#include <QGuiApplication>
+#include <QScreen>
+#include <algorithm>
+#include <cmath>
+
+namespace QuantLabs {
+
+TickBatcher::TickBatcher(QObject *parent)
+    : QObject(parent) {
+    _pending.reserve(256);
+    _batch.reserve(256);
+    _timer.setTimerType(Qt::PreciseTimer);
+    connect(&_timer, &QTimer::timeout, this, &TickBatcher::flush);
+}
+
+void TickBatcher::push(const TickData& tick, int64_t publishTime) {
+    std::string_view id(tick.instrument_id, strnlen(tick.instrument_id, sizeof(tick.instrument_id)));
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    if (_recordPublishTimes.load(std::memory_order_relaxed)) _pendingPublishTimes.push_back(publishTime);
+    auto it = _pendingIndex.find(id);
+    if (it != _pendingIndex.end()) {
+        _pending[it->second] = tick;
+    } else {
+        _pendingIndex.emplace(std::string(id), _pending.size());
+        _pending.push_back(tick);
+    }
+}
+
+void TickBatcher::start(int fps) {
+    if (fps <= 0) {
+        QScreen* screen = QGuiApplication::primaryScreen();
+        fps = screen ? static_cast<int>(std::lround(screen->refreshRate())) : 60;
+    }
+    fps = std::clamp(fps, 10, 240);
+    _timer.start(1000 / fps);
+    qDebug() << "[TickBatcher] Frame interval:" << (1000 / fps) << "ms";
+}
+
+void TickBatcher::flush() {
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_pending.empty()) return;
+        _batch.swap(_pending);
+        _pending.clear();
+        _pendingIndex.clear();
+        _batchPublishTimes.swap(_pendingPublishTimes);
+        _pendingPublishTimes.clear();
+    }
+    emit ticksReady(_batch);
+}
+
+} // namespace QuantLabs
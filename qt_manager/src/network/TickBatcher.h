@@ -0,0 +1,79 @@
+#pragma once
+
+#include <QObject>
+#include <QTimer>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include "protocol/message_schema.h"
+
+namespace QuantLabs {
+
+/**
+ * @brief 行情按显示帧合并
+ *
+ * ZmqWorker 线程每收到一笔行情只调用 push()，按合约覆盖为最新值；
+ * GUI 线程的帧定时器 (默认跟随屏幕刷新率) 每帧取走一次，通过 ticksReady 一次性交给各模型。
+ * 同一帧内同一合约的多笔行情只保留最后一笔，模型每帧最多刷新一次。
+ */
+class TickBatcher : public QObject {
+    Q_OBJECT
+public:
+    explicit TickBatcher(QObject *parent = nullptr);
+
+    /**
+     * @brief 写入一笔行情 (任意线程调用)
+     * @param publishTime 消息头中的发布时间 (UTC epoch 纳秒)，仅在开启记录时保存
+     */
+    void push(const TickData& tick, int64_t publishTime = 0);
+
+    /**
+     * @brief 记录每笔行情的发布时间 (基准测试用，默认关闭)
+     */
+    void setRecordPublishTimes(bool on) { _recordPublishTimes = on; }
+
+    /**
+     * @brief 本帧合并的所有行情 (含被覆盖的) 的发布时间，只在 ticksReady 槽函数内有效
+     */
+    const std::vector<int64_t>& publishTimes() const { return _batchPublishTimes; }
+
+    /**
+     * @brief 启动帧定时器 (GUI 线程调用)
+     * @param fps 每秒刷新次数，<= 0 时取主屏刷新率
+     */
+    void start(int fps = 0);
+
+signals:
+    /**
+     * @brief 每帧一次，ticks 中每个合约至多一笔 (直连，引用只在槽函数内有效)
+     */
+    void ticksReady(const std::vector<TickData>& ticks);
+
+private slots:
+    void flush();
+
+private:
+    // 支持 string_view 直接查找，push 时无需构造 std::string
+    struct KeyHash {
+        using is_transparent = void;
+        size_t operator()(std::string_view s) const { return std::hash<std::string_view>{}(s); }
+    };
+
+    std::mutex _mutex;
+    std::vector<TickData> _pending;                                                  // 本帧已收到的最新值
+    std::unordered_map<std::string, size_t, KeyHash, std::equal_to<>> _pendingIndex; // 合约 -> _pending 下标
+
+    std::vector<TickData> _batch; // GUI 线程持有，与 _pending 交换以复用容量
+
+    std::atomic<bool> _recordPublishTimes{false};
+    std::vector<int64_t> _pendingPublishTimes;
+    std::vector<int64_t> _batchPublishTimes;
+    QTimer _timer;
+};
+
+} // namespace QuantLabs
@@ -1,10 +1,18 @@
 #include "network/ZmqWorker.h"
 #include "protocol/zmq_topics.h"
 #include <QDebug>
-#include <QCoreApplication>
+#include <QMetaObject>
+#include <cstring>
 
 namespace QuantLabs {
 
+// 快照请求超时后重发
+static constexpr auto kSnapshotTimeout = std::chrono::seconds(5);
+// 等待快照期间缓存的增量上限，超过则丢弃并重新请求
+static constexpr size_t kMaxBufferedMessages = 100000;
+// 每次唤醒最多处理的消息数，超过后让出事件循环再继续
+static constexpr int kMaxBatch = 256;
+
 ZmqWorker::ZmqWorker(QObject *parent)
     : QObject(parent),
       _context(1),
@@ -15,10 +23,6 @@ ZmqWorker::~ZmqWorker() {
     stop();
 }
 
-// 引入 chrono
-#include <chrono>
-#include <string_view>
-
 void ZmqWorker::process() {
     try {
         // [1] 连接与订阅配置
@@ -31,127 +35,366 @@ void ZmqWorker::process() {
         // CTP 行情、持仓、账户、合约、报单、成交、策略状态
         _subscriber.set(zmq::sockopt::subscribe, zmq_topics::MARKET_DATA);
         _subscriber.set(zmq::sockopt::subscribe, zmq_topics::MARKET_DATA_BIN); // 二进制急速行情
-        _subscriber.set(zmq::sockopt::subscribe, zmq_topics::POSITION_DATA);
-        _subscriber.set(zmq::sockopt::subscribe, zmq_topics::ACCOUNT_DATA);
         _subscriber.set(zmq::sockopt::subscribe, zmq_topics::INSTRUMENT_DATA);
-        _subscriber.set(zmq::sockopt::subscribe, zmq_topics::ORDER_DATA);
-        _subscriber.set(zmq::sockopt::subscribe, zmq_topics::TRADE_DATA);
         _subscriber.set(zmq::sockopt::subscribe, QuantLabs::TOPIC_STRATEGY);
+
+        // 账户相关 topic 只订阅绑定的账户 ("PB|acc|")；未配置时等快照应答给出主账户再订阅，
+        // 不订阅裸 topic，否则多个账户会合并进单账户模型
+        _accountId = zmq_topics::Config::instance().getAccountId();
+        if (!_accountId.empty()) {
+            subscribeAccountTopics();
+        } else {
+            qDebug() << "[ZmqWorker] No account_id configured, binding to Core primary account via snapshot";
+        }
         
         _running = true;
         qDebug() << "[ZmqWorker] Connected and Subscribed to all topics";
 
-        // [2] 初始同步请求
-        // 延时 500ms 确保连接就绪，然后触发 CommandWorker 发送 SYNC_STATE 指令
-        QThread::msleep(500);
-        emit commandRequired("{\"type\":\"SYNC_STATE\"}");
-        
-        // 定义 Poll 监听项：监听 _subscriber 的 ZMQ_POLLIN (可读) 事件
-        zmq::pollitem_t items[] = {
-            { _subscriber, 0, ZMQ_POLLIN, 0 }
-        };
-        
-        // 时间戳记录 (用于超时检查)
-        auto lastCheckTime = std::chrono::steady_clock::now();
-        auto lastCtpActivity = std::chrono::steady_clock::now();
-        bool ctpStatus = false;
+        // [2] 接入本线程的 Qt 事件循环
+        // ZMQ_FD 只是"状态可能变化"的通知 (边沿触发)，可读与否以 ZMQ_EVENTS 为准，
+        // 所以每次唤醒都要读到 ZMQ_EVENTS 不含 POLLIN 为止
+        auto fd = _subscriber.get(zmq::sockopt::fd);
+        _notifier = new QSocketNotifier(static_cast<qintptr>(fd), QSocketNotifier::Read, this);
+        connect(_notifier, &QSocketNotifier::activated, this, &ZmqWorker::drainSocket);
 
-        int msgCount = 0;
-        
-        // [3] 接收主循环
-        while (_running) {
-            // zmq::poll 用于多路复用监听
-            // 参数 100ms 是超时时间：
-            // - 如果有数据：立即返回
-            // - 如果无数据：阻塞等待最多 100ms
-            zmq::poll(items, 1, std::chrono::milliseconds(100));
-
-            // [4] 自适应事件处理 (优化 CPU 占用)
-            if (items[0].revents & ZMQ_POLLIN) {
-                // 有数据（繁忙模式）：每 100 条消息才让出 CPU 处理一次 Qt 事件
-                // 这样可以最大化吞吐量
-                if (++msgCount >= 100) {
-                    QCoreApplication::processEvents();
-                    msgCount = 0;
-                }
-            } else {
-                // 无数据（空闲模式）：每次循环都处理 Qt 事件
-                // 确保对 stop() 等控制信号的实时响应
-                QCoreApplication::processEvents();
-            }          
-
-            // [5] 数据接收与处理
-            if (items[0].revents & ZMQ_POLLIN) {
-                zmq::message_t topic_msg;
-                zmq::message_t payload_msg;
-                
-                // 接收两帧：Topic 帧和 Payload 帧
-                // 使用非阻塞标志 zmq::recv_flags::none 是因为 poll 已经确认有数据了
-                (void)_subscriber.recv(topic_msg, zmq::recv_flags::none);
-                (void)_subscriber.recv(payload_msg, zmq::recv_flags::none);
-                
-                // 使用 string_view 进行零拷贝的 Topic 匹配
-                std::string_view topic(static_cast<char*>(topic_msg.data()), topic_msg.size());
-                
-                if (topic == zmq_topics::MARKET_DATA_BIN) {
-                     // 二进制行情处理 (高性能)
-                     if (payload_msg.size() == sizeof(TickData)) {
-                        const TickData* pData = static_cast<const TickData*>(payload_msg.data());
-                        emit tickReceivedBinary(*pData); // 触发信号
-                        lastCtpActivity = std::chrono::steady_clock::now(); // 更新最后活动时间
-                     }
-                } else {
-                    // JSON 数据处理
-                    // 使用 fromRawData 避免深拷贝，直接引用 ZMQ 缓冲区进行 JSON 解析
-                    QByteArray rawData = QByteArray::fromRawData(static_cast<char*>(payload_msg.data()), payload_msg.size());
-                    QJsonDocument doc = QJsonDocument::fromJson(rawData);
-                    
-                    if (doc.isObject()) {
-                        QJsonObject jsonObj = doc.object();
-
-                        // 根据 Topic 分发到不同的信号
-                        if (topic == zmq_topics::MARKET_DATA) {
-                            emit tickReceived(jsonObj);
-                            lastCtpActivity = std::chrono::steady_clock::now();
-                        } else if (topic == zmq_topics::POSITION_DATA) {
-                            emit positionReceived(jsonObj);
-                        } else if (topic == zmq_topics::ACCOUNT_DATA) {
-                            emit accountReceived(jsonObj);
-                            lastCtpActivity = std::chrono::steady_clock::now(); // 资金变动也算 CTP 活动
-                        } else if (topic == zmq_topics::INSTRUMENT_DATA) {
-                            emit instrumentReceived(jsonObj);
-                        } else if (topic == zmq_topics::ORDER_DATA) {
-                            emit orderReceived(jsonObj);
-                        } else if (topic == zmq_topics::TRADE_DATA) {
-                            emit tradeReceived(jsonObj);
-                        } else if (topic == QuantLabs::TOPIC_STRATEGY) {
-                            emit conditionOrderReceived(jsonObj);
-                        }
-                    } 
-                }
-            }
-            
-            // [6] 状态超时检查 (每 1 秒检查一次)
-            auto now = std::chrono::steady_clock::now();
-            if (now - lastCheckTime > std::chrono::seconds(1)) {
-                 // 判断逻辑：如果 5 秒内有收到 CTP 相关数据，认为 CTP 连接正常
-                 bool newCtpStatus = (now - lastCtpActivity < std::chrono::seconds(5));
-                 
-                 // 状态变更时发出通知
-                 if (newCtpStatus != ctpStatus) {
-                     ctpStatus = newCtpStatus;
-                     emit ctpStatusUpdated(ctpStatus);
-                 }
-                 lastCheckTime = now;
-            }
-        }
+        // [3] 状态超时检查 (每 1 秒)
+        _lastCtpActivity = std::chrono::steady_clock::now();
+        _statusTimer = new QTimer(this);
+        connect(_statusTimer, &QTimer::timeout, this, &ZmqWorker::checkStatus);
+        _statusTimer->start(1000);
+
+        // [4] 初始同步请求
+        // 延时 500ms 确保连接就绪，然后请求全量快照；
+        // 快照返回前收到的状态类增量先缓存，返回后按序号衔接
+        QTimer::singleShot(500, this, [this]() {
+            if (_running) requestSnapshot({});
+        });
+
+        // 通知器创建前可能已有消息到达 (边沿已错过)，先排空一次
+        drainSocket();
     } catch (const zmq::error_t& e) {
         qWarning() << "[ZmqWorker] ZMQ Error:" << e.what();
     }
 }
 
+void ZmqWorker::subscribeAccountTopics() {
+    for (const char* topic : { zmq_topics::POSITION_DATA_BIN, // 二进制持仓 (含盯市浮盈)
+                               zmq_topics::ACCOUNT_DATA, zmq_topics::ORDER_DATA, zmq_topics::TRADE_DATA }) {
+        _subscriber.set(zmq::sockopt::subscribe, zmq_topics::accountTopic(topic, _accountId));
+    }
+    qDebug() << "[ZmqWorker] Subscribed to account" << QString::fromStdString(_accountId);
+}
+
 void ZmqWorker::stop() {
+    if (!_running) return;
     _running = false;
+    if (_statusTimer) {
+        _statusTimer->stop();
+        delete _statusTimer;
+        _statusTimer = nullptr;
+    }
+    if (_notifier) {
+        _notifier->setEnabled(false);
+        delete _notifier;
+        _notifier = nullptr;
+    }
+    // 关闭 socket 后上下文可立即析构 (linger 为 0，不等待未发送数据)
+    try {
+        _subscriber.set(zmq::sockopt::linger, 0);
+        _subscriber.close();
+    } catch (const zmq::error_t& e) {
+        qWarning() << "[ZmqWorker] Close error:" << e.what();
+    }
+    qDebug() << "[ZmqWorker] Stopped";
+}
+
+void ZmqWorker::drainSocket() {
+    if (!_running) return;
+    try {
+        int handled = 0;
+        while (_subscriber.get(zmq::sockopt::events) & ZMQ_POLLIN) {
+            if (handled >= kMaxBatch) {
+                // 本批已满: 先让出事件循环 (跨线程信号、定时器)，随后继续排空。
+                // 此时 FD 不会再次触发，必须主动续上
+                QMetaObject::invokeMethod(this, &ZmqWorker::drainSocket, Qt::QueuedConnection);
+                return;
+            }
+            if (!receiveMessage()) break;
+            ++handled;
+        }
+    } catch (const zmq::error_t& e) {
+        qWarning() << "[ZmqWorker] ZMQ Error:" << e.what();
+    }
+}
+
+bool ZmqWorker::receiveMessage() {
+    zmq::message_t topic_msg;
+    zmq::message_t header_msg;
+    zmq::message_t payload_msg;
+    
+    // 接收三帧：Topic 帧、MessageHeader 帧和 Payload 帧
+    // 兼容旧版 Core 的两帧格式 (无 MessageHeader，seq 视为 0 不做校验)
+    // 多帧消息整体到达，首帧可读后其余帧可直接阻塞读取
+    if (!_subscriber.recv(topic_msg, zmq::recv_flags::dontwait)) return false;
+    if (!topic_msg.more()) return true;
+    (void)_subscriber.recv(header_msg, zmq::recv_flags::none);
+
+    uint64_t seq = 0;
+    int64_t publishTime = 0;
+    if (header_msg.more()) {
+        (void)_subscriber.recv(payload_msg, zmq::recv_flags::none);
+        if (header_msg.size() == sizeof(MessageHeader)) {
+            MessageHeader header;
+            std::memcpy(&header, header_msg.data(), sizeof(header));
+            seq = header.seq;
+            publishTime = header.publish_time;
+        }
+    } else {
+        payload_msg.swap(header_msg);
+    }
+    
+    // 使用 string_view 进行零拷贝的 Topic 匹配
+    // fullTopic 可能带账户后缀 ("PT|acc1")，分发按基础 topic，序号按完整 topic
+    std::string_view fullTopic(static_cast<char*>(topic_msg.data()), topic_msg.size());
+    std::string_view topic = baseTopic(fullTopic);
+    
+    if (topic == zmq_topics::MARKET_DATA_BIN) {
+         // 二进制行情处理 (高性能): 不逐笔发信号，写入帧合并缓冲，由 GUI 线程每帧取走
+         if (payload_msg.size() == sizeof(TickData)) {
+            const TickData* pData = static_cast<const TickData*>(payload_msg.data());
+            if (_tickBatcher) _tickBatcher->push(*pData, publishTime);
+            _lastCtpActivity = std::chrono::steady_clock::now(); // 更新最后活动时间
+         }
+    } else if (topic == zmq_topics::POSITION_DATA_BIN) {
+        if (payload_msg.size() == sizeof(PositionData)) {
+            QByteArray payload(static_cast<const char*>(payload_msg.data()), static_cast<int>(payload_msg.size()));
+            if (seq != 0) {
+                handleSyncMessage(fullTopic, seq, QJsonObject(), payload);
+            } else {
+                dispatchBinary(topic, payload);
+            }
+        }
+    } else {
+        // JSON 数据处理
+        // 使用 fromRawData 避免深拷贝，直接引用 ZMQ 缓冲区进行 JSON 解析
+        QByteArray rawData = QByteArray::fromRawData(static_cast<char*>(payload_msg.data()), payload_msg.size());
+        QJsonDocument doc = QJsonDocument::fromJson(rawData);
+        
+        if (doc.isObject()) {
+            QJsonObject jsonObj = doc.object();
+
+            if (topic == zmq_topics::MARKET_DATA || topic == zmq_topics::ACCOUNT_DATA) {
+                _lastCtpActivity = std::chrono::steady_clock::now(); // 资金变动也算 CTP 活动
+            }
+
+            // 状态类 topic 按序号衔接快照，其余直接分发
+            if (seq != 0 && isSyncTopic(topic)) {
+                handleSyncMessage(fullTopic, seq, jsonObj);
+            } else {
+                dispatch(topic, jsonObj);
+            }
+        } 
+    }
+    return true;
+}
+
+void ZmqWorker::checkStatus() {
+    auto now = std::chrono::steady_clock::now();
+
+    // 判断逻辑：如果 5 秒内有收到 CTP 相关数据，认为 CTP 连接正常
+    bool newCtpStatus = (now - _lastCtpActivity < std::chrono::seconds(5));
+
+    // 状态变更时发出通知
+    if (newCtpStatus != _ctpStatus) {
+        _ctpStatus = newCtpStatus;
+        emit ctpStatusUpdated(_ctpStatus);
+    }
+
+    // 快照应答超时 (Core 未就绪/指令丢失)，重新请求
+    if (!_pendingTopics.empty() && now - _snapshotRequestedAt > kSnapshotTimeout) {
+        qWarning() << "[ZmqWorker] Snapshot timeout, retrying";
+        requestSnapshot(_pendingTopics);
+    }
+}
+
+bool ZmqWorker::isSyncTopic(std::string_view topic) {
+    return topic == zmq_topics::POSITION_DATA_BIN || topic == zmq_topics::ACCOUNT_DATA ||
+           topic == zmq_topics::ORDER_DATA || topic == zmq_topics::TRADE_DATA ||
+           topic == zmq_topics::INSTRUMENT_DATA;
+}
+
+std::string_view ZmqWorker::baseTopic(std::string_view topic) {
+    return topic.substr(0, topic.find(zmq_topics::ACCOUNT_SEPARATOR));
+}
+
+void ZmqWorker::dispatch(std::string_view topic, const QJsonObject& jsonObj) {
+    // 根据 Topic 分发到不同的信号
+    if (topic == zmq_topics::MARKET_DATA) {
+        emit tickReceived(jsonObj);
+    } else if (topic == zmq_topics::ACCOUNT_DATA) {
+        emit accountReceived(jsonObj);
+    } else if (topic == zmq_topics::INSTRUMENT_DATA) {
+        emit instrumentReceived(jsonObj);
+    } else if (topic == zmq_topics::ORDER_DATA) {
+        emit orderReceived(jsonObj);
+    } else if (topic == zmq_topics::TRADE_DATA) {
+        emit tradeReceived(jsonObj);
+    } else if (topic == QuantLabs::TOPIC_STRATEGY) {
+        emit conditionOrderReceived(jsonObj);
+    }
+}
+
+void ZmqWorker::dispatchBinary(std::string_view topic, const QByteArray& payload) {
+    if (topic == zmq_topics::POSITION_DATA_BIN && payload.size() == sizeof(PositionData)) {
+        PositionData data;
+        std::memcpy(&data, payload.constData(), sizeof(data));
+        emit positionReceivedBinary(data);
+    }
+}
+
+void ZmqWorker::handleSyncMessage(std::string_view topic, uint64_t seq, const QJsonObject& jsonObj,
+                                  const QByteArray& binary) {
+    std::string key(topic);
+    std::string base(baseTopic(topic));
+
+    // 等待快照中: 先缓存，快照到达后丢弃已包含的部分再回放
+    if (_pendingTopics.count(base)) {
+        if (_buffered.size() >= kMaxBufferedMessages) {
+            qWarning() << "[ZmqWorker] Snapshot buffer overflow, re-requesting";
+            _buffered.clear();
+            requestSnapshot(_pendingTopics);
+        }
+        _buffered.push_back({key, seq, jsonObj, binary});
+        return;
+    }
+
+    // 序号不连续: 丢包 (HWM 溢出/慢订阅者) 或 Core 重启 (序号回到 1)，只重同步该 topic
+    uint64_t& last = _lastSeq[key];
+    if (seq != last + 1) {
+        qWarning() << "[ZmqWorker] Sequence gap on" << QString::fromStdString(key)
+                   << "expected" << (last + 1) << "got" << seq;
+        _buffered.push_back({key, seq, jsonObj, binary});
+        requestSnapshot({base});
+        return;
+    }
+
+    last = seq;
+    if (!binary.isEmpty()) dispatchBinary(base, binary);
+    else dispatch(base, jsonObj);
+}
+
+void ZmqWorker::requestSnapshot(const std::set<std::string>& topics) {
+    std::set<std::string> wanted = topics;
+    if (wanted.empty()) {
+        wanted = { zmq_topics::POSITION_DATA_BIN, zmq_topics::ACCOUNT_DATA, zmq_topics::ORDER_DATA,
+                   zmq_topics::TRADE_DATA, zmq_topics::INSTRUMENT_DATA };
+    }
+
+    QJsonArray arr;
+    for (const auto& t : wanted) {
+        _pendingTopics.insert(t);
+        arr.append(QString::fromStdString(t));
+    }
+    _snapshotRequestedAt = std::chrono::steady_clock::now();
+
+    QJsonObject data;
+    data["topics"] = arr;
+    if (!_accountId.empty()) data["account_id"] = QString::fromStdString(_accountId);
+    QJsonObject req;
+    req["type"] = QString::fromStdString(CmdType::Snapshot);
+    req["data"] = data;
+    emit commandRequired(QString::fromUtf8(QJsonDocument(req).toJson(QJsonDocument::Compact)));
+}
+
+void ZmqWorker::onCommandReply(const QString& reply) {
+    QJsonDocument doc = QJsonDocument::fromJson(reply.toUtf8());
+    if (!doc.isObject()) return;
+    QJsonObject snap = doc.object();
+    if (snap["type"].toString() != QString::fromStdString(CmdType::RtnSnapshot)) return;
+
+    // 未配置账户: 绑定 Core 返回的主账户。订阅生效前发布的增量会表现为序号缺口，由缺口重同步补齐
+    if (_accountId.empty()) {
+        _accountId = snap["account_id"].toString().toStdString();
+        if (_accountId.empty()) {
+            qWarning() << "[ZmqWorker] Snapshot without account_id, account topics not subscribed";
+        } else {
+            try {
+                subscribeAccountTopics();
+                // setsockopt 会处理掉挂起的事件，ZMQ_FD 的边沿可能已被消耗，同初始订阅一样先排空一次
+                // (此时 topic 仍在等待快照，收到的增量进缓存，下面按序号回放)
+                drainSocket();
+            } catch (const zmq::error_t& e) {
+                qWarning() << "[ZmqWorker] ZMQ Error:" << e.what();
+            }
+        }
+    }
+
+    QJsonObject seqs = snap["seq"].toObject();
+
+    // 快照中出现的字段即其覆盖的 topic
+    struct Section { const char* topic; const char* field; };
+    static const Section sections[] = {
+        { zmq_topics::INSTRUMENT_DATA, "instruments" }, // 合约先于持仓，保证乘数/名称可用
+        { zmq_topics::ACCOUNT_DATA, "accounts" },
+        { zmq_topics::POSITION_DATA_BIN, "positions" }, // 快照中为 JSON，增量为二进制
+        { zmq_topics::ORDER_DATA, "orders" },
+        { zmq_topics::TRADE_DATA, "trades" },
+    };
+
+    for (const auto& sec : sections) {
+        if (!snap.contains(sec.field)) continue;
+        std::string key(sec.topic);
+
+        // 该基础 topic 下各账户的快照序号 ("PB|acc1" -> n)
+        std::unordered_map<std::string, uint64_t> snapSeqs;
+        for (auto it = seqs.begin(); it != seqs.end(); ++it) {
+            std::string full = it.key().toStdString();
+            if (baseTopic(full) == key) snapSeqs[full] = static_cast<uint64_t>(it.value().toDouble());
+        }
+
+        // 迟到的旧快照 (已有更新的序号且未在等待) 直接忽略
+        if (!_pendingTopics.count(key)) {
+            bool stale = false;
+            for (const auto& [full, s] : snapSeqs) {
+                auto it = _lastSeq.find(full);
+                if (it != _lastSeq.end() && s < it->second) stale = true;
+            }
+            if (stale) continue;
+        }
+
+        QJsonValue v = snap[sec.field];
+        if (key == zmq_topics::POSITION_DATA_BIN) {
+            emit positionSnapshotReceived(v.toArray());
+        } else {
+            for (const auto& item : v.toArray()) {
+                if (item.isObject()) dispatch(sec.topic, item.toObject());
+            }
+        }
+
+        // 以快照序号重置该基础 topic 的全部账户 (快照中不存在的 topic 尚未发布过，序号归零)
+        for (auto it = _lastSeq.begin(); it != _lastSeq.end();) {
+            if (baseTopic(it->first) == key && !snapSeqs.count(it->first)) it = _lastSeq.erase(it);
+            else ++it;
+        }
+        for (const auto& [full, s] : snapSeqs) _lastSeq[full] = s;
+        _pendingTopics.erase(key);
+
+        // 回放快照之后的增量 (seq <= 快照序号的已包含在快照中)
+        std::vector<BufferedMessage> replay;
+        std::vector<BufferedMessage> others;
+        for (auto& m : _buffered) {
+            if (baseTopic(m.topic) != key) {
+                others.push_back(std::move(m));
+                continue;
+            }
+            auto it = snapSeqs.find(m.topic);
+            if (m.seq > (it != snapSeqs.end() ? it->second : 0)) replay.push_back(std::move(m));
+        }
+        _buffered.swap(others);
+        for (const auto& m : replay) handleSyncMessage(m.topic, m.seq, m.json, m.binary);
+    }
+
+    qDebug() << "[ZmqWorker] Snapshot applied, pending topics:" << _pendingTopics.size();
 }
 
 
@@ -1,29 +1,58 @@
 #pragma once
 
 #include <QJsonObject>
+#include <QJsonArray>
 #include <QJsonDocument>
 #include <QObject>
+#include <QSocketNotifier>
 #include <QThread>
+#include <QTimer>
 #include <QString>
 #include <zmq.hpp>
+#include <chrono>
+#include <set>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
 #include "protocol/message_schema.h"
+#include "network/TickBatcher.h"
 
 
 namespace QuantLabs {
 
+/**
+ * @brief SUB 行情/状态接收 (运行在独立线程的 Qt 事件循环中)
+ * socket 通过 ZMQ_FD + QSocketNotifier 接入事件循环，空闲时不占 CPU；
+ * 跨线程信号 (快照应答、stop) 与消息处理在同一事件循环中按序执行。
+ */
 class ZmqWorker : public QObject {
     Q_OBJECT
 public:
     explicit ZmqWorker(QObject *parent = nullptr);
     ~ZmqWorker();
 
+    /**
+     * @brief 二进制行情写入的帧合并缓冲 (须在 process 启动前设置)
+     */
+    void setTickBatcher(TickBatcher* batcher) { _tickBatcher = batcher; }
+
 public slots:
     /**
-     * @brief 启动工作循环，订阅行情
+     * @brief 连接并订阅，把 socket 挂到本线程事件循环后立即返回
      */
     void process();
+    /**
+     * @brief 停止接收并关闭 socket (须在本线程执行，跨线程用 BlockingQueuedConnection)
+     */
     void stop();
 
+    /**
+     * @brief 处理指令应答 (连接 CommandWorker::commandReplyReceived)
+     * 只关心 rtn_snapshot，其它应答忽略
+     */
+    void onCommandReply(const QString& reply);
+
 
 
 signals:
@@ -34,12 +63,16 @@ signals:
      * @brief 收到新的行情 JSON 时触发
      */
     void tickReceived(const QJsonObject& json);
-    void tickReceivedBinary(const TickData& data);
 
     /**
-     * @brief 收到持仓 JSON 时触发
+     * @brief 收到二进制持仓 (PB) 时触发，含 core 盯市后的浮动盈亏
      */
-    void positionReceived(const QJsonObject& json);
+    void positionReceivedBinary(const PositionData& data);
+
+    /**
+     * @brief 收到持仓快照 (整体替换)
+     */
+    void positionSnapshotReceived(const QJsonArray& positions);
 
     /**
      * @brief 收到账户资金 JSON 时触发
@@ -65,8 +98,47 @@ signals:
      */
     void commandRequired(const QString& json);
 
+private slots:
+    // socket 可能可读: 按批排空，单批上限后让出事件循环
+    void drainSocket();
+    void checkStatus();
+
 private:
+    // 非阻塞接收并处理一条消息，无消息返回 false
+    bool receiveMessage();
+    // 需要与快照对齐的状态类 topic (PB/AT/OT/TT/IT)
+    static bool isSyncTopic(std::string_view topic);
+    // 去掉账户后缀: "PT|acc1" -> "PT"
+    static std::string_view baseTopic(std::string_view topic);
+    void dispatch(std::string_view topic, const QJsonObject& json);
+    void dispatchBinary(std::string_view topic, const QByteArray& payload);
+    // topic 为完整 topic (含账户后缀)，序号按完整 topic 独立递增
+    // 二进制 topic (PB) 的 payload 放在 binary 中，json 为空
+    void handleSyncMessage(std::string_view topic, uint64_t seq, const QJsonObject& json,
+                           const QByteArray& binary = QByteArray());
+    void requestSnapshot(const std::set<std::string>& topics);
+    // 订阅绑定账户的 PB/AT/OT/TT
+    void subscribeAccountTopics();
+
+    struct BufferedMessage {
+        std::string topic;   // 完整 topic
+        uint64_t seq;
+        QJsonObject json;
+        QByteArray binary;   // 二进制 topic 的 payload (深拷贝)
+    };
+
+    std::unordered_map<std::string, uint64_t> _lastSeq;   // 各完整 topic 已应用的最新序号
+    std::set<std::string> _pendingTopics;                  // 等待快照的基础 topic
+    std::vector<BufferedMessage> _buffered;                // 快照返回前收到的增量
+    std::chrono::steady_clock::time_point _snapshotRequestedAt;
+    std::string _accountId;                                // 绑定的账户 (配置或快照给出的主账户)
+
     bool _running = false;
+    TickBatcher* _tickBatcher = nullptr;
+    QSocketNotifier* _notifier = nullptr;
+    QTimer* _statusTimer = nullptr;
+    std::chrono::steady_clock::time_point _lastCtpActivity;
+    bool _ctpStatus = false;
     zmq::context_t _context;
     zmq::socket_t _subscriber;
 };
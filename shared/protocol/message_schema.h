@@ -61,6 +61,37 @@ struct TickData {
     int update_millisec;         // 更新毫秒
 };
 
+/**
+ * @brief PUB 消息头 (每条消息的第二帧: [topic][MessageHeader][payload])
+ * seq 按 topic 独立单调递增 (从 1 开始)，客户端据此检测丢包并与快照对齐
+ */
+struct MessageHeader {
+    uint64_t seq;                // 该 topic 的序号
+    int64_t publish_time;        // 发布时间 (UTC epoch 纳秒)
+};
+
+/**
+ * @brief K线数据结构 (Bar Data)
+ * Core 端由 Tick 实时合成，固定长度二进制直接传输/落盘
+ */
+struct BarData {
+    int64_t bar_time;            // Bar 开始时间 (UTC epoch 毫秒)
+    double open_price;
+    double high_price;
+    double low_price;
+    double close_price;
+    double turnover;             // 本 Bar 成交额 (增量)
+    double open_interest;        // Bar 结束时持仓量
+    int64_t volume;              // 本 Bar 成交量 (增量)
+    int32_t period;              // 周期 (秒): 1 / 60 / 300
+    int32_t tick_count;          // 本 Bar 包含的 Tick 数
+    char instrument_id[32];      // 合约代码
+    char trading_day[12];        // 交易日 (YYYYMMDD)
+    char action_day[12];         // 自然日 (YYYYMMDD, 已修正夜盘)
+    uint8_t status;              // 0: 更新中, 1: 已完成
+    char reserved[7];
+};
+
 // 持仓数据 (推送给前端的扁平化结构，每个方向一条)
 struct PositionData {
     char instrument_id[64];
@@ -188,11 +219,26 @@ enum class CompareType : int {
     LessOrEqual = 3         // <=
 };
 
+// 条件类型
+enum class ConditionType : int {
+    Price = 0,              // 价格 (price_source) 与 trigger_price 比较
+    TrailingStop = 1,       // 跟踪止损: 卖出跟踪最高价、买入跟踪最低价，回撤 trail_distance 触发
+    Spread = 2              // 价差: 本合约价格 - leg2 价格 与 trigger_price 比较
+};
+
+// 触发价格来源
+enum class PriceSource : int {
+    Last = 0,               // 最新价
+    Bid = 1,                // 买一
+    Ask = 2,                // 卖一
+    Mid = 3                 // (买一 + 卖一) / 2
+};
+
 // 条件单结构
 struct ConditionOrderRequest {
     // 触发条件
     char instrument_id[64];
-    double trigger_price;
+    double trigger_price;   // 跟踪止损为当前止损价 (随极值移动)
     CompareType compare_type; 
 
     // 报单参数
@@ -208,6 +254,19 @@ struct ConditionOrderRequest {
     // 状态
     int status;             // 0: Pending, 1: Triggered, 2: Cancelled
     uint64_t request_id;    // 唯一ID
+
+    // 扩展条件
+    ConditionType condition_type;
+    PriceSource price_source;
+    double trail_distance;      // 跟踪止损回撤距离 (价格单位)
+    double extreme_price;       // 跟踪止损已记录的最高/最低价 (0 表示尚未开始跟踪)
+    char leg2_instrument_id[64];// 价差条件的第二腿
+    uint64_t oco_group;         // 非 0 时同组条件单任一触发即撤销其余
+    int start_time;             // 生效时段 HHMMSS (交易所时间)，start_time == end_time 表示不限
+    int end_time;               // start_time > end_time 表示跨午夜 (夜盘)
+
+    // 默认构造: 全零初始化 (价格条件/最新价/不限时段)
+    ConditionOrderRequest() { std::memset(this, 0, sizeof(ConditionOrderRequest)); }
 };
 
 namespace CmdType {
@@ -223,6 +282,9 @@ namespace CmdType {
     const std::string OrderAction = "ORDER_ACTION"; // Added
     const std::string ConditionOrderQuery = "req_condition_order_query"; // Added
     const std::string StrategyQuery = "req_strategy_query"; // Added
+    const std::string HistoryQuery = "req_history_query"; // 历史 Bar/Tick 查询 (结果走 history_port)
+    const std::string Snapshot = "req_snapshot"; // 一致性快照 (带各 topic 序号)
+    const std::string StrategyControl = "req_strategy_control"; // 进程内策略 Start/Stop/UpdateParams/Reload
 
     // Returns / Pushes
     const std::string RtnOrder = "rtn_order";
@@ -232,6 +294,9 @@ namespace CmdType {
     const std::string RtnInstrument = "rtn_instrument"; // sync
     const std::string RtnConditionOrder = "rtn_condition_order"; // Added
     const std::string RtnStrategyList = "rtn_strategy_list"; // Added
+    const std::string RtnHistory = "rtn_history"; // 历史查询分块
+    const std::string RtnSnapshot = "rtn_snapshot"; // 快照应答
+    const std::string RtnStrategyStatus = "rtn_strategy_status"; // 进程内策略运行状态
 }
 
 } // namespace QuantLabs
@@ -0,0 +1,259 @@
+#pragma once
+
+/**
+ * @brief 共享内存行情总线 (同机策略进程使用)
+ *
+ * Core 的行情线程是唯一写者，任意多个本机进程只读映射同一块共享内存:
+ *   - Tick 环形队列 (SPMC): 每个槽带 seqlock 版本号，读者按序号顺序消费，被覆盖则跳过并计数
+ *   - 最新值表 (Last Value): 每个合约一条，seqlock 保护，随时读取最新快照
+ * 读路径无系统调用、无锁；跨机/GUI 仍走 ZMQ。
+ *
+ * 内存布局: [ShmBusHeader][ShmTickSlot x ring_capacity][ShmLastValueEntry x table_capacity]
+ * Linux 下位于 /dev/shm/<name>；仅支持 POSIX 平台。
+ */
+
+#include "protocol/message_schema.h"
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace QuantLabs {
+namespace shm {
+
+static constexpr const char* kBusMagic = "ATSHMMD";
+static constexpr uint32_t kBusVersion = 1;
+static constexpr const char* kDefaultBusName = "/atrader_md";
+
+struct alignas(64) ShmBusHeader {
+    char magic[8];                      // "ATSHMMD"
+    uint32_t version;                   // 布局版本
+    uint32_t record_size;               // sizeof(TickData)，读写双方校验
+    uint32_t ring_capacity;             // 环形队列槽数 (2 的幂)
+    uint32_t table_capacity;            // 最新值表容量 (合约数上限)
+    uint64_t ring_offset;               // 环形队列相对映射起点的偏移
+    uint64_t table_offset;              // 最新值表偏移
+    uint64_t total_size;                // 映射总长度
+    int64_t session_id;                 // 创建时间 (UTC 纳秒)，Core 重启后变化
+    int32_t writer_pid;
+
+    alignas(64) std::atomic<uint64_t> write_seq;   // 已写入的 Tick 总数 (下一条的序号)
+    alignas(64) std::atomic<uint32_t> table_count; // 已登记的合约数
+};
+
+// 环形队列槽: version = 2n+1 写入中, 2n+2 序号 n 写入完成
+struct alignas(64) ShmTickSlot {
+    std::atomic<uint64_t> version;
+    TickData tick;
+};
+
+// 最新值表条目: instrument_id 在登记后不再改变，version 奇数表示写入中
+struct alignas(64) ShmLastValueEntry {
+    std::atomic<uint64_t> version;
+    char instrument_id[32];
+    TickData tick;
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "shm bus requires lock-free 64-bit atomics");
+
+inline size_t busSize(uint32_t ring_capacity, uint32_t table_capacity) {
+    return sizeof(ShmBusHeader) + sizeof(ShmTickSlot) * ring_capacity +
+           sizeof(ShmLastValueEntry) * table_capacity;
+}
+
+/**
+ * @brief 只读访问端 (header-only，供策略进程直接包含)
+ *
+ * 用法:
+ *   shm::ShmMarketReader reader;
+ *   if (reader.open()) {
+ *       TickData t;
+ *       while (running) {
+ *           if (reader.poll(t) == shm::ShmMarketReader::Result::Ok) onTick(t);
+ *       }
+ *   }
+ * 单个 Reader 对象不可跨线程共享 (读游标非原子)；多线程各自 open 一个即可。
+ */
+class ShmMarketReader {
+public:
+    enum class Result {
+        Ok,       // 读到一条
+        Empty,    // 暂无新数据
+        Overrun   // 读得太慢被写者覆盖，已跳到可读的最早位置 (见 dropped())
+    };
+
+    ShmMarketReader() = default;
+    ~ShmMarketReader() { close(); }
+    ShmMarketReader(const ShmMarketReader&) = delete;
+    ShmMarketReader& operator=(const ShmMarketReader&) = delete;
+
+    /**
+     * @brief 映射总线，游标置于最新位置 (只消费 open 之后的 Tick)
+     * @return 总线不存在或格式不兼容时返回 false
+     */
+    bool open(const std::string& name = kDefaultBusName) {
+        close();
+#ifndef _WIN32
+        int fd = ::shm_open(name.c_str(), O_RDONLY, 0);
+        if (fd < 0) return false;
+
+        struct stat st;
+        if (::fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < sizeof(ShmBusHeader)) {
+            ::close(fd);
+            return false;
+        }
+        void* p = ::mmap(nullptr, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (p == MAP_FAILED) return false;
+
+        base_ = static_cast<const char*>(p);
+        size_ = static_cast<size_t>(st.st_size);
+        header_ = reinterpret_cast<const ShmBusHeader*>(base_);
+
+        if (std::strncmp(header_->magic, kBusMagic, sizeof(header_->magic)) != 0 ||
+            header_->version != kBusVersion || header_->record_size != sizeof(TickData) ||
+            header_->total_size > size_ || header_->ring_capacity == 0 ||
+            (header_->ring_capacity & (header_->ring_capacity - 1)) != 0) {
+            close();
+            return false;
+        }
+
+        slots_ = reinterpret_cast<const ShmTickSlot*>(base_ + header_->ring_offset);
+        table_ = reinterpret_cast<const ShmLastValueEntry*>(base_ + header_->table_offset);
+        mask_ = header_->ring_capacity - 1;
+        session_id_ = header_->session_id;
+        seekToLatest();
+        return true;
+#else
+        (void)name;
+        return false;
+#endif
+    }
+
+    void close() {
+#ifndef _WIN32
+        if (base_) ::munmap(const_cast<char*>(base_), size_);
+#endif
+        base_ = nullptr;
+        header_ = nullptr;
+        slots_ = nullptr;
+        table_ = nullptr;
+        size_ = 0;
+    }
+
+    bool isOpen() const { return header_ != nullptr; }
+
+    // Core 重启会重建共享内存，旧映射不再更新；调用方检测到后应重新 open
+    int64_t sessionId() const { return session_id_; }
+
+    void seekToLatest() {
+        if (header_) next_seq_ = header_->write_seq.load(std::memory_order_acquire);
+    }
+
+    // 从环中仍保留的最早一条开始消费
+    void seekToOldest() {
+        if (!header_) return;
+        uint64_t w = header_->write_seq.load(std::memory_order_acquire);
+        next_seq_ = (w > header_->ring_capacity) ? w - header_->ring_capacity : 0;
+    }
+
+    /**
+     * @brief 顺序读取下一条 Tick
+     */
+    Result poll(TickData& out) {
+        if (!header_) return Result::Empty;
+
+        uint64_t w = header_->write_seq.load(std::memory_order_acquire);
+        if (next_seq_ >= w) return Result::Empty;
+
+        Result result = Result::Ok;
+        if (w - next_seq_ > header_->ring_capacity) {
+            uint64_t oldest = w - header_->ring_capacity;
+            dropped_ += oldest - next_seq_;
+            next_seq_ = oldest;
+            result = Result::Overrun;
+        }
+
+        const ShmTickSlot& slot = slots_[next_seq_ & mask_];
+        const uint64_t expect = 2 * next_seq_ + 2;
+
+        uint64_t v1 = slot.version.load(std::memory_order_acquire);
+        if (v1 == expect) {
+            std::memcpy(&out, &slot.tick, sizeof(TickData));
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (slot.version.load(std::memory_order_relaxed) == v1) {
+                ++next_seq_;
+                return result;
+            }
+        }
+
+        // 读取期间被覆盖 (写者领先一整圈)，跳过该条
+        ++dropped_;
+        ++next_seq_;
+        return Result::Overrun;
+    }
+
+    /**
+     * @brief 查找合约在最新值表中的下标 (线性扫描，调用方应缓存结果)
+     * @return 未登记返回 -1
+     */
+    int findInstrument(const char* instrument_id) const {
+        if (!header_) return -1;
+        uint32_t n = header_->table_count.load(std::memory_order_acquire);
+        for (uint32_t i = 0; i < n; ++i) {
+            if (std::strncmp(table_[i].instrument_id, instrument_id, sizeof(table_[i].instrument_id)) == 0) {
+                return static_cast<int>(i);
+            }
+        }
+        return -1;
+    }
+
+    /**
+     * @brief 读取某合约的最新 Tick
+     * @return 下标无效或尚无数据时返回 false
+     */
+    bool readLast(int index, TickData& out) const {
+        if (!header_ || index < 0 ||
+            static_cast<uint32_t>(index) >= header_->table_count.load(std::memory_order_acquire)) {
+            return false;
+        }
+        const ShmLastValueEntry& e = table_[index];
+        for (int attempt = 0; attempt < 64; ++attempt) {
+            uint64_t v1 = e.version.load(std::memory_order_acquire);
+            if (v1 & 1) continue; // 写入中
+            if (v1 == 0) return false;
+            std::memcpy(&out, &e.tick, sizeof(TickData));
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (e.version.load(std::memory_order_relaxed) == v1) return true;
+        }
+        return false;
+    }
+
+    bool readLast(const char* instrument_id, TickData& out) const {
+        return readLast(findInstrument(instrument_id), out);
+    }
+
+    uint64_t dropped() const { return dropped_; }
+    uint64_t position() const { return next_seq_; }
+
+private:
+    const char* base_ = nullptr;
+    size_t size_ = 0;
+    const ShmBusHeader* header_ = nullptr;
+    const ShmTickSlot* slots_ = nullptr;
+    const ShmLastValueEntry* table_ = nullptr;
+    uint64_t mask_ = 0;
+    uint64_t next_seq_ = 0;
+    uint64_t dropped_ = 0;
+    int64_t session_id_ = 0;
+};
+
+} // namespace shm
+} // namespace QuantLabs
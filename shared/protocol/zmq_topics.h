@@ -12,13 +12,27 @@ namespace zmq_topics {
 // 行情广播 (PUB/SUB)
 static constexpr const char* MARKET_DATA = "MD";
 static constexpr const char* MARKET_DATA_BIN = "MB"; // Market Binary
+static constexpr const char* BAR_DATA_BIN = "BB"; // Bar Binary (struct BarData)
 static constexpr const char* POSITION_DATA = "PT"; // Position Tick
+static constexpr const char* POSITION_DATA_BIN = "PB"; // Position Binary (struct PositionData, 含 core 盯市浮盈)
 static constexpr const char* ACCOUNT_DATA = "AT"; // Account Tick
 static constexpr const char* INSTRUMENT_DATA = "IT"; // Instrument Tick
 static constexpr const char* ORDER_DATA = "OT"; // Order Update
 static constexpr const char* TRADE_DATA = "TT"; // Trade Update
 static constexpr const char* COMMAND     = "CM"; // Command
 
+// 账户相关 topic (PT/PB/AT/OT/TT) 发布为 "<topic>|<account_id>|"，
+// 订阅 "PT" 收全部账户，订阅 "PT|acc1|" 只收单个账户 (末尾分隔符避免前缀匹配到 "PT|acc10|")
+static constexpr char ACCOUNT_SEPARATOR = '|';
+
+inline std::string accountTopic(const char* topic, const std::string& account_id) {
+    std::string full(topic);
+    full += ACCOUNT_SEPARATOR;
+    full += account_id;
+    full += ACCOUNT_SEPARATOR;
+    return full;
+}
+
 // 交易回报广播 (PUB/SUB)
 inline const char* TRADE_REPORT = "TR";
 
@@ -56,24 +70,44 @@ public:
         updateAddresses();
     }
     
+    // 历史数据 ROUTER (Core 侧 zmq.history_port)
+    void setHistoryPort(int port) {
+        history_port_ = port;
+        updateAddresses();
+    }
+    
     std::string getSubMarketAddr() const { return sub_market_addr_; }
     std::string getReqCmdAddr() const { return req_cmd_addr_; }
+    std::string getHistoryAddr() const { return history_addr_; }
+
+    // 客户端绑定的交易账户 (多账户 Core)；为空表示由 Core 绑定主账户
+    void setAccountId(const std::string& id) { account_id_ = id; }
+    const std::string& getAccountId() const { return account_id_; }
+
+    // 账户相关 topic 的订阅前缀 "<topic>|<account_id>|"
+    std::string accountTopic(const char* topic) const {
+        return zmq_topics::accountTopic(topic, account_id_);
+    }
     
 private:
-    Config() : server_addr_("127.0.0.1"), pub_port_(5555), rep_port_(5556) {
+    Config() : server_addr_("127.0.0.1"), pub_port_(5555), rep_port_(5556), history_port_(5557) {
         updateAddresses();
     }
     
     void updateAddresses() {
         sub_market_addr_ = "tcp://" + server_addr_ + ":" + std::to_string(pub_port_);
         req_cmd_addr_ = "tcp://" + server_addr_ + ":" + std::to_string(rep_port_);
+        history_addr_ = "tcp://" + server_addr_ + ":" + std::to_string(history_port_);
     }
     
     std::string server_addr_;
     int pub_port_;
     int rep_port_;
+    int history_port_;
     std::string sub_market_addr_;
     std::string req_cmd_addr_;
+    std::string history_addr_;
+    std::string account_id_;
 };
 
 // 兼容旧代码的静态地址（默认 localhost）